@@ -1101,10 +1101,18 @@ SOURCE=.\src\sound\mixer.c
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\sound\mixkern.c
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\sound\mixer.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\sound\mixkern.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\sound\msm5205.c
 # End Source File
 # Begin Source File
@@ -1482,6 +1490,10 @@ SOURCE=.\src\memory.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\mtlock.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\multidef.h
 # End Source File
 # Begin Source File
@@ -1510,10 +1522,18 @@ SOURCE=.\src\profiler.c
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\hprof.c
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\profiler.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\hprof.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\sha1.c
 # End Source File
 # Begin Source File
@@ -1538,10 +1558,18 @@ SOURCE=.\src\state.c
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\rewind.c
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\state.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\rewind.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\tilemap.c
 # End Source File
 # Begin Source File
@@ -2316,10 +2344,26 @@ SOURCE=.\src\wpc\dedmd.c
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\wpc\dmdkern.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\wpc\dmdcap.c
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\wpc\dedmd.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\wpc\dmdkern.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\wpc\dmdcap.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\wpc\degames.c
 # End Source File
 # Begin Source File
@@ -2688,10 +2732,18 @@ SOURCE=.\src\wpc\sndbrd.c
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\wpc\swrec.c
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\wpc\sndbrd.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\wpc\swrec.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\wpc\spectra.c
 # End Source File
 # Begin Source File
@@ -3,10 +3,25 @@
 #include <string.h>
 #include "audit.h"
 #include "harddisk.h"
+#include "unzip.h"
+#include "mtlock.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
 
 static tAuditRecord *gAudits = NULL;
 
+/* nonzero between AuditBegin and AuditEnd, which saves the hash cache once */
+static int audit_bracket;
+
+/* the hard disk interface has no context, one disk audit at a time */
 static const struct GameDriver *hard_disk_gamedrv;
+MTLOCK(hard_disk_lock);
 
 /*-------------------------------------------------
 	audit_hard_disk_open - interface for opening
@@ -146,13 +161,7 @@ int RomsetMissing (int game)
    in the romset (same as number of audit records), 0 if romset missing. */
 int AuditRomSet (int game, tAuditRecord **audit)
 {
-	const struct RomModule *region, *rom, *chunk;
-	const char *name;
-	const struct GameDriver *gamedrv;
-
-	int count = 0;
-	tAuditRecord *aud;
-	int	err;
+	int count;
 
 	if (!gAudits)
 	{
@@ -164,10 +173,30 @@ int AuditRomSet (int game, tAuditRecord **audit)
 	}
 
 	if (gAudits)
-		*audit = aud = gAudits;
+		*audit = gAudits;
 	else
 		return 0;
 
+	count = AuditRomSetInto (game, gAudits);
+
+	/* keep the new checksums for the next audit, AuditEnd does it for a bracket */
+	if (!audit_bracket)
+		mame_save_hash_cache();
+
+	return count;
+}
+
+/* Like AuditRomSet, but into the caller's AUD_MAX_ROMS records. Can be
+   called from several threads at once between AuditBegin and AuditEnd. */
+int AuditRomSetInto (int game, tAuditRecord *aud)
+{
+	const struct RomModule *region, *rom, *chunk;
+	const char *name;
+	const struct GameDriver *gamedrv;
+
+	int count = 0;
+	int	err;
+
 	gamedrv = drivers[game];
 
 	if (!gamedrv->rom) return -1;
@@ -267,6 +296,7 @@ int AuditRomSet (int game, tAuditRecord **audit)
 				hash_data_clear(aud->hash);
 				count++;
 
+				mtlock_enter(&hard_disk_lock);
 				hard_disk_gamedrv = gamedrv;
 				hard_disk_set_interface(&audit_hard_disk_interface);
 				source = hard_disk_open( name, 0, NULL );
@@ -299,6 +329,7 @@ int AuditRomSet (int game, tAuditRecord **audit)
 
 					hard_disk_close( source );
 				}
+				mtlock_leave(&hard_disk_lock);
 
 				aud++;
 			}
@@ -328,10 +359,18 @@ int VerifyRomSet (int game, verify_printf_proc verify_printf)
 {
 	tAuditRecord			*aud;
 	int						count;
+
+	count = AuditRomSet (game, &aud);
+	return VerifyAuditRecords (game, aud, count, verify_printf);
+}
+
+/* The reporting part of VerifyRomSet, for the records of AuditRomSet(Into) */
+int VerifyAuditRecords (int game, const tAuditRecord *aud, int count, verify_printf_proc verify_printf)
+{
 	int						archive_status = 0;
 	const struct GameDriver *gamedrv = drivers[game];
 
-	if ((count = AuditRomSet (game, &aud)) == 0)
+	if (count == 0)
 		return NOTFOUND;
 
 	if (count == -1) return CORRECT;
@@ -460,6 +499,286 @@ int VerifyRomSet (int game, verify_printf_proc verify_printf)
 }
 
 
+
+/*-------------------------------------------------
+	AuditBegin/AuditEnd - bracket the audit of
+	many sets, AuditRomSetInto can then be called
+	from several threads
+-------------------------------------------------*/
+
+void AuditBegin (void)
+{
+	/* expand the paths now, not in the threads */
+	osd_get_path_count(FILETYPE_ROM);
+	osd_get_path_count(FILETYPE_IMAGE);
+	osd_get_path_count(FILETYPE_CONFIG);
+	audit_bracket++;
+
+	/* the clones and the parent share a zip, read its directory only once */
+	unzip_cache_shared(1);
+}
+
+void AuditEnd (void)
+{
+	unzip_cache_shared(0);
+	audit_bracket--;
+
+	/* keep the new checksums of all sets for the next audit */
+	mame_save_hash_cache();
+}
+
+
+
+/*-------------------------------------------------
+	VerifyRomSetJSON - one line JSON report of
+	audited records, for scripts
+-------------------------------------------------*/
+
+static void VerifyJSONHash(const char* key, const char* hash, verify_printf_proc verify_printf)
+{
+	static const struct { int function; const char *name; } functions[] =
+	{
+		{ HASH_CRC, "crc" }, { HASH_SHA1, "sha1" }, { HASH_MD5, "md5" }
+	};
+	char buf[256];
+	int i, n = 0;
+
+	verify_printf(",\"%s\":{", key);
+	for (i = 0; i < sizeof(functions) / sizeof(functions[0]); i++)
+		if (hash_data_extract_printable_checksum(hash, functions[i].function, buf))
+			verify_printf("%s\"%s\":\"%s\"", n++ ? "," : "", functions[i].name, buf);
+	verify_printf("}");
+}
+
+void VerifyRomSetJSON (int game, const tAuditRecord *aud, int count, int status, verify_printf_proc verify_printf)
+{
+	static const char *set_status[] =
+	{
+		"correct", "not_found", "incorrect", "clone_not_found", "best_available", "missing_optional"
+	};
+	const struct GameDriver *gamedrv = drivers[game];
+	int i;
+
+	verify_printf("{\"name\":\"%s\",\"parent\":\"%s\",\"status\":\"%s\",\"roms\":[",
+		gamedrv->name, gamedrv->clone_of ? gamedrv->clone_of->name : "",
+		(status >= 0 && status < sizeof(set_status) / sizeof(set_status[0])) ? set_status[status] : "unknown");
+
+	for (i = 0; i < count; i++, aud++)
+	{
+		const char *rom_status;
+
+		switch (aud->status)
+		{
+			case AUD_ROM_GOOD:					rom_status = "good";				break;
+			case AUD_ROM_NEED_REDUMP:			rom_status = "needs_redump";		break;
+			case AUD_ROM_NOT_FOUND:				rom_status = "not_found";			break;
+			case AUD_NOT_AVAILABLE:				rom_status = "no_good_dump";		break;
+			case AUD_BAD_CHECKSUM:				rom_status = "bad_checksum";		break;
+			case AUD_MEM_ERROR:					rom_status = "out_of_memory";		break;
+			case AUD_LENGTH_MISMATCH:			rom_status = "bad_length";			break;
+			case AUD_ROM_NEED_DUMP:				rom_status = "no_good_dump_found";	break;
+			case AUD_DISK_GOOD:					rom_status = "good";				break;
+			case AUD_DISK_NOT_FOUND:			rom_status = "not_found";			break;
+			case AUD_DISK_BAD_MD5:				rom_status = "bad_checksum";		break;
+			case AUD_OPTIONAL_ROM_NOT_FOUND:	rom_status = "optional_not_found";	break;
+			default:							rom_status = "unknown";				break;
+		}
+
+		verify_printf("%s{\"name\":\"%s\",\"status\":\"%s\",\"length\":%u,\"found_length\":%u",
+			i ? "," : "", aud->rom, rom_status, aud->explength, aud->length);
+		VerifyJSONHash("expected", aud->exphash, verify_printf);
+		VerifyJSONHash("found", aud->hash, verify_printf);
+		verify_printf("}");
+	}
+	verify_printf("]}\n");
+}
+
+
+
+/*-------------------------------------------------
+	AuditRomSets - audit a list of sets with a
+	pool of threads, reporting them in order from
+	the calling thread
+-------------------------------------------------*/
+
+#define AUD_MAX_THREADS		64
+#define AUD_AHEAD			4		/* sets audited ahead of the report, per thread */
+
+struct audit_pool
+{
+	const int *games;
+	int numgames;
+	int window;				/* sets in progress or waiting for the report */
+	tAuditRecord *records;	/* window * AUD_MAX_ROMS */
+	int *count;				/* per window slot */
+	UINT8 *done;			/* per window slot */
+	int next;				/* next set to audit */
+	int reported;			/* sets reported */
+#ifdef _WIN32
+	CRITICAL_SECTION lock;
+	CONDITION_VARIABLE cond;
+#else
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+#endif
+};
+
+#ifdef _WIN32
+#define pool_lock(p)		EnterCriticalSection(&(p)->lock)
+#define pool_unlock(p)		LeaveCriticalSection(&(p)->lock)
+#define pool_wait(p)		SleepConditionVariableCS(&(p)->cond, &(p)->lock, INFINITE)
+#define pool_signal(p)		WakeAllConditionVariable(&(p)->cond)
+#else
+#define pool_lock(p)		pthread_mutex_lock(&(p)->lock)
+#define pool_unlock(p)		pthread_mutex_unlock(&(p)->lock)
+#define pool_wait(p)		pthread_cond_wait(&(p)->cond, &(p)->lock)
+#define pool_signal(p)		pthread_cond_broadcast(&(p)->cond)
+#endif
+
+#ifdef _WIN32
+static unsigned __stdcall audit_worker(void *param)
+#else
+static void *audit_worker(void *param)
+#endif
+{
+	struct audit_pool *pool = (struct audit_pool *)param;
+
+	pool_lock(pool);
+	for (;;)
+	{
+		int index, slot, count;
+
+		/* don't get too far ahead of the report */
+		while (pool->next < pool->numgames && pool->next >= pool->reported + pool->window)
+			pool_wait(pool);
+		if (pool->next >= pool->numgames)
+			break;
+		index = pool->next++;
+		pool_unlock(pool);
+
+		slot = index % pool->window;
+		count = AuditRomSetInto(pool->games[index], pool->records + slot * AUD_MAX_ROMS);
+
+		pool_lock(pool);
+		pool->count[slot] = count;
+		pool->done[slot] = 1;
+		pool_signal(pool);
+	}
+	pool_unlock(pool);
+	return 0;
+}
+
+static int audit_cpu_count(void)
+{
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+	return sysconf(_SC_NPROCESSORS_ONLN);
+#else
+	return 1;
+#endif
+}
+
+void AuditRomSets (const int *games, int numgames, int threads, audit_report_proc report, void *param)
+{
+	struct audit_pool pool;
+#ifdef _WIN32
+	HANDLE thread[AUD_MAX_THREADS];
+#else
+	pthread_t thread[AUD_MAX_THREADS];
+#endif
+	int started = 0;
+	int i;
+
+	if (threads <= 0)
+		threads = audit_cpu_count();
+	if (threads > AUD_MAX_THREADS)
+		threads = AUD_MAX_THREADS;
+	if (threads > numgames)
+		threads = numgames;
+
+	AuditBegin();
+
+	memset(&pool, 0, sizeof(pool));
+	pool.games = games;
+	pool.numgames = numgames;
+	pool.window = AUD_AHEAD * (threads > 1 ? threads : 1);
+	pool.records = (tAuditRecord *)calloc(pool.window * AUD_MAX_ROMS, sizeof(tAuditRecord));
+	pool.count = (int *)calloc(pool.window, sizeof(int));
+	pool.done = (UINT8 *)calloc(pool.window, sizeof(UINT8));
+
+	if (pool.records && pool.count && pool.done && threads > 1)
+	{
+#ifdef _WIN32
+		InitializeCriticalSection(&pool.lock);
+		InitializeConditionVariable(&pool.cond);
+		for (started = 0; started < threads; started++)
+			if (!(thread[started] = (HANDLE)_beginthreadex(NULL, 0, audit_worker, &pool, 0, NULL)))
+				break;
+#else
+		pthread_mutex_init(&pool.lock, NULL);
+		pthread_cond_init(&pool.cond, NULL);
+		for (started = 0; started < threads; started++)
+			if (pthread_create(&thread[started], NULL, audit_worker, &pool))
+				break;
+#endif
+	}
+
+	/* without threads (or if none could be started) audit here, one set after the other */
+	if (!started)
+	{
+		tAuditRecord *aud = pool.records ? pool.records : gAudits;
+		if (!aud)
+			aud = gAudits = (tAuditRecord *)calloc(AUD_MAX_ROMS, sizeof(tAuditRecord));
+
+		for (i = 0; i < numgames; i++)
+			report(games[i], aud, aud ? AuditRomSetInto(games[i], aud) : 0, param);
+	}
+	else
+	{
+		for (i = 0; i < numgames; i++)
+		{
+			const int slot = i % pool.window;
+
+			pool_lock(&pool);
+			while (!pool.done[slot])
+				pool_wait(&pool);
+			pool_unlock(&pool);
+
+			report(games[i], pool.records + slot * AUD_MAX_ROMS, pool.count[slot], param);
+
+			pool_lock(&pool);
+			pool.done[slot] = 0;
+			pool.reported++;
+			pool_signal(&pool);
+			pool_unlock(&pool);
+		}
+
+#ifdef _WIN32
+		for (i = 0; i < started; i++)
+		{
+			WaitForSingleObject(thread[i], INFINITE);
+			CloseHandle(thread[i]);
+		}
+		DeleteCriticalSection(&pool.lock);
+#else
+		for (i = 0; i < started; i++)
+			pthread_join(thread[i], NULL);
+		pthread_mutex_destroy(&pool.lock);
+		pthread_cond_destroy(&pool.cond);
+#endif
+	}
+
+	free(pool.records);
+	free(pool.count);
+	free(pool.done);
+
+	AuditEnd();
+}
+
+
 static tMissingSample *gMissingSamples = NULL;
 
 /* Builds a list of every missing sample. Returns total number of missing
@@ -48,8 +48,17 @@ typedef struct
 
 typedef void (CLIB_DECL *verify_printf_proc)(const char *fmt,...);
 
+/* called from AuditRomSets for each set, in the order of the list */
+typedef void (*audit_report_proc)(int game, const tAuditRecord *audit, int count, void *param);
+
 int AuditRomSet (int game, tAuditRecord **audit);
+int AuditRomSetInto (int game, tAuditRecord *audit);
+void AuditRomSets (const int *games, int numgames, int threads, audit_report_proc report, void *param);
+void AuditBegin (void);
+void AuditEnd (void);
 int VerifyRomSet(int game,verify_printf_proc verify_printf);
+int VerifyAuditRecords (int game, const tAuditRecord *audit, int count, verify_printf_proc verify_printf);
+void VerifyRomSetJSON (int game, const tAuditRecord *audit, int count, int status, verify_printf_proc verify_printf);
 int AuditSampleSet (int game, tMissingSample **audit);
 int VerifySampleSet(int game,verify_printf_proc verify_printf);
 int RomInSet (const struct GameDriver *gamedrv, const char* hash);
@@ -10,6 +10,7 @@
 #include "png.h"
 #include "harddisk.h"
 #include "artwork.h"
+#include "zlib.h"
 #include <stdarg.h>
 #include <ctype.h>
 
@@ -82,6 +83,15 @@ static void *hard_disk_handle[4];
 /* system BIOS */
 static int system_bios;
 
+/* CRC of the loaded ROM data */
+static UINT32 rom_crc;
+
+#ifdef PINMAME
+/* ROM region images shared with other machines of the process */
+static const struct rom_share *rom_share;
+static UINT8 region_shared[MAX_MEMORY_REGIONS];
+#endif
+
 
 /***************************************************************************
 
@@ -403,6 +413,14 @@ void free_memory_region(int num)
 {
 	if (num < MAX_MEMORY_REGIONS)
 	{
+#ifdef PINMAME
+		if (region_shared[num])
+		{
+			rom_share->release(Machine->memory_region[num].base, Machine->memory_region[num].length);
+			region_shared[num] = 0;
+		}
+		else
+#endif
 		free(Machine->memory_region[num].base);
 		memset(&Machine->memory_region[num], 0, sizeof(Machine->memory_region[num]));
 	}
@@ -413,6 +431,14 @@ void free_memory_region(int num)
 		{
 			if (Machine->memory_region[i].type == num)
 			{
+#ifdef PINMAME
+				if (region_shared[i])
+				{
+					rom_share->release(Machine->memory_region[i].base, Machine->memory_region[i].length);
+					region_shared[i] = 0;
+				}
+				else
+#endif
 				free(Machine->memory_region[i].base);
 				memset(&Machine->memory_region[i], 0, sizeof(Machine->memory_region[i]));
 				return;
@@ -1806,6 +1832,50 @@ fatalerror:
 }
 
 
+#ifdef PINMAME
+/*-------------------------------------------------
+	rom_set_share - sets the ROM image sharing
+	of the process, NULL for none
+-------------------------------------------------*/
+
+void rom_set_share(const struct rom_share *share)
+{
+	rom_share = share;
+}
+
+
+/*-------------------------------------------------
+	get_shared_region - uses the image of a ROM
+	region another machine already loaded
+-------------------------------------------------*/
+
+static int get_shared_region(const struct RomModule *region)
+{
+	size_t length = ROMREGION_GETLENGTH(region);
+	UINT8 *base;
+	int i;
+
+	if (!rom_share || !ROMREGION_ISROMDATA(region) || ROMREGION_ISDISPOSE(region))
+		return 0;
+	for (i = 0; i < MAX_MEMORY_REGIONS; i++)
+		if (Machine->memory_region[i].base == NULL)
+			break;
+	if (i == MAX_MEMORY_REGIONS)
+		return 0;
+	base = rom_share->get(Machine->gamedrv->name, ROMREGION_GETTYPE(region), length);
+	if (!base)
+		return 0;
+
+	Machine->memory_region[i].base = base;
+	Machine->memory_region[i].length = length;
+	Machine->memory_region[i].type = ROMREGION_GETTYPE(region);
+	Machine->memory_region[i].flags = ROMREGION_GETFLAGS(region);
+	region_shared[i] = 1;
+	return 1;
+}
+#endif
+
+
 /*-------------------------------------------------
 	rom_load - new, more flexible ROM
 	loading system
@@ -1850,6 +1920,12 @@ int rom_load(const struct RomModule *romp)
 		if (Machine->sample_rate == 0 && ROMREGION_ISSOUNDONLY(region))
 			continue;
 
+#ifdef PINMAME
+		/* already loaded and post-processed by another machine */
+		if (get_shared_region(region))
+			continue;
+#endif
+
 		/* allocate memory for the region */
 		if (new_memory_region(regiontype, ROMREGION_GETLENGTH(region), ROMREGION_GETFLAGS(region)))
 		{
@@ -1922,11 +1998,39 @@ int rom_load(const struct RomModule *romp)
 			region_post_process(&romdata, regionlist[regnum]);
 		}
 
+#ifdef PINMAME
+	/* offer the complete images to the other machines */
+	if (rom_share && !romdata.errors && !romdata.warnings)
+		for (regnum = 0; regnum < REGION_MAX; regnum++)
+			if (regionlist[regnum] && ROMREGION_ISROMDATA(regionlist[regnum]) && !ROMREGION_ISDISPOSE(regionlist[regnum]))
+				rom_share->put(Machine->gamedrv->name, regnum, memory_region(regnum), memory_region_length(regnum));
+#endif
+
+	/* keep the checksums of the new or changed ROM files */
+	mame_save_hash_cache();
+
+	/* identify the images as loaded, before anything runs in the RAM of the regions */
+	rom_crc = 0;
+	for (region = romp; region; region = rom_next_region(region))
+		if (ROMREGION_ISROMDATA(region) && memory_region(ROMREGION_GETTYPE(region)))
+			rom_crc = crc32(rom_crc, memory_region(ROMREGION_GETTYPE(region)), memory_region_length(ROMREGION_GETTYPE(region)));
+
 	/* display the results and exit */
 	return display_rom_load_results(&romdata);
 }
 
 
+/*-------------------------------------------------
+	rom_image_crc - CRC of the ROM data regions as
+	rom_load left them
+-------------------------------------------------*/
+
+UINT32 rom_image_crc(void)
+{
+	return rom_crc;
+}
+
+
 /*-------------------------------------------------
 	printromlist - print list of ROMs
 -------------------------------------------------*/
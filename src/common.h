@@ -445,6 +445,7 @@ void *get_disk_handle(int diskindex);
 
 /* ROM processing */
 int rom_load(const struct RomModule *romp);
+UINT32 rom_image_crc(void);
 const struct RomModule *rom_first_region(const struct GameDriver *drv);
 const struct RomModule *rom_next_region(const struct RomModule *romp);
 const struct RomModule *rom_first_file(const struct RomModule *romp);
@@ -454,6 +455,19 @@ const struct RomModule *rom_next_chunk(const struct RomModule *romp);
 
 void printromlist(const struct RomModule *romp,const char *name);
 
+#ifdef PINMAME
+/* ROM region images shared by the machines that run side by side in */
+/* one process (libpinmame instances). get returns a private copy of */
+/* the image that another machine loaded, or NULL. */
+struct rom_share
+{
+	UINT8 *(*get)(const char *game, int type, size_t length);
+	void (*put)(const char *game, int type, const UINT8 *data, size_t length);
+	void (*release)(UINT8 *base, size_t length);
+};
+void rom_set_share(const struct rom_share *share);
+#endif
+
 
 
 /***************************************************************************
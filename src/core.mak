@@ -6,10 +6,10 @@ COREOBJS = $(OBJ)/version.o $(OBJ)/mame.o \
 	$(OBJ)/palette.o $(OBJ)/input.o $(OBJ)/inptport.o $(OBJ)/config.o $(OBJ)/unzip.o \
 	$(OBJ)/audit.o $(OBJ)/info.o $(OBJ)/png.o $(OBJ)/artwork.o \
 	$(OBJ)/tilemap.o $(OBJ)/fileio.o \
-	$(OBJ)/state.o $(OBJ)/datafile.o $(OBJ)/hiscore.o \
+	$(OBJ)/state.o $(OBJ)/rewind.o $(OBJ)/datafile.o $(OBJ)/hiscore.o \
 	$(sort $(CPUOBJS)) \
 	$(OBJ)/sndintrf.o \
-	$(OBJ)/sound/streams.o $(OBJ)/sound/mixer.o $(OBJ)/sound/filter.o \
+	$(OBJ)/sound/streams.o $(OBJ)/sound/mixer.o $(OBJ)/sound/mixkern.o $(OBJ)/sound/filter.o \
 	$(sort $(SOUNDOBJS)) \
 	$(OBJ)/machine/6532riot.o \
 	$(OBJ)/machine/z80fmly.o $(OBJ)/machine/6821pia.o \
@@ -20,7 +20,7 @@ COREOBJS = $(OBJ)/version.o $(OBJ)/mame.o \
 	$(OBJ)/machine/6522via.o $(OBJ)/machine/mb87078.o \
 	$(OBJ)/machine/random.o \
 	$(OBJ)/mamedbg.o $(OBJ)/window.o \
-	$(OBJ)/profiler.o \
+	$(OBJ)/profiler.o $(OBJ)/hprof.o \
 	$(OBJ)/hash.o $(OBJ)/sha1.o \
 	$(OBJ)/harddisk.o $(OBJ)/md5.o $(OBJ)/machine/idectrl.o \
 	$(sort $(DBGOBJS))
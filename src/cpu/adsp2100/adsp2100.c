@@ -77,6 +77,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "cpuintrf.h"
+#include "state.h"
 #if defined(WPCDCSSPEEDUP) && (MAMEVER > 3716)
 #  include "cpuexec.h"
 #endif /* MAMEVER */
@@ -516,11 +517,75 @@ void adsp2100_set_context(void *src)
 **	INITIALIZATION AND SHUTDOWN
 **#################################################################################################*/
 
+static void register_core(int cpu, const char *bank, ADSPCORE *c)
+{
+	static const char *names16[] = { "ax0", "ax1", "ay0", "ay1", "ar", "af", "mx0", "mx1", "my0", "my1", "mf", "si", "se", "sb" };
+	UINT16 *regs16[14];
+	char name[16];
+	int i;
+
+	regs16[0] = &c->ax0.u;  regs16[1] = &c->ax1.u;  regs16[2] = &c->ay0.u;  regs16[3] = &c->ay1.u;
+	regs16[4] = &c->ar.u;   regs16[5] = &c->af.u;   regs16[6] = &c->mx0.u;  regs16[7] = &c->mx1.u;
+	regs16[8] = &c->my0.u;  regs16[9] = &c->my1.u;  regs16[10] = &c->mf.u;  regs16[11] = &c->si.u;
+	regs16[12] = &c->se.u;  regs16[13] = &c->sb.u;
+	for (i = 0; i < 14; i++)
+	{
+		sprintf(name, "%s.%s", bank, names16[i]);
+		state_save_register_UINT16("adsp2100", cpu, name, regs16[i], 1);
+	}
+	sprintf(name, "%s.mr0", bank);
+	state_save_register_UINT32("adsp2100", cpu, name, &c->mr.mry.mr0, 1);
+	sprintf(name, "%s.mr1", bank);
+	state_save_register_UINT32("adsp2100", cpu, name, &c->mr.mry.mr1, 1);
+	sprintf(name, "%s.sr", bank);
+	state_save_register_UINT32("adsp2100", cpu, name, &c->sr.sr, 1);
+}
+
 void adsp2100_init(void)
 {
+	int cpu = cpu_getactivecpu();
+
 	/* create the tables */
 	if (!create_tables())
 		exit(-1);
+
+	register_core(cpu, "core", &adsp2100.core);
+	register_core(cpu, "alt", &adsp2100.alt);
+	state_save_register_UINT32("adsp2100", cpu, "I", adsp2100.i, 8);
+	state_save_register_INT32 ("adsp2100", cpu, "M", adsp2100.m, 8);
+	state_save_register_UINT32("adsp2100", cpu, "L", adsp2100.l, 8);
+	state_save_register_UINT32("adsp2100", cpu, "LMASK", adsp2100.lmask, 8);
+	state_save_register_UINT32("adsp2100", cpu, "BASE", adsp2100.base, 8);
+	state_save_register_UINT8 ("adsp2100", cpu, "PX", &adsp2100.px, 1);
+	state_save_register_UINT32("adsp2100", cpu, "PC", &adsp2100.pc, 1);
+	state_save_register_UINT32("adsp2100", cpu, "PPC", &adsp2100.ppc, 1);
+	state_save_register_UINT32("adsp2100", cpu, "LOOP", &adsp2100.loop, 1);
+	state_save_register_UINT32("adsp2100", cpu, "LOOPCOND", &adsp2100.loop_condition, 1);
+	state_save_register_UINT32("adsp2100", cpu, "CNTR", &adsp2100.cntr, 1);
+	state_save_register_UINT32("adsp2100", cpu, "ASTAT", &adsp2100.astat, 1);
+	state_save_register_UINT32("adsp2100", cpu, "SSTAT", &adsp2100.sstat, 1);
+	state_save_register_UINT32("adsp2100", cpu, "MSTAT", &adsp2100.mstat, 1);
+	state_save_register_UINT32("adsp2100", cpu, "ASTATCLR", &adsp2100.astat_clear, 1);
+	state_save_register_UINT32("adsp2100", cpu, "IDLE", &adsp2100.idle, 1);
+	state_save_register_UINT32("adsp2100", cpu, "LOOPSTACK", adsp2100.loop_stack, LOOP_STACK_DEPTH);
+	state_save_register_UINT32("adsp2100", cpu, "CNTRSTACK", adsp2100.cntr_stack, CNTR_STACK_DEPTH);
+	state_save_register_UINT32("adsp2100", cpu, "PCSTACK", adsp2100.pc_stack, PC_STACK_DEPTH);
+	state_save_register_UINT8 ("adsp2100", cpu, "STATSTACK", &adsp2100.stat_stack[0][0], STAT_STACK_DEPTH * 3);
+	state_save_register_INT32 ("adsp2100", cpu, "PCSP", &adsp2100.pc_sp, 1);
+	state_save_register_INT32 ("adsp2100", cpu, "CNTRSP", &adsp2100.cntr_sp, 1);
+	state_save_register_INT32 ("adsp2100", cpu, "STATSP", &adsp2100.stat_sp, 1);
+	state_save_register_INT32 ("adsp2100", cpu, "LOOPSP", &adsp2100.loop_sp, 1);
+	state_save_register_UINT8 ("adsp2100", cpu, "FLAGOUT", &adsp2100.flagout, 1);
+	state_save_register_UINT8 ("adsp2100", cpu, "FLAGIN", &adsp2100.flagin, 1);
+	state_save_register_UINT8 ("adsp2100", cpu, "FL0", &adsp2100.fl0, 1);
+	state_save_register_UINT8 ("adsp2100", cpu, "FL1", &adsp2100.fl1, 1);
+	state_save_register_UINT8 ("adsp2100", cpu, "FL2", &adsp2100.fl2, 1);
+	state_save_register_UINT8 ("adsp2100", cpu, "IMASK", &adsp2100.imask, 1);
+	state_save_register_UINT8 ("adsp2100", cpu, "ICNTL", &adsp2100.icntl, 1);
+	state_save_register_UINT16("adsp2100", cpu, "IFC", &adsp2100.ifc, 1);
+	state_save_register_UINT8 ("adsp2100", cpu, "IRQSTATE", adsp2100.irq_state, 5);
+	state_save_register_UINT8 ("adsp2100", cpu, "IRQLATCH", adsp2100.irq_latch, 5);
+	state_save_register_INT32 ("adsp2100", cpu, "INTCYCLES", &adsp2100.interrupt_cycles, 1);
 }
 
 void adsp2100_reset(void *param)
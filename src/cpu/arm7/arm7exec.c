@@ -404,12 +404,17 @@ extern unsigned at91_get_reg(int regnum);
 
 // --------------------------------------------------------------------------
 //
-// Windows/Intel JIT 
+// Intel JIT 
 //
 #if JIT_ENABLED
 
 	// call native code translated by the JIT
 jit_go_native:
+#if JIT_X64
+	// no inline assembler here - go through the entry stub, which takes
+	// care of the register setup and the EDI cycle counter for us
+	R15 = jit_call_native(ARM7.jit, JIT_NATIVE(ARM7.jit, pc), &ARM7_ICOUNT);
+#else
 	{
 		// get the native code pointer and cycle counter into stack variables
 		data32_t tmp1 = (data32_t)JIT_NATIVE(ARM7.jit, pc);
@@ -464,6 +469,7 @@ jit_go_native:
 		R15 = tmp1;
 		ARM7_ICOUNT = tmp2;
 	}
+#endif /* JIT_X64 */
 	// resume emulation
 	goto resume_from_jit;
 
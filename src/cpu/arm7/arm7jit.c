@@ -1,5 +1,5 @@
 /*
- *   JIT translator for ARM7 on Windows/Intel
+ *   JIT translator for ARM7 on Intel (Windows x86, POSIX x86-64)
  *   
  *   IMPORTANT USAGE NOTE!  As with the rest of the ARM7 core code, this
  *   module is written to be generic across multiple ARM7-derived processors,
@@ -44,7 +44,9 @@
 
 #if JIT_ENABLED
 
+#ifdef _WIN32
 #include <Windows.h>
+#endif
 #include <stdarg.h>
 
 #include "memory.h"
@@ -62,9 +64,13 @@ static int xlat_recursive(struct jit_ctl *jit, data32_t addr);
 
 // Active registers are in the fixed array ARM7.sArmRegister.  This
 // array is indexed by register number.
-#define Rn(n) Idx, Imm, ((UINT32)&ARM7.sArmRegister[n])
+#define Rn(n) Idx, Imm, JIT_ABS(&ARM7.sArmRegister[n])
 #define RCPSR Rn(eCPSR)
 
+// Call a C function from generated code.  Arguments are pushed beforehand
+// (cdecl order) and must be popped afterwards with ADD ESP, n*JIT_SLOT.
+#define emit_ccall(func) emit(CALL, Label, jit_new_native_label(jit_cfunc(jit, (byte *)(func))))
+
 // Emit a conditional jump.  We'll TEST CPSR against the given flag mask,
 // then do the given conditional jump.
 #define testCPSR(mask)          emit(TEST, DwordPtr, RCPSR, Imm, mask)
@@ -332,7 +338,7 @@ static void gen_test_abort(struct jit_ctl *jit, data32_t addr, int sp_inc)
 
 	struct jit_label *lbl;
 
-	emit(CMP, BytePtr, Idx, Imm, (UINT32)abt, Imm, 0);   // test pending ABORT flag
+	emit(CMP, BytePtr, Idx, Imm, JIT_ABS(abt), Imm, 0);   // test pending ABORT flag
 	emit(JE, Label, lbl = jit_new_fwd_label());          // if no abort, jump ahead
 	emit(MOV, RCYCLECNT, Imm, 0);                        // clear the remaining cycle counter so we exit the emulator loop
 	emit(MOV, EAX, Imm, addr + 4);                       // set PC to next instruction address on return to emulator
@@ -356,10 +362,10 @@ static void gen_test_irq(struct jit_ctl *jit, data32_t addr)
 	// The gist is that a memory read/write may have caused an external source
 	// to throw an IRQ.  FIQ tends to be for something like a timer, which MAME
 	// will check for on its own schedule. 
-//	emit(CMP, BytePtr, Idx, Imm, (UINT32)abt, Imm, 0);
+//	emit(CMP, BytePtr, Idx, Imm, JIT_ABS(abt), Imm, 0);
 //	emit(JE, Label, lbl = jit_new_fwd_label());  
 	emit(MOV, DwordPtr, Rn(15), Imm, addr+4);
-	emit(CALL, Label, jit_new_native_label((byte *)&arm7_check_irq_state));
+	emit_ccall(&arm7_check_irq_state);
 	// If R15 changed, then do a lookup, otherwise move along.
 	emit(MOV, EAX, Rn(15));
 	emit(CMP, EAX, Imm, addr+4);
@@ -388,10 +394,10 @@ static void gen_mem_read(struct jit_ctl *jit, int siz, int rn, data32_t immAddr,
 	}
 
 	// call the emulator memory reader
-	emit(CALL, Label, jit_new_native_label(siz == 8 ? jit->read8 : siz == 16 ? jit->read16 : jit->read32));
+	emit_ccall(siz == 8 ? jit->read8 : siz == 16 ? jit->read16 : jit->read32);
 
 	// pop arguments
-	emit(ADD, ESP, Imm, 4);
+	emit(ADD, ESP, Imm, JIT_SLOT);
 }
 static void gen_mem_write(struct jit_ctl *jit, int siz, data32_t addr, int rd, int rn, data32_t immAddr, int ofs)
 {
@@ -412,14 +418,14 @@ static void gen_mem_write(struct jit_ctl *jit, int siz, data32_t addr, int rd, i
 	else {
 		emit(PUSH, rn);
 		if (ofs != 0)
-			emit(ADD, DwordPtr, Idx, SP, Imm, ofs);
+			emit(ADD, DwordPtr, Idx, ESP, Imm, ofs);
 	}
 
 	// call the emulator memory writer
-	emit(CALL, Label, jit_new_native_label(siz == 8 ? jit->write8 : siz == 16 ? jit->write16 : jit->write32));
+	emit_ccall(siz == 8 ? jit->write8 : siz == 16 ? jit->write16 : jit->write32);
 
 	// pop arguments
-	emit(ADD, ESP, Imm, 8);
+	emit(ADD, ESP, Imm, 2*JIT_SLOT);
 }
 
 // Generate a memory access (read or write).
@@ -636,7 +642,7 @@ static int LDRHB_STRHB(struct jit_ctl *jit, data32_t addr, data32_t insn, int *i
 			// we do need to do the write-back - save the index, do the memory access,
 			// and restore the index
 			emit(PUSH, EBX);
-			gen_mem(jit, rd, ld, siz, sx, addr, is_br, EBX, 0, 4);
+			gen_mem(jit, rd, ld, siz, sx, addr, is_br, EBX, 0, JIT_SLOT);
 			emit(POP, EBX);
 		}
 	}
@@ -671,7 +677,7 @@ static int LDRHB_STRHB(struct jit_ctl *jit, data32_t addr, data32_t insn, int *i
 		// an ABORT, in which case the write-back is skipped.
 		if (wrt) {
 			emit(PUSH, EBX);
-			sp_inc += 4;
+			sp_inc += JIT_SLOT;
 		}
 		
 		// perform the memory operation
@@ -680,7 +686,7 @@ static int LDRHB_STRHB(struct jit_ctl *jit, data32_t addr, data32_t insn, int *i
 		// if writing back, restore the index value
 		if (wrt) {
 			emit(POP, EBX);
-			sp_inc -= 4;
+			sp_inc -= JIT_SLOT;
 		}
 	}
 
@@ -1304,7 +1310,7 @@ static int ALU(struct jit_ctl *jit, data32_t addr, data32_t insn, int *is_br, in
 				emit(MOV, Rn(rd), result_reg);
 
 				// call our helper routine to load SPSR into CPSR and switch modes.  Also check if run count exhausted.
-				emit(CALL, Label, jit_new_native_label((byte *)&spsr_to_cpsr));
+				emit_ccall(&spsr_to_cpsr);
 				emit(MOV, EAX, Rn(15));
 				/*emit(CMP, RCYCLECNT, Imm, 0);
 				emit(JG, Label, lbl = jit_new_fwd_label());
@@ -1316,7 +1322,7 @@ static int ALU(struct jit_ctl *jit, data32_t addr, data32_t insn, int *is_br, in
 			{
 				// Jump to the result value by loading it into R15.  Check IRQs and run count.
 				emit(MOV, Rn(rd), result_reg);
-				emit(CALL, Label, jit_new_native_label((byte *)&arm7_check_irq_state));
+				emit_ccall(&arm7_check_irq_state);
 				emit(MOV, EAX, Rn(15));
 			/*	emit(CMP, RCYCLECNT, Imm, 0);
 				emit(JG, Label, lbl = jit_new_fwd_label());
@@ -1421,7 +1427,7 @@ static int LDR_STR(struct jit_ctl *jit, data32_t addr, data32_t insn, int *is_br
 			emit(PUSH, EBX);
 
 			// do the memory operation
-			gen_mem(jit, rd, ld, byt ? 8 : 32, 0, addr, is_br, EBX, 0, 4);
+			gen_mem(jit, rd, ld, byt ? 8 : 32, 0, addr, is_br, EBX, 0, JIT_SLOT);
 
 			// restore the index value for the write-back
 			emit(POP, EBX);
@@ -1453,7 +1459,7 @@ static int LDR_STR(struct jit_ctl *jit, data32_t addr, data32_t insn, int *is_br
 		// the duration of the call - we'll need it to write back afterwards
 		// (we can't do ahead of time because of the possibility of an ABORT)
 		if (wrt) {
-			sp_inc += 4;
+			sp_inc += JIT_SLOT;
 			emit(PUSH, EBX);
 		}
 
@@ -1463,7 +1469,7 @@ static int LDR_STR(struct jit_ctl *jit, data32_t addr, data32_t insn, int *is_br
 		// recover the index register if writing back
 		if (wrt) {
 			emit(POP, EBX);
-			sp_inc -= 4;
+			sp_inc -= JIT_SLOT;
 		}
 	}
 
@@ -1516,8 +1522,8 @@ static int SWAP(struct jit_ctl *jit, data32_t addr, data32_t insn, int *cycles)
 	// read a byte/dword from the memory location indexed by rn (now in EBX)
 	emit(PUSH, EBX);           // save EBX on the stack for the duration of the call
 	emit(PUSH, EBX);           // push Rn index value as argument
-	emit(CALL, Label, jit_new_native_label(siz == 8 ? jit->read8 : jit->read32));  // call read8/32
-	emit(ADD, ESP, Imm, 4);    // discard arguments
+	emit_ccall(siz == 8 ? jit->read8 : jit->read32);  // call read8/32
+	emit(ADD, ESP, Imm, JIT_SLOT);    // discard arguments
 	emit(POP, EBX);            // restore the rn value in EBX
 
 	// The byte/dword we read from the memory location is now in EAX.  Save it for a moment.
@@ -1526,8 +1532,8 @@ static int SWAP(struct jit_ctl *jit, data32_t addr, data32_t insn, int *cycles)
 	// store the contents of rm in the memory location
 	emit(PUSH, DwordPtr, Rn(rm));  // push value argument (the contents of Rm)
 	emit(PUSH, EBX);           // push address argument (EBX, the contents of Rn)
-	emit(CALL, Label, jit_new_native_label(siz == 8 ? jit->write8 : jit->write32)); // call write8/32
-	emit(ADD, ESP, Imm, 8);    // discard arguments
+	emit_ccall(siz == 8 ? jit->write8 : jit->write32); // call write8/32
+	emit(ADD, ESP, Imm, 2*JIT_SLOT);    // discard arguments
 
 	// recover the saved data that we read from te memory location earlier, and store it in Rd
 	emit(POP, EAX);
@@ -1591,8 +1597,8 @@ static int PSRX(struct jit_ctl *jit, data32_t addr, data32_t insn, int *cycles)
 		//emit(MOV, DwordPtr, Rn(15), Imm, addr+4);
 		// call HandleMSR(spsr, val, insn) to do the update
 		emit(PUSH, Imm, spsr);
-		emit(CALL, Label, jit_new_native_label((byte *)&HandleMSR));
-		emit(ADD, ESP, Imm, 12);
+		emit_ccall(&HandleMSR);
+		emit(ADD, ESP, Imm, 3*JIT_SLOT);
 		// Changing IRQ mask may have caused a branch. 
 		//emit(MOV, EAX, Rn(15));
 		//emit(JMP, Label, jit_new_native_label(jit->pLookup));
@@ -1607,8 +1613,8 @@ static int PSRX(struct jit_ctl *jit, data32_t addr, data32_t insn, int *cycles)
 		// call HandleMRS(rd, spsr) to retrieve the value
 		emit(PUSH, Imm, spsr);
 		emit(PUSH, Imm, rd);
-		emit(CALL, Label, jit_new_native_label((byte *)&HandleMRS));
-		emit(ADD, ESP, Imm, 8);
+		emit_ccall(&HandleMRS);
+		emit(ADD, ESP, Imm, 2*JIT_SLOT);
 	}
 
 	// successful translation
@@ -1698,8 +1704,8 @@ static int LDM_STM(struct jit_ctl *jit, data32_t addr, data32_t insn, int *is_br
 			emit(PUSH, Imm, S);
 			emit(PUSH, EAX);
 			emit(PUSH, Imm, pat);
-			emit(CALL, Label, jit_new_native_label(func));
-			emit(ADD, ESP, Imm, 16);
+			emit_ccall(func);
+			emit(ADD, ESP, Imm, 4*JIT_SLOT);
 		}
 		else
 		{
@@ -1710,8 +1716,8 @@ static int LDM_STM(struct jit_ctl *jit, data32_t addr, data32_t insn, int *is_br
 			emit(PUSH, Imm, eARM7_MODE_USER);
 			emit(PUSH, EAX);
 			emit(PUSH, Imm, pat);
-			emit(CALL, Label, jit_new_native_label(func));
-			emit(ADD, ESP, Imm, 12);
+			emit_ccall(func);
+			emit(ADD, ESP, Imm, 3*JIT_SLOT);
 		}
 	}
 	else
@@ -1749,11 +1755,11 @@ static int LDM_STM(struct jit_ctl *jit, data32_t addr, data32_t insn, int *is_br
 				{
 					// call read32(ESI)
 					emit(PUSH, ESI);
-					emit(CALL, Label, jit_new_native_label(jit->read32));
-					emit(ADD, ESP, Imm, 4);
+					emit_ccall(jit->read32);
+					emit(ADD, ESP, Imm, JIT_SLOT);
 
 					// test ABORT - loading registers stops on abort
-					emit(CMP, BytePtr, Idx, Imm, (UINT32)abt, Imm, 0);
+					emit(CMP, BytePtr, Idx, Imm, JIT_ABS(abt), Imm, 0);
 					emit(JNE, Label, lAbort);
 
 					// store the result in the current register
@@ -1768,8 +1774,8 @@ static int LDM_STM(struct jit_ctl *jit, data32_t addr, data32_t insn, int *is_br
 					else
 						emit(PUSH, DwordPtr, Rn(r));
 					emit(PUSH, ESI);
-					emit(CALL, Label, jit_new_native_label(jit->write32));
-					emit(ADD, ESP, Imm, 8);
+					emit_ccall(jit->write32);
+					emit(ADD, ESP, Imm, 2*JIT_SLOT);
 
 					// Note that the emulator version of Store doesn't stop on abort,
 					// so we won't either
@@ -1780,7 +1786,7 @@ static int LDM_STM(struct jit_ctl *jit, data32_t addr, data32_t insn, int *is_br
 
 	// We're done with the memory transfers.  These could have triggered an ABORT
 	// from the memory manager, so check for it.
-	emit(CMP, BytePtr, Idx, Imm, (UINT32)abt, Imm, 0);
+	emit(CMP, BytePtr, Idx, Imm, JIT_ABS(abt), Imm, 0);
 	emit(JE, Label, lNoAbort = jit_new_fwd_label());
 
 	// generate the abort handler - zero the cycle counter and return to the emulator
@@ -1806,12 +1812,12 @@ static int LDM_STM(struct jit_ctl *jit, data32_t addr, data32_t insn, int *is_br
 
 		// S - Flag Set Signals transfer of current mode SPSR->CPSR
 		if (insn & INSN_BDT_S)
-			emit(CALL, Label, jit_new_native_label((byte *)&HandleLDMS_ModeChange));
+			emit_ccall(&HandleLDMS_ModeChange);
 
 		// Generate a jump to the new R15
 		*is_br = 1;
 		// Check to see if changed flags causes an IRQ jump
-		emit(CALL, Label, jit_new_native_label((byte *)&arm7_check_irq_state));
+		emit_ccall(&arm7_check_irq_state);
 		emit(MOV, EAX, Rn(15));
 	/*	emit(CMP, RCYCLECNT, Imm, 0);
 		emit(JG, Label, lbl = jit_new_fwd_label());
@@ -89,7 +89,7 @@ extern	UINT8	*RAM;
 	((cur_mrhard[(addr) >> (ABITS2_16 + ABITS_MIN_16)]) ?		\
 		cpu_readmem16(addr) : RAM[addr])
 #else
-#define RDMEM(addr) cpu_readmem16(addr)
+#define RDMEM(addr) cpu_readmem16_page(addr)
 #endif
 
 /***************************************************************
@@ -102,7 +102,7 @@ extern	UINT8	*RAM;
 	else														\
 		RAM[addr] = data
 #else
-#define WRMEM(addr,data) cpu_writemem16(addr,data)
+#define WRMEM(addr,data) cpu_writemem16_page(addr,data)
 #endif
 
 /***************************************************************
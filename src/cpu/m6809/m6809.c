@@ -82,6 +82,18 @@
 #define BIG_SWITCH  1
 #endif
 
+/* Enable threaded dispatch: every opcode jumps through a table of labels
+   straight to the next one and the $10/$11 prefixes go to their second
+   opcode at once. Needs GCC's computed goto, -DM6809_THREADED=0 builds the
+   switch instead. */
+#ifndef M6809_THREADED
+#ifdef __GNUC__
+#define M6809_THREADED	1
+#else
+#define M6809_THREADED	0
+#endif
+#endif
+
 #define VERBOSE 0
 
 #if VERBOSE
@@ -673,9 +685,137 @@ unsigned m6809_dasm(char *buffer, unsigned pc)
 /* includes the actual opcode implementations */
 #include "6809ops.c"
 
+#if M6809_THREADED
+#define DISPATCH								\
+	pPPC = pPC;									\
+	CALL_MAME_DEBUG;							\
+	m6809.ireg = ROP(PCD);						\
+	PC++;										\
+	goto *op_main[m6809.ireg]
+
+#define NEXT									\
+	if( m6809_ICount <= 0 ) goto done;			\
+	DISPATCH
+
+#define DISPATCH_PAGE(table)					\
+	{											\
+		UINT8 ireg2 = ROP(PCD);					\
+		PC++;									\
+		goto *table[ireg2];						\
+	}
+#endif
+
 /* execute instructions on this CPU until icount expires */
 int m6809_execute(int cycles)	/* NS 970908 */
 {
+#if M6809_THREADED
+	static const void *const op_main[0x100] =
+	{
+		&&op_00, &&op_01, &&op_02, &&op_03, &&op_04, &&op_05, &&op_06, &&op_07,	/* 00 */
+		&&op_08, &&op_09, &&op_0a, &&op_0b, &&op_0c, &&op_0d, &&op_0e, &&op_0f,
+		&&op_10, &&op_11, &&op_12, &&op_13, &&op_14, &&op_15, &&op_16, &&op_17,	/* 10 */
+		&&op_18, &&op_19, &&op_1a, &&op_1b, &&op_1c, &&op_1d, &&op_1e, &&op_1f,
+		&&op_20, &&op_21, &&op_22, &&op_23, &&op_24, &&op_25, &&op_26, &&op_27,	/* 20 */
+		&&op_28, &&op_29, &&op_2a, &&op_2b, &&op_2c, &&op_2d, &&op_2e, &&op_2f,
+		&&op_30, &&op_31, &&op_32, &&op_33, &&op_34, &&op_35, &&op_36, &&op_37,	/* 30 */
+		&&op_38, &&op_39, &&op_3a, &&op_3b, &&op_3c, &&op_3d, &&op_3e, &&op_3f,
+		&&op_40, &&op_41, &&op_42, &&op_43, &&op_44, &&op_45, &&op_46, &&op_47,	/* 40 */
+		&&op_48, &&op_49, &&op_4a, &&op_4b, &&op_4c, &&op_4d, &&op_4e, &&op_4f,
+		&&op_50, &&op_51, &&op_52, &&op_53, &&op_54, &&op_55, &&op_56, &&op_57,	/* 50 */
+		&&op_58, &&op_59, &&op_5a, &&op_5b, &&op_5c, &&op_5d, &&op_5e, &&op_5f,
+		&&op_60, &&op_61, &&op_62, &&op_63, &&op_64, &&op_65, &&op_66, &&op_67,	/* 60 */
+		&&op_68, &&op_69, &&op_6a, &&op_6b, &&op_6c, &&op_6d, &&op_6e, &&op_6f,
+		&&op_70, &&op_71, &&op_72, &&op_73, &&op_74, &&op_75, &&op_76, &&op_77,	/* 70 */
+		&&op_78, &&op_79, &&op_7a, &&op_7b, &&op_7c, &&op_7d, &&op_7e, &&op_7f,
+		&&op_80, &&op_81, &&op_82, &&op_83, &&op_84, &&op_85, &&op_86, &&op_87,	/* 80 */
+		&&op_88, &&op_89, &&op_8a, &&op_8b, &&op_8c, &&op_8d, &&op_8e, &&op_8f,
+		&&op_90, &&op_91, &&op_92, &&op_93, &&op_94, &&op_95, &&op_96, &&op_97,	/* 90 */
+		&&op_98, &&op_99, &&op_9a, &&op_9b, &&op_9c, &&op_9d, &&op_9e, &&op_9f,
+		&&op_a0, &&op_a1, &&op_a2, &&op_a3, &&op_a4, &&op_a5, &&op_a6, &&op_a7,	/* a0 */
+		&&op_a8, &&op_a9, &&op_aa, &&op_ab, &&op_ac, &&op_ad, &&op_ae, &&op_af,
+		&&op_b0, &&op_b1, &&op_b2, &&op_b3, &&op_b4, &&op_b5, &&op_b6, &&op_b7,	/* b0 */
+		&&op_b8, &&op_b9, &&op_ba, &&op_bb, &&op_bc, &&op_bd, &&op_be, &&op_bf,
+		&&op_c0, &&op_c1, &&op_c2, &&op_c3, &&op_c4, &&op_c5, &&op_c6, &&op_c7,	/* c0 */
+		&&op_c8, &&op_c9, &&op_ca, &&op_cb, &&op_cc, &&op_cd, &&op_ce, &&op_cf,
+		&&op_d0, &&op_d1, &&op_d2, &&op_d3, &&op_d4, &&op_d5, &&op_d6, &&op_d7,	/* d0 */
+		&&op_d8, &&op_d9, &&op_da, &&op_db, &&op_dc, &&op_dd, &&op_de, &&op_df,
+		&&op_e0, &&op_e1, &&op_e2, &&op_e3, &&op_e4, &&op_e5, &&op_e6, &&op_e7,	/* e0 */
+		&&op_e8, &&op_e9, &&op_ea, &&op_eb, &&op_ec, &&op_ed, &&op_ee, &&op_ef,
+		&&op_f0, &&op_f1, &&op_f2, &&op_f3, &&op_f4, &&op_f5, &&op_f6, &&op_f7,	/* f0 */
+		&&op_f8, &&op_f9, &&op_fa, &&op_fb, &&op_fc, &&op_fd, &&op_fe, &&op_ff
+	};
+	static const void *const op_page2[0x100] =
+	{
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* 00 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* 10 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,
+		&&op_ill, &&op_1021, &&op_1022, &&op_1023, &&op_1024, &&op_1025, &&op_1026, &&op_1027,	/* 20 */
+		&&op_1028, &&op_1029, &&op_102a, &&op_102b, &&op_102c, &&op_102d, &&op_102e, &&op_102f,
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* 30 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_103f,
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* 40 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* 50 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* 60 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* 70 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,
+		&&op_ill, &&op_ill, &&op_ill, &&op_1083, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* 80 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_108c, &&op_ill, &&op_108e, &&op_108f,
+		&&op_ill, &&op_ill, &&op_ill, &&op_1093, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* 90 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_109c, &&op_ill, &&op_109e, &&op_109f,
+		&&op_ill, &&op_ill, &&op_ill, &&op_10a3, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* a0 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_10ac, &&op_ill, &&op_10ae, &&op_10af,
+		&&op_ill, &&op_ill, &&op_ill, &&op_10b3, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* b0 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_10bc, &&op_ill, &&op_10be, &&op_10bf,
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* c0 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_10ce, &&op_10cf,
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* d0 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_10de, &&op_10df,
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* e0 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_10ee, &&op_10ef,
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* f0 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_10fe, &&op_10ff
+	};
+	static const void *const op_page3[0x100] =
+	{
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* 00 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* 10 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* 20 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* 30 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_113f,
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* 40 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* 50 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* 60 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* 70 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,
+		&&op_ill, &&op_ill, &&op_ill, &&op_1183, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* 80 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_118c, &&op_ill, &&op_ill, &&op_ill,
+		&&op_ill, &&op_ill, &&op_ill, &&op_1193, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* 90 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_119c, &&op_ill, &&op_ill, &&op_ill,
+		&&op_ill, &&op_ill, &&op_ill, &&op_11a3, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* a0 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_11ac, &&op_ill, &&op_ill, &&op_ill,
+		&&op_ill, &&op_ill, &&op_ill, &&op_11b3, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* b0 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_11bc, &&op_ill, &&op_ill, &&op_ill,
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* c0 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* d0 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* e0 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill,	/* f0 */
+		&&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill, &&op_ill
+	};
+#endif
+
     m6809_ICount = cycles - m6809.extra_cycles;
 	m6809.extra_cycles = 0;
 
@@ -685,6 +825,321 @@ int m6809_execute(int cycles)	/* NS 970908 */
 	}
 	else
 	{
+#if M6809_THREADED
+		DISPATCH;
+
+	op_00:    neg_di();   m6809_ICount-= 6; NEXT;
+	op_01:    neg_di();   m6809_ICount-= 6; NEXT; /* undocumented */
+	op_02:    illegal();  m6809_ICount-= 2; NEXT;
+	op_03:    com_di();   m6809_ICount-= 6; NEXT;
+	op_04:    lsr_di();   m6809_ICount-= 6; NEXT;
+	op_05:    illegal();  m6809_ICount-= 2; NEXT;
+	op_06:    ror_di();   m6809_ICount-= 6; NEXT;
+	op_07:    asr_di();   m6809_ICount-= 6; NEXT;
+	op_08:    asl_di();   m6809_ICount-= 6; NEXT;
+	op_09:    rol_di();   m6809_ICount-= 6; NEXT;
+	op_0a:    dec_di();   m6809_ICount-= 6; NEXT;
+	op_0b:    illegal();  m6809_ICount-= 2; NEXT;
+	op_0c:    inc_di();   m6809_ICount-= 6; NEXT;
+	op_0d:    tst_di();   m6809_ICount-= 6; NEXT;
+	op_0e:    jmp_di();   m6809_ICount-= 3; NEXT;
+	op_0f:    clr_di();   m6809_ICount-= 6; NEXT;
+	op_10:    DISPATCH_PAGE(op_page2);
+	op_11:    DISPATCH_PAGE(op_page3);
+	op_12:    nop();      m6809_ICount-= 2; NEXT;
+	op_13:    sync();     m6809_ICount-= 4; NEXT;
+	op_14:    illegal();  m6809_ICount-= 2; NEXT;
+	op_15:    illegal();  m6809_ICount-= 2; NEXT;
+	op_16:    lbra();     m6809_ICount-= 5; NEXT;
+	op_17:    lbsr();     m6809_ICount-= 9; NEXT;
+	op_18:    illegal();  m6809_ICount-= 2; NEXT;
+	op_19:    daa();      m6809_ICount-= 2; NEXT;
+	op_1a:    orcc();     m6809_ICount-= 3; NEXT;
+	op_1b:    illegal();  m6809_ICount-= 2; NEXT;
+	op_1c:    andcc();    m6809_ICount-= 3; NEXT;
+	op_1d:    sex();      m6809_ICount-= 2; NEXT;
+	op_1e:    exg();      m6809_ICount-= 8; NEXT;
+	op_1f:    tfr();      m6809_ICount-= 6; NEXT;
+	op_20:    bra();      m6809_ICount-= 3; NEXT;
+	op_21:    brn();      m6809_ICount-= 3; NEXT;
+	op_22:    bhi();      m6809_ICount-= 3; NEXT;
+	op_23:    bls();      m6809_ICount-= 3; NEXT;
+	op_24:    bcc();      m6809_ICount-= 3; NEXT;
+	op_25:    bcs();      m6809_ICount-= 3; NEXT;
+	op_26:    bne();      m6809_ICount-= 3; NEXT;
+	op_27:    beq();      m6809_ICount-= 3; NEXT;
+	op_28:    bvc();      m6809_ICount-= 3; NEXT;
+	op_29:    bvs();      m6809_ICount-= 3; NEXT;
+	op_2a:    bpl();      m6809_ICount-= 3; NEXT;
+	op_2b:    bmi();      m6809_ICount-= 3; NEXT;
+	op_2c:    bge();      m6809_ICount-= 3; NEXT;
+	op_2d:    blt();      m6809_ICount-= 3; NEXT;
+	op_2e:    bgt();      m6809_ICount-= 3; NEXT;
+	op_2f:    ble();      m6809_ICount-= 3; NEXT;
+	op_30:    leax();     m6809_ICount-= 4; NEXT;
+	op_31:    leay();     m6809_ICount-= 4; NEXT;
+	op_32:    leas();     m6809_ICount-= 4; NEXT;
+	op_33:    leau();     m6809_ICount-= 4; NEXT;
+	op_34:    pshs();     m6809_ICount-= 5; NEXT;
+	op_35:    puls();     m6809_ICount-= 5; NEXT;
+	op_36:    pshu();     m6809_ICount-= 5; NEXT;
+	op_37:    pulu();     m6809_ICount-= 5; NEXT;
+	op_38:    illegal();  m6809_ICount-= 2; NEXT;
+	op_39:    rts();      m6809_ICount-= 5; NEXT;
+	op_3a:    abx();      m6809_ICount-= 3; NEXT;
+	op_3b:    rti();      m6809_ICount-= 6; NEXT;
+	op_3c:    cwai();     m6809_ICount-=20; NEXT;
+	op_3d:    mul();      m6809_ICount-=11; NEXT;
+	op_3e:    illegal();  m6809_ICount-= 2; NEXT;
+	op_3f:    swi();      m6809_ICount-=19; NEXT;
+	op_40:    nega();     m6809_ICount-= 2; NEXT;
+	op_41:    illegal();  m6809_ICount-= 2; NEXT;
+	op_42:    illegal();  m6809_ICount-= 2; NEXT;
+	op_43:    coma();     m6809_ICount-= 2; NEXT;
+	op_44:    lsra();     m6809_ICount-= 2; NEXT;
+	op_45:    illegal();  m6809_ICount-= 2; NEXT;
+	op_46:    rora();     m6809_ICount-= 2; NEXT;
+	op_47:    asra();     m6809_ICount-= 2; NEXT;
+	op_48:    asla();     m6809_ICount-= 2; NEXT;
+	op_49:    rola();     m6809_ICount-= 2; NEXT;
+	op_4a:    deca();     m6809_ICount-= 2; NEXT;
+	op_4b:    illegal();  m6809_ICount-= 2; NEXT;
+	op_4c:    inca();     m6809_ICount-= 2; NEXT;
+	op_4d:    tsta();     m6809_ICount-= 2; NEXT;
+	op_4e:    illegal();  m6809_ICount-= 2; NEXT;
+	op_4f:    clra();     m6809_ICount-= 2; NEXT;
+	op_50:    negb();     m6809_ICount-= 2; NEXT;
+	op_51:    illegal();  m6809_ICount-= 2; NEXT;
+	op_52:    illegal();  m6809_ICount-= 2; NEXT;
+	op_53:    comb();     m6809_ICount-= 2; NEXT;
+	op_54:    lsrb();     m6809_ICount-= 2; NEXT;
+	op_55:    illegal();  m6809_ICount-= 2; NEXT;
+	op_56:    rorb();     m6809_ICount-= 2; NEXT;
+	op_57:    asrb();     m6809_ICount-= 2; NEXT;
+	op_58:    aslb();     m6809_ICount-= 2; NEXT;
+	op_59:    rolb();     m6809_ICount-= 2; NEXT;
+	op_5a:    decb();     m6809_ICount-= 2; NEXT;
+	op_5b:    illegal();  m6809_ICount-= 2; NEXT;
+	op_5c:    incb();     m6809_ICount-= 2; NEXT;
+	op_5d:    tstb();     m6809_ICount-= 2; NEXT;
+	op_5e:    illegal();  m6809_ICount-= 2; NEXT;
+	op_5f:    clrb();     m6809_ICount-= 2; NEXT;
+	op_60:    neg_ix();   m6809_ICount-= 6; NEXT;
+	op_61:    illegal();  m6809_ICount-= 2; NEXT;
+	op_62:    illegal();  m6809_ICount-= 2; NEXT;
+	op_63:    com_ix();   m6809_ICount-= 6; NEXT;
+	op_64:    lsr_ix();   m6809_ICount-= 6; NEXT;
+	op_65:    illegal();  m6809_ICount-= 2; NEXT;
+	op_66:    ror_ix();   m6809_ICount-= 6; NEXT;
+	op_67:    asr_ix();   m6809_ICount-= 6; NEXT;
+	op_68:    asl_ix();   m6809_ICount-= 6; NEXT;
+	op_69:    rol_ix();   m6809_ICount-= 6; NEXT;
+	op_6a:    dec_ix();   m6809_ICount-= 6; NEXT;
+	op_6b:    illegal();  m6809_ICount-= 2; NEXT;
+	op_6c:    inc_ix();   m6809_ICount-= 6; NEXT;
+	op_6d:    tst_ix();   m6809_ICount-= 6; NEXT;
+	op_6e:    jmp_ix();   m6809_ICount-= 3; NEXT;
+	op_6f:    clr_ix();   m6809_ICount-= 6; NEXT;
+	op_70:    neg_ex();   m6809_ICount-= 7; NEXT;
+	op_71:    illegal();  m6809_ICount-= 2; NEXT;
+	op_72:    illegal();  m6809_ICount-= 2; NEXT;
+	op_73:    com_ex();   m6809_ICount-= 7; NEXT;
+	op_74:    lsr_ex();   m6809_ICount-= 7; NEXT;
+	op_75:    illegal();  m6809_ICount-= 2; NEXT;
+	op_76:    ror_ex();   m6809_ICount-= 7; NEXT;
+	op_77:    asr_ex();   m6809_ICount-= 7; NEXT;
+	op_78:    asl_ex();   m6809_ICount-= 7; NEXT;
+	op_79:    rol_ex();   m6809_ICount-= 7; NEXT;
+	op_7a:    dec_ex();   m6809_ICount-= 7; NEXT;
+	op_7b:    illegal();  m6809_ICount-= 2; NEXT;
+	op_7c:    inc_ex();   m6809_ICount-= 7; NEXT;
+	op_7d:    tst_ex();   m6809_ICount-= 7; NEXT;
+	op_7e:    jmp_ex();   m6809_ICount-= 4; NEXT;
+	op_7f:    clr_ex();   m6809_ICount-= 7; NEXT;
+	op_80:    suba_im();  m6809_ICount-= 2; NEXT;
+	op_81:    cmpa_im();  m6809_ICount-= 2; NEXT;
+	op_82:    sbca_im();  m6809_ICount-= 2; NEXT;
+	op_83:    subd_im();  m6809_ICount-= 4; NEXT;
+	op_84:    anda_im();  m6809_ICount-= 2; NEXT;
+	op_85:    bita_im();  m6809_ICount-= 2; NEXT;
+	op_86:    lda_im();   m6809_ICount-= 2; NEXT;
+	op_87:    sta_im();   m6809_ICount-= 2; NEXT;
+	op_88:    eora_im();  m6809_ICount-= 2; NEXT;
+	op_89:    adca_im();  m6809_ICount-= 2; NEXT;
+	op_8a:    ora_im();   m6809_ICount-= 2; NEXT;
+	op_8b:    adda_im();  m6809_ICount-= 2; NEXT;
+	op_8c:    cmpx_im();  m6809_ICount-= 4; NEXT;
+	op_8d:    bsr();      m6809_ICount-= 7; NEXT;
+	op_8e:    ldx_im();   m6809_ICount-= 3; NEXT;
+	op_8f:    stx_im();   m6809_ICount-= 2; NEXT;
+	op_90:    suba_di();  m6809_ICount-= 4; NEXT;
+	op_91:    cmpa_di();  m6809_ICount-= 4; NEXT;
+	op_92:    sbca_di();  m6809_ICount-= 4; NEXT;
+	op_93:    subd_di();  m6809_ICount-= 6; NEXT;
+	op_94:    anda_di();  m6809_ICount-= 4; NEXT;
+	op_95:    bita_di();  m6809_ICount-= 4; NEXT;
+	op_96:    lda_di();   m6809_ICount-= 4; NEXT;
+	op_97:    sta_di();   m6809_ICount-= 4; NEXT;
+	op_98:    eora_di();  m6809_ICount-= 4; NEXT;
+	op_99:    adca_di();  m6809_ICount-= 4; NEXT;
+	op_9a:    ora_di();   m6809_ICount-= 4; NEXT;
+	op_9b:    adda_di();  m6809_ICount-= 4; NEXT;
+	op_9c:    cmpx_di();  m6809_ICount-= 6; NEXT;
+	op_9d:    jsr_di();   m6809_ICount-= 7; NEXT;
+	op_9e:    ldx_di();   m6809_ICount-= 5; NEXT;
+	op_9f:    stx_di();   m6809_ICount-= 5; NEXT;
+	op_a0:    suba_ix();  m6809_ICount-= 4; NEXT;
+	op_a1:    cmpa_ix();  m6809_ICount-= 4; NEXT;
+	op_a2:    sbca_ix();  m6809_ICount-= 4; NEXT;
+	op_a3:    subd_ix();  m6809_ICount-= 6; NEXT;
+	op_a4:    anda_ix();  m6809_ICount-= 4; NEXT;
+	op_a5:    bita_ix();  m6809_ICount-= 4; NEXT;
+	op_a6:    lda_ix();   m6809_ICount-= 4; NEXT;
+	op_a7:    sta_ix();   m6809_ICount-= 4; NEXT;
+	op_a8:    eora_ix();  m6809_ICount-= 4; NEXT;
+	op_a9:    adca_ix();  m6809_ICount-= 4; NEXT;
+	op_aa:    ora_ix();   m6809_ICount-= 4; NEXT;
+	op_ab:    adda_ix();  m6809_ICount-= 4; NEXT;
+	op_ac:    cmpx_ix();  m6809_ICount-= 6; NEXT;
+	op_ad:    jsr_ix();   m6809_ICount-= 7; NEXT;
+	op_ae:    ldx_ix();   m6809_ICount-= 5; NEXT;
+	op_af:    stx_ix();   m6809_ICount-= 5; NEXT;
+	op_b0:    suba_ex();  m6809_ICount-= 5; NEXT;
+	op_b1:    cmpa_ex();  m6809_ICount-= 5; NEXT;
+	op_b2:    sbca_ex();  m6809_ICount-= 5; NEXT;
+	op_b3:    subd_ex();  m6809_ICount-= 7; NEXT;
+	op_b4:    anda_ex();  m6809_ICount-= 5; NEXT;
+	op_b5:    bita_ex();  m6809_ICount-= 5; NEXT;
+	op_b6:    lda_ex();   m6809_ICount-= 5; NEXT;
+	op_b7:    sta_ex();   m6809_ICount-= 5; NEXT;
+	op_b8:    eora_ex();  m6809_ICount-= 5; NEXT;
+	op_b9:    adca_ex();  m6809_ICount-= 5; NEXT;
+	op_ba:    ora_ex();   m6809_ICount-= 5; NEXT;
+	op_bb:    adda_ex();  m6809_ICount-= 5; NEXT;
+	op_bc:    cmpx_ex();  m6809_ICount-= 7; NEXT;
+	op_bd:    jsr_ex();   m6809_ICount-= 8; NEXT;
+	op_be:    ldx_ex();   m6809_ICount-= 6; NEXT;
+	op_bf:    stx_ex();   m6809_ICount-= 6; NEXT;
+	op_c0:    subb_im();  m6809_ICount-= 2; NEXT;
+	op_c1:    cmpb_im();  m6809_ICount-= 2; NEXT;
+	op_c2:    sbcb_im();  m6809_ICount-= 2; NEXT;
+	op_c3:    addd_im();  m6809_ICount-= 4; NEXT;
+	op_c4:    andb_im();  m6809_ICount-= 2; NEXT;
+	op_c5:    bitb_im();  m6809_ICount-= 2; NEXT;
+	op_c6:    ldb_im();   m6809_ICount-= 2; NEXT;
+	op_c7:    stb_im();   m6809_ICount-= 2; NEXT;
+	op_c8:    eorb_im();  m6809_ICount-= 2; NEXT;
+	op_c9:    adcb_im();  m6809_ICount-= 2; NEXT;
+	op_ca:    orb_im();   m6809_ICount-= 2; NEXT;
+	op_cb:    addb_im();  m6809_ICount-= 2; NEXT;
+	op_cc:    ldd_im();   m6809_ICount-= 3; NEXT;
+	op_cd:    std_im();   m6809_ICount-= 2; NEXT;
+	op_ce:    ldu_im();   m6809_ICount-= 3; NEXT;
+	op_cf:    stu_im();   m6809_ICount-= 3; NEXT;
+	op_d0:    subb_di();  m6809_ICount-= 4; NEXT;
+	op_d1:    cmpb_di();  m6809_ICount-= 4; NEXT;
+	op_d2:    sbcb_di();  m6809_ICount-= 4; NEXT;
+	op_d3:    addd_di();  m6809_ICount-= 6; NEXT;
+	op_d4:    andb_di();  m6809_ICount-= 4; NEXT;
+	op_d5:    bitb_di();  m6809_ICount-= 4; NEXT;
+	op_d6:    ldb_di();   m6809_ICount-= 4; NEXT;
+	op_d7:    stb_di();   m6809_ICount-= 4; NEXT;
+	op_d8:    eorb_di();  m6809_ICount-= 4; NEXT;
+	op_d9:    adcb_di();  m6809_ICount-= 4; NEXT;
+	op_da:    orb_di();   m6809_ICount-= 4; NEXT;
+	op_db:    addb_di();  m6809_ICount-= 4; NEXT;
+	op_dc:    ldd_di();   m6809_ICount-= 5; NEXT;
+	op_dd:    std_di();   m6809_ICount-= 5; NEXT;
+	op_de:    ldu_di();   m6809_ICount-= 5; NEXT;
+	op_df:    stu_di();   m6809_ICount-= 5; NEXT;
+	op_e0:    subb_ix();  m6809_ICount-= 4; NEXT;
+	op_e1:    cmpb_ix();  m6809_ICount-= 4; NEXT;
+	op_e2:    sbcb_ix();  m6809_ICount-= 4; NEXT;
+	op_e3:    addd_ix();  m6809_ICount-= 6; NEXT;
+	op_e4:    andb_ix();  m6809_ICount-= 4; NEXT;
+	op_e5:    bitb_ix();  m6809_ICount-= 4; NEXT;
+	op_e6:    ldb_ix();   m6809_ICount-= 4; NEXT;
+	op_e7:    stb_ix();   m6809_ICount-= 4; NEXT;
+	op_e8:    eorb_ix();  m6809_ICount-= 4; NEXT;
+	op_e9:    adcb_ix();  m6809_ICount-= 4; NEXT;
+	op_ea:    orb_ix();   m6809_ICount-= 4; NEXT;
+	op_eb:    addb_ix();  m6809_ICount-= 4; NEXT;
+	op_ec:    ldd_ix();   m6809_ICount-= 5; NEXT;
+	op_ed:    std_ix();   m6809_ICount-= 5; NEXT;
+	op_ee:    ldu_ix();   m6809_ICount-= 5; NEXT;
+	op_ef:    stu_ix();   m6809_ICount-= 5; NEXT;
+	op_f0:    subb_ex();  m6809_ICount-= 5; NEXT;
+	op_f1:    cmpb_ex();  m6809_ICount-= 5; NEXT;
+	op_f2:    sbcb_ex();  m6809_ICount-= 5; NEXT;
+	op_f3:    addd_ex();  m6809_ICount-= 7; NEXT;
+	op_f4:    andb_ex();  m6809_ICount-= 5; NEXT;
+	op_f5:    bitb_ex();  m6809_ICount-= 5; NEXT;
+	op_f6:    ldb_ex();   m6809_ICount-= 5; NEXT;
+	op_f7:    stb_ex();   m6809_ICount-= 5; NEXT;
+	op_f8:    eorb_ex();  m6809_ICount-= 5; NEXT;
+	op_f9:    adcb_ex();  m6809_ICount-= 5; NEXT;
+	op_fa:    orb_ex();   m6809_ICount-= 5; NEXT;
+	op_fb:    addb_ex();  m6809_ICount-= 5; NEXT;
+	op_fc:    ldd_ex();   m6809_ICount-= 6; NEXT;
+	op_fd:    std_ex();   m6809_ICount-= 6; NEXT;
+	op_fe:    ldu_ex();   m6809_ICount-= 6; NEXT;
+	op_ff:    stu_ex();   m6809_ICount-= 6; NEXT;
+	/* $10xx opcodes */
+	op_1021:  lbrn();     m6809_ICount-= 5; NEXT;
+	op_1022:  lbhi();     m6809_ICount-= 5; NEXT;
+	op_1023:  lbls();     m6809_ICount-= 5; NEXT;
+	op_1024:  lbcc();     m6809_ICount-= 5; NEXT;
+	op_1025:  lbcs();     m6809_ICount-= 5; NEXT;
+	op_1026:  lbne();     m6809_ICount-= 5; NEXT;
+	op_1027:  lbeq();     m6809_ICount-= 5; NEXT;
+	op_1028:  lbvc();     m6809_ICount-= 5; NEXT;
+	op_1029:  lbvs();     m6809_ICount-= 5; NEXT;
+	op_102a:  lbpl();     m6809_ICount-= 5; NEXT;
+	op_102b:  lbmi();     m6809_ICount-= 5; NEXT;
+	op_102c:  lbge();     m6809_ICount-= 5; NEXT;
+	op_102d:  lblt();     m6809_ICount-= 5; NEXT;
+	op_102e:  lbgt();     m6809_ICount-= 5; NEXT;
+	op_102f:  lble();     m6809_ICount-= 5; NEXT;
+	op_103f:  swi2();     m6809_ICount-=20; NEXT;
+	op_1083:  cmpd_im();  m6809_ICount-= 5; NEXT;
+	op_108c:  cmpy_im();  m6809_ICount-= 5; NEXT;
+	op_108e:  ldy_im();   m6809_ICount-= 4; NEXT;
+	op_108f:  sty_im();   m6809_ICount-= 4; NEXT;
+	op_1093:  cmpd_di();  m6809_ICount-= 7; NEXT;
+	op_109c:  cmpy_di();  m6809_ICount-= 7; NEXT;
+	op_109e:  ldy_di();   m6809_ICount-= 6; NEXT;
+	op_109f:  sty_di();   m6809_ICount-= 6; NEXT;
+	op_10a3:  cmpd_ix();  m6809_ICount-= 7; NEXT;
+	op_10ac:  cmpy_ix();  m6809_ICount-= 7; NEXT;
+	op_10ae:  ldy_ix();   m6809_ICount-= 6; NEXT;
+	op_10af:  sty_ix();   m6809_ICount-= 6; NEXT;
+	op_10b3:  cmpd_ex();  m6809_ICount-= 8; NEXT;
+	op_10bc:  cmpy_ex();  m6809_ICount-= 8; NEXT;
+	op_10be:  ldy_ex();   m6809_ICount-= 7; NEXT;
+	op_10bf:  sty_ex();   m6809_ICount-= 7; NEXT;
+	op_10ce:  lds_im();   m6809_ICount-= 4; NEXT;
+	op_10cf:  sts_im();   m6809_ICount-= 4; NEXT;
+	op_10de:  lds_di();   m6809_ICount-= 6; NEXT;
+	op_10df:  sts_di();   m6809_ICount-= 6; NEXT;
+	op_10ee:  lds_ix();   m6809_ICount-= 6; NEXT;
+	op_10ef:  sts_ix();   m6809_ICount-= 6; NEXT;
+	op_10fe:  lds_ex();   m6809_ICount-= 7; NEXT;
+	op_10ff:  sts_ex();   m6809_ICount-= 7; NEXT;
+	/* $11xx opcodes */
+	op_113f:  swi3();     m6809_ICount-=20; NEXT;
+	op_1183:  cmpu_im();  m6809_ICount-= 5; NEXT;
+	op_118c:  cmps_im();  m6809_ICount-= 5; NEXT;
+	op_1193:  cmpu_di();  m6809_ICount-= 7; NEXT;
+	op_119c:  cmps_di();  m6809_ICount-= 7; NEXT;
+	op_11a3:  cmpu_ix();  m6809_ICount-= 7; NEXT;
+	op_11ac:  cmps_ix();  m6809_ICount-= 7; NEXT;
+	op_11b3:  cmpu_ex();  m6809_ICount-= 8; NEXT;
+	op_11bc:  cmps_ex();  m6809_ICount-= 8; NEXT;
+	op_ill:   illegal();                    NEXT;
+
+	done:
+		;
+#else
 		do
 		{
 			pPPC = pPC;
@@ -959,6 +1414,7 @@ int m6809_execute(int cycles)	/* NS 970908 */
 #endif
 
 		} while( m6809_ICount > 0 );
+#endif
 
         m6809_ICount -= m6809.extra_cycles;
 		m6809.extra_cycles = 0;
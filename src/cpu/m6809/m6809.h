@@ -38,12 +38,13 @@ extern unsigned m6809_dasm(char *buffer, unsigned pc);
 /* Read a byte from given memory location                                   */
 /****************************************************************************/
 /* ASG 971005 -- changed to cpu_readmem16/cpu_writemem16 */
-#define M6809_RDMEM(Addr) ((unsigned)cpu_readmem16(Addr))
+/* RAM/ROM/banks through the page pointers of the memory system */
+#define M6809_RDMEM(Addr) ((unsigned)cpu_readmem16_page(Addr))
 
 /****************************************************************************/
 /* Write a byte to given memory location                                    */
 /****************************************************************************/
-#define M6809_WRMEM(Addr,Value) (cpu_writemem16(Addr,Value))
+#define M6809_WRMEM(Addr,Value) (cpu_writemem16_page(Addr,Value))
 
 /****************************************************************************/
 /* Z80_RDOP() is identical to Z80_RDMEM() except it is used for reading     */
@@ -0,0 +1,191 @@
+/***************************************************************************
+
+	m6809bench.c
+
+	6809 core microbenchmark. Runs a CPU-bound test program on m6809.c
+	built with the switch and with the threaded dispatch (M6809_THREADED),
+	checks that both end with the same RAM and registers and prints the
+	emulated MHz of both. Memory goes through the page pointers like RAM
+	and ROM of the pinball CPUs do in the emulator.
+
+	usage: m6809bench [-r runs] [mcycles]
+	  each run executes mcycles million cycles (default 200) on both
+	  cores, the best run of each is printed. makefile.unix only
+	  optimizes for CC=gcc, so build it with that ("make tools CC=gcc").
+
+***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "driver.h"
+#include "m6809.h"
+
+/* m6809.c built once with each dispatch (see unix.mak) */
+#define BENCH_CORE(prefix) \
+	extern void prefix##_init(void); \
+	extern void prefix##_reset(void *param); \
+	extern int prefix##_execute(int cycles); \
+	extern unsigned prefix##_get_reg(int regnum);
+BENCH_CORE(m6809sw)
+BENCH_CORE(m6809thr)
+
+#define BENCH_SLICE		20000		/* cycles per execute call, about a WPC timeslice */
+#define BENCH_RAMSIZE	0x0800		/* RAM the program uses, compared at the end */
+
+struct bench_core
+{
+	const char *name;
+	void (*init)(void);
+	void (*reset)(void *param);
+	int (*execute)(int cycles);
+	unsigned (*get_reg)(int regnum);
+};
+
+static const struct bench_core cores[2] =
+{
+	{ "switch",   m6809sw_init,  m6809sw_reset,  m6809sw_execute,  m6809sw_get_reg },
+	{ "threaded", m6809thr_init, m6809thr_reset, m6809thr_execute, m6809thr_get_reg }
+};
+
+/*
+ 8000 LDS  #$0800
+ 8004 LDX  #$0100		loop: add 64 table bytes into RAM
+ 8007 LDY  #$F000
+ 800B LDB  #$40
+ 800D LDA  ,Y+
+ 800F ADDA ,X
+ 8011 STA  ,X+
+ 8013 DECB
+ 8014 BNE  $800D
+ 8016 LDD  $0100		16-bit arithmetic, $10 prefixed ops
+ 8019 ADDD #$1234
+ 801C STD  $0102
+ 801F CMPD #$4000
+ 8023 LBNE $8027
+ 8027 JSR  $802C
+ 802A BRA  $8004
+ 802C PSHS X,B,A		subroutine: read-modify-write on the direct page
+ 802E LDA  #$05
+ 8030 ROL  <$04
+ 8032 DECA
+ 8033 BNE  $8030
+ 8035 PULS PC,X,B,A
+*/
+static const UINT8 program[] =
+{
+	0x10,0xce,0x08,0x00, 0x8e,0x01,0x00, 0x10,0x8e,0xf0,0x00, 0xc6,0x40,
+	0xa6,0xa0, 0xab,0x84, 0xa7,0x80, 0x5a, 0x26,0xf7,
+	0xfc,0x01,0x00, 0xc3,0x12,0x34, 0xfd,0x01,0x02, 0x10,0x83,0x40,0x00, 0x10,0x26,0x00,0x00,
+	0xbd,0x80,0x2c, 0x20,0xd8,
+	0x34,0x16, 0x86,0x05, 0x09,0x04, 0x4a, 0x26,0xfb, 0x35,0x96
+};
+
+static const int compared_regs[] = { M6809_PC, M6809_S, M6809_U, M6809_X, M6809_Y, M6809_A, M6809_B, M6809_CC, M6809_DP };
+#define BENCH_REGS		(sizeof(compared_regs) / sizeof(compared_regs[0]))
+
+/* flat 64K: RAM below $8000, ROM above */
+static UINT8 bench_mem[0x10000];
+static UINT8 *bench_read_page[MEM_PAGE_COUNT];
+static UINT8 *bench_write_page[MEM_PAGE_COUNT];
+static UINT8 bench_lookup[0x10000];
+
+/* what the core needs from the memory system and the CPU interface */
+UINT8 *OP_ROM = bench_mem, *OP_RAM = bench_mem;
+offs_t OP_MEM_MIN = 0, OP_MEM_MAX = 0xffff, mem_amask = 0xffff;
+UINT8 opcode_entry;
+UINT8 *readmem_lookup = bench_lookup;
+UINT8 **mem_read_page = bench_read_page;
+UINT8 **mem_write_page = bench_write_page;
+int activecpu;
+
+data8_t cpu_readmem16(offs_t address) { return bench_mem[address]; }
+void cpu_writemem16(offs_t address, data8_t data) { }
+void cpu_setopbase16(offs_t pc) { }
+void activecpu_set_op_base(unsigned val) { }
+void state_save_register_UINT8(const char *module, int instance, const char *name, UINT8 *val, unsigned size) { }
+void state_save_register_UINT16(const char *module, int instance, const char *name, UINT16 *val, unsigned size) { }
+
+
+/*-------------------------------------------------
+	run - one run of a core from the power-up
+	memory image, returns the emulated MHz
+-------------------------------------------------*/
+
+static double run(const struct bench_core *core, double cycles, UINT8 *ram, unsigned *regs)
+{
+	double total = 0;
+	clock_t start;
+	int i;
+
+	memset(bench_mem, 0, 0x8000);
+	core->init();
+	core->reset(NULL);
+
+	start = clock();
+	while (total < cycles)
+		total += core->execute(BENCH_SLICE);
+	start = clock() - start;
+
+	memcpy(ram, bench_mem, BENCH_RAMSIZE);
+	for (i = 0; i < BENCH_REGS; i++)
+		regs[i] = core->get_reg(compared_regs[i]);
+	return total / ((double)(start ? start : 1) / CLOCKS_PER_SEC) / 1e6;
+}
+
+
+int main(int argc, char *argv[])
+{
+	static UINT8 ram[2][BENCH_RAMSIZE];
+	unsigned regs[2][BENCH_REGS];
+	double best[2] = { 0, 0 }, cycles = 200e6;
+	int runs = 3;
+	int i, r;
+
+	for (i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+			runs = atoi(argv[++i]);
+		else if (argv[i][0] != '-' && i == argc - 1)
+			cycles = atof(argv[i]) * 1e6;
+		else
+			break;
+	}
+	if (i < argc || runs <= 0 || cycles <= 0)
+	{
+		fprintf(stderr, "usage: %s [-r runs] [mcycles]\n", argv[0]);
+		return 1;
+	}
+
+	/* random table at $F000, the program at $8000 and the reset vector */
+	srand(1);
+	for (i = 0xf000; i < 0xf100; i++)
+		bench_mem[i] = rand();
+	memcpy(bench_mem + 0x8000, program, sizeof(program));
+	bench_mem[0xfffe] = 0x80;
+	bench_mem[0xffff] = 0x00;
+	for (i = 0; i < MEM_PAGE_COUNT; i++)
+	{
+		bench_read_page[i] = bench_mem + (i << MEM_PAGE_BITS);
+		bench_write_page[i] = (i < MEM_PAGE_COUNT / 2) ? bench_read_page[i] : NULL;
+	}
+
+	printf("m6809bench: %d runs of %.0f million cycles per core\n", runs, cycles / 1e6);
+	for (r = 0; r < runs; r++)
+		for (i = 0; i < 2; i++)
+		{
+			double mhz = run(&cores[i], cycles, ram[i], regs[i]);
+			if (mhz > best[i])
+				best[i] = mhz;
+		}
+
+	if (memcmp(ram[0], ram[1], BENCH_RAMSIZE) || memcmp(regs[0], regs[1], sizeof(regs[0])))
+	{
+		printf("switch and threaded results differ\n");
+		return 1;
+	}
+	for (i = 0; i < 2; i++)
+		printf("%-8s %7.1f emulated MHz\n", cores[i].name, best[i]);
+	printf("threaded/switch %.3f, PC %04X\n", best[1] / best[0], regs[1][0]);
+	return 0;
+}
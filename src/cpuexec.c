@@ -10,9 +10,11 @@
 #include "driver.h"
 #include "timer.h"
 #include "state.h"
+#include "rewind.h"
 #include "video.h"
 #include "mamedbg.h"
 #include "hiscore.h"
+#include "zlib.h"
 
 #if (HAS_M68000 || HAS_M68010 || HAS_M68020 || HAS_M68EC020)
 #include "cpu/m68000/m68000.h"
@@ -213,6 +215,92 @@ static double perfect_interleave;
 static int loadsave_schedule;
 static char *loadsave_schedule_name;
 
+static int rewind_frames;		/* frames until the next rewind state */
+static int rewind_capture;		/* take a rewind state before the next timeslice */
+static int rewind_steps;		/* go back this many rewind states before the next timeslice */
+
+
+
+/*************************************
+ *
+ *	Boot snapshot variables
+ *
+ *************************************/
+
+enum
+{
+	BOOTSNAP_NONE = 0,
+	BOOTSNAP_LOAD,			/* restore the snapshot in the first timeslice */
+	BOOTSNAP_SAVE			/* take the snapshot when the warp ends */
+};
+
+static struct
+{
+	int		state;
+	char	name[64];		/* <game>-boot-<key> */
+	UINT8 *	nvram;			/* the .nv file the machine started from */
+	UINT32	nvram_size;
+	void	(*merge)(const UINT8 *nvram, UINT32 size);	/* puts its persistent bytes into the machine */
+} bootsnap;
+
+
+
+/*************************************
+ *
+ *	Warp (fast forward) variables
+ *
+ *************************************/
+
+static struct
+{
+	int		active;
+	double	until;			/* emulated time when the warp ends */
+	int		drawinterval;	/* draw every n-th frame, 0 = none */
+	int		frames;
+} warp;
+
+
+
+/*************************************
+ *
+ *	Idle loop variables
+ *
+ *************************************/
+
+#define IDLE_WINDOW			16		/* bytes of code a loop may span */
+#define IDLE_SAMPLES		8		/* timeslices ending in one window before a probe */
+#define IDLE_BACKOFF		64		/* timeslices to wait after a failed probe */
+#define IDLE_STEPS			32		/* instructions to find and check a loop */
+#define IDLE_READS			4		/* RAM bytes a loop may poll */
+#define IDLE_REGS			32		/* registers compared */
+#define IDLE_LOOPS			4		/* loops kept per CPU */
+
+struct idle_loop
+{
+	offs_t	head, lo, hi;			/* first instruction and range of the loop */
+	int		reads;
+	offs_t	address[IDLE_READS];	/* the RAM it polls */
+	UINT8 *	ptr[IDLE_READS];
+	UINT8	value[IDLE_READS];
+	UINT32	regs[IDLE_REGS];		/* registers at the head */
+	UINT32	skips;					/* timeslices skipped */
+	UINT64	cycles;					/* cycles skipped */
+};
+
+static struct
+{
+	int		enabled;
+	int		regcount;
+	offs_t	anchor;					/* PC at the end of the recent timeslices */
+	int		samples;				/* timeslices that ended near anchor */
+	int		loops;
+	struct idle_loop loop[IDLE_LOOPS];
+} idle[MAX_CPU];
+
+int cpu_idle_probe;					/* the 8-bit memory handlers call cpu_idle_read/write */
+static struct idle_loop idle_probed;
+static int idle_bad;
+
 
 
 /*************************************
@@ -222,6 +310,10 @@ static char *loadsave_schedule_name;
  *************************************/
 
 static void cpu_timeslice(void);
+static void idle_init(void);
+static void idle_report(void);
+static void idle_slice(int cpunum, double target);
+static void idle_sample(int cpunum);
 static void cpu_inittimers(void);
 static void cpu_vblankreset(void);
 static void cpu_vblankcallback(int param);
@@ -231,6 +323,8 @@ static void end_interleave_boost(int param);
 static void compute_perfect_interleave(void);
 
 static void handle_loadsave(void);
+static void handle_rewind(void);
+static void bootsnap_init(void);
 
 #ifdef PINMAME
 void run_one_timeslice(void) {
@@ -289,6 +383,9 @@ int cpu_init(void)
 	state_save_set_current_tag(0);
 	state_save_register_INT32("cpu", 0, "watchdog count", &watchdog_counter, 1);
 
+	/* the NVRAM handler of the driver sets it again */
+	bootsnap.merge = NULL;
+
 	/* reset the IRQ lines and save those */
 	if (cpuint_init())
 		return 1;
@@ -320,6 +417,10 @@ static void cpu_pre_run(void)
 	cpu_inittimers();
 	watchdog_counter = -1;
 
+	/* fast forward over the boot if requested (machine_init() may change this) */
+	warp.active = 0;
+	cpu_warp(options.warp, 0);
+
 	/* reset sound chips */
 	sound_reset();
 
@@ -358,6 +459,11 @@ static void cpu_pre_run(void)
 	cpu_vblankreset();
 	current_frame = 0;
 	state_save_dump_registry();
+
+	/* the rewind states are of the machine before the reset */
+	rewind_reset();
+	rewind_frames = options.rewind_interval;
+	rewind_capture = rewind_steps = 0;
 }
 
 
@@ -396,6 +502,11 @@ void cpu_run(void)
 		mame_debug_init();
 #endif
 
+	/* look for a snapshot of the booted machine */
+	bootsnap_init();
+	rewind_init(options.rewind_interval > 0 ? (unsigned)options.rewind << 20 : 0);
+	idle_init();
+
 	/* loop over multiple resets, until the user quits */
 	time_to_quit = 0;
 	while (!time_to_quit)
@@ -412,6 +523,10 @@ void cpu_run(void)
 			/* if we have a load/save scheduled, handle it */
 			if (loadsave_schedule != LOADSAVE_NONE)
 				handle_loadsave();
+
+			/* same for the rewind states */
+			if (rewind_capture || rewind_steps)
+				handle_rewind();
 			
 			/* execute CPUs */
 			cpu_timeslice();
@@ -422,6 +537,8 @@ void cpu_run(void)
 		/* finish up this iteration */
 		cpu_post_run();
 	}
+	rewind_exit();
+	idle_report();
 
 #ifdef MAME_DEBUG
 	/* shut down the debugger */
@@ -469,6 +586,67 @@ void machine_reset(void)
 #pragma mark SAVE/RESTORE
 #endif
 
+/*************************************
+ *
+ *	Save/load all tags of a state
+ *
+ *************************************/
+
+static void save_tags(void)
+{
+	int cpunum;
+
+	/* write tag 0 */
+	state_save_set_current_tag(0);
+	state_save_save_continue();
+
+	/* loop over CPUs */
+	for (cpunum = 0; cpunum < cpu_gettotalcpu(); cpunum++)
+	{
+		cpuintrf_push_context(cpunum);
+
+		/* make sure banking is set */
+		activecpu_reset_banking();
+
+		/* save the CPU data */
+		state_save_set_current_tag(cpunum + 1);
+		state_save_save_continue();
+
+		cpuintrf_pop_context();
+	}
+
+	/* registrations after this belong to no CPU */
+	state_save_set_current_tag(0);
+}
+
+static void load_tags(void)
+{
+	int cpunum;
+
+	/* read tag 0 */
+	state_save_set_current_tag(0);
+	state_save_load_continue();
+
+	/* loop over CPUs */
+	for (cpunum = 0; cpunum < cpu_gettotalcpu(); cpunum++)
+	{
+		cpuintrf_push_context(cpunum);
+
+		/* load the CPU data */
+		state_save_set_current_tag(cpunum + 1);
+		state_save_load_continue();
+
+		/* the PC and the banks may have changed, refetch the opcode base */
+		activecpu_reset_banking();
+
+		cpuintrf_pop_context();
+	}
+
+	state_save_set_current_tag(0);
+}
+
+
+
 /*************************************
  *
  *	Handle saves at runtime
@@ -484,29 +662,9 @@ static void handle_save(void)
 
 	if (file)
 	{
-		int cpunum;
-
 		/* write the save state */
 		state_save_save_begin(file);
-
-		/* write tag 0 */
-		state_save_set_current_tag(0);
-		state_save_save_continue();
-
-		/* loop over CPUs */
-		for (cpunum = 0; cpunum < cpu_gettotalcpu(); cpunum++)
-		{
-			cpuintrf_push_context(cpunum);
-
-			/* make sure banking is set */
-			activecpu_reset_banking();
-
-			/* save the CPU data */
-			state_save_set_current_tag(cpunum + 1);
-			state_save_save_continue();
-
-			cpuintrf_pop_context();
-		}
+		save_tags();
 
 		/* finish and close */
 		state_save_save_finish();
@@ -529,9 +687,10 @@ static void handle_save(void)
  *
  *************************************/
 
-static void handle_load(void)
+static int handle_load(void)
 {
 	mame_file *file;
+	int loaded = 0;
 
 	/* open the file */
 	file = mame_fopen(Machine->gamedrv->name, loadsave_schedule_name, FILETYPE_STATE, 0);
@@ -542,29 +701,11 @@ static void handle_load(void)
 		/* start loading */
 		if (!state_save_load_begin(file))
 		{
-			int cpunum;
-
-			/* read tag 0 */
-			state_save_set_current_tag(0);
-			state_save_load_continue();
-
-			/* loop over CPUs */
-			for (cpunum = 0; cpunum < cpu_gettotalcpu(); cpunum++)
-			{
-				cpuintrf_push_context(cpunum);
-
-				/* make sure banking is set */
-				activecpu_reset_banking();
-
-				/* load the CPU data */
-				state_save_set_current_tag(cpunum + 1);
-				state_save_load_continue();
-
-				cpuintrf_pop_context();
-			}
+			load_tags();
 
 			/* finish and close */
 			state_save_load_finish();
+			loaded = 1;
 		}
 		mame_fclose(file);
 	}
@@ -575,6 +716,7 @@ static void handle_load(void)
 
 	/* unschedule the load */
 	cpu_loadsave_reset();
+	return loaded;
 }
 
 
@@ -590,6 +732,23 @@ static void handle_loadsave(void)
 	/* it's one or the other */
 	if (loadsave_schedule == LOADSAVE_SAVE)
 		handle_save();
+	else if (bootsnap.state == BOOTSNAP_LOAD)
+	{
+		/* the boot snapshot; the warp is not needed anymore if it could be loaded */
+		bootsnap.state = BOOTSNAP_NONE;
+		if (handle_load())
+		{
+			logerror("bootsnapshot: restored %s\n", bootsnap.name);
+			warp.active = 0;
+
+			/* the settings, audits and high scores of the .nv file */
+			(*bootsnap.merge)(bootsnap.nvram, bootsnap.nvram_size);
+			free(bootsnap.nvram);
+			bootsnap.nvram = NULL;
+		}
+		else
+			bootsnap.state = BOOTSNAP_SAVE;
+	}
 	else if (loadsave_schedule == LOADSAVE_LOAD)
 		handle_load();
 
@@ -599,6 +758,67 @@ static void handle_loadsave(void)
 
 
 
+/*************************************
+ *
+ *	Take and restore rewind states
+ *
+ *************************************/
+
+static void handle_rewind(void)
+{
+	UINT8 *data;
+	unsigned size;
+
+	if (rewind_steps)
+	{
+		data = rewind_pop(rewind_steps, &size);
+		if (data)
+		{
+			if (!state_save_load_begin_mem(data, size))
+			{
+				load_tags();
+				state_save_load_finish();
+			}
+			free(data);
+
+			/* the next state is a full interval after this one */
+			rewind_frames = options.rewind_interval;
+			rewind_capture = 0;
+		}
+		rewind_steps = 0;
+	}
+
+	if (rewind_capture)
+	{
+		state_save_save_begin(NULL);
+		save_tags();
+		data = state_save_save_finish_mem(&size);
+		if (data)
+		{
+			rewind_add(data, size);
+			free(data);
+		}
+		rewind_capture = 0;
+	}
+}
+
+
+
+/*************************************
+ *
+ *	Goes back steps rewind states at
+ *	the end of this timeslice
+ *
+ *************************************/
+
+void cpu_rewind(int steps)
+{
+	if (rewind_enabled() && steps > 0)
+		rewind_steps += steps;
+}
+
+
+
 /*************************************
  *
  *	Schedules a save/load for later
@@ -651,6 +871,117 @@ void cpu_loadsave_reset(void)
 }
 
 
+
+
+/*************************************
+ *
+ *	Boot snapshot
+ *
+ *	With -bootsnapshot the state at the
+ *	end of the first warp is saved and
+ *	later starts continue from there.
+ *	The file name contains a hash of the
+ *	ROMs, the build and the sound setting
+ *	so a snapshot is never used with
+ *	anything else. After the snapshot is
+ *	restored the driver copies the bytes
+ *	of the .nv file that persist into the
+ *	machine (cpu_set_bootsnap_nvram); the
+ *	rest of its NVRAM is working RAM that
+ *	has to match the CPU. Drivers that
+ *	can't tell them apart boot normally.
+ *
+ *************************************/
+
+static UINT8 *bootsnap_read(mame_file *file, UINT32 *size)
+{
+	UINT8 *data;
+
+	*size = (UINT32)mame_fsize(file);
+	data = malloc(*size ? *size : 1);
+	if (data && mame_fread(file, data, *size) != *size)
+	{
+		free(data);
+		data = NULL;
+	}
+	return data;
+}
+
+
+static void bootsnap_init(void)
+{
+	UINT32 key;
+	mame_file *file;
+
+	bootsnap.state = BOOTSNAP_NONE;
+	free(bootsnap.nvram);
+	bootsnap.nvram = NULL;
+	bootsnap.nvram_size = 0;
+	/* an explicit savegame wins */
+	if (!options.bootsnapshot || options.savegame)
+		return;
+	if (!bootsnap.merge)
+	{
+		logerror("bootsnapshot: the driver can't merge its NVRAM into a snapshot, booting\n");
+		return;
+	}
+
+	/* the ROM data as rom_load left it, the RAM in the regions has been used since */
+	key = crc32(0, (const Bytef *)build_version, strlen(build_version));
+	key = crc32(key, (const Bytef *)(Machine->sample_rate ? "s" : "-"), 1);
+	key ^= rom_image_crc();
+	sprintf(bootsnap.name, "%.40s-boot-%08x", Machine->gamedrv->name, key);
+
+	/* the NVRAM the machine starts from */
+	file = mame_fopen(Machine->gamedrv->name, 0, FILETYPE_NVRAM, 0);
+	if (file)
+	{
+		bootsnap.nvram = bootsnap_read(file, &bootsnap.nvram_size);
+		mame_fclose(file);
+	}
+
+	/* restore it in the first timeslice if it's there */
+	file = mame_fopen(Machine->gamedrv->name, bootsnap.name, FILETYPE_STATE, 0);
+	if (!file)
+		bootsnap.state = BOOTSNAP_SAVE;
+	else
+	{
+		mame_fclose(file);
+
+		/* without NVRAM (e.g. deleted for a factory reset) the game has to set it up */
+		if (bootsnap.nvram)
+		{
+			bootsnap.state = BOOTSNAP_LOAD;
+			cpu_loadsave_schedule_file(LOADSAVE_LOAD, bootsnap.name);
+		}
+		else
+			logerror("bootsnapshot: no NVRAM to merge into %s, booting\n", bootsnap.name);
+	}
+}
+
+
+static void bootsnap_save(void)
+{
+	logerror("bootsnapshot: saving %s\n", bootsnap.name);
+	cpu_loadsave_schedule_file(LOADSAVE_SAVE, bootsnap.name);
+	free(bootsnap.nvram);
+	bootsnap.nvram = NULL;
+}
+
+
+/*************************************
+ *
+ *	The NVRAM merge of a driver, set in
+ *	its NVRAM handler when it reads
+ *
+ *************************************/
+
+void cpu_set_bootsnap_nvram(void (*merge)(const UINT8 *nvram, UINT32 size))
+{
+	bootsnap.merge = merge;
+}
+
+
 #if 0
 #pragma mark -
 #pragma mark WATCHDOG
@@ -832,19 +1163,31 @@ static void cpu_timeslice(void)
 			cycles_running = TIME_TO_CYCLES(cpunum, target - cpu[cpunum].localtime);
 			LOG(("  cpu %d: %d cycles\n", cpunum, cycles_running));
 		
+			/* a CPU in an idle loop skips the slice, or a part of it while we look at the loop */
+			if (cycles_running > 0 && idle[cpunum].enabled)
+			{
+				idle_slice(cpunum, target);
+				cycles_running = TIME_TO_CYCLES(cpunum, target - cpu[cpunum].localtime);
+			}
+
 			/* run for the requested number of cycles */
 			if (cycles_running > 0)
 			{
 				profiler_mark(PROFILER_CPU1 + cpunum);
+				hprof_begin(HPROF_CPU, (FPTR)cpunum, 0);
 				cycles_stolen = 0;
 				ran = cpunum_execute(cpunum, cycles_running);
 				ran -= cycles_stolen;
+				hprof_end();
 				profiler_mark(PROFILER_END);
 				
 				/* account for these cycles */
 				cpu[cpunum].totalcycles += ran;
 				cpu[cpunum].localtime += TIME_IN_CYCLES(ran, cpunum);
 				LOG(("         %d ran, %d total, time = %.9f\n", ran, (INT32)cpu[cpunum].totalcycles, cpu[cpunum].localtime));
+
+				if (idle[cpunum].enabled)
+					idle_sample(cpunum);
 				
 				/* if the new local CPU time is less than our target, move the target up */
 				if (cpu[cpunum].localtime < target && cpu[cpunum].localtime > 0)
@@ -1060,6 +1403,345 @@ void cpu_boost_interleave(double timeslice_time, double boost_duration)
 
 
 
+/*************************************
+ *
+ *	Warp (fast forward)
+ *
+ *************************************/
+
+void cpu_warp(double duration, int drawinterval)
+{
+	if (duration > 0)
+	{
+		if (!warp.active)
+			logerror("warp: fast forwarding from %.3f seconds\n", timer_get_time());
+		warp.active = 1;
+		warp.until = timer_get_time() + duration;
+		warp.drawinterval = drawinterval;
+		warp.frames = 0;
+	}
+	else if (warp.active)
+	{
+		logerror("warp: back to normal speed at %.3f seconds\n", timer_get_time());
+		warp.active = 0;
+
+		/* the machine has booted, keep it for the next start */
+		if (bootsnap.state == BOOTSNAP_SAVE)
+		{
+			bootsnap.state = BOOTSNAP_NONE;
+			bootsnap_save();
+		}
+	}
+}
+
+
+int cpu_warping(void)
+{
+	return warp.active;
+}
+
+
+int cpu_warp_drawframe(void)
+{
+	return warp.drawinterval > 0 && (warp.frames % warp.drawinterval) == 0;
+}
+
+
+
+/*************************************
+ *
+ *	Idle loop detection
+ *
+ *	The PC at the end of each timeslice
+ *	is sampled. When it stays in a few
+ *	bytes of code, the CPU is stepped
+ *	until an instruction repeats and
+ *	then for one more turn of the loop
+ *	with the memory handlers reporting.
+ *	A loop that only reads RAM (or
+ *	constants), writes nothing and ends
+ *	with the registers it started with
+ *	polls until an IRQ or the RAM
+ *	changes. Whenever a timeslice starts
+ *	in it with those registers and RAM,
+ *	the whole timeslice is skipped.
+ *
+ *************************************/
+
+/* cores whose interrupts all come from the IRQ lines and that have no ports or timers of their own */
+static int idle_cputype(int cputype)
+{
+	switch (cputype)
+	{
+#if (HAS_M6502)
+		case CPU_M6502:
+#endif
+#if (HAS_M65C02)
+		case CPU_M65C02:
+#endif
+#if (HAS_M65SC02)
+		case CPU_M65SC02:
+#endif
+#if (HAS_M6800)
+		case CPU_M6800:
+#endif
+#if (HAS_M6802)
+		case CPU_M6802:
+#endif
+#if (HAS_M6808)
+		case CPU_M6808:
+#endif
+#if (HAS_HD6309)
+		case CPU_HD6309:
+#endif
+#if (HAS_M6809)
+		case CPU_M6809:
+#endif
+			return 1;
+	}
+	return 0;
+}
+
+
+static int idle_regs(int cpunum, UINT32 *regs)
+{
+	const INT8 *layout = (const INT8 *)cpunum_reg_layout(cpunum);
+	int count = 0;
+
+	cpuintrf_push_context(cpunum);
+	for ( ; *layout && count < IDLE_REGS; layout++)
+		if (*layout != -1)
+			regs[count++] = activecpu_get_reg(*layout);
+	cpuintrf_pop_context();
+	return count;
+}
+
+
+static void idle_init(void)
+{
+	int cpunum;
+
+	memset(idle, 0, sizeof(idle));
+	for (cpunum = 0; cpunum < cpu_gettotalcpu(); cpunum++)
+	{
+		UINT32 regs[IDLE_REGS];
+
+		idle[cpunum].enabled = options.idleskip
+#ifdef MAME_DEBUG
+			&& !mame_debug
+#endif
+			&& idle_cputype(Machine->drv->cpu[cpunum].cpu_type)
+			&& !(Machine->drv->cpu[cpunum].cpu_flags & CPU_NO_IDLE_SKIP);
+		idle[cpunum].regcount = idle_regs(cpunum, regs);
+	}
+}
+
+
+static void idle_report(void)
+{
+	int cpunum, i, j;
+
+	for (cpunum = 0; cpunum < cpu_gettotalcpu(); cpunum++)
+		for (i = 0; i < idle[cpunum].loops; i++)
+		{
+			struct idle_loop *loop = &idle[cpunum].loop[i];
+			char polls[64] = "";
+
+			for (j = 0; j < loop->reads; j++)
+				sprintf(&polls[strlen(polls)], " %04X", loop->address[j]);
+			logerror("idleskip: CPU #%d loop %04X-%04X polling%s: %u timeslices, %.3f seconds skipped\n",
+					cpunum, loop->lo, loop->hi, loop->reads ? polls : " nothing", loop->skips,
+					(double)loop->cycles * cycles_to_sec[cpunum]);
+		}
+}
+
+
+/* the 8-bit memory handlers report the accesses of the probed loop */
+void cpu_idle_read(offs_t address, UINT8 *ptr)
+{
+	int i;
+
+	if (ptr == IDLE_IO)
+		idle_bad = 1;
+	else if (ptr)
+	{
+		for (i = 0; i < idle_probed.reads; i++)
+			if (idle_probed.ptr[i] == ptr)
+				return;
+		if (i == IDLE_READS)
+			idle_bad = 1;
+		else
+		{
+			idle_probed.address[i] = address;
+			idle_probed.ptr[i] = ptr;
+			idle_probed.value[i] = *ptr;
+			idle_probed.reads++;
+		}
+	}
+}
+
+
+void cpu_idle_write(offs_t address)
+{
+	idle_bad = 1;
+}
+
+
+/* runs one instruction */
+static void idle_step(int cpunum)
+{
+	int ran;
+
+	cycles_running = 1;
+	cycles_stolen = 0;
+	ran = cpunum_execute(cpunum, 1) - cycles_stolen;
+	cpu[cpunum].totalcycles += ran;
+	cpu[cpunum].localtime += TIME_IN_CYCLES(ran, cpunum);
+}
+
+
+/* true if the loop will spin from here on */
+static int idle_match(int cpunum, const struct idle_loop *loop)
+{
+	UINT32 regs[IDLE_REGS];
+	int i;
+
+	for (i = 0; i < loop->reads; i++)
+		if (*loop->ptr[i] != loop->value[i])
+			return 0;
+	return idle_regs(cpunum, regs) == idle[cpunum].regcount &&
+		!memcmp(regs, loop->regs, idle[cpunum].regcount * sizeof(regs[0]));
+}
+
+
+/* looks for a loop at the PC, returns 1 if found */
+static int idle_probe(int cpunum, double target)
+{
+	struct idle_loop *loop = &idle_probed;
+	offs_t pcs[IDLE_STEPS];
+	offs_t pc = cpunum_get_reg(cpunum, REG_PC);
+	int count = 0, steps, turned, i, j;
+
+	/* the first instruction that comes again is the head of a loop */
+	for (;;)
+	{
+		for (i = 0; i < count && pcs[i] != pc; i++)
+			;
+		if (i < count)
+			break;
+		if (count == IDLE_STEPS || cpu[cpunum].localtime >= target)
+			return 0;
+		pcs[count++] = pc;
+		idle_step(cpunum);
+		pc = cpunum_get_reg(cpunum, REG_PC);
+	}
+
+	/* one turn from the head with the memory handlers reporting */
+	memset(loop, 0, sizeof(*loop));
+	loop->head = loop->lo = loop->hi = pc;
+	idle_regs(cpunum, loop->regs);
+	idle_bad = 0;
+	cpu_idle_probe = 1;
+	memory_use_pages(0);
+	for (steps = 0, turned = 0; steps < IDLE_STEPS && !idle_bad && !turned && cpu[cpunum].localtime < target; steps++)
+	{
+		idle_step(cpunum);
+		pc = cpunum_get_reg(cpunum, REG_PC);
+		if (pc < loop->lo) loop->lo = pc;
+		if (pc > loop->hi) loop->hi = pc;
+		turned = (pc == loop->head);
+	}
+	memory_use_pages(1);
+	cpu_idle_probe = 0;
+
+	/* the timeslice can end before the turn does */
+	if (idle_bad || !turned || loop->hi - loop->lo >= IDLE_WINDOW || !idle_match(cpunum, loop))
+		return 0;
+
+	/* keep it in place of the same one or of the least useful one */
+	for (i = 0; i < idle[cpunum].loops && (loop->hi < idle[cpunum].loop[i].lo || loop->lo > idle[cpunum].loop[i].hi); i++)
+		;
+	if (i == IDLE_LOOPS)
+		for (i = j = 0; j < IDLE_LOOPS; j++)
+			if (idle[cpunum].loop[j].skips < idle[cpunum].loop[i].skips)
+				i = j;
+	if (i == idle[cpunum].loops)
+		idle[cpunum].loops++;
+	else if (loop->hi >= idle[cpunum].loop[i].lo && loop->lo <= idle[cpunum].loop[i].hi)
+	{
+		loop->skips = idle[cpunum].loop[i].skips;
+		loop->cycles = idle[cpunum].loop[i].cycles;
+	}
+	idle[cpunum].loop[i] = *loop;
+	logerror("idleskip: CPU #%d idle loop at %04X-%04X\n", cpunum, loop->lo, loop->hi);
+	return 1;
+}
+
+
+/* skips the rest of the timeslice if the CPU spins in the loop, returns 1 if it did */
+static int idle_skip(int cpunum, struct idle_loop *loop, double target)
+{
+	offs_t pc = cpunum_get_reg(cpunum, REG_PC);
+	int steps, cycles;
+
+	/* a timeslice rarely ends at the head, go there */
+	for (steps = 0; pc != loop->head; steps++)
+	{
+		if (steps == IDLE_STEPS || pc < loop->lo || pc > loop->hi || cpu[cpunum].localtime >= target)
+			return 0;
+		idle_step(cpunum);
+		pc = cpunum_get_reg(cpunum, REG_PC);
+	}
+	if (!idle_match(cpunum, loop))
+		return 0;
+
+	cycles = TIME_TO_CYCLES(cpunum, target - cpu[cpunum].localtime);
+	if (cycles > 0)
+	{
+		cpu[cpunum].totalcycles += cycles;
+		cpu[cpunum].localtime += TIME_IN_CYCLES(cycles, cpunum);
+		loop->skips++;
+		loop->cycles += cycles;
+	}
+	return 1;
+}
+
+
+static void idle_slice(int cpunum, double target)
+{
+	offs_t pc = cpunum_get_reg(cpunum, REG_PC);
+	int i;
+
+	for (i = 0; i < idle[cpunum].loops; i++)
+		if (pc >= idle[cpunum].loop[i].lo && pc <= idle[cpunum].loop[i].hi)
+		{
+			if (idle_skip(cpunum, &idle[cpunum].loop[i], target))
+				return;
+			break;
+		}
+
+	/* a known loop that stopped matching (a masked IRQ line came up) is probed again */
+	if (idle[cpunum].samples >= IDLE_SAMPLES)
+		idle[cpunum].samples = idle_probe(cpunum, target) ? 0 : -IDLE_BACKOFF;
+}
+
+
+/* the PC at the end of a timeslice */
+static void idle_sample(int cpunum)
+{
+	offs_t pc = cpunum_get_reg(cpunum, REG_PC);
+
+	if (pc - idle[cpunum].anchor < IDLE_WINDOW || idle[cpunum].anchor - pc < IDLE_WINDOW)
+		idle[cpunum].samples++;
+	else
+	{
+		idle[cpunum].anchor = pc;
+		idle[cpunum].samples = 0;
+	}
+}
+
+
+
 #if 0
 #pragma mark -
 #pragma mark TIMING HELPERS
@@ -1621,6 +2303,14 @@ static void cpu_vblankcallback(int param)
 	/* is it a real VBLANK? */
 	if (!--vblank_countdown)
 	{
+		/* end the warp when its time is up */
+		if (warp.active)
+		{
+			warp.frames++;
+			if (timer_get_time() >= warp.until)
+				cpu_warp(0, 0);
+		}
+
 		/* do we update the screen now? */
 		if (!(Machine->drv->video_attributes & VIDEO_UPDATE_AFTER_VBLANK))
 			time_to_quit = updatescreen();
@@ -1634,7 +2324,7 @@ static void cpu_vblankcallback(int param)
 		/* reset the counter */
 		vblank_countdown = vblank_multiplier;
 		sync_countdown = LOW_LATENCY_THROTTLE_PARTS - 1;
-		if(g_low_latency_throttle && frameskip == 0)
+		if(g_low_latency_throttle && frameskip == 0 && !warp.active)
 			timer_adjust(sync_timer, TIME_IN_HZ(60 * LOW_LATENCY_THROTTLE_PARTS), 0, TIME_IN_HZ(60 * LOW_LATENCY_THROTTLE_PARTS));
 	}
 }
@@ -1671,6 +2361,13 @@ static void cpu_updatecallback(int param)
 	/* track total frames */
 	current_frame++;
 
+	/* time for a rewind state? not while fast forwarding over the boot */
+	if (rewind_enabled() && !warp.active && --rewind_frames <= 0)
+	{
+		rewind_frames = options.rewind_interval;
+		rewind_capture = 1;
+	}
+
 	/* reset the refresh timer */
 	timer_adjust(refresh_timer, TIME_NEVER, 0, 0);
 }
@@ -71,7 +71,10 @@ enum
 	CPU_AUDIO_CPU = 0x0002,
 
 	/* the Z80 can be wired to use 16 bit addressing for I/O ports */
-	CPU_16BIT_PORT = 0x0001
+	CPU_16BIT_PORT = 0x0001,
+
+	/* set this if the CPU must not skip the loops that look idle (-idleskip) */
+	CPU_NO_IDLE_SKIP = 0x0004
 };
 
 
@@ -114,6 +117,15 @@ void cpu_loadsave_schedule(int type, char id);
 void cpu_loadsave_schedule_file(int type, const char *name);
 void cpu_loadsave_reset(void);
 
+/* Go back steps of the in-memory states of -rewind */
+void cpu_rewind(int steps);
+
+/* -bootsnapshot: called with the .nv file after the snapshot of the booted
+   machine is restored, copies the bytes of it that persist (settings, audits,
+   high scores) into the machine. A driver sets it in its NVRAM handler,
+   without one the machine always boots */
+void cpu_set_bootsnap_nvram(void (*merge)(const UINT8 *nvram, UINT32 size));
+
 
 
 /*************************************
@@ -195,6 +207,25 @@ void cpunum_set_clockscale(int cpunum, double clockscale);
 /* Temporarily boosts the interleave factor */
 void cpu_boost_interleave(double timeslice_time, double boost_duration);
 
+/* Warp: run unthrottled without showing video or playing sound for up to duration
+   seconds (TIME_NEVER = until cpu_warp(0, 0)), drawing only every drawinterval
+   frames (0 = never), e.g. for conditions that look at the display */
+void cpu_warp(double duration, int drawinterval);
+
+/* Returns true while warping */
+int cpu_warping(void);
+
+/* Returns true if this frame should be drawn while warping */
+int cpu_warp_drawframe(void);
+
+/* Idle loop detection (-idleskip): a loop of an 8-bit CPU that only reads
+   RAM and ends with the registers it started with is skipped until its RAM or an IRQ line
+   changes. The 8-bit memory handlers report the accesses of a probed loop. */
+#define IDLE_IO		((UINT8 *)1)	/* the read went to a handler */
+extern int cpu_idle_probe;
+void cpu_idle_read(offs_t address, UINT8 *ptr);
+void cpu_idle_write(offs_t address);
+
 /* Backwards compatibility */
 #define timer_suspendcpu(cpunum, suspend, reason)	do { if (suspend) cpunum_suspend(cpunum, reason, 1); else cpunum_resume(cpunum, reason); } while (0)
 #define timer_holdcpu(cpunum, suspend, reason)		do { if (suspend) cpunum_suspend(cpunum, reason, 0); else cpunum_resume(cpunum, reason); } while (0)
@@ -71,6 +71,7 @@
 #include "cheat.h"
 #include "tilemap.h"
 #include "profiler.h"
+#include "hprof.h"
 
 #ifdef MESS
 #include "messdrv.h"
@@ -98,6 +99,13 @@ typedef struct {
 #if defined(VPINMAME_ALTSOUND) || defined(VPINMAME_PINSOUND)
   int sound_mode; // 0 = pinmame, 1 = altsound, 2 = pinsound, 3 = pinsound + recordings
 #endif
+#ifdef XMAME
+  char *dmd_capture;			/* record the DMD to this DMD capture file (dmdcap.h) */
+#endif
+  int warp_switch;			/* warp (fast forward) until this switch is set */
+  char *warp_dmd;			/* warp until the DMD shows the frame with this hash (hex, dmdcap_hash) */
+  char *sw_record;			/* record the switch changes of the host to this file (swrec.h) */
+  char *sw_replay;			/* set the switches from this recording instead */
 #ifdef PROC_SUPPORT
 	char *p_roc;				/* YAML Machine description file */
 	int alpha_on_dmd;			/* Virtual alphanumeric displays on P-ROC DMD */
@@ -9,6 +9,7 @@
 #include <assert.h>
 #include "driver.h"
 #include "unzip.h"
+#include "mtlock.h"
 
 #ifdef MESS
 #include "image.h"
@@ -51,6 +52,8 @@
 #define DEBUG_COOKIE			0xbaadf00d
 #endif
 
+#define HASHCACHE_NAME			"romhash"		/* romhash.cfg in the config directory */
+
 
 /***************************************************************************
 	PROTOTYPES
@@ -58,7 +61,10 @@
 
 static mame_file *generic_fopen(int pathtype, const char *gamename, const char *filename, const char* hash, UINT32 flags);
 static const char *get_extension_for_filetype(int filetype);
-static int checksum_file(int pathtype, int pathindex, const char *file, UINT8 **p, UINT64 *size, char* hash);
+static int checksum_file(int pathtype, int pathindex, const char *file, UINT8 **p, UINT64 *size, char* hash, UINT8 *mapped);
+static UINT32 expected_crc(const char *hash);
+static int hashcache_find(const char *name, UINT64 size, UINT64 mtime, UINT32 crc, unsigned int functions, char *hash);
+static void hashcache_add(const char *name, UINT64 size, UINT64 mtime, UINT32 crc, const char *hash);
 
 
 /***************************************************************************
@@ -234,7 +240,9 @@ void mame_fclose(mame_file *file)
 
 		case ZIPPED_FILE:
 		case RAM_FILE:
-			if (file->data)
+			if (file->data && file->mapped)
+				osd_funmap(file->data, file->length);
+			else if (file->data)
 				free(file->data);
 			break;
 	}
@@ -872,10 +880,11 @@ static mame_file *generic_fopen(int pathtype, const char *gamename, const char *
 			/* now look for path/gamename/filename.ext */
 			compose_path(name, gamename, filename, extension);
 
-			/* if we need checksums, load it into RAM and compute it along the way */
+			/* if we need checksums, load it into RAM and compute it along the way
+			   (to verify, the checksums are enough) */
 			if (flags & FILEFLAG_HASH)
 			{
-				if (checksum_file(pathtype, pathindex, name, &file.data, &file.length, file.hash) == 0)
+				if (checksum_file(pathtype, pathindex, name, (flags & FILEFLAG_VERIFY_ONLY) ? NULL : &file.data, &file.length, file.hash, &file.mapped) == 0)
 				{
 					file.type = RAM_FILE;
 					break;
@@ -915,20 +924,10 @@ static mame_file *generic_fopen(int pathtype, const char *gamename, const char *
 				if (flags & FILEFLAG_VERIFY_ONLY)
 				{
 					UINT8 crcs[4];
-					UINT32 crc = 0;
 
 					/* Since this is a .ZIP file, we extract the CRC from the expected hash
-					   (if any), so that we can load by CRC if needed. We must check that
-					   the hash really contains a CRC, because it could be a NO_DUMP rom
-					   for which we do not know the CRC yet. */
-					if (hash && hash_data_extract_binary_checksum(hash, HASH_CRC, crcs) != 0)
-					{
-						/* Store the CRC in a single DWORD */
-						crc = ((unsigned long)crcs[0] << 24) |
-							  ((unsigned long)crcs[1] << 16) |
-							  ((unsigned long)crcs[2] <<  8) |
-							  ((unsigned long)crcs[3] <<  0);
-					}
+					   (if any), so that we can load by CRC if needed. */
+					UINT32 crc = expected_crc(hash);
 
 					hash_data_clear(file.hash);
 						
@@ -967,6 +966,9 @@ static mame_file *generic_fopen(int pathtype, const char *gamename, const char *
 
 					if (err == 0)
 					{
+						struct osd_file_stamp stamp;
+						UINT32 entrylength, entrycrc = expected_crc(hash);
+						char key[sizeof(stamp.name) + sizeof(tempname) + 1];
 						unsigned functions;
 
 						LOG(("Using (mame_fopen) zip file for %s\n", filename));
@@ -982,7 +984,22 @@ static mame_file *generic_fopen(int pathtype, const char *gamename, const char *
 						if (options.crc_only && (functions & HASH_CRC))
 							functions = HASH_CRC;
 
+						/* The hash cache knows the entry by the stamp of the ZIP file
+						   and the CRC of the entry in its directory (found by name or
+						   by CRC, just like it was loaded). */
+						key[0] = 0;
+						if (options.hash_cache && osd_get_file_stamp(pathtype, pathindex, name, &stamp) &&
+							checksum_zipped_file(pathtype, pathindex, name, tempname, &entrylength, &entrycrc) == 0 &&
+							entrylength == ziplength)
+						{
+							sprintf(key, "%s|%s", stamp.name, tempname);
+							if (hashcache_find(key, stamp.size, stamp.mtime, entrycrc, functions, file.hash))
+								break;
+						}
+
 						hash_compute(file.hash, file.data, file.length, functions);
+						if (key[0])
+							hashcache_add(key, stamp.size, stamp.mtime, entrycrc, file.hash);
 						break;
 					}
 				}
@@ -1013,12 +1030,14 @@ static mame_file *generic_fopen(int pathtype, const char *gamename, const char *
 	checksum_file
 ***************************************************************************/
 
-static int checksum_file(int pathtype, int pathindex, const char *file, UINT8 **p, UINT64 *size, char* hash)
+static int checksum_file(int pathtype, int pathindex, const char *file, UINT8 **p, UINT64 *size, char* hash, UINT8 *mapped)
 {
-	UINT64 length;
+	struct osd_file_stamp stamp;
+	UINT64 length, maplength;
 	UINT8 *data;
 	osd_file *f;
 	unsigned int functions;
+	int stamped, cached;
 
 	/* open the file */
 	f = osd_fopen(pathtype, pathindex, file, "rb");
@@ -1039,41 +1058,70 @@ static int checksum_file(int pathtype, int pathindex, const char *file, UINT8 **
 		return -1;
 	}
 
-	/* allocate space for entire file */
-	data = malloc(length);
-	if (!data)
+	*size = length;
+	/* compute the checksums (only the functions for which we have an expected
+	   checksum). Take also care of crconly: if the user asked, we will calculate
+	   only the CRC, but only if there is an expected CRC for this file. */
+	functions = hash_data_used_functions(hash);
+	if (options.crc_only && (functions & HASH_CRC))
+		functions = HASH_CRC;
+
+	/* an unchanged file has its checksums in the hash cache; if the caller
+	   doesn't want the data, we don't even have to read it then */
+	stamped = options.hash_cache && osd_get_file_stamp(pathtype, pathindex, file, &stamp) && stamp.size == length;
+	cached = stamped && hashcache_find(stamp.name, stamp.size, stamp.mtime, 0, functions, hash);
+	if (cached && !p)
 	{
 		osd_fclose(f);
-		return -1;
+		return 0;
 	}
 
-	/* read entire file into memory */
-	if (osd_fseek(f, 0L, SEEK_SET) != 0)
+	/* map the file if the OSD can, otherwise read it into memory */
+	*mapped = 0;
+	data = (UINT8 *)osd_fmap(f, &maplength);
+	if (data && maplength == length)
+		*mapped = 1;
+	else
 	{
-		free(data);
-		osd_fclose(f);
-		return -1;
+		if (data)
+			osd_funmap(data, maplength);
+
+		/* allocate space for entire file */
+		data = malloc(length);
+		if (!data)
+		{
+			osd_fclose(f);
+			return -1;
+		}
+
+		/* read entire file into memory */
+		if (osd_fseek(f, 0L, SEEK_SET) != 0)
+		{
+			free(data);
+			osd_fclose(f);
+			return -1;
+		}
+
+		if (osd_fread(f, data, length) != length)
+		{
+			free(data);
+			osd_fclose(f);
+			return -1;
+		}
 	}
 
-	if (osd_fread(f, data, length) != length)
+	if (!cached)
 	{
-		free(data);
-		osd_fclose(f);
-		return -1;
+		hash_compute(hash, data, length, functions);
+		if (stamped)
+			hashcache_add(stamp.name, stamp.size, stamp.mtime, 0, hash);
 	}
 
-	*size = length;
-	/* compute the checksums (only the functions for which we have an expected
-	   checksum). Take also care of crconly: if the user asked, we will calculate
-	   only the CRC, but only if there is an expected CRC for this file. */
-	functions = hash_data_used_functions(hash);
-	if (options.crc_only && (functions & HASH_CRC))
-		functions = HASH_CRC;
-	hash_compute(hash, data, length, functions);
-
 	/* if the caller wants the data, give it away, otherwise free it */
 	if (p)
 		*p = data;
+	else if (*mapped)
+		osd_funmap(data, length);
 	else
 		free(data);
 
@@ -1081,6 +1129,311 @@ static int checksum_file(int pathtype, int pathindex, const char *file, UINT8 **
 	osd_fclose(f);
 	return 0;
 }
+
+
+
+/***************************************************************************
+	expected_crc - the CRC in an expected hash,
+	0 if none (e.g. a NO_DUMP ROM)
+***************************************************************************/
+
+static UINT32 expected_crc(const char *hash)
+{
+	UINT8 crcs[4];
+
+	if (!hash || hash_data_extract_binary_checksum(hash, HASH_CRC, crcs) == 0)
+		return 0;
+
+	/* Store the CRC in a single DWORD */
+	return ((UINT32)crcs[0] << 24) |
+		   ((UINT32)crcs[1] << 16) |
+		   ((UINT32)crcs[2] <<  8) |
+		   ((UINT32)crcs[3] <<  0);
+}
+
+
+
+/***************************************************************************
+	ROM HASH CACHE
+
+	The checksums of the ROM files are kept in romhash.cfg in the config
+	directory, so that unchanged files aren't hashed again at every start.
+	An entry is used only while the file (for a ZIP entry the ZIP file)
+	has the same full name, size and modification time and a ZIP entry
+	the same CRC in the ZIP directory. One line per file:
+
+	  <size> <mtime> <ZIP entry CRC> <hash data> <full name>[|<ZIP entry>]
+***************************************************************************/
+
+struct hashcache_entry
+{
+	char *		name;
+	UINT64		size;
+	UINT64		mtime;
+	UINT32		crc;			/* of the ZIP entry, 0 for plain files */
+	char		hash[HASH_BUF_SIZE];
+};
+
+static struct
+{
+	int			loaded;
+	int			dirty;
+	struct hashcache_entry *entry;
+	int			count;
+	int			alloc;
+	int *		table;			/* entry index + 1 by name, 0 = empty slot */
+	int			tablesize;		/* power of 2, more than twice the count */
+} hashcache;
+
+/* the audit checks several sets at once, see audit.c */
+MTLOCK(hashcache_lock);
+
+
+
+/*-------------------------------------------------
+	hashcache_slot - first table slot for a name
+-------------------------------------------------*/
+
+static UINT32 hashcache_slot(const char *name)
+{
+	UINT32 h = 2166136261U;
+
+	while (*name)
+		h = (h ^ (UINT8)*name++) * 16777619U;
+	return h & (hashcache.tablesize - 1);
+}
+
+
+
+/*-------------------------------------------------
+	hashcache_lookup - find an entry by name
+-------------------------------------------------*/
+
+static struct hashcache_entry *hashcache_lookup(const char *name)
+{
+	UINT32 slot;
+
+	if (!hashcache.tablesize)
+		return NULL;
+	for (slot = hashcache_slot(name); hashcache.table[slot]; slot = (slot + 1) & (hashcache.tablesize - 1))
+		if (strcmp(hashcache.entry[hashcache.table[slot] - 1].name, name) == 0)
+			return &hashcache.entry[hashcache.table[slot] - 1];
+	return NULL;
+}
+
+
+
+/*-------------------------------------------------
+	hashcache_new - add an empty entry
+-------------------------------------------------*/
+
+static struct hashcache_entry *hashcache_new(const char *name)
+{
+	struct hashcache_entry *e;
+	UINT32 slot;
+	int i;
+
+	/* make room for one more */
+	if (hashcache.count >= hashcache.alloc)
+	{
+		int alloc = hashcache.alloc ? 2 * hashcache.alloc : 256;
+		e = realloc(hashcache.entry, alloc * sizeof(*e));
+		if (!e)
+			return NULL;
+		hashcache.entry = e;
+		hashcache.alloc = alloc;
+	}
+	if (2 * (hashcache.count + 1) >= hashcache.tablesize)
+	{
+		int size = hashcache.tablesize ? 2 * hashcache.tablesize : 1024;
+		int *table = calloc(size, sizeof(*table));
+		if (!table)
+			return NULL;
+		free(hashcache.table);
+		hashcache.table = table;
+		hashcache.tablesize = size;
+		for (i = 0; i < hashcache.count; i++)
+		{
+			for (slot = hashcache_slot(hashcache.entry[i].name); table[slot]; slot = (slot + 1) & (size - 1))
+				;
+			table[slot] = i + 1;
+		}
+	}
+
+	e = &hashcache.entry[hashcache.count];
+	memset(e, 0, sizeof(*e));
+	e->name = malloc(strlen(name) + 1);
+	if (!e->name)
+		return NULL;
+	strcpy(e->name, name);
+	for (slot = hashcache_slot(name); hashcache.table[slot]; slot = (slot + 1) & (hashcache.tablesize - 1))
+		;
+	hashcache.table[slot] = ++hashcache.count;
+	return e;
+}
+
+
+
+/*-------------------------------------------------
+	hashcache_load - read romhash.cfg
+-------------------------------------------------*/
+
+static void hashcache_load(void)
+{
+	struct hashcache_entry *e;
+	mame_file *f;
+	char line[sizeof(((struct osd_file_stamp *)0)->name) + 512];
+
+	hashcache.loaded = 1;
+	f = mame_fopen(HASHCACHE_NAME, NULL, FILETYPE_CONFIG, 0);
+	if (!f)
+		return;
+
+	while (mame_fgets(line, sizeof(line), f))
+	{
+		UINT32 sizehi, sizelo, mtimehi, mtimelo, crc;
+		char hash[HASH_BUF_SIZE], *name, *end;
+		int n = 0;
+
+		/* comments and broken lines fail here */
+		if (sscanf(line, "%8x%8x %8x%8x %8x %255s %n", &sizehi, &sizelo, &mtimehi, &mtimelo, &crc, hash, &n) != 6 || !n)
+			continue;
+		name = line + n;
+		for (end = name + strlen(name); end > name && (end[-1] == '\r' || end[-1] == '\n'); )
+			*--end = 0;
+		if (!*name || !hash_verify_string(hash) || hashcache_lookup(name))
+			continue;
+
+		e = hashcache_new(name);
+		if (!e)
+			break;
+		e->size = ((UINT64)sizehi << 32) | sizelo;
+		e->mtime = ((UINT64)mtimehi << 32) | mtimelo;
+		e->crc = crc;
+		hash_data_copy(e->hash, hash);
+	}
+	mame_fclose(f);
+}
+
+
+
+/*-------------------------------------------------
+	hashcache_find - get the checksums of an
+	unchanged file, if they are all in the cache
+-------------------------------------------------*/
+
+static int hashcache_find(const char *name, UINT64 size, UINT64 mtime, UINT32 crc, unsigned int functions, char *hash)
+{
+	struct hashcache_entry *e;
+	UINT8 chksum[256];
+	unsigned int i;
+	int found;
+
+	/* zero means all functions, as for hash_compute */
+	if (!functions)
+		functions = (1 << HASH_NUM_FUNCTIONS) - 1;
+
+	mtlock_enter(&hashcache_lock);
+	if (!hashcache.loaded)
+		hashcache_load();
+	e = hashcache_lookup(name);
+	found = e && e->size == size && e->mtime == mtime && e->crc == crc &&
+			(hash_data_used_functions(e->hash) & functions) == functions;
+
+	/* exactly what hash_compute would give */
+	if (found)
+	{
+		hash_data_clear(hash);
+		for (i = 1; i < (1 << HASH_NUM_FUNCTIONS); i <<= 1)
+			if (functions & i)
+			{
+				hash_data_extract_binary_checksum(e->hash, i, chksum);
+				hash_data_insert_binary_checksum(hash, i, chksum);
+			}
+	}
+	mtlock_leave(&hashcache_lock);
+	return found;
+}
+
+
+
+/*-------------------------------------------------
+	hashcache_add - remember the checksums of a
+	file, with those known already
+-------------------------------------------------*/
+
+static void hashcache_add(const char *name, UINT64 size, UINT64 mtime, UINT32 crc, const char *hash)
+{
+	struct hashcache_entry *e;
+	UINT8 chksum[256];
+	unsigned int i;
+
+	mtlock_enter(&hashcache_lock);
+	if (!hashcache.loaded)
+		hashcache_load();
+	e = hashcache_lookup(name);
+
+	/* the same file: add what wasn't known yet, romhash.cfg only
+	   needs writing if there was something */
+	if (e && e->size == size && e->mtime == mtime && e->crc == crc)
+	{
+		for (i = 1; i < (1 << HASH_NUM_FUNCTIONS); i <<= 1)
+			if (hash_data_extract_binary_checksum(hash, i, chksum) &&
+				!hash_data_has_checksum(e->hash, i))
+			{
+				hash_data_insert_binary_checksum(e->hash, i, chksum);
+				hashcache.dirty = 1;
+			}
+	}
+
+	/* a new or a changed file */
+	else
+	{
+		if (!e && !(e = hashcache_new(name)))
+		{
+			mtlock_leave(&hashcache_lock);
+			return;
+		}
+		e->size = size;
+		e->mtime = mtime;
+		e->crc = crc;
+		hash_data_copy(e->hash, hash);
+		hashcache.dirty = 1;
+	}
+	mtlock_leave(&hashcache_lock);
+}
+
+
+
+/***************************************************************************
+	mame_save_hash_cache - write romhash.cfg
+	if there are new checksums
+***************************************************************************/
+
+void mame_save_hash_cache(void)
+{
+	mame_file *f;
+	int i;
+
+	mtlock_enter(&hashcache_lock);
+	if (!hashcache.dirty || !(f = mame_fopen(HASHCACHE_NAME, NULL, FILETYPE_CONFIG, 1)))
+	{
+		mtlock_leave(&hashcache_lock);
+		return;
+	}
+
+	mame_fprintf(f, "# checksums of the ROM files, delete this file to check all of them again\n");
+	for (i = 0; i < hashcache.count; i++)
+	{
+		const struct hashcache_entry *e = &hashcache.entry[i];
+		mame_fprintf(f, "%08x%08x %08x%08x %08x %s %s\n",
+				(UINT32)(e->size >> 32), (UINT32)e->size, (UINT32)(e->mtime >> 32), (UINT32)e->mtime,
+				e->crc, e->hash, e->name);
+	}
+	mame_fclose(f);
+	hashcache.dirty = 0;
+	mtlock_leave(&hashcache_lock);
+}
 /***************************************************************************
 	mame_fputs
 ***************************************************************************/
@@ -72,6 +72,7 @@ struct _mame_file
 	UINT64 length;
 	UINT8 eof;
 	UINT8 type;
+	UINT8 mapped;	/* data is a read-only mapping of the file (osd_fmap) */
 	char hash[HASH_BUF_SIZE];
 };
 
@@ -103,6 +104,7 @@ UINT32 mame_fwrite_swap(mame_file *file, const void *buffer, size_t length);
 int mame_fseek(mame_file *file, INT64 offset, int whence);
 void mame_fclose(mame_file *file);
 int mame_fchecksum(const char *gamename, const char *filename, unsigned int *length, char* hash);
+void mame_save_hash_cache(void);
 UINT64 mame_fsize(mame_file *file);
 const char *mame_fhash(mame_file *file);
 int mame_fgetc(mame_file *file);
@@ -0,0 +1,397 @@
+/***************************************************************************
+
+	hprof.c
+
+	Hierarchical profiler, see hprof.h.
+
+	Every scope is a node in a call tree, found by its parent, kind and
+	id in a hash table. The tree keeps calls and time per node; for a
+	Chrome trace every finished scope is also kept as an event.
+
+***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "driver.h"
+#include "hprof.h"
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#elif !defined(__GNUC__) || !(defined(__i386__) || defined(__x86_64__))
+#include <time.h>
+#endif
+
+
+#define HPROF_MAXNODES		4096
+#define HPROF_HASHSIZE		8192		/* power of 2, larger than HPROF_MAXNODES */
+#define HPROF_MAXDEPTH		64
+
+
+/*-------------------------------------------------
+	profiler structures
+-------------------------------------------------*/
+
+struct hprof_node
+{
+	int				parent;
+	int				kind;
+	const void *	id;
+	UINT32			arg;
+	UINT64			calls;
+	UINT64			ticks;			/* time in the scope, including the children */
+	UINT64			childticks;		/* time in the children */
+};
+
+struct hprof_event
+{
+	UINT64			start;			/* relative to the start of the profile */
+	UINT32			ticks;
+	UINT32			node;
+};
+
+int hprof_active;
+
+static struct
+{
+	char *			filename;
+	int				json;			/* write a Chrome trace instead of folded stacks */
+
+	struct hprof_node *nodes;		/* node 0 is the root */
+	int				nodecount;
+	int *			hash;			/* node index, 0 = empty slot */
+
+	int				stack[HPROF_MAXDEPTH];
+	int				last[HPROF_MAXDEPTH];	/* the node last entered at this depth */
+	UINT64			start[HPROF_MAXDEPTH];
+	int				depth;
+	int				lost;			/* open scopes beyond HPROF_MAXDEPTH */
+
+	struct hprof_event *events;
+	UINT32			eventcount;
+	UINT32			droppedevents;
+
+	UINT64			ticks0;
+	cycles_t		wall0;
+} hprof;
+
+
+
+/*-------------------------------------------------
+	hprof_ticks - a fast time stamp
+-------------------------------------------------*/
+
+INLINE UINT64 hprof_ticks(void)
+{
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+	UINT32 lo, hi;
+	__asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
+	return ((UINT64)hi << 32) | lo;
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+	return __rdtsc();
+#elif defined(_WIN32)
+	LARGE_INTEGER t;
+	QueryPerformanceCounter(&t);
+	return t.QuadPart;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (UINT64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+
+
+/*-------------------------------------------------
+	hprof_node - find or add the child of a node
+-------------------------------------------------*/
+
+static int hprof_node(int parent, int kind, const void *id, UINT32 arg)
+{
+	UINT32 slot = ((UINT32)(FPTR)id * 0x9e3779b1) ^ (parent * 31 + kind);
+	struct hprof_node *n;
+
+	if (parent < 0)
+		return -1;
+
+	for (slot &= HPROF_HASHSIZE - 1; hprof.hash[slot]; slot = (slot + 1) & (HPROF_HASHSIZE - 1))
+	{
+		n = &hprof.nodes[hprof.hash[slot]];
+		if (n->id == id && n->parent == parent && n->kind == kind)
+			return hprof.hash[slot];
+	}
+
+	/* a new one */
+	if (hprof.nodecount >= HPROF_MAXNODES)
+		return -1;
+	n = &hprof.nodes[hprof.nodecount];
+	n->parent = parent;
+	n->kind = kind;
+	n->id = id;
+	n->arg = arg;
+	hprof.hash[slot] = hprof.nodecount;
+	return hprof.nodecount++;
+}
+
+
+
+/*-------------------------------------------------
+	hprof__begin - enter a scope
+-------------------------------------------------*/
+
+void hprof__begin(int kind, const void *id, UINT32 arg)
+{
+	int parent, node;
+
+	if (hprof.lost || hprof.depth >= HPROF_MAXDEPTH)
+	{
+		hprof.lost++;
+		return;
+	}
+
+	/* mostly the same scope as last time at this depth (e.g. a loop over a chip's registers) */
+	parent = hprof.depth ? hprof.stack[hprof.depth-1] : 0;
+	node = hprof.last[hprof.depth];
+	if (node <= 0 || hprof.nodes[node].id != id || hprof.nodes[node].parent != parent || hprof.nodes[node].kind != kind)
+		hprof.last[hprof.depth] = node = hprof_node(parent, kind, id, arg);
+	hprof.stack[hprof.depth] = node;
+	hprof.start[hprof.depth] = hprof_ticks();
+	hprof.depth++;
+}
+
+
+
+/*-------------------------------------------------
+	hprof__end - leave the current scope
+-------------------------------------------------*/
+
+void hprof__end(void)
+{
+	UINT64 ticks = hprof_ticks();
+	struct hprof_node *n;
+	int node;
+
+	if (hprof.lost)
+	{
+		hprof.lost--;
+		return;
+	}
+	if (hprof.depth == 0)
+		return;
+
+	hprof.depth--;
+	node = hprof.stack[hprof.depth];
+	if (node < 0)
+		return;
+	ticks -= hprof.start[hprof.depth];
+
+	n = &hprof.nodes[node];
+	n->calls++;
+	n->ticks += ticks;
+	hprof.nodes[n->parent].childticks += ticks;
+
+	if (hprof.events)
+	{
+		if (hprof.eventcount < HPROF_MAXEVENTS)
+		{
+			struct hprof_event *e = &hprof.events[hprof.eventcount++];
+			e->start = hprof.start[hprof.depth] - hprof.ticks0;
+			e->ticks = (ticks > 0xffffffff) ? 0xffffffff : (UINT32)ticks;
+			e->node = node;
+		}
+		else
+			hprof.droppedevents++;
+	}
+}
+
+
+
+/*-------------------------------------------------
+	hprof_start - start profiling
+-------------------------------------------------*/
+
+int hprof_start(const char *filename)
+{
+	const char *ext = strrchr(filename, '.');
+
+	hprof_stop();
+	memset(&hprof, 0, sizeof(hprof));
+
+	hprof.json = ext && (strcmp(ext, ".json") == 0 || strcmp(ext, ".JSON") == 0);
+	hprof.filename = malloc(strlen(filename) + 1);
+	hprof.nodes = calloc(HPROF_MAXNODES, sizeof(hprof.nodes[0]));
+	hprof.hash = calloc(HPROF_HASHSIZE, sizeof(hprof.hash[0]));
+	if (hprof.json)
+		hprof.events = malloc(HPROF_MAXEVENTS * sizeof(hprof.events[0]));
+	if (!hprof.filename || !hprof.nodes || !hprof.hash || (hprof.json && !hprof.events))
+	{
+		free(hprof.filename);
+		free(hprof.nodes);
+		free(hprof.hash);
+		free(hprof.events);
+		memset(&hprof, 0, sizeof(hprof));
+		return 0;
+	}
+	strcpy(hprof.filename, filename);
+
+	/* the root stands for everything outside of a scope */
+	hprof.nodes[0].kind = -1;
+	hprof.nodecount = 1;
+
+	hprof.wall0 = osd_cycles();
+	hprof.ticks0 = hprof_ticks();
+	hprof_active = 1;
+	return 1;
+}
+
+
+
+/*-------------------------------------------------
+	hprof_nodename - the name of a scope
+-------------------------------------------------*/
+
+static void hprof_nodename(const struct hprof_node *n, char *name)
+{
+	switch (n->kind)
+	{
+		case HPROF_CPU:
+			sprintf(name, "cpu%d %.40s", (int)(FPTR)n->id + 1, cputype_name(Machine->drv->cpu[(FPTR)n->id].cpu_type));
+			break;
+
+		case HPROF_MEMREAD:
+			sprintf(name, "read %x @%p", n->arg, n->id);
+			break;
+
+		case HPROF_MEMWRITE:
+			sprintf(name, "write %x @%p", n->arg, n->id);
+			break;
+
+		case HPROF_TIMER:
+			sprintf(name, "timer @%p", n->id);
+			break;
+
+		case HPROF_STREAM:
+			if (mixer_get_name(n->arg))
+				sprintf(name, "stream %.60s", mixer_get_name(n->arg));
+			else
+				sprintf(name, "stream %d", n->arg);
+			break;
+
+		case HPROF_NAMED:
+			sprintf(name, "%.60s", (const char *)n->id);
+			break;
+
+		default:
+			sprintf(name, "%.60s", Machine->gamedrv->name);
+			break;
+	}
+}
+
+
+
+/*-------------------------------------------------
+	hprof_writefolded - one line per node with
+	the path from the root and the self time
+-------------------------------------------------*/
+
+static void hprof_writefolded(FILE *f, double usecspertick)
+{
+	int node;
+
+	for (node = 0; node < hprof.nodecount; node++)
+	{
+		const struct hprof_node *n = &hprof.nodes[node];
+		int path[HPROF_MAXDEPTH + 1];
+		int depth = 0, ii;
+		char name[80];
+
+		if (n->ticks <= n->childticks)
+			continue;
+
+		for (ii = node; ii && depth < HPROF_MAXDEPTH; ii = hprof.nodes[ii].parent)
+			path[depth++] = ii;
+		path[depth++] = 0;
+
+		while (depth--)
+		{
+			hprof_nodename(&hprof.nodes[path[depth]], name);
+			fprintf(f, depth ? "%s;" : "%s", name);
+		}
+		fprintf(f, " %.0f\n", (double)(n->ticks - n->childticks) * usecspertick);
+	}
+}
+
+
+
+/*-------------------------------------------------
+	hprof_writejson - Chrome trace format
+-------------------------------------------------*/
+
+static void hprof_writejson(FILE *f, double usecspertick)
+{
+	static const char *category[HPROF_KINDS] = { "cpu", "memread", "memwrite", "timer", "stream", "named" };
+	UINT32 ii;
+	char name[80], *c;
+
+	fprintf(f, "{\"traceEvents\":[\n");
+	hprof_nodename(&hprof.nodes[0], name);
+	fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"%s\"}}", name);
+
+	for (ii = 0; ii < hprof.eventcount; ii++)
+	{
+		const struct hprof_event *e = &hprof.events[ii];
+		const struct hprof_node *n = &hprof.nodes[e->node];
+
+		hprof_nodename(n, name);
+		for (c = name; *c; c++)
+			if (*c == '"' || *c == '\\')
+				*c = '\'';
+		fprintf(f, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1}",
+				name, category[n->kind], (double)e->start * usecspertick, (double)e->ticks * usecspertick);
+	}
+	fprintf(f, "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":\"%u\"}}\n", hprof.droppedevents);
+}
+
+
+
+/*-------------------------------------------------
+	hprof_stop - stop profiling and write the file
+-------------------------------------------------*/
+
+void hprof_stop(void)
+{
+	UINT64 ticks;
+	double seconds;
+	FILE *f;
+
+	if (!hprof.nodes)
+		return;
+	hprof_active = 0;
+
+	/* calibrate the time stamps against the OSD clock */
+	ticks = hprof_ticks() - hprof.ticks0;
+	seconds = (double)(osd_cycles() - hprof.wall0) / (double)osd_cycles_per_second();
+	hprof.nodes[0].ticks = ticks;
+
+	if ((f = fopen(hprof.filename, "w")) != NULL)
+	{
+		const double usecspertick = (ticks && seconds > 0) ? seconds * 1000000.0 / (double)ticks : 0.001;
+
+		if (hprof.json)
+			hprof_writejson(f, usecspertick);
+		else
+			hprof_writefolded(f, usecspertick);
+		fclose(f);
+		logerror("hprof: %.3f seconds, %d scopes, written to %s\n", seconds, hprof.nodecount - 1, hprof.filename);
+	}
+	else
+		printf("hprof: can't write %s\n", hprof.filename);
+
+	free(hprof.filename);
+	free(hprof.nodes);
+	free(hprof.hash);
+	free(hprof.events);
+	memset(&hprof, 0, sizeof(hprof));
+}
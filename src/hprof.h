@@ -0,0 +1,52 @@
+#ifndef HPROF_H
+#define HPROF_H
+#if !defined(__GNUC__) || (__GNUC__ == 3 && __GNUC_MINOR__ >= 4) || (__GNUC__ >= 4)	// GCC supports "pragma once" correctly since 3.4
+#pragma once
+#endif
+
+/***************************************************************************
+
+	hprof.h
+
+	Hierarchical profiler. Unlike profiler.c it is compiled into every
+	build; while it is not running a scope costs one test of hprof_active.
+
+	Scopes are identified by a kind and an id (CPU number, handler or
+	callback address, mixer channel, name string) and nest: a memory
+	handler called by CPU 1 is counted under that CPU, a sound stream
+	updated by that handler under the handler, and so on.
+
+	hprof_start() starts profiling, hprof_stop() writes the result:
+	  *.json  Chrome trace (chrome://tracing, Perfetto) of the first
+	          HPROF_MAXEVENTS scopes
+	  else    folded stacks ("cpu1 M6809;read 3fdc @0x... 1234", self
+	          time in microseconds per line) for flamegraph.pl
+
+***************************************************************************/
+
+enum
+{
+	HPROF_CPU = 0,		/* id = CPU number */
+	HPROF_MEMREAD,		/* id = read handler, arg = its base address */
+	HPROF_MEMWRITE,		/* id = write handler, arg = its base address */
+	HPROF_TIMER,		/* id = timer callback */
+	HPROF_STREAM,		/* id = arg = mixer channel */
+	HPROF_NAMED,		/* id = name (a string constant) */
+	HPROF_KINDS
+};
+
+#define HPROF_MAXEVENTS		(1 << 20)
+
+extern int hprof_active;
+
+#define hprof_begin(kind,id,arg)	do { if (hprof_active) hprof__begin(kind, (const void *)(id), arg); } while (0)
+#define hprof_end()					do { if (hprof_active) hprof__end(); } while (0)
+
+void hprof__begin(int kind, const void *id, UINT32 arg);
+void hprof__end(void);
+
+/* returns 0 if the profiler could not be started */
+int hprof_start(const char *filename);
+void hprof_stop(void);
+
+#endif	/* HPROF_H */
@@ -227,6 +227,7 @@ struct ipd inputport_defaults[] =
 	{ IPT_UI_WATCH_VALUE,		"Watch Value",			SEQ_DEF_1(KEYCODE_W) },
 	{ IPT_UI_EDIT_CHEAT,		"Edit Cheat",			SEQ_DEF_1(KEYCODE_E) },
 	{ IPT_UI_TOGGLE_CROSSHAIR,	"Toggle Crosshair",		SEQ_DEF_1(KEYCODE_F1) },
+	{ IPT_UI_REWIND,			"Rewind",				SEQ_DEF_1(KEYCODE_BACKSPACE) },
 	{ IPT_START1, "1 Player Start",  SEQ_DEF_3(KEYCODE_1, CODE_OR, JOYCODE_1_START) },
 	{ IPT_START2, "2 Players Start", SEQ_DEF_3(KEYCODE_2, CODE_OR, JOYCODE_2_START) },
 	{ IPT_START3, "3 Players Start", SEQ_DEF_3(KEYCODE_3, CODE_OR, JOYCODE_3_START) },
@@ -1009,6 +1010,7 @@ struct ik input_keywords[] =
 	{ "UI_WATCH_VALUE",			IKT_IPT,		IPT_UI_WATCH_VALUE },
 	{ "UI_EDIT_CHEAT",			IKT_IPT,		IPT_UI_EDIT_CHEAT },
 	{ "UI_TOGGLE_CROSSHAIR",	IKT_IPT,		IPT_UI_TOGGLE_CROSSHAIR },
+	{ "UI_REWIND",				IKT_IPT,		IPT_UI_REWIND },
 	{ "START1",					IKT_IPT,		IPT_START1 },
 	{ "START2",					IKT_IPT,		IPT_START2 },
 	{ "START3",					IKT_IPT,		IPT_START3 },
@@ -125,6 +125,7 @@ enum { IPT_END=1,IPT_PORT,
 	/* 8 player support */
 	IPT_START5, IPT_START6, IPT_START7, IPT_START8,
 	IPT_COIN5, IPT_COIN6, IPT_COIN7, IPT_COIN8,
+	IPT_UI_REWIND,
 	__ipt_max,
 
 	/* pinDMD frame dumping */
@@ -0,0 +1,134 @@
+/************************************************/
+/* libpinmame - several machines in one process */
+/************************************************/
+/*
+ Experimental. The emulator keeps its machine in globals, so a machine
+ instance is a private copy of libpinmame.so loaded with dlmopen() into
+ a link map of its own: every copy has its own globals and emulation
+ thread and the copies run side by side without knowing of each other.
+ The instance functions only forward to the pinmame_* functions of the
+ copy.
+
+ This is not a replacement for a machine context: glibc has 16 link
+ maps, which leaves room for 11 copies (glibc 2.36), every copy loads
+ its own libc and libz, and a copy only runs on its own thread. Each
+ instance gets its own cfg, nvram and sta directories, so two machines
+ of the same game don't write the same files.
+
+ The copies use the ROM image cache (romcache.c) of this copy, so
+ the machines of the same game share the ROM images and only the first
+ one loads them.
+*/
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include "driver.h"
+#include "libpinmame.h"
+#include "romcache.h"
+
+#define MAX_INSTANCES 16    /* more than glibc can load */
+
+/* in libpinmame.c of the copy */
+void pinmame_setDataDir(const char *dir);
+
+struct pinmame_tInstance {
+  void *lib;
+  int  no;                  /* slot in used[] */
+  int  (*start)(const char *gameName, const pinmame_tConfig *config);
+  void (*stop)(void);
+  int  (*isRunning)(void);
+  void (*pause)(int pause);
+  void (*setSwitch)(int swNo, int state);
+  int  (*getSwitch)(int swNo);
+};
+static pinmame_tInstance *used[MAX_INSTANCES];
+
+/*-------------------------------------
+/  called in the new copy by
+/  pinmame_instanceCreate, not public
+/--------------------------------------*/
+void pinmame_instanceAttach(const struct rom_share *share, const char *dataDir) {
+  romcache_attach(share);
+  pinmame_setDataDir(dataDir);
+}
+
+/*-------------------------------
+/  Create/destroy an instance
+/--------------------------------*/
+pinmame_tInstance *pinmame_instanceCreate(const char *dataDir) {
+  pinmame_tInstance *inst;
+  void (*attach)(const struct rom_share *share, const char *dataDir);
+  char defaultDir[64];
+  Dl_info info;
+  int no;
+
+  for (no = 0; no < MAX_INSTANCES && used[no]; no++)
+    ;
+  /*-- load the file this code came from again --*/
+  if (no == MAX_INSTANCES || !dladdr((void *)pinmame_instanceCreate, &info) || !info.dli_fname)
+    return NULL;
+  if ((inst = calloc(1, sizeof(*inst))) == NULL)
+    return NULL;
+  if ((inst->lib = dlmopen(LM_ID_NEWLM, info.dli_fname, RTLD_NOW | RTLD_LOCAL)) == NULL) {
+    free(inst);
+    return NULL;
+  }
+  inst->start     = dlsym(inst->lib, "pinmame_start");
+  inst->stop      = dlsym(inst->lib, "pinmame_stop");
+  inst->isRunning = dlsym(inst->lib, "pinmame_isRunning");
+  inst->pause     = dlsym(inst->lib, "pinmame_pause");
+  inst->setSwitch = dlsym(inst->lib, "pinmame_setSwitch");
+  inst->getSwitch = dlsym(inst->lib, "pinmame_getSwitch");
+  attach          = dlsym(inst->lib, "pinmame_instanceAttach");
+  if (!inst->start || !inst->stop || !inst->isRunning || !inst->pause ||
+      !inst->setSwitch || !inst->getSwitch || !attach) {
+    dlclose(inst->lib);
+    free(inst);
+    return NULL;
+  }
+  /*-- the rc code expands $HOME --*/
+  if (!dataDir) {
+    snprintf(defaultDir, sizeof(defaultDir), "$HOME/.xpinmame/instance%d", no);
+    dataDir = defaultDir;
+  }
+  attach(romcache_share(), dataDir);
+  inst->no = no;
+  used[no] = inst;
+  return inst;
+}
+
+void pinmame_instanceDestroy(pinmame_tInstance *inst) {
+  if (!inst)
+    return;
+  inst->stop();
+  dlclose(inst->lib);
+  used[inst->no] = NULL;
+  free(inst);
+}
+
+/*-------------------------------
+/  Same as the functions without
+/  instance in libpinmame.h
+/--------------------------------*/
+int pinmame_instanceStart(pinmame_tInstance *inst, const char *gameName, const pinmame_tConfig *config) {
+  return inst->start(gameName, config);
+}
+
+void pinmame_instanceStop(pinmame_tInstance *inst) {
+  inst->stop();
+}
+
+int pinmame_instanceIsRunning(pinmame_tInstance *inst) {
+  return inst->isRunning();
+}
+
+void pinmame_instancePause(pinmame_tInstance *inst, int pause) {
+  inst->pause(pause);
+}
+
+void pinmame_instanceSetSwitch(pinmame_tInstance *inst, int swNo, int state) {
+  inst->setSwitch(swNo, state);
+}
+
+int pinmame_instanceGetSwitch(pinmame_tInstance *inst, int swNo) {
+  return inst->getSwitch(swNo);
+}
@@ -0,0 +1,273 @@
+/************************************************/
+/* libpinmame - PinMAME as an embeddable library */
+/************************************************/
+/*
+ Built on top of the headless display method: the regular xmame start-up
+ (config_init/run_game) runs on a thread of its own and the headless driver
+ calls pinmame_frame() once per emulated frame. From there the changes
+ since the previous frame are pushed to the host through the callbacks,
+ lamps/solenoids/GI from the vpintf change event queue.
+ The loaded ROM images stay in the ROM image cache (romcache.c), so
+ starting a recent game again skips loading its ROMs.
+*/
+#include <pthread.h>
+#include <unistd.h>
+#include "xmame.h"
+#include "driver.h"
+#include "wpc/core.h"
+#include "wpc/vpintf.h"
+#include "libpinmame.h"
+#include "romcache.h"
+
+extern UINT8 trying_to_quit;
+
+/* From unix/video.c. */
+void osd_video_initpre();
+
+static struct {
+  pinmame_tConfig config;
+  char gameName[64];
+  char *romPath;
+  char *dataDir;          /* cfg, nvram and state directories of an instance, NULL for the defaults */
+  pthread_t thread;
+  int joinable;           /* thread has been created and not joined yet */
+  volatile int running;   /* thread started and not yet finished */
+  volatile int started;   /* machine is emulating (first frame seen) */
+  volatile int paused;
+  cycles_t baseCycles;
+  double   baseTime;
+  vp_tChgEvent chgEvents[256];
+  vp_tChgLED   chgLEDs;
+  UINT8 dmd[DMD_MAXY*DMD_MAXX];
+  int dmdWidth, dmdHeight;
+} locals;
+static pthread_mutex_t pauseMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  pauseCond  = PTHREAD_COND_INITIALIZER;
+
+/*-- restart real time tracking from the current emulated time --*/
+static void pinmame_resync(void) {
+  locals.baseCycles = osd_cycles();
+  locals.baseTime   = timer_get_time();
+}
+
+/*-- keep the emulated time in step with the wall clock --*/
+static void pinmame_throttle(void) {
+  const cycles_t cps = osd_cycles_per_second();
+  const cycles_t target = locals.baseCycles + (cycles_t)((timer_get_time() - locals.baseTime) * cps);
+  const cycles_t now = osd_cycles();
+
+  if (target > now)
+    usleep((useconds_t)((target - now) * 1000000 / cps));
+  else if (now - target > cps / 10) /* too far behind to catch up, don't try */
+    pinmame_resync();
+}
+
+/*-------------------------------------
+/  called by the headless display method
+/  after each emulated frame
+/--------------------------------------*/
+static void pinmame_frame(void) {
+  const pinmame_tConfig *cfg = &locals.config;
+  int ii, count;
+
+  if (!locals.started) {
+    locals.started = 1;
+    pinmame_resync();
+    if (cfg->onStateChange) cfg->onStateChange(1, cfg->userData);
+  }
+
+  /*-- lamps, solenoids and GI come queued in the order they changed --*/
+  do {
+    count = vp_getChangeEvents(locals.chgEvents, sizeof(locals.chgEvents)/sizeof(locals.chgEvents[0]));
+    for (ii = 0; ii < count; ii++) {
+      const vp_tChgEvent *ev = &locals.chgEvents[ii];
+      switch (ev->type) {
+        case VP_CHGEVENT_LAMP:
+          if (cfg->onLamp) cfg->onLamp(ev->no, ev->currStat, cfg->userData);
+          break;
+        case VP_CHGEVENT_SOLENOID:
+          if (cfg->onSolenoid) cfg->onSolenoid(ev->no, ev->currStat, cfg->userData);
+          break;
+        case VP_CHGEVENT_GI:
+          if (cfg->onGI) cfg->onGI(ev->no, ev->currStat, cfg->userData);
+          break;
+      }
+    }
+  } while (count == sizeof(locals.chgEvents)/sizeof(locals.chgEvents[0]));
+  if (cfg->onSegment) {
+    count = vp_getChangedLEDs(locals.chgLEDs, ~(UINT64)0, ~(UINT64)0);
+    for (ii = 0; ii < count; ii++)
+      cfg->onSegment(locals.chgLEDs[ii].ledNo, locals.chgLEDs[ii].chgSeg, locals.chgLEDs[ii].currStat, cfg->userData);
+  }
+
+  if (locals.paused) {
+    pthread_mutex_lock(&pauseMutex);
+    while (locals.paused && !trying_to_quit)
+      pthread_cond_wait(&pauseCond, &pauseMutex);
+    pthread_mutex_unlock(&pauseMutex);
+    pinmame_resync();
+  }
+  else if (cfg->throttle)
+    pinmame_throttle();
+}
+
+/*-------------------------------------
+/  called by core.c for every DMD update
+/--------------------------------------*/
+void libpinmame_updateDMD(int width, int height, int levels, tDMDDot dotCol) {
+  UINT8 frame[DMD_MAXY*DMD_MAXX];
+  int ii;
+
+  if (!locals.config.onDMD || width > DMD_MAXX || height > DMD_MAXY)
+    return;
+
+  for (ii = 0; ii < height; ii++)
+    memcpy(&frame[ii*width], &dotCol[ii+1][0], width);
+
+  /*-- only pass on frames that differ from the previous one --*/
+  if (width == locals.dmdWidth && height == locals.dmdHeight &&
+      memcmp(frame, locals.dmd, width*height) == 0)
+    return;
+  memcpy(locals.dmd, frame, width*height);
+  locals.dmdWidth = width; locals.dmdHeight = height;
+  locals.config.onDMD(width, height, levels, locals.dmd, locals.config.userData);
+}
+
+static void *pinmame_thread(void *arg) {
+  static const char *dataOpts[3][2] = {
+    { "-cfg_directory", "cfg" }, { "-nvram_directory", "nvram" }, { "-state_directory", "sta" }
+  };
+  char dataPaths[3][300];
+  char *argv[16];
+  int argc = 0, ii;
+
+  argv[argc++] = "libpinmame";
+  if (locals.romPath) {
+    argv[argc++] = "-rompath";
+    argv[argc++] = locals.romPath;
+  }
+  /*-- an instance keeps its settings and NVRAM apart from the others --*/
+  if (locals.dataDir)
+    for (ii = 0; ii < 3; ii++) {
+      snprintf(dataPaths[ii], sizeof(dataPaths[ii]), "%s/%s", locals.dataDir, dataOpts[ii][1]);
+      argv[argc++] = (char *)dataOpts[ii][0];
+      argv[argc++] = dataPaths[ii];
+    }
+  /*-- the DMD is only decoded when frames are drawn --*/
+  if (locals.config.onDMD)
+    argv[argc++] = "-batch_draw";
+  argv[argc++] = locals.gameName;
+  argv[argc] = NULL;
+
+  if (sysdep_init() == OSD_OK) {
+    if (config_init(argc, argv) == 1234) {
+      if (!options.color_depth && !sysdep_display_16bpp_capable())
+        options.color_depth = 8;
+      osd_video_initpre();
+      run_game(game_index);
+    }
+    sysdep_close();
+  }
+  /*-- config_exit closes the rc files, don't let it take the host's stdio along --*/
+  if (stdout_file == stdout) stdout_file = NULL;
+  if (stderr_file == stderr) stderr_file = NULL;
+  config_exit();
+
+  headless_frame_callback = NULL;
+  if (locals.started && locals.config.onStateChange)
+    locals.config.onStateChange(0, locals.config.userData);
+  locals.started = 0;
+  locals.running = 0;
+  return NULL;
+}
+
+/*-------------------------------
+/  Start/stop the emulation
+/--------------------------------*/
+int pinmame_start(const char *gameName, const pinmame_tConfig *config) {
+  if (locals.running || !gameName)
+    return -1;
+
+  /*-- reap a thread that ended on its own --*/
+  if (locals.joinable) {
+    pthread_join(locals.thread, NULL);
+    locals.joinable = 0;
+  }
+  free(locals.romPath);
+  locals.romPath = NULL;
+
+  memset(&locals.config, 0, sizeof(locals.config));
+  if (config) locals.config = *config;
+  strncpy(locals.gameName, gameName, sizeof(locals.gameName)-1);
+  locals.gameName[sizeof(locals.gameName)-1] = '\0';
+  if (locals.config.romPath)
+    locals.romPath = strdup(locals.config.romPath);
+  locals.dmdWidth = locals.dmdHeight = 0;
+  locals.started = locals.paused = 0;
+
+  vp_init();
+  rom_set_share(romcache_share());
+  trying_to_quit = 0;
+  headless_frame_callback = pinmame_frame;
+
+  locals.running = 1;
+  if (pthread_create(&locals.thread, NULL, pinmame_thread, NULL)) {
+    headless_frame_callback = NULL;
+    locals.running = 0;
+    return -1;
+  }
+  locals.joinable = 1;
+  return 0;
+}
+
+void pinmame_stop(void) {
+  if (!locals.joinable)
+    return;
+
+  pthread_mutex_lock(&pauseMutex);
+  trying_to_quit = 1;
+  locals.paused = 0;
+  pthread_cond_signal(&pauseCond);
+  pthread_mutex_unlock(&pauseMutex);
+
+  pthread_join(locals.thread, NULL);
+  locals.joinable = 0;
+}
+
+int pinmame_isRunning(void) {
+  return locals.running && locals.started;
+}
+
+void pinmame_pause(int pause) {
+  pthread_mutex_lock(&pauseMutex);
+  locals.paused = pause;
+  pthread_cond_signal(&pauseCond);
+  pthread_mutex_unlock(&pauseMutex);
+}
+
+/*------------------------------------
+/  set/get status of a switch (0=off, !0=on)
+/-------------------------------------*/
+void pinmame_setSwitch(int swNo, int state) {
+  if (locals.started) vp_putSwitch(swNo, state);
+}
+
+int pinmame_getSwitch(int swNo) {
+  return locals.started ? vp_getSwitch(swNo) : 0;
+}
+
+/*-------------------------------------
+/  data directory of an instance, set
+/  by pinmame_instanceAttach, not public
+/--------------------------------------*/
+void pinmame_setDataDir(const char *dir) {
+  free(locals.dataDir);
+  locals.dataDir = dir ? strdup(dir) : NULL;
+}
+
+/*------------------------------------
+/  size of the ROM image cache
+/-------------------------------------*/
+void pinmame_setRomCacheSize(unsigned int megabytes) {
+  romcache_setSize(megabytes);
+}
@@ -0,0 +1,96 @@
+#ifndef INC_LIBPINMAME
+#define INC_LIBPINMAME
+#if !defined(__GNUC__) || (__GNUC__ == 3 && __GNUC_MINOR__ >= 4) || (__GNUC__ >= 4)	// GCC supports "pragma once" correctly since 3.4
+#pragma once
+#endif
+
+/*-------------------------------------------------------------------
+/  libpinmame - embeddable PinMAME
+/
+/  The emulation runs on its own thread. All callbacks are called from
+/  that thread, once per emulated frame for whatever changed since the
+/  previous frame, so they should return quickly and must not call
+/  pinmame_stop(). Only one game can run at a time, more need an
+/  instance each (see below).
+/  Numbering of lamps, solenoids, switches etc. is the same as in the
+/  Visual PinMAME (vpintf) interface.
+/-------------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  const char *romPath;  /* ROM search path, NULL for the default one */
+  int throttle;         /* 1 = run in real time, 0 = as fast as possible */
+  void *userData;       /* passed back to all callbacks */
+
+  /*-- all callbacks are optional --*/
+  void (*onStateChange)(int running, void *userData);
+  void (*onLamp)(int lampNo, int state, void *userData);
+  void (*onSolenoid)(int solNo, int state, void *userData);
+  void (*onGI)(int giNo, int state, void *userData);
+  void (*onSegment)(int ledNo, int chgSeg, int state, void *userData);
+  /* dots are width*height bytes, row by row, with 0..levels-1 brightness */
+  void (*onDMD)(int width, int height, int levels, const unsigned char *dots, void *userData);
+} pinmame_tConfig;
+
+/*-------------------------------
+/  Start/stop the emulation
+/  pinmame_start returns 0 when the emulation thread was started
+/--------------------------------*/
+int  pinmame_start(const char *gameName, const pinmame_tConfig *config);
+void pinmame_stop(void);
+int  pinmame_isRunning(void);
+
+/*-------------------------------
+/  Pause (!0) or resume (0) the emulation
+/--------------------------------*/
+void pinmame_pause(int pause);
+
+/*------------------------------------
+/  set/get status of a switch (0=off, !0=on)
+/-------------------------------------*/
+void pinmame_setSwitch(int swNo, int state);
+int  pinmame_getSwitch(int swNo);
+
+/*------------------------------------
+/  The ROM images of the games that ran recently are kept in memory,
+/  starting one of them again doesn't load its ROMs. Default 64 MB,
+/  0 turns the cache off. Instances use the cache of the host.
+/-------------------------------------*/
+void pinmame_setRomCacheSize(unsigned int megabytes);
+
+/*-------------------------------------------------------------------
+/  Machine instances (Linux, experimental)
+/
+/  Each instance is a private copy of the library with its own
+/  emulation thread, so several games can run at the same time, the
+/  same one too. The instance functions work like the ones above.
+/  The instances of a game share its ROM images if they loaded
+/  without warnings.
+/  glibc limits a process to 11 instances (glibc 2.36), a destroyed
+/  one doesn't always give its place back, and each one loads its own
+/  copy of libc.
+/  An instance keeps its cfg, nvram and sta files in subdirectories
+/  of dataDir, NULL means ~/.xpinmame/instance<n> with n the lowest
+/  number not used by another instance.
+/  pinmame_instanceCreate returns NULL if the copy can't be loaded.
+/-------------------------------------------------------------------*/
+typedef struct pinmame_tInstance pinmame_tInstance;
+
+pinmame_tInstance *pinmame_instanceCreate(const char *dataDir);
+void pinmame_instanceDestroy(pinmame_tInstance *inst);
+
+int  pinmame_instanceStart(pinmame_tInstance *inst, const char *gameName, const pinmame_tConfig *config);
+void pinmame_instanceStop(pinmame_tInstance *inst);
+int  pinmame_instanceIsRunning(pinmame_tInstance *inst);
+void pinmame_instancePause(pinmame_tInstance *inst, int pause);
+void pinmame_instanceSetSwitch(pinmame_tInstance *inst, int swNo, int state);
+int  pinmame_instanceGetSwitch(pinmame_tInstance *inst, int swNo);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_LIBPINMAME */
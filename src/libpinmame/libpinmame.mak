@@ -0,0 +1,21 @@
+# only libpinmame specific output files and rules
+#
+OBJDIRS += $(OBJ)/libpinmame
+
+# add objects for libpinmame
+LIBPINMAMEOBJS = \
+ $(OBJ)/libpinmame/libpinmame.o \
+ $(OBJ)/libpinmame/instance.o \
+ $(OBJ)/libpinmame/romcache.o
+
+# add libraries for libpinmame
+LIBPINMAMELIBS = \
+ -lpthread -ldl
+
+# only export the pinmame_* API
+LIBPINMAMEMAP = src/libpinmame/libpinmame.map
+
+# libpinmame functions
+$(OBJ)/libpinmame/%.o: src/libpinmame/%.c src/libpinmame/libpinmame.h src/libpinmame/romcache.h
+	$(CC_COMMENT) @echo 'Compiling $< ...'
+	$(CC_COMPILE) $(CC) $(MY_CFLAGS) -o $@ -c $<
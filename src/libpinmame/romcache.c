@@ -0,0 +1,118 @@
+/************************************************/
+/* libpinmame - ROM image cache                 */
+/************************************************/
+/*
+ See romcache.h. The images live in memfds; a machine maps its image
+ privately, so the pages are shared until a machine writes to them and
+ dropping an image from the cache does not affect the machines that
+ have it mapped.
+*/
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "driver.h"
+#include "romcache.h"
+
+static struct {
+  struct {
+    char game[16];
+    int type;
+    size_t length;
+    int fd;
+    UINT32 lastUse;
+  } region[ROMCACHE_REGIONS];
+  int count;
+  size_t used, size;
+  UINT32 useCount;
+  const struct rom_share *parent;
+} locals = { .size = (size_t)ROMCACHE_SIZE << 20 };
+static pthread_mutex_t cacheMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int romcache_find(const char *game, int type, size_t length) {
+  int ii;
+  for (ii = 0; ii < locals.count; ii++)
+    if (locals.region[ii].type == type && locals.region[ii].length == length && !strcmp(locals.region[ii].game, game))
+      return ii;
+  return -1;
+}
+
+static void romcache_drop(int ii) {
+  close(locals.region[ii].fd);
+  locals.used -= locals.region[ii].length;
+  locals.region[ii] = locals.region[--locals.count];
+}
+
+static void romcache_dropOldest(void) {
+  int ii, oldest = 0;
+  for (ii = 1; ii < locals.count; ii++)
+    if (locals.region[ii].lastUse < locals.region[oldest].lastUse)
+      oldest = ii;
+  romcache_drop(oldest);
+}
+
+static UINT8 *romcache_get(const char *game, int type, size_t length) {
+  void *base = MAP_FAILED;
+  int ii;
+
+  pthread_mutex_lock(&cacheMutex);
+  if ((ii = romcache_find(game, type, length)) >= 0) {
+    base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, locals.region[ii].fd, 0);
+    locals.region[ii].lastUse = ++locals.useCount;
+  }
+  pthread_mutex_unlock(&cacheMutex);
+  return base == MAP_FAILED ? NULL : base;
+}
+
+static void romcache_put(const char *game, int type, const UINT8 *data, size_t length) {
+  size_t done = 0;
+  int fd;
+
+  if (strlen(game) >= sizeof(locals.region[0].game) || length == 0)
+    return;
+  pthread_mutex_lock(&cacheMutex);
+  if (length <= locals.size && romcache_find(game, type, length) < 0 &&
+      (fd = memfd_create("pinmame-rom", MFD_CLOEXEC)) >= 0) {
+    while (done < length) {
+      ssize_t n = write(fd, data + done, length - done);
+      if (n <= 0) break;
+      done += n;
+    }
+    if (done == length) {
+      while (locals.count && (locals.count == ROMCACHE_REGIONS || locals.used + length > locals.size))
+        romcache_dropOldest();
+      strcpy(locals.region[locals.count].game, game);
+      locals.region[locals.count].type = type;
+      locals.region[locals.count].length = length;
+      locals.region[locals.count].fd = fd;
+      locals.region[locals.count].lastUse = ++locals.useCount;
+      locals.count += 1;
+      locals.used += length;
+    }
+    else
+      close(fd);
+  }
+  pthread_mutex_unlock(&cacheMutex);
+}
+
+static void romcache_release(UINT8 *base, size_t length) {
+  munmap(base, length);
+}
+
+static const struct rom_share romCache = { romcache_get, romcache_put, romcache_release };
+
+const struct rom_share *romcache_share(void) {
+  return locals.parent ? locals.parent : &romCache;
+}
+
+void romcache_attach(const struct rom_share *share) {
+  locals.parent = share;
+}
+
+void romcache_setSize(unsigned int megabytes) {
+  pthread_mutex_lock(&cacheMutex);
+  locals.size = (size_t)megabytes << 20;
+  while (locals.count && locals.used > locals.size)
+    romcache_dropOldest();
+  pthread_mutex_unlock(&cacheMutex);
+}
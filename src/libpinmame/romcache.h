@@ -0,0 +1,30 @@
+#ifndef INC_ROMCACHE
+#define INC_ROMCACHE
+#if !defined(__GNUC__) || (__GNUC__ == 3 && __GNUC_MINOR__ >= 4) || (__GNUC__ >= 4)	// GCC supports "pragma once" correctly since 3.4
+#pragma once
+#endif
+
+/*-------------------------------------------------------------------
+/  ROM image cache of libpinmame
+/
+/  Keeps the loaded and post-processed ROM regions of the games that
+/  ran recently in memfds, so starting one of them again, or another
+/  instance of it, maps the images instead of loading the ROMs. Only
+/  regions that loaded without errors or warnings get here, their data
+/  is the one of the ROM list whatever path they came from. The least
+/  recently used images go when the cache is over its size.
+/-------------------------------------------------------------------*/
+#define ROMCACHE_SIZE     64    /* MB, default */
+#define ROMCACHE_REGIONS  64
+
+/*-- the cache to use: this copy's or the one of the copy that
+     created the instance (see romcache_attach) --*/
+const struct rom_share *romcache_share(void);
+
+/*-- an instance uses the cache of its creator --*/
+void romcache_attach(const struct rom_share *share);
+
+/*-- 0 empties the cache and turns it off --*/
+void romcache_setSize(unsigned int megabytes);
+
+#endif /* INC_ROMCACHE */
@@ -23,6 +23,7 @@
  */
 
 #include "driver.h"
+#include "state.h"
 #include "6522via.h"
 
 //#define TRACE_VIA
@@ -165,6 +166,31 @@ void via_set_clock(int which,int clock)
 	via[which].cycles_to_sec = 1.0 / via[which].sec_to_cycles;
 }
 
+/* the timers are not saved (like all timers), the registers are */
+static void via_register(int which)
+{
+	struct via6522 *v = via + which;
+	state_save_register_UINT8("6522via", which, "in_a",    &v->in_a, 1);
+	state_save_register_UINT8("6522via", which, "in_ca1",  &v->in_ca1, 1);
+	state_save_register_UINT8("6522via", which, "in_ca2",  &v->in_ca2, 1);
+	state_save_register_UINT8("6522via", which, "out_a",   &v->out_a, 1);
+	state_save_register_UINT8("6522via", which, "out_ca2", &v->out_ca2, 1);
+	state_save_register_UINT8("6522via", which, "ddr_a",   &v->ddr_a, 1);
+	state_save_register_UINT8("6522via", which, "in_b",    &v->in_b, 1);
+	state_save_register_UINT8("6522via", which, "in_cb1",  &v->in_cb1, 1);
+	state_save_register_UINT8("6522via", which, "in_cb2",  &v->in_cb2, 1);
+	state_save_register_UINT8("6522via", which, "out_b",   &v->out_b, 1);
+	state_save_register_UINT8("6522via", which, "out_cb2", &v->out_cb2, 1);
+	state_save_register_UINT8("6522via", which, "ddr_b",   &v->ddr_b, 1);
+	state_save_register_UINT8("6522via", which, "t1",      &v->t1cl, 4);
+	state_save_register_UINT8("6522via", which, "t2",      &v->t2cl, 4);
+	state_save_register_UINT8("6522via", which, "sr",      &v->sr, 1);
+	state_save_register_UINT8("6522via", which, "pcr",     &v->pcr, 1);
+	state_save_register_UINT8("6522via", which, "acr",     &v->acr, 1);
+	state_save_register_UINT8("6522via", which, "ier",     &v->ier, 1);
+	state_save_register_UINT8("6522via", which, "ifr",     &v->ifr, 1);
+}
+
 void via_config(int which, const struct via6522_interface *intf)
 {
 	if (which >= MAX_VIA) return;
@@ -177,6 +203,7 @@ void via_config(int which, const struct via6522_interface *intf)
 
 	/* Default clock is from CPU1 */
 	via_set_clock (which, Machine->drv->cpu[0].cpu_clock);
+	via_register(which);
 }
 
 
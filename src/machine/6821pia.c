@@ -100,11 +100,17 @@ static void update_6821_interrupts(struct pia6821 *p);
 static void pia_postload(int which)
 {
 	struct pia6821 *p = pia + which;
+	if (!p->intf)
+		return;
 	update_6821_interrupts(p);
+#ifndef PINMAME
+	/* (in PinMAME the outputs fire solenoids and sound commands, */
+	/*  the receiving side saves its own state instead) */
 	if (p->intf->out_a_func && p->ddr_a) p->intf->out_a_func(0, p->out_a & p->ddr_a);
 	if (p->intf->out_b_func && p->ddr_b) p->intf->out_b_func(0, p->out_b & p->ddr_b);
 	if (p->intf->out_ca2_func) p->intf->out_ca2_func(0, p->out_ca2);
 	if (p->intf->out_cb2_func) p->intf->out_cb2_func(0, p->out_cb2);
+#endif
 }
 
 static void pia_postload_0(void)
@@ -159,32 +165,35 @@ static void (*pia_postload_funcs[MAX_PIA])(void) =
 	pia_postload_7
 };
 
+static void pia_register(int i)
+{
+	state_save_register_UINT8("6821pia", i, "in_a",		&pia[i].in_a, 1);
+	state_save_register_UINT8("6821pia", i, "in_ca1",	&pia[i].in_ca1, 1);
+	state_save_register_UINT8("6821pia", i, "in_ca2",	&pia[i].in_ca2, 1);
+	state_save_register_UINT8("6821pia", i, "out_a",	&pia[i].out_a, 1);
+	state_save_register_UINT8("6821pia", i, "out_ca2",	&pia[i].out_ca2, 1);
+	state_save_register_UINT8("6821pia", i, "ddr_a",	&pia[i].ddr_a, 1);
+	state_save_register_UINT8("6821pia", i, "ctl_a",	&pia[i].ctl_a, 1);
+	state_save_register_UINT8("6821pia", i, "irq_a1",	&pia[i].irq_a1, 1);
+	state_save_register_UINT8("6821pia", i, "irq_a2",	&pia[i].irq_a2, 1);
+	state_save_register_UINT8("6821pia", i, "in_b",		&pia[i].in_b, 1);
+	state_save_register_UINT8("6821pia", i, "in_cb1",	&pia[i].in_cb1, 1);
+	state_save_register_UINT8("6821pia", i, "in_cb2",	&pia[i].in_cb2, 1);
+	state_save_register_UINT8("6821pia", i, "out_b",	&pia[i].out_b, 1);
+	state_save_register_UINT8("6821pia", i, "out_cb2",	&pia[i].out_cb2, 1);
+	state_save_register_UINT8("6821pia", i, "ddr_b",	&pia[i].ddr_b, 1);
+	state_save_register_UINT8("6821pia", i, "ctl_b",	&pia[i].ctl_b, 1);
+	state_save_register_UINT8("6821pia", i, "irq_b1",	&pia[i].irq_b1, 1);
+	state_save_register_UINT8("6821pia", i, "irq_b2",	&pia[i].irq_b2, 1);
+	state_save_register_UINT8("6821pia", i, "in_set",	&pia[i].in_set, 1);
+	state_save_register_func_postload(pia_postload_funcs[i]);
+}
+
 void pia_init(int count)
 {
 	int i;
 	for (i = 0; i < count; i++)
-	{
-		state_save_register_UINT8("6821pia", i, "in_a",		&pia[i].in_a, 1);
-		state_save_register_UINT8("6821pia", i, "in_ca1",	&pia[i].in_ca1, 1);
-		state_save_register_UINT8("6821pia", i, "in_ca2",	&pia[i].in_ca2, 1);
-		state_save_register_UINT8("6821pia", i, "out_a",	&pia[i].out_a, 1);
-		state_save_register_UINT8("6821pia", i, "out_ca2",	&pia[i].out_ca2, 1);
-		state_save_register_UINT8("6821pia", i, "ddr_a",	&pia[i].ddr_a, 1);
-		state_save_register_UINT8("6821pia", i, "ctl_a",	&pia[i].ctl_a, 1);
-		state_save_register_UINT8("6821pia", i, "irq_a1",	&pia[i].irq_a1, 1);
-		state_save_register_UINT8("6821pia", i, "irq_a2",	&pia[i].irq_a2, 1);
-		state_save_register_UINT8("6821pia", i, "in_b",		&pia[i].in_b, 1);
-		state_save_register_UINT8("6821pia", i, "in_cb1",	&pia[i].in_cb1, 1);
-		state_save_register_UINT8("6821pia", i, "in_cb2",	&pia[i].in_cb2, 1);
-		state_save_register_UINT8("6821pia", i, "out_b",	&pia[i].out_b, 1);
-		state_save_register_UINT8("6821pia", i, "out_cb2",	&pia[i].out_cb2, 1);
-		state_save_register_UINT8("6821pia", i, "ddr_b",	&pia[i].ddr_b, 1);
-		state_save_register_UINT8("6821pia", i, "ctl_b",	&pia[i].ctl_b, 1);
-		state_save_register_UINT8("6821pia", i, "irq_b1",	&pia[i].irq_b1, 1);
-		state_save_register_UINT8("6821pia", i, "irq_b2",	&pia[i].irq_b2, 1);
-		state_save_register_UINT8("6821pia", i, "in_set",	&pia[i].in_set, 1);
-		state_save_register_func_postload(pia_postload_funcs[i]);
-	}
+		pia_register(i);
 }
 
 /******************* un-configuration *******************/
@@ -220,6 +229,7 @@ void pia_config(int which, int addressing, const struct pia6821_interface *intf)
 		{ pia[which].in_cb1 = ((FPTR)(intf->in_cb1_func) - 1); pia[which].in_set |= PIA_IN_SET_CB1; }
 	if ((intf->in_cb2_func) && ((FPTR)(intf->in_cb2_func) <= 0x100))
 		{ pia[which].in_cb2 = ((FPTR)(intf->in_cb2_func) - 1); pia[which].in_set |= PIA_IN_SET_CB2; }
+	pia_register(which);
 }
 
 
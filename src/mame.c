@@ -578,7 +578,10 @@ void run_machine_core(void)
 				}
 
 				/* run the emulation! */
+				if (options.hprof && *options.hprof && !hprof_start(options.hprof))
+					printf("hprof: not enough memory to profile\n");
 				cpu_run();
+				hprof_stop();
 
 				/* save the NVRAM */
 				if (Machine->drv->nvram_handler)
@@ -1179,8 +1182,10 @@ void force_partial_update(int scanline)
 	if (clip.min_y <= clip.max_y)
 	{
 		profiler_mark(PROFILER_VIDEO);
+		hprof_begin(HPROF_NAMED, "video update", 0);
 		(*Machine->drv->video_update)(Machine->scrbitmap, &clip);
 		performance.partial_updates_this_frame++;
+		hprof_end();
 		profiler_mark(PROFILER_END);
 	}
 
@@ -1215,7 +1220,8 @@ void draw_screen(void)
 
 void update_video_and_audio(void)
 {
-	int skipped_it = osd_skip_this_frame();
+	/* nothing is shown while warping */
+	int skipped_it = osd_skip_this_frame() || cpu_warping();
 
 #ifdef MAME_DEBUG
 	debug_trace_delay = 0;
@@ -1339,7 +1345,7 @@ int updatescreen(void)
 	sound_update();
 
 	/* if we're not skipping this frame, draw the screen */
-	if (osd_skip_this_frame() == 0)
+	if (cpu_warping() ? cpu_warp_drawframe() : osd_skip_this_frame() == 0)
 	{
 		profiler_mark(PROFILER_VIDEO);
 		draw_screen();
@@ -1354,7 +1360,9 @@ int updatescreen(void)
 		return 1;
 
 	/* blit to the screen */
+	hprof_begin(HPROF_NAMED, "osd update", 0);
 	update_video_and_audio();
+	hprof_end();
 
 	/* call the end-of-frame callback */
 	if (Machine->drv->video_eof)
@@ -205,6 +205,7 @@ struct GameOptions
 
 	int		samplerate;		/* sound sample playback rate, in Hz */
 	int		use_samples;	/* 1 to enable external .wav samples */
+	int		audio_block;	/* mix and output the sound in blocks of this many samples, 0 = once per frame */
 	//int		use_filter;		/* 1 to enable FIR filter on final mixer output */
 
 	float	brightness;		/* brightness of the display */
@@ -227,6 +228,7 @@ struct GameOptions
 
 	char	savegame;		/* character representing a savegame to load */
 	int     crc_only;       /* specify if only CRC should be used as checksum */
+	int		hash_cache;		/* 1 to remember the checksums of unchanged ROM files (romhash.cfg) */
 	char *	bios;			/* specify system bios (if used), 0 is default */
 
 	int		debug_width;	/* requested width of debugger bitmap */
@@ -235,6 +237,12 @@ struct GameOptions
 
 	int		at91jit;
 	int		usemodsol; 
+	float	warp;			/* seconds of emulated time to fast forward after a reset (0 = off) */
+	int		bootsnapshot;	/* 1 to start from a snapshot taken at the end of the first warp */
+	int		rewind;			/* MB of recent save states to keep in memory (0 = off) */
+	int		rewind_interval;	/* frames between two rewind states */
+	int		idleskip;		/* skip the timeslices the CPUs spend in idle loops */
+	char *	hprof;			/* write a profile (hprof.h) of the run to this file */
 
 	#ifdef MESS
 	UINT32 ram;
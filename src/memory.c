@@ -19,6 +19,7 @@
 #include "driver.h"
 #include "osd_cpu.h"
 #include "state.h"
+#include "mtlock.h"
 
 #include <stdarg.h>
 
@@ -59,6 +60,10 @@
 #define MEMWRITESTART			profiler_mark(PROFILER_MEMWRITE);
 #define MEMWRITEEND(ret)		{ (ret); profiler_mark(PROFILER_END); return; }
 
+/* macros for the handler calls, with a scope of the hierarchical profiler */
+#define MEMREADHANDLER(h,base,ret)	{ data32_t result; if (hprof_active) { hprof__begin(HPROF_MEMREAD, (const void *)(h), base); result = (ret); hprof__end(); } else result = (ret); MEMREADEND(result) }
+#define MEMWRITEHANDLER(h,base,ret)	{ if (hprof_active) { hprof__begin(HPROF_MEMWRITE, (const void *)(h), base); (ret); hprof__end(); } else (ret); profiler_mark(PROFILER_END); return; }
+
 #define DATABITS_TO_SHIFT(d)	(((d) == 32) ? 2 : ((d) == 16) ? 1 : 0)
 
 /* helper macros */
@@ -84,6 +89,8 @@ struct bank_data
 	offs_t 				base;				/* the base offset */
 	offs_t				readoffset;			/* original base offset for reads */
 	offs_t				writeoffset;		/* original base offset for writes */
+	int					firstpage;			/* pages that may map the bank, */
+	int					endpage;			/* first and one past the last */
 };
 
 struct handler_data
@@ -126,6 +133,24 @@ struct cpu_data
 
 	struct memport_data	mem;				/* memory tables */
 	struct memport_data	port;				/* port tables */
+
+	int					has_pages;			/* 8-bit data, 16-bit addresses: page pointers below */
+	UINT8 *				read_page[MEM_PAGE_COUNT];	/* direct read pointers, NULL calls the handler */
+	UINT8 *				write_page[MEM_PAGE_COUNT];	/* direct write pointers, NULL calls the handler */
+	UINT8				read_page_entry[MEM_PAGE_COUNT];	/* read handler of the whole page, 0 if mixed */
+	UINT8				write_page_entry[MEM_PAGE_COUNT];	/* write handler of the whole page, 0 if mixed */
+#ifdef MEM_PAGE_STATS
+	UINT64				page_hits;			/* accesses through the page pointers */
+	UINT64				page_misses;		/* accesses through the handlers */
+#endif
+};
+
+struct watch_data
+{
+	mem_watch_handler	handler;			/* callback, NULL if unused */
+	void *				param;				/* parameter of the callback */
+	offs_t				offset;				/* offset in the tracked region */
+	data8_t				data;				/* value at the last callback */
 };
 
 struct memory_address_table
@@ -156,6 +181,23 @@ static UINT8 *				writeport_lookup;				/* port write lookup table */
 offs_t						mem_amask;						/* memory address mask */
 static offs_t				port_amask;						/* port address mask */
 
+UINT8 **					mem_read_page;					/* direct read pointers of the pages */
+UINT8 **					mem_write_page;					/* direct write pointers of the pages */
+#ifdef MEM_PAGE_STATS
+UINT64						mem_page_hits;					/* accesses through the page pointers */
+UINT64						mem_page_misses;				/* accesses through the handlers */
+#endif
+static UINT8 *				no_pages[MEM_PAGE_COUNT];		/* for the CPUs without page pointers */
+static int					pages_off;						/* every access goes to the handlers */
+
+UINT8 *						mem_track_base;					/* region of the write tracking */
+size_t						mem_track_length;				/* length of the tracked region */
+static UINT8 *				track_dirty;					/* one flag per page, set by writes */
+static UINT8 *				track_watched;					/* one flag per page with watched bytes */
+static UINT8 *				track_shadow;					/* contents at the last memory_track_changes */
+static struct watch_data	watches[MAX_MEM_WATCHES];		/* watched bytes of the tracked region */
+MTLOCK(track_lock);											/* the host collects the changes in its thread */
+
 UINT8 *						cpu_bankbase[STATIC_COUNT];		/* array of bank bases */
 #ifdef PINMAME
 /* Bank support for CODELIST */
@@ -213,6 +255,8 @@ static int allocate_memory(void);
 static int populate_memory(void);
 static int populate_ports(void);
 static void register_banks(void);
+static void update_pages(int cpunum, offs_t start, offs_t end);
+static void set_pages(void);
 static int mem_address_bits_of_cpu(int cpunum);
 static int port_address_bits_of_cpu(int cpunum);
 static int init_static(void);
@@ -239,6 +283,7 @@ int memory_init(void)
 	/* no current context to start */
 	cur_context = -1;
 	unmap_value = 0;
+	set_pages();
 
 	/* init the static handlers */
 	if (!init_static())
@@ -285,6 +330,22 @@ void memory_shutdown(void)
 	int ext_entry;
 	int cpunum;
 
+#ifdef MEM_PAGE_STATS
+	/* report how many accesses the page pointers took */
+	if (cur_context != -1)
+	{
+		cpudata[cur_context].page_hits = mem_page_hits;
+		cpudata[cur_context].page_misses = mem_page_misses;
+	}
+	for (cpunum = 0; cpunum < MAX_CPU; cpunum++)
+	{
+		UINT64 total = cpudata[cpunum].page_hits + cpudata[cpunum].page_misses;
+		if (cpudata[cpunum].has_pages && total)
+			logerror("%s: cpu #%d: %.1f%% of %.0f memory accesses through the page pointers\n",
+					Machine->gamedrv->name, cpunum, 100.0 * (double)cpudata[cpunum].page_hits / (double)total, (double)total);
+	}
+#endif
+
 	/* free all the tables */
 	for (cpunum = 0; cpunum < MAX_CPU; cpunum++ )
 	{
@@ -298,6 +359,12 @@ void memory_shutdown(void)
 			free(cpudata[cpunum].port.write.table);
 	}
 	memset(&cpudata, 0, sizeof(cpudata));
+	cur_context = -1;
+	set_pages();
+
+	/* stop the write tracking */
+	memory_track_region(NULL, 0);
+	memset(watches, 0, sizeof(watches));
 
 	/* free all the external memory */
 	ext = ext_memory;
@@ -354,6 +421,10 @@ void memory_set_context(int activecpu)
 		cpudata[cur_context].op_mem_min = OP_MEM_MIN;
 		cpudata[cur_context].op_mem_max = OP_MEM_MAX;
 		cpudata[cur_context].opcode_entry = opcode_entry;
+#ifdef MEM_PAGE_STATS
+		cpudata[cur_context].page_hits = mem_page_hits;
+		cpudata[cur_context].page_misses = mem_page_misses;
+#endif
 	}
 	cur_context = activecpu;
 
@@ -373,6 +444,25 @@ void memory_set_context(int activecpu)
 	port_amask = cpudata[activecpu].port.mask;
 
 	opbasefunc = cpudata[activecpu].opbase;
+
+	set_pages();
+#ifdef MEM_PAGE_STATS
+	mem_page_hits = cpudata[activecpu].page_hits;
+	mem_page_misses = cpudata[activecpu].page_misses;
+#endif
+}
+
+
+/*-------------------------------------------------
+	memory_use_pages - turn the page pointers
+	off or on again; while off, every access
+	reaches the handlers
+-------------------------------------------------*/
+
+void memory_use_pages(int use)
+{
+	pages_off = !use;
+	set_pages();
 }
 
 
@@ -406,6 +496,7 @@ void memory_set_bankhandler_r(int bank, offs_t offset, mem_read_handler handler)
 	if (HANDLER_IS_STATIC(handler))
 		handler = rmemhandler8s[(FPTR)handler];
 	rmemhandler8[bank].handler = (genf *)handler;
+	memory_update_bank_pages(bank);
 }
 
 
@@ -428,6 +519,7 @@ void memory_set_bankhandler_w(int bank, offs_t offset, mem_write_handler handler
 	if (HANDLER_IS_STATIC(handler))
 		handler = wmemhandler8s[(FPTR)handler];
 	wmemhandler8[bank].handler = (genf *)handler;
+	memory_update_bank_pages(bank);
 }
 
 
@@ -825,6 +917,213 @@ void *memory_get_write_ptr(int cpunum, offs_t offset)
 }
 
 
+/*-------------------------------------------------
+	track_postload - a state was loaded behind
+	the back of the drivers, look at everything
+-------------------------------------------------*/
+
+static void track_postload(void)
+{
+	memory_track_mark(0, mem_track_length);
+}
+
+
+/*-------------------------------------------------
+	memory_track_region - start tracking the
+	writes to a region (NULL stops)
+-------------------------------------------------*/
+
+int memory_track_region(void *base, size_t length)
+{
+	size_t pages = (length + MEM_PAGE_MASK) >> MEM_PAGE_BITS;
+	int i;
+
+	/* forget the previous one */
+	mtlock_enter(&track_lock);
+	mem_track_base = NULL;
+	mem_track_length = 0;
+	free(track_dirty);
+	free(track_watched);
+	free(track_shadow);
+	track_dirty = track_watched = track_shadow = NULL;
+	if (!base || !length)
+	{
+		mtlock_leave(&track_lock);
+		return 1;
+	}
+
+	track_dirty = malloc(pages);
+	track_watched = calloc(pages, 1);
+	track_shadow = malloc(length);
+	if (!track_dirty || !track_watched || !track_shadow)
+	{
+		free(track_dirty);
+		free(track_watched);
+		free(track_shadow);
+		track_dirty = track_watched = track_shadow = NULL;
+		mtlock_leave(&track_lock);
+		return 0;
+	}
+
+	/* the driver may have changed it before it was tracked: */
+	/* everything is compared at the first memory_track_changes */
+	memcpy(track_shadow, base, length);
+	memset(track_dirty, 1, pages);
+	for (i = 0; i < MAX_MEM_WATCHES; i++)
+		if (watches[i].handler && watches[i].offset < length)
+		{
+			watches[i].data = ((UINT8 *)base)[watches[i].offset];
+			track_watched[watches[i].offset >> MEM_PAGE_BITS] = 1;
+		}
+	state_save_register_func_postload(track_postload);
+
+	mem_track_base = base;
+	mem_track_length = length;
+	mtlock_leave(&track_lock);
+	return 1;
+}
+
+
+/*-------------------------------------------------
+	memory_track_mark - bytes of the tracked
+	region were written
+-------------------------------------------------*/
+
+void memory_track_mark(size_t offset, size_t length)
+{
+	size_t first = offset >> MEM_PAGE_BITS, page;
+	size_t last;
+	int watched = 0;
+	int i;
+
+	if (offset >= mem_track_length || !length)
+		return;
+	if (length > mem_track_length - offset)
+		length = mem_track_length - offset;
+	last = (offset + length - 1) >> MEM_PAGE_BITS;
+
+	/* under the lock: the written bytes are visible to memory_track_changes
+	   before the flag is, and a flag it clears isn't lost */
+	mtlock_enter(&track_lock);
+	for (page = first; page <= last; page++)
+	{
+		track_dirty[page] = 1;
+		watched |= track_watched[page];
+	}
+	mtlock_leave(&track_lock);
+
+	/* tell the watchers about the bytes that changed */
+	if (watched)
+		for (i = 0; i < MAX_MEM_WATCHES; i++)
+		{
+			struct watch_data *watch = &watches[i];
+			if (watch->handler && watch->offset >= offset && watch->offset < offset + length &&
+				mem_track_base[watch->offset] != watch->data)
+			{
+				data8_t olddata = watch->data;
+				watch->data = mem_track_base[watch->offset];
+				(*watch->handler)(watch->offset, olddata, watch->data, watch->param);
+			}
+		}
+}
+
+
+/*-------------------------------------------------
+	memory_track_changes - the bytes of the
+	tracked region that changed since the last
+	call, -1 if nothing is tracked
+-------------------------------------------------*/
+
+int memory_track_changes(struct mem_change *changes, int max)
+{
+	size_t pages, page;
+	int count = 0;
+
+	mtlock_enter(&track_lock);
+	if (!mem_track_base)
+	{
+		mtlock_leave(&track_lock);
+		return -1;
+	}
+	pages = (mem_track_length + MEM_PAGE_MASK) >> MEM_PAGE_BITS;
+
+	for (page = 0; page < pages; page++)
+	{
+		size_t offset = page << MEM_PAGE_BITS;
+		size_t end = offset + MEM_PAGE_MASK + 1;
+
+		if (!track_dirty[page])
+			continue;
+
+		/* clear first: a write from now on shows at the next call */
+		track_dirty[page] = 0;
+		if (end > mem_track_length)
+			end = mem_track_length;
+		for ( ; offset < end; offset++)
+		{
+			data8_t data = mem_track_base[offset];
+			if (data == track_shadow[offset])
+				continue;
+			if (count == max)
+			{
+				/* the rest of this page is for the next call */
+				track_dirty[page] = 1;
+				mtlock_leave(&track_lock);
+				return count;
+			}
+			changes[count].offset = offset;
+			changes[count].olddata = track_shadow[offset];
+			changes[count].newdata = data;
+			track_shadow[offset] = data;
+			count++;
+		}
+	}
+	mtlock_leave(&track_lock);
+	return count;
+}
+
+
+/*-------------------------------------------------
+	memory_watch - call a handler when a byte of
+	the tracked region changes, returns the
+	watch for memory_unwatch or -1
+-------------------------------------------------*/
+
+int memory_watch(offs_t offset, mem_watch_handler handler, void *param)
+{
+	int i;
+
+	mtlock_enter(&track_lock);
+	for (i = 0; i < MAX_MEM_WATCHES; i++)
+		if (!watches[i].handler)
+		{
+			watches[i].handler = handler;
+			watches[i].param = param;
+			watches[i].offset = offset;
+			if (offset < mem_track_length)
+			{
+				watches[i].data = mem_track_base[offset];
+				track_watched[offset >> MEM_PAGE_BITS] = 1;
+			}
+			mtlock_leave(&track_lock);
+			return i;
+		}
+	mtlock_leave(&track_lock);
+	return -1;
+}
+
+
+/*-------------------------------------------------
+	memory_unwatch - remove a watch
+-------------------------------------------------*/
+
+void memory_unwatch(int watch)
+{
+	if (watch >= 0 && watch < MAX_MEM_WATCHES)
+		watches[watch].handler = NULL;
+}
+
+
 /*-------------------------------------------------
 	get_handler_index - finds the index of a
 	handler, or allocates a new one as necessary
@@ -1031,6 +1330,7 @@ void install_mem_handler(struct memport_data *memport, int iswrite, offs_t start
 	/* set the handler */
 	idx = get_handler_index(tabledata->handlers, handler, start);
 	populate_table(memport, iswrite, start, end, idx);
+	update_pages(memport->cpunum, start, end);
 
 	/* if this is a bank, set the bankbase as well */
 	if (HANDLER_IS_BANK(handler))
@@ -1040,6 +1340,7 @@ void install_mem_handler(struct memport_data *memport, int iswrite, offs_t start
 /* Bank support for CODELIST */
 		cpu_bankid[HANDLER_TO_BANK(handler)] = FAKE_BANKID;
 #endif /* PINMAME */
+		memory_update_bank_pages(HANDLER_TO_BANK(handler));
 	}
 }
 
@@ -1057,6 +1358,135 @@ void install_port_handler(struct memport_data *memport, int iswrite, offs_t star
 }
 
 
+/*-------------------------------------------------
+	page_entry - the handler of a whole page, 0
+	if parts of it have different ones
+-------------------------------------------------*/
+
+static UINT8 page_entry(const struct memport_data *memport, const struct table_data *tabledata, int page)
+{
+	int l2bits = LEVEL2_BITS(memport->ebits);
+	offs_t l1start = (page << MEM_PAGE_BITS) >> l2bits;
+	offs_t l1count = 1 << (MEM_PAGE_BITS - l2bits);
+	UINT8 entry = tabledata->table[l1start];
+	offs_t i;
+
+	if (entry >= SUBTABLE_BASE)
+		return 0;
+	for (i = 1; i < l1count; i++)
+		if (tabledata->table[l1start + i] != entry)
+			return 0;
+	return entry;
+}
+
+
+/*-------------------------------------------------
+	page_pointer - the host memory of a page,
+	NULL if its accesses need the handler
+-------------------------------------------------*/
+
+static UINT8 *page_pointer(int cpunum, int iswrite, UINT8 entry, int page)
+{
+	offs_t start = page << MEM_PAGE_BITS;
+
+	if (entry == STATIC_RAM)
+		return (UINT8 *)cpudata[cpunum].rambase + start;
+
+	/* banks, unless memory_set_bankhandler_r/w put another handler there */
+	if (entry >= STATIC_BANK1 && entry <= STATIC_BANKMAX && cpu_bankbase[entry])
+	{
+		if (!iswrite && rmemhandler8[entry].handler == (genf *)rmemhandler8s[entry])
+			return cpu_bankbase[entry] + (start - rmemhandler8[entry].offset);
+		if (iswrite && wmemhandler8[entry].handler == (genf *)wmemhandler8s[entry])
+			return cpu_bankbase[entry] + (start - wmemhandler8[entry].offset);
+	}
+	return NULL;
+}
+
+
+/*-------------------------------------------------
+	update_pages - recompute the page pointers
+	of a range of addresses
+-------------------------------------------------*/
+
+static void update_pages(int cpunum, offs_t start, offs_t end)
+{
+	struct cpu_data *cpu = &cpudata[cpunum];
+	int page, i;
+
+	if (!cpu->has_pages || start > 0xffff)
+		return;
+	if (end > 0xffff)
+		end = 0xffff;
+
+	for (page = start >> MEM_PAGE_BITS; page <= (int)(end >> MEM_PAGE_BITS); page++)
+	{
+		cpu->read_page_entry[page] = page_entry(&cpu->mem, &cpu->mem.read, page);
+		cpu->write_page_entry[page] = page_entry(&cpu->mem, &cpu->mem.write, page);
+		cpu->read_page[page] = page_pointer(cpunum, 0, cpu->read_page_entry[page], page);
+		cpu->write_page[page] = page_pointer(cpunum, 1, cpu->write_page_entry[page], page);
+
+		/* remember where the banks are, for memory_update_bank_pages */
+		for (i = 0; i < 2; i++)
+		{
+			UINT8 entry = i ? cpu->write_page_entry[page] : cpu->read_page_entry[page];
+			struct bank_data *bank = &bankdata[entry];
+			if (entry < STATIC_BANK1 || entry > STATIC_BANKMAX)
+				continue;
+			if (bank->firstpage == bank->endpage)
+				bank->firstpage = page, bank->endpage = page + 1;
+			else if (page < bank->firstpage)
+				bank->firstpage = page;
+			else if (page >= bank->endpage)
+				bank->endpage = page + 1;
+		}
+	}
+}
+
+
+/*-------------------------------------------------
+	memory_update_bank_pages - recompute the page
+	pointers into a bank, its base or handler
+	changed
+-------------------------------------------------*/
+
+void memory_update_bank_pages(int bank)
+{
+	int cpunum, page;
+
+	for (cpunum = 0; cpunum < MAX_CPU; cpunum++)
+	{
+		struct cpu_data *cpu = &cpudata[cpunum];
+		if (!cpu->has_pages)
+			continue;
+		for (page = bankdata[bank].firstpage; page < bankdata[bank].endpage; page++)
+		{
+			if (cpu->read_page_entry[page] == bank)
+				cpu->read_page[page] = page_pointer(cpunum, 0, bank, page);
+			if (cpu->write_page_entry[page] == bank)
+				cpu->write_page[page] = page_pointer(cpunum, 1, bank, page);
+		}
+	}
+}
+
+
+/*-------------------------------------------------
+	set_pages - point mem_read/write_page to the
+	page pointers of the active CPU
+-------------------------------------------------*/
+
+static void set_pages(void)
+{
+	if (cur_context != -1 && cpudata[cur_context].has_pages && !pages_off)
+	{
+		mem_read_page = cpudata[cur_context].read_page;
+		mem_write_page = cpudata[cur_context].write_page;
+	}
+	else
+		mem_read_page = mem_write_page = no_pages;
+}
+
+
 /*-------------------------------------------------
 	set_static_handler - handy shortcut for
 	setting all 6 handlers for a given index
@@ -1119,6 +1549,12 @@ static int init_cpudata(void)
 		if (!init_memport(cpunum, &cpudata[cpunum].port, port_address_bits_of_cpu(cputype), cpunum_databus_width(cpunum), 0))
 			return 0;
 
+		/* 8-bit CPUs with 16-bit addresses get page pointers, unless */
+		/* the debugger needs to see every access */
+#if !(defined(PINMAME) && defined(DBG_BPR) && defined(MAME_DEBUG))
+		cpudata[cpunum].has_pages = (cpudata[cpunum].mem.abits == 16 && cpudata[cpunum].mem.dbits == 8);
+#endif
+
 #if HAS_Z80
 		/* Z80 port mask kludge */
 		if (cputype == CPU_Z80)
@@ -1668,11 +2104,13 @@ void register_banks(void)
 	int cpunum, i;
 	int banksize[MAX_BANKS];
 	int bankcpu[MAX_BANKS];
+	int bankwrite[MAX_BANKS];
 
 	for (i=0; i<MAX_BANKS; i++)
 	{
 		banksize[i] = 0;
 		bankcpu[i] = -1;
+		bankwrite[i] = 0;
 	}
 
 	/* loop over CPUs */
@@ -1752,6 +2190,7 @@ void register_banks(void)
 						if (banksize[HANDLER_TO_BANK(h)] < size)
 							banksize[HANDLER_TO_BANK(h)] = size;
 						bankcpu[HANDLER_TO_BANK(h)] = cpunum;
+						bankwrite[HANDLER_TO_BANK(h)] = 1;
 						mode = RG_DROP_WRITE;;
 					}
 					else
@@ -1794,8 +2233,9 @@ void register_banks(void)
 		rg_map_clear();
 	}
 
+	/* banks that are only read are ROM pages, nothing to save there */
 	for (i=0; i<MAX_BANKS; i++)
-		if (banksize[i])
+		if (banksize[i] && bankwrite[i])
 			switch (cpunum_databus_width(bankcpu[i]))
 			{
 			case 8:
@@ -1820,6 +2260,28 @@ extern void bpr_memref(UINT32 adr, int length);
 #define bpr_memref(a,l)
 #endif
 
+/* the idle loop probe of cpuexec.c watches what an 8-bit CPU reads and writes */
+#define IDLE_READ(address,entry,handlist)												\
+	if (cpu_idle_probe) cpu_idle_read(address, idle_read_ptr(address, entry, handlist));
+#define IDLE_WRITE(address)																\
+	if (cpu_idle_probe) cpu_idle_write(address);
+
+/*-------------------------------------------------
+	idle_read_ptr - the byte an 8-bit read gets,
+	NULL for constants, IDLE_IO for a handler
+-------------------------------------------------*/
+
+static UINT8 *idle_read_ptr(offs_t address, UINT8 entry, const struct handler_data *handlist)
+{
+	if (entry == STATIC_RAM)
+		return &cpu_bankbase[STATIC_RAM][address];
+	if (entry >= STATIC_BANK1 && entry <= STATIC_BANKMAX)
+		return &cpu_bankbase[entry][address - handlist[entry].offset];
+	if (entry == STATIC_NOP || entry == STATIC_UNMAP)
+		return NULL;
+	return IDLE_IO;
+}
+
 #define READBYTE8(name,abits,lookup,handlist,mask)										\
 data8_t name(offs_t address)															\
 {																						\
@@ -1831,6 +2293,7 @@ data8_t name(offs_t address)															\
 	entry = lookup[LEVEL1_INDEX(address,abits,0)];										\
 	if (entry >= SUBTABLE_BASE)															\
 		entry = lookup[LEVEL2_INDEX(entry,address,abits,0)];							\
+	IDLE_READ(address,entry,handlist)													\
 																						\
 	/* for compatibility with setbankhandler, 8-bit systems */							\
 	/* must call handlers for banks */													\
@@ -1841,7 +2304,7 @@ data8_t name(offs_t address)															\
 	else																				\
 	{																					\
 		read8_handler handler = (read8_handler)handlist[entry].handler;					\
-		MEMREADEND((*handler)(address - handlist[entry].offset))						\
+		MEMREADHANDLER(handler, handlist[entry].offset, (*handler)(address - handlist[entry].offset))						\
 	}																					\
 	return 0;																			\
 }																						\
@@ -1868,7 +2331,7 @@ data8_t name(offs_t address)															\
 	{																					\
 		int shift = 8 * (~address & 1);													\
 		read16_handler handler = (read16_handler)handlist[entry].handler;				\
-		MEMREADEND((*handler)(address >> 1, ~(0xff << shift)) >> shift)					\
+		MEMREADHANDLER(handler, handlist[entry].offset, (*handler)(address >> 1, ~(0xff << shift)) >> shift)					\
 	}																					\
 	return 0;																			\
 }																						\
@@ -1895,7 +2358,7 @@ data8_t name(offs_t address)															\
 	{																					\
 		int shift = 8 * (address & 1);													\
 		read16_handler handler = (read16_handler)handlist[entry].handler;				\
-		MEMREADEND((*handler)(address >> 1, ~(0xff << shift)) >> shift)					\
+		MEMREADHANDLER(handler, handlist[entry].offset, (*handler)(address >> 1, ~(0xff << shift)) >> shift)					\
 	}																					\
 	return 0;																			\
 }																						\
@@ -1922,7 +2385,7 @@ data8_t name(offs_t address)															\
 	{																					\
 		int shift = 8 * (~address & 3);													\
 		read32_handler handler = (read32_handler)handlist[entry].handler;				\
-		MEMREADEND((*handler)(address >> 2, ~(0xff << shift)) >> shift) 				\
+		MEMREADHANDLER(handler, handlist[entry].offset, (*handler)(address >> 2, ~(0xff << shift)) >> shift) 				\
 	}																					\
 	return 0;																			\
 }																						\
@@ -1949,7 +2412,7 @@ data8_t name(offs_t address)															\
 	{																					\
 		int shift = 8 * (address & 3);													\
 		read32_handler handler = (read32_handler)handlist[entry].handler;				\
-		MEMREADEND((*handler)(address >> 2, ~(0xff << shift)) >> shift) 				\
+		MEMREADHANDLER(handler, handlist[entry].offset, (*handler)(address >> 2, ~(0xff << shift)) >> shift) 				\
 	}																					\
 	return 0;																			\
 }																						\
@@ -1981,7 +2444,7 @@ data16_t name(offs_t address)															\
 	else																				\
 	{																					\
 		read16_handler handler = (read16_handler)handlist[entry].handler;				\
-		MEMREADEND((*handler)(address >> 1,0))										 	\
+		MEMREADHANDLER(handler, handlist[entry].offset, (*handler)(address >> 1,0))										 	\
 	}																					\
 	return 0;																			\
 }																						\
@@ -2008,7 +2471,7 @@ data16_t name(offs_t address)															\
 	{																					\
 		int shift = 8 * (~address & 2);													\
 		read32_handler handler = (read32_handler)handlist[entry].handler;				\
-		MEMREADEND((*handler)(address >> 2, ~(0xffff << shift)) >> shift)				\
+		MEMREADHANDLER(handler, handlist[entry].offset, (*handler)(address >> 2, ~(0xffff << shift)) >> shift)				\
 	}																					\
 	return 0;																			\
 }																						\
@@ -2035,7 +2498,7 @@ data16_t name(offs_t address)															\
 	{																					\
 		int shift = 8 * (address & 2);													\
 		read32_handler handler = (read32_handler)handlist[entry].handler;				\
-		MEMREADEND((*handler)(address >> 2, ~(0xffff << shift)) >> shift)				\
+		MEMREADHANDLER(handler, handlist[entry].offset, (*handler)(address >> 2, ~(0xffff << shift)) >> shift)				\
 	}																					\
 	return 0;																			\
 }																						\
@@ -2067,7 +2530,7 @@ data32_t name(offs_t address)															\
 	else																				\
 	{																					\
 		read32_handler handler = (read32_handler)handlist[entry].handler;				\
-		MEMREADEND((*handler)(address >> 2,0))										 	\
+		MEMREADHANDLER(handler, handlist[entry].offset, (*handler)(address >> 2,0))										 	\
 	}																					\
 	return 0;																			\
 }																						\
@@ -2082,6 +2545,7 @@ void name(offs_t address, data8_t data)													\
 {																						\
 	UINT8 entry;																		\
 	MEMWRITESTART																		\
+	IDLE_WRITE(address)																	\
 																						\
 	/* perform lookup */																\
 	address &= mask;bpr_memref(address,1);																	\
@@ -2098,7 +2562,7 @@ void name(offs_t address, data8_t data)													\
 	else																				\
 	{																					\
 		write8_handler handler = (write8_handler)handlist[entry].handler;				\
-		MEMWRITEEND((*handler)(address - handlist[entry].offset, data))					\
+		MEMWRITEHANDLER(handler, handlist[entry].offset, (*handler)(address - handlist[entry].offset, data))					\
 	}																					\
 }																						\
 
@@ -2124,7 +2588,7 @@ void name(offs_t address, data8_t data)													\
 	{																					\
 		int shift = 8 * (~address & 1);													\
 		write16_handler handler = (write16_handler)handlist[entry].handler;				\
-		MEMWRITEEND((*handler)(address >> 1, data << shift, ~(0xff << shift))) 			\
+		MEMWRITEHANDLER(handler, handlist[entry].offset, (*handler)(address >> 1, data << shift, ~(0xff << shift))) 			\
 	}																					\
 }																						\
 
@@ -2150,7 +2614,7 @@ void name(offs_t address, data8_t data)													\
 	{																					\
 		int shift = 8 * (address & 1);													\
 		write16_handler handler = (write16_handler)handlist[entry].handler;				\
-		MEMWRITEEND((*handler)(address >> 1, data << shift, ~(0xff << shift)))			\
+		MEMWRITEHANDLER(handler, handlist[entry].offset, (*handler)(address >> 1, data << shift, ~(0xff << shift)))			\
 	}																					\
 }																						\
 
@@ -2176,7 +2640,7 @@ void name(offs_t address, data8_t data)													\
 	{																					\
 		int shift = 8 * (~address & 3);													\
 		write32_handler handler = (write32_handler)handlist[entry].handler;				\
-		MEMWRITEEND((*handler)(address >> 2, data << shift, ~(0xff << shift))) 			\
+		MEMWRITEHANDLER(handler, handlist[entry].offset, (*handler)(address >> 2, data << shift, ~(0xff << shift))) 			\
 	}																					\
 }																						\
 
@@ -2202,7 +2666,7 @@ void name(offs_t address, data8_t data)													\
 	{																					\
 		int shift = 8 * (address & 3);													\
 		write32_handler handler = (write32_handler)handlist[entry].handler;				\
-		MEMWRITEEND((*handler)(address >> 2, data << shift, ~(0xff << shift))) 			\
+		MEMWRITEHANDLER(handler, handlist[entry].offset, (*handler)(address >> 2, data << shift, ~(0xff << shift))) 			\
 	}																					\
 }																						\
 
@@ -2233,7 +2697,7 @@ void name(offs_t address, data16_t data)												\
 	else																				\
 	{																					\
 		write16_handler handler = (write16_handler)handlist[entry].handler;				\
-		MEMWRITEEND((*handler)(address >> 1, data, 0))								 	\
+		MEMWRITEHANDLER(handler, handlist[entry].offset, (*handler)(address >> 1, data, 0))								 	\
 	}																					\
 }																						\
 
@@ -2259,7 +2723,7 @@ void name(offs_t address, data16_t data)												\
 	{																					\
 		int shift = 8 * (~address & 2);													\
 		write32_handler handler = (write32_handler)handlist[entry].handler;				\
-		MEMWRITEEND((*handler)(address >> 2, data << shift, ~(0xffff << shift))) 		\
+		MEMWRITEHANDLER(handler, handlist[entry].offset, (*handler)(address >> 2, data << shift, ~(0xffff << shift))) 		\
 	}																					\
 }																						\
 
@@ -2285,7 +2749,7 @@ void name(offs_t address, data16_t data)												\
 	{																					\
 		int shift = 8 * (address & 2);													\
 		write32_handler handler = (write32_handler)handlist[entry].handler;				\
-		MEMWRITEEND((*handler)(address >> 2, data << shift, ~(0xffff << shift))) 		\
+		MEMWRITEHANDLER(handler, handlist[entry].offset, (*handler)(address >> 2, data << shift, ~(0xffff << shift))) 		\
 	}																					\
 }																						\
 
@@ -2316,7 +2780,7 @@ void name(offs_t address, data32_t data)												\
 	else																				\
 	{																					\
 		write32_handler handler = (write32_handler)handlist[entry].handler;				\
-		MEMWRITEEND((*handler)(address >> 2, data, 0))								 	\
+		MEMWRITEHANDLER(handler, handlist[entry].offset, (*handler)(address >> 2, data, 0))								 	\
 	}																					\
 }																						\
 
@@ -609,6 +609,20 @@ struct IO_WritePort32
 /* ----- external memory constants ----- */
 #define MAX_EXT_MEMORY			64						/* maximum external memory areas we can allocate */
 
+/* ----- write tracking constants ----- */
+#define MAX_MEM_WATCHES			64						/* maximum watched addresses of the tracked region */
+
+/* ----- page pointer constants ----- */
+#define MEM_PAGE_BITS			8						/* number of address bits within a page */
+#define MEM_PAGE_COUNT			(1 << (16 - MEM_PAGE_BITS))	/* pages of a 16-bit address space */
+#define MEM_PAGE_MASK			((1 << MEM_PAGE_BITS) - 1)	/* mask of the offset within a page */
+
+/* count the accesses through the page pointers and the handlers (logged at exit), */
+/* on in debug builds, -DMEM_PAGE_STATS for the others */
+#if defined(MAME_DEBUG) && !defined(MEM_PAGE_STATS)
+#define MEM_PAGE_STATS
+#endif
+
 
 
 /***************************************************************************
@@ -816,6 +830,29 @@ void		memory_shutdown(void);
 void		memory_set_context(int activecpu);
 void		memory_set_unmap_value(data32_t value);
 
+/* ----- page pointers of the 8-bit CPUs ----- */
+void		memory_use_pages(int use);
+void		memory_update_bank_pages(int bank);
+
+/* ----- write tracking of a host memory region (the NVRAM) ----- */
+/* the driver names the region and reports the writes to it with */
+/* memory_track_write; hosts collect the changed bytes with */
+/* memory_track_changes (any thread) and tools get a callback when */
+/* a watched byte changes (in the emulation thread) */
+struct mem_change
+{
+	offs_t				offset;				/* offset in the region */
+	data8_t				olddata;			/* value at the previous call */
+	data8_t				newdata;			/* value now */
+};
+typedef void (*mem_watch_handler)(offs_t offset, data8_t olddata, data8_t newdata, void *param);
+
+int			memory_track_region(void *base, size_t length);
+void		memory_track_mark(size_t offset, size_t length);
+int			memory_track_changes(struct mem_change *changes, int max);
+int			memory_watch(offs_t offset, mem_watch_handler handler, void *param);
+void		memory_unwatch(int watch);
+
 /* ----- dynamic bank handlers ----- */
 void		memory_set_bankhandler_r(int bank, offs_t offset, mem_read_handler handler);
 void		memory_set_bankhandler_w(int bank, offs_t offset, mem_write_handler handler);
@@ -865,6 +902,14 @@ extern offs_t			OP_MEM_MAX;			/* opcode memory maximum */
 extern UINT8 *			cpu_bankbase[];		/* array of bank bases */
 extern UINT8 *			readmem_lookup;		/* pointer to the readmem lookup table */
 extern offs_t			mem_amask;			/* memory address mask */
+extern UINT8 **			mem_read_page;		/* direct read pointers of the pages, NULL calls the handler */
+extern UINT8 **			mem_write_page;		/* direct write pointers of the pages, NULL calls the handler */
+#ifdef MEM_PAGE_STATS
+extern UINT64			mem_page_hits;		/* accesses through the page pointers */
+extern UINT64			mem_page_misses;	/* accesses through the handlers */
+#endif
+extern UINT8 *			mem_track_base;		/* region of the write tracking, NULL if none */
+extern size_t			mem_track_length;	/* length of the region */
 extern struct ExtMemory	ext_memory[];		/* externally-allocated memory */
 
 #ifdef PINMAME
@@ -932,6 +977,50 @@ INLINE data8_t  cpu_readop_arg(offs_t A)	{ if (address_is_unsafe(A)) { activecpu
 INLINE data16_t cpu_readop_arg16(offs_t A)	{ if (address_is_unsafe(A)) { activecpu_set_op_base(A); } return cpu_readop_arg16_unsafe(A); }
 INLINE data32_t cpu_readop_arg32(offs_t A)	{ if (address_is_unsafe(A)) { activecpu_set_op_base(A); } return cpu_readop_arg32_unsafe(A); }
 
+/* ----- 8-bit reads/writes for CPU cores, 16-bit addresses ----- */
+/* RAM, ROM and banks are accessed through the page pointers of the active CPU, */
+/* the rest goes to cpu_readmem16/cpu_writemem16 */
+INLINE data8_t cpu_readmem16_page(offs_t A)
+{
+	UINT8 *page = mem_read_page[(A & mem_amask) >> MEM_PAGE_BITS];
+	if (page)
+	{
+#ifdef MEM_PAGE_STATS
+		mem_page_hits++;
+#endif
+		return page[A & MEM_PAGE_MASK];
+	}
+#ifdef MEM_PAGE_STATS
+	mem_page_misses++;
+#endif
+	return cpu_readmem16(A);
+}
+
+INLINE void cpu_writemem16_page(offs_t A, data8_t D)
+{
+	UINT8 *page = mem_write_page[(A & mem_amask) >> MEM_PAGE_BITS];
+	if (page)
+	{
+#ifdef MEM_PAGE_STATS
+		mem_page_hits++;
+#endif
+		page[A & MEM_PAGE_MASK] = D;
+		return;
+	}
+#ifdef MEM_PAGE_STATS
+	mem_page_misses++;
+#endif
+	cpu_writemem16(A, D);
+}
+
+/* ----- write tracking, called by the drivers after writing the tracked region ----- */
+INLINE void memory_track_write(const void *ptr, size_t length)
+{
+	size_t offset = (size_t)((const UINT8 *)ptr - mem_track_base);
+	if (offset < mem_track_length)
+		memory_track_mark(offset, length);
+}
+
 /* ----- bank switching for CPU cores ----- */
 #define change_pc_generic(pc,abits,minbits,setop)										\
 do {																					\
@@ -949,6 +1038,7 @@ do {																					\
 	if (bank >= STATIC_BANK1 && bank <= STATIC_BANKMAX)									\
 	{																					\
 		cpu_bankbase[bank] = (UINT8 *)(base);											\
+		memory_update_bank_pages(bank);													\
 		if (opcode_entry == bank && cpu_getactivecpu() >= 0)							\
 		{																				\
 			opcode_entry = 0xff;														\
@@ -0,0 +1,37 @@
+#ifndef MTLOCK_H
+#define MTLOCK_H
+#if !defined(__GNUC__) || (__GNUC__ == 3 && __GNUC_MINOR__ >= 4) || (__GNUC__ >= 4)	// GCC supports "pragma once" correctly since 3.4
+#pragma once
+#endif
+
+/***************************************************************************
+
+	mtlock.h
+
+	A statically initialized lock for the few places of the core that
+	can be called from several threads at once (the ROM audit workers,
+	see audit.c). Declare one with MTLOCK(name) at file scope and take
+	it with mtlock_enter(&name) / mtlock_leave(&name). Not recursive.
+
+***************************************************************************/
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+
+#define MTLOCK(name)		static SRWLOCK name = SRWLOCK_INIT
+#define mtlock_enter(lock)	AcquireSRWLockExclusive(lock)
+#define mtlock_leave(lock)	ReleaseSRWLockExclusive(lock)
+
+#else
+#include <pthread.h>
+
+#define MTLOCK(name)		static pthread_mutex_t name = PTHREAD_MUTEX_INITIALIZER
+#define mtlock_enter(lock)	pthread_mutex_lock(lock)
+#define mtlock_leave(lock)	pthread_mutex_unlock(lock)
+
+#endif
+
+#endif	/* MTLOCK_H */
@@ -162,6 +162,16 @@ int osd_start_audio_stream(int stereo);
 int osd_update_audio_stream(INT16 *buffer);
 void osd_stop_audio_stream(void);
 
+/*
+  osd_set_audio_block() is called after osd_start_audio_stream() when the
+  sound is to be made in blocks of a fixed number of samples on emulated time
+  instead of once per frame, to cut the latency. From then on
+  osd_update_audio_stream() gets (and returns the size of) the next block
+  instead of the next frame, the same small adjustments apply. Returns the
+  samples for the first block, or 0 if the OSD can only take whole frames.
+*/
+int osd_set_audio_block(int samples);
+
 /*
   control master volume. attenuation is the attenuation in dB (a negative
   number). To convert from dB to a linear volume scale do the following:
@@ -374,6 +384,24 @@ UINT32 osd_fwrite(osd_file *file, const void *buffer, UINT32 length);
 /* Close an open file */
 void osd_fclose(osd_file *file);
 
+/* The full name, size and last modification time of a file, for the ROM hash cache */
+struct osd_file_stamp
+{
+	char	name[1024];
+	UINT64	size;
+	UINT64	mtime;
+};
+
+/* Get the stamp of a file; returns 0 if there is no such file */
+int osd_get_file_stamp(int pathtype, int pathindex, const char *filename, struct osd_file_stamp *stamp);
+
+/* Map a whole file read-only into memory; returns NULL if that's not possible
+   (the caller reads the file then). The mapping stays valid after osd_fclose. */
+const void *osd_fmap(osd_file *file, UINT64 *length);
+
+/* Release a mapping made by osd_fmap */
+void osd_funmap(const void *data, UINT64 length);
+
 
 
 /******************************************************************************
@@ -12,14 +12,15 @@ DEFS += -DPINMAME=1 -DMAMEVER=$(MAMEVER)
 DEFS += -DMAME32NAME=\"PINMAME32\" -DMAMENAME=\"PINMAME\"
 # do not compile currently unused function (GCC 3.4+, GCC 4+)
 DEFS += -DPINMAME_NO_UNUSED=1
-TOOLS=
+TOOLS=dmdbench$(EXE) pwmbench$(EXE) dmdplay$(EXE) mixbench$(EXE) m6809bench$(EXE)
 
 #
 # Common stuff
 #
 DRVLIBS = $(PINOBJ)/sim.o $(PINOBJ)/core.o $(OBJ)/allgames.a
 DRVLIBS += $(PINOBJ)/vpintf.o $(PINOBJ)/snd_cmd.o $(PINOBJ)/wpcsam.o
-DRVLIBS += $(PINOBJ)/sndbrd.o
+DRVLIBS += $(PINOBJ)/dmdkern.o $(PINOBJ)/dmdcap.o
+DRVLIBS += $(PINOBJ)/sndbrd.o $(PINOBJ)/swrec.o
 DRVLIBS += $(OBJ)/machine/4094.o
 DRVLIBS += $(OBJ)/sound/wavwrite.o
 
@@ -0,0 +1,222 @@
+/***************************************************************************
+
+	rewind.c
+
+	In-memory save state ring, see rewind.h.
+
+	Every state is a list of references to blocks. A block has a
+	reference count and is freed with the last state using it; the
+	memory budget counts every block once no matter how many states
+	share it.
+
+***************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "driver.h"
+#include "rewind.h"
+
+
+/*-------------------------------------------------
+	rewind structures
+-------------------------------------------------*/
+
+struct rewind_block
+{
+	int				refs;
+	UINT8			data[REWIND_BLOCKSIZE];
+};
+
+struct rewind_state
+{
+	unsigned		size;
+	unsigned		blocks;
+	struct rewind_block **block;
+};
+
+static struct
+{
+	unsigned		budget;
+	unsigned		used;			/* bytes in blocks */
+	int				first;			/* oldest state in the ring */
+	int				count;
+	struct rewind_state state[REWIND_MAXSTATES];
+} rw;
+
+
+
+/*-------------------------------------------------
+	rewind_free_state - drops the references of
+	a state
+-------------------------------------------------*/
+
+static void rewind_free_state(struct rewind_state *s)
+{
+	unsigned i;
+
+	for (i = 0; i < s->blocks; i++)
+		if (--s->block[i]->refs == 0)
+		{
+			free(s->block[i]);
+			rw.used -= sizeof(struct rewind_block);
+		}
+	free(s->block);
+	memset(s, 0, sizeof(*s));
+}
+
+
+
+/*-------------------------------------------------
+	rewind_init/rewind_exit
+-------------------------------------------------*/
+
+void rewind_init(unsigned budget)
+{
+	rewind_reset();
+	rw.budget = budget;
+}
+
+void rewind_exit(void)
+{
+	rewind_reset();
+	rw.budget = 0;
+}
+
+int rewind_enabled(void)
+{
+	return rw.budget != 0;
+}
+
+int rewind_count(void)
+{
+	return rw.count;
+}
+
+
+
+/*-------------------------------------------------
+	rewind_reset - drops all states
+-------------------------------------------------*/
+
+void rewind_reset(void)
+{
+	while (rw.count)
+	{
+		rewind_free_state(&rw.state[rw.first]);
+		rw.first = (rw.first + 1) % REWIND_MAXSTATES;
+		rw.count--;
+	}
+	rw.first = 0;
+}
+
+
+
+/*-------------------------------------------------
+	rewind_add - adds a state, sharing the blocks
+	that match the newest one
+-------------------------------------------------*/
+
+void rewind_add(const UINT8 *data, unsigned size)
+{
+	struct rewind_state *prev = rw.count ? &rw.state[(rw.first + rw.count - 1) % REWIND_MAXSTATES] : NULL;
+	struct rewind_state *s;
+	unsigned i;
+
+	if (!rw.budget || !size)
+		return;
+
+	/* the ring is full, drop the oldest */
+	if (rw.count == REWIND_MAXSTATES)
+	{
+		rewind_free_state(&rw.state[rw.first]);
+		rw.first = (rw.first + 1) % REWIND_MAXSTATES;
+		rw.count--;
+	}
+
+	s = &rw.state[(rw.first + rw.count) % REWIND_MAXSTATES];
+	s->blocks = (size + REWIND_BLOCKSIZE - 1) / REWIND_BLOCKSIZE;
+	s->block = malloc(s->blocks * sizeof(s->block[0]));
+	if (!s->block)
+	{
+		memset(s, 0, sizeof(*s));
+		return;
+	}
+	s->size = size;
+
+	for (i = 0; i < s->blocks; i++)
+	{
+		unsigned len = size - i * REWIND_BLOCKSIZE;
+		const UINT8 *src = data + i * REWIND_BLOCKSIZE;
+		struct rewind_block *b;
+
+		if (len > REWIND_BLOCKSIZE)
+			len = REWIND_BLOCKSIZE;
+
+		/* unchanged since the previous state? */
+		if (prev && prev->size == size && !memcmp(prev->block[i]->data, src, len))
+			b = prev->block[i];
+		else
+		{
+			b = malloc(sizeof(*b));
+			if (!b)
+			{
+				s->blocks = i;
+				rewind_free_state(s);
+				return;
+			}
+			b->refs = 0;
+			memcpy(b->data, src, len);
+			rw.used += sizeof(*b);
+		}
+		b->refs++;
+		s->block[i] = b;
+	}
+	rw.count++;
+
+	/* keep the newest state whatever it costs */
+	while (rw.used > rw.budget && rw.count > 1)
+	{
+		rewind_free_state(&rw.state[rw.first]);
+		rw.first = (rw.first + 1) % REWIND_MAXSTATES;
+		rw.count--;
+	}
+}
+
+
+
+/*-------------------------------------------------
+	rewind_pop - takes the steps-th newest state
+	out of the ring
+-------------------------------------------------*/
+
+UINT8 *rewind_pop(int steps, unsigned *size)
+{
+	struct rewind_state *s;
+	UINT8 *data;
+	unsigned i;
+
+	*size = 0;
+	if (steps < 1 || !rw.count)
+		return NULL;
+	if (steps > rw.count)
+		steps = rw.count;
+
+	/* the newer ones are gone */
+	while (--steps)
+		rewind_free_state(&rw.state[(rw.first + --rw.count) % REWIND_MAXSTATES]);
+
+	s = &rw.state[(rw.first + rw.count - 1) % REWIND_MAXSTATES];
+	data = malloc(s->size);
+	if (data)
+	{
+		for (i = 0; i < s->blocks; i++)
+		{
+			unsigned len = s->size - i * REWIND_BLOCKSIZE;
+			memcpy(data + i * REWIND_BLOCKSIZE, s->block[i]->data, len > REWIND_BLOCKSIZE ? REWIND_BLOCKSIZE : len);
+		}
+		*size = s->size;
+	}
+	rewind_free_state(s);
+	rw.count--;
+	return data;
+}
@@ -0,0 +1,42 @@
+#ifndef REWIND_H
+#define REWIND_H
+#if !defined(__GNUC__) || (__GNUC__ == 3 && __GNUC_MINOR__ >= 4) || (__GNUC__ >= 4)	// GCC supports "pragma once" correctly since 3.4
+#pragma once
+#endif
+
+/***************************************************************************
+
+	rewind.h
+
+	A ring of save states kept in memory (-rewind), taken by cpuexec.c
+	every -rewind_interval frames and restored with cpu_rewind().
+
+	The states are split in blocks of REWIND_BLOCKSIZE bytes and a block
+	that did not change since the previous state is shared with it, so
+	a state usually costs little more than the RAM written in between.
+	The oldest states are dropped when the blocks use more memory than
+	the budget.
+
+***************************************************************************/
+
+#define REWIND_BLOCKSIZE	1024
+#define REWIND_MAXSTATES	4096
+
+/* budget in bytes, 0 = off */
+void rewind_init(unsigned budget);
+void rewind_exit(void);
+
+/* drops all states, on a reset */
+void rewind_reset(void);
+
+int rewind_enabled(void);
+int rewind_count(void);
+
+/* copies a save state image into the ring */
+void rewind_add(const UINT8 *data, unsigned size);
+
+/* removes the newest states up to the steps-th one and returns that one */
+/* (malloc'd, the caller frees it), NULL if there is none */
+UINT8 *rewind_pop(int steps, unsigned *size);
+
+#endif	/* REWIND_H */
@@ -1629,11 +1629,19 @@ OBJDIRS += $(OBJ)/cpu/at91
 CPUDEFS += -DHAS_AT91=1
 CPUOBJS += $(OBJ)/cpu/at91/at91.o
 DBGOBJS += $(OBJ)/cpu/at91/at91dasm.o
-$(OBJ)/cpu/at91/at91.o: src/cpu/at91/at91.c src/cpu/at91/at91.h
+$(OBJ)/cpu/at91/at91.o: src/cpu/at91/at91.c src/cpu/at91/at91.h src/cpu/arm7/arm7core.c src/cpu/arm7/arm7jit.c src/cpu/arm7/arm7jit.h
 else
 CPUDEFS += -DHAS_AT91=0
 endif
 
+# ARM7 JIT translator core (compiles to nothing on hosts without JIT support)
+ifneq ($(strip $(findstring ARM7@,$(CPUS))$(findstring AT91@,$(CPUS))),)
+OBJDIRS += $(OBJ)/windows
+CPUOBJS += $(OBJ)/windows/jit.o $(OBJ)/windows/jitemit.o
+$(OBJ)/windows/jit.o: src/windows/jit.c src/windows/jit.h
+$(OBJ)/windows/jitemit.o: src/windows/jitemit.c src/windows/jitemit.h src/windows/jit.h
+endif
+
 CPU=$(strip $(findstring CDP1802@,$(CPUS)))
 ifneq ($(CPU),)
 OBJDIRS += $(OBJ)/cpu/cdp1802
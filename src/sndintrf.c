@@ -204,6 +204,9 @@ void soundlatch_setclearedvalue(int value)
 static void *sound_update_timer;
 static double refresh_period;
 static double refresh_period_inv;
+static int audio_block;		/* samples per block when the sound is made on its own timer */
+
+static void sound_update_block(int param);
 
 
 struct snd_interface
@@ -1311,11 +1314,20 @@ logerror("Sound #%d wrong ID %d: check enum SOUND_... in src/sndintrf.h!\n",i,sn
 
 	refresh_period = TIME_IN_HZ(Machine->drv->frames_per_second);
 	refresh_period_inv = 1.0 / refresh_period;
-	sound_update_timer = timer_alloc(NULL);
+	sound_update_timer = timer_alloc(sound_update_block);
 
 	if (mixer_sh_start() != 0)
 		return 1;
 
+	/* with audio blocks the sound is made every block of emulated time, not every frame */
+	audio_block = mixer_audio_block();
+	if (audio_block)
+	{
+		refresh_period = (double)audio_block / (double)Machine->sample_rate;
+		refresh_period_inv = 1.0 / refresh_period;
+		timer_adjust(sound_update_timer, refresh_period, 0, refresh_period);
+	}
+
 	if (streams_sh_start() != 0)
 		return 1;
 
@@ -1359,12 +1371,13 @@ void sound_stop(void)
 
 
 
-void sound_update(void)
+static void sound_update_block(int param)
 {
 	int totalsound = 0;
 
 
 	profiler_mark(PROFILER_SOUND);
+	hprof_begin(HPROF_NAMED, "sound update", 0);
 
 	while (totalsound < MAX_SOUND && Machine->drv->sound[totalsound].sound_type != 0)
 	{
@@ -1377,12 +1390,23 @@ void sound_update(void)
 	streams_sh_update();
 	mixer_sh_update();
 
-	timer_adjust(sound_update_timer, TIME_NEVER, 0, 0);
+	/* the periodic timer of the audio blocks restarts by itself */
+	if (!audio_block)
+		timer_adjust(sound_update_timer, TIME_NEVER, 0, 0);
 
+	hprof_end();
 	profiler_mark(PROFILER_END);
 }
 
 
+void sound_update(void)
+{
+	/* once per frame, unless the sound is made in blocks */
+	if (!audio_block)
+		sound_update_block(0);
+}
+
+
 void sound_reset(void)
 {
 	int totalsound = 0;
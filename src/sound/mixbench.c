@@ -0,0 +1,304 @@
+/***************************************************************************
+
+	mixbench.c
+
+	Mixer microbenchmark. Checks that the plain C and the vector versions
+	of the mixer kernels (mixkern.c) give identical results, then runs
+	the mixer's resampling path (short to float, libsamplerate, add to
+	the accumulator, clip) for a number of stream channels with both and
+	prints the time per second of sound.
+
+	usage: mixbench [-o outrate] [-s seconds] [case ...]
+	  a case is <channels>x<rate>, several joined with '+', e.g.
+	  "2x55930+1x48000" for a YM2151 and a CVSD. Without cases a few
+	  typical sound boards are measured.
+
+***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "driver.h"
+#include "mixkern.h"
+
+#include "../../ext/libsamplerate/samplerate.h"
+#include "../../ext/libsamplerate/samplerate.c"
+#include "../../ext/libsamplerate/src_linear.c"
+#include "../../ext/libsamplerate/src_sinc_opt.c"
+#include "../../ext/libsamplerate/src_zoh.c"
+
+#define BENCH_MAXCHANNELS	32
+#define BENCH_FPS			60
+#define BENCH_CHECKLEN		4099		/* not a multiple of the vector size */
+
+struct bench_kernels
+{
+	void (*short_to_float)(float *dst, const INT16 *src, unsigned len);
+	void (*add_float)(int *dst, const float *src, unsigned len, double scale);
+	void (*accum_to_short)(INT16 *dst, int *left, int *right, unsigned len);
+};
+
+static const struct bench_kernels kernels_c = { mixk_short_to_float_c, mixk_add_float_c, mixk_accum_to_short_c };
+static const struct bench_kernels kernels_v = { mixk_short_to_float, mixk_add_float, mixk_accum_to_short };
+
+static const char *default_cases[][2] =
+{
+	{ "DCS",             "1x31250" },
+	{ "BSMT2000",        "2x24000" },
+	{ "YM2151 + CVSD",   "2x55930+1x48000" },
+	{ "16 streams",      "16x44100" }
+};
+
+static int errors;
+
+static double seconds(clock_t start)
+{
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+
+
+/*-------------------------------------------------
+	check_kernels - compare the C and vector
+	kernels on random data, clipping included
+-------------------------------------------------*/
+
+static void check(const char *name, int ok)
+{
+	if (!ok)
+	{
+		printf("%s: vector and C results differ\n", name);
+		errors++;
+	}
+}
+
+static void check_kernels(void)
+{
+	static INT16 s16[BENCH_CHECKLEN], mixc[2*BENCH_CHECKLEN], mixv[2*BENCH_CHECKLEN];
+	static INT8 s8[BENCH_CHECKLEN];
+	static float f[BENCH_CHECKLEN], fc[BENCH_CHECKLEN], fv[BENCH_CHECKLEN];
+	static int lc[BENCH_CHECKLEN], lv[BENCH_CHECKLEN], rc[BENCH_CHECKLEN], rv[BENCH_CHECKLEN];
+	int i, stereo;
+
+	for (i = 0; i < BENCH_CHECKLEN; i++)
+	{
+		s16[i] = (INT16)(rand() ^ (rand() << 8));
+		s8[i] = (INT8)rand();
+		/* mostly -1..1, some far out to test the clipping, some halfway values to test the rounding */
+		f[i] = (float)(rand() - RAND_MAX/2) / (RAND_MAX/2) * ((i % 7) ? 1.0f : 300.0f);
+		if (i % 11 == 0)
+			f[i] = (float)(rand() % 65536 - 32768) / 65536.0f + 1.0f / 131072.0f;
+		lc[i] = lv[i] = rand() - RAND_MAX/2;
+	}
+
+	mixk_short_to_float_c(fc, s16, BENCH_CHECKLEN);
+	mixk_short_to_float(fv, s16, BENCH_CHECKLEN);
+	check("short to float", !memcmp(fc, fv, sizeof(fc)));
+
+	mixk_char_to_float_c(fc, s8, BENCH_CHECKLEN);
+	mixk_char_to_float(fv, s8, BENCH_CHECKLEN);
+	check("char to float", !memcmp(fc, fv, sizeof(fc)));
+
+	for (i = 0; i < 256; i += 51)
+	{
+		mixk_add_float_c(lc, f, BENCH_CHECKLEN, i * (8.0 * 0x10000000 / 256.0));
+		mixk_add_float(lv, f, BENCH_CHECKLEN, i * (8.0 * 0x10000000 / 256.0));
+	}
+	check("add float", !memcmp(lc, lv, sizeof(lc)));
+
+	for (stereo = 0; stereo < 2; stereo++)
+	{
+		for (i = 0; i < BENCH_CHECKLEN; i++)
+		{
+			lc[i] = lv[i] = (rand() - RAND_MAX/2) / 16384;
+			rc[i] = rv[i] = (rand() - RAND_MAX/2) / 16384;
+		}
+		mixk_accum_to_short_c(mixc, lc, stereo ? rc : NULL, BENCH_CHECKLEN);
+		mixk_accum_to_short(mixv, lv, stereo ? rv : NULL, BENCH_CHECKLEN);
+		check(stereo ? "accum to short (stereo)" : "accum to short (mono)",
+			!memcmp(mixc, mixv, (stereo ? 2 : 1) * BENCH_CHECKLEN * sizeof(INT16)) &&
+			!memcmp(lc, lv, sizeof(lc)) && !memcmp(rc, rv, sizeof(rc)));
+	}
+}
+
+
+
+/*-------------------------------------------------
+	time_kernels - time the kernels alone on
+	blocks of BENCH_CHECKLEN samples
+-------------------------------------------------*/
+
+static void report(const char *name, double timec, double timev, int secs)
+{
+	printf("%-35s C: %7.2f ms  %s: %7.2f ms  per second of sound (%.1fx)\n", name,
+			timec * 1000.0 / secs, mixk_simd_name, timev * 1000.0 / secs, timev > 0 ? timec / timev : 0.0);
+}
+
+static void time_kernels(int outrate, int secs)
+{
+	static INT16 s16[BENCH_CHECKLEN], mix[2*BENCH_CHECKLEN];
+	static float f[BENCH_CHECKLEN];
+	static int l[BENCH_CHECKLEN], r[BENCH_CHECKLEN];
+	const int blocks = (int)((INT64)outrate * secs / BENCH_CHECKLEN) + 1;
+	const struct bench_kernels *k;
+	double time[2][3];
+	clock_t start;
+	int i, j;
+
+	for (i = 0; i < BENCH_CHECKLEN; i++)
+		f[i] = (float)(rand() - RAND_MAX/2) / (RAND_MAX/2);
+
+	for (j = 0; j < 2; j++)
+	{
+		k = j ? &kernels_v : &kernels_c;
+		start = clock();
+		for (i = 0; i < blocks; i++)
+			k->short_to_float(f, s16, BENCH_CHECKLEN);
+		time[j][0] = seconds(start);
+		start = clock();
+		for (i = 0; i < blocks; i++)
+			k->add_float(l, f, BENCH_CHECKLEN, 160 * (8.0 * 0x10000000 / 256.0));
+		time[j][1] = seconds(start);
+		start = clock();
+		for (i = 0; i < blocks; i++)
+			k->accum_to_short(mix, l, r, BENCH_CHECKLEN);
+		time[j][2] = seconds(start);
+	}
+	report("short to float (per channel)", time[0][0], time[1][0], secs);
+	report("add float (per channel)", time[0][1], time[1][1], secs);
+	report("accum to short (stereo output)", time[0][2], time[1][2], secs);
+}
+
+
+
+/*-------------------------------------------------
+	run_case - mix the given channels for the
+	given time, returns the CPU time used
+-------------------------------------------------*/
+
+static double run_case(const struct bench_kernels *k, int channels, const int *rate, int outrate, int secs)
+{
+	static INT16 src[BENCH_MAXCHANNELS][2*96000/BENCH_FPS + 64];
+	static float in[2*96000/BENCH_FPS + 64], out[96000/BENCH_FPS + 64];
+	static int left[96000/BENCH_FPS + 64], right[96000/BENCH_FPS + 64];
+	static INT16 mix[2*(96000/BENCH_FPS + 64)];
+	SRC_STATE *state[BENCH_MAXCHANNELS];
+	const int samples = outrate / BENCH_FPS;
+	double time;
+	clock_t start;
+	int ch, frame, i, error;
+
+	for (ch = 0; ch < channels; ch++)
+	{
+		/* a tone with some noise, so that the resampler has work to do */
+		for (i = 0; i < (int)(sizeof(src[0]) / sizeof(src[0][0])); i++)
+			src[ch][i] = (INT16)(8000 * ((i * (ch + 3) / 7) % 8 - 4) + (rand() & 0x3ff));
+		state[ch] = src_new(SRC_SINC_FASTEST, 1, &error);
+	}
+
+	start = clock();
+	for (frame = 0; frame < secs * BENCH_FPS; frame++)
+	{
+		for (ch = 0; ch < channels; ch++)
+		{
+			SRC_DATA data;
+			const unsigned len = (unsigned)((INT64)samples * rate[ch] / outrate + 1);
+
+			k->short_to_float(in, src[ch], len);
+			data.data_in = in;
+			data.data_out = out;
+			data.input_frames = len;
+			data.output_frames = samples;
+			data.end_of_input = 0;
+			data.src_ratio = (double)outrate / rate[ch];
+			src_process(state[ch], &data);
+			k->add_float((ch & 1) ? right : left, out, data.output_frames_gen, 160 * (8.0 * 0x10000000 / 256.0));
+		}
+		k->accum_to_short(mix, left, right, samples);
+	}
+	time = seconds(start);
+
+	for (ch = 0; ch < channels; ch++)
+		src_delete(state[ch]);
+	return time;
+}
+
+
+
+/*-------------------------------------------------
+	bench - parse and measure a case
+-------------------------------------------------*/
+
+static void bench(const char *name, const char *spec, int outrate, int secs)
+{
+	int rate[BENCH_MAXCHANNELS];
+	int channels = 0, count, r, n;
+	const char *p = spec;
+	double timec, timev;
+
+	while (sscanf(p, "%dx%d%n", &count, &r, &n) == 2 && count > 0 && r > 0 && r <= 96000)
+	{
+		while (count-- && channels < BENCH_MAXCHANNELS)
+			rate[channels++] = r;
+		p += n;
+		if (*p != '+')
+			break;
+		p++;
+	}
+	if (channels == 0 || *p)
+	{
+		fprintf(stderr, "mixbench: bad case '%s' (<channels>x<rate>[+...], rate up to 96000)\n", spec);
+		errors++;
+		return;
+	}
+
+	timec = run_case(&kernels_c, channels, rate, outrate, secs);
+	timev = run_case(&kernels_v, channels, rate, outrate, secs);
+	printf("%-16s %-18s C: %7.2f ms  %s: %7.2f ms  per second of sound (%.2fx), %.2f%% of a core\n",
+			name, spec, timec * 1000.0 / secs, mixk_simd_name, timev * 1000.0 / secs,
+			timev > 0 ? timec / timev : 0.0, timev * 100.0 / secs);
+}
+
+
+
+int main(int argc, char *argv[])
+{
+	int outrate = 48000, secs = 10;
+	int i, cases = 0;
+
+	for (i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+			outrate = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+			secs = atoi(argv[++i]);
+		else if (argv[i][0] == '-')
+			break;
+	}
+	if (i < argc || outrate < 8000 || outrate > 96000 || secs <= 0)
+	{
+		fprintf(stderr, "usage: %s [-o outrate] [-s seconds] [<channels>x<rate>[+...] ...]\n", argv[0]);
+		return 1;
+	}
+
+	srand(1234);
+	printf("mixbench: output %d Hz, %d s of sound per case, vector unit: %s\n", outrate, secs, mixk_simd_name);
+	check_kernels();
+	time_kernels(outrate, secs);
+
+	for (i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "-s") == 0)
+			i++;
+		else
+		{
+			bench("", argv[i], outrate, secs);
+			cases++;
+		}
+	}
+	if (!cases)
+		for (i = 0; i < (int)(sizeof(default_cases) / sizeof(default_cases[0])); i++)
+			bench(default_cases[i][0], default_cases[i][1], outrate, secs);
+
+	return errors ? 1 : 0;
+}
@@ -8,6 +8,7 @@
 
 #include "driver.h"
 #include "filter.h"
+#include "mixkern.h"
 
 #include <math.h>
 #include <limits.h>
@@ -48,6 +49,10 @@
 #define ACCUMULATOR_SAMPLES		8192
 #define ACCUMULATOR_MASK		(ACCUMULATOR_SAMPLES - 1)
 
+/* limits of options.audio_block */
+#define MIXER_MIN_BLOCK			16
+#define MIXER_MAX_BLOCK			(ACCUMULATOR_SAMPLES / 2)
+
 /* fractional numbers have FRACTION_BITS bits of resolution */
 #define FRACTION_BITS			16
 #define FRACTION_ONE			(1 << FRACTION_BITS)
@@ -142,7 +147,9 @@ static int left_accum[ACCUMULATOR_SAMPLES];
 static int right_accum[ACCUMULATOR_SAMPLES];
 
 #ifdef USE_LIBSAMPLERATE
-static float in_f[ACCUMULATOR_SAMPLES*25]; //!! 25=magic, should be able to handle all cases where src sample rate is far far larger than dst sample rate (e.g. 4x48000 -> 8000), if changing also change asserts and overflow check in below code (search for ACCUMULATOR_MASK*25)
+/* libsamplerate input (the source samples go through it in chunks) and output */
+#define RESAMPLE_CHUNK ACCUMULATOR_SAMPLES
+static float in_f[RESAMPLE_CHUNK];
 static float out_f[ACCUMULATOR_SAMPLES];
 #endif
 
@@ -151,6 +158,7 @@ static INT16 mix_buffer[ACCUMULATOR_SAMPLES*2]; /* *2 for stereo */
 
 /* global sample tracking */
 static unsigned samples_this_frame;
+static unsigned audio_block;	/* samples per block, 0 = one block per frame */
 
 #ifdef PINMAME
 static void mixer_apply_reverb_filter(struct mixer_channel_data* const channel, float * const __restrict buf, const int len, const unsigned left_right)
@@ -279,6 +287,58 @@ static void mixer_channel_resample_set(struct mixer_channel_data *channel, unsig
 	}
 }
 
+#ifdef USE_LIBSAMPLERATE
+/* Resample through libsamplerate and add the result to the accumulator
+	from dst_pos on. The source goes through in_f in chunks, so there is no
+	limit to src_len. Returns the number of destination samples made,
+	*src_used the number of source samples used.
+*/
+static unsigned mixer_channel_resample_src(struct mixer_channel_data* channel, SRC_STATE* src_state,
+	int volume, int* const __restrict dst, unsigned dst_pos, unsigned dst_len, const void* src, int is_16bit, unsigned src_len, unsigned left_right, unsigned* src_used)
+{
+	const double scale = volume * (8.0 * 0x10000000 / 256.0);
+	unsigned used = 0, gen = 0;
+	SRC_DATA data;
+
+	data.data_in = in_f;
+	data.data_out = out_f;
+	data.end_of_input = 0;
+	data.src_ratio = (double)channel->to_frequency / channel->from_frequency;
+
+	while (used < src_len && gen < dst_len)
+	{
+		unsigned pos, len;
+
+		data.input_frames = MIN(src_len - used, RESAMPLE_CHUNK);
+		data.output_frames = dst_len - gen;
+		if (is_16bit)
+			mixk_short_to_float(in_f, (const INT16*)src + used, data.input_frames);
+		else
+			mixk_char_to_float(in_f, (const INT8*)src + used, data.input_frames);
+
+		src_process(src_state, &data);
+
+		mixer_apply_reverb_filter(channel, out_f, data.output_frames_gen, left_right);
+
+		/* add to the accumulator, in two runs where it wraps around */
+		for (pos = 0; pos < (unsigned)data.output_frames_gen; pos += len)
+		{
+			const unsigned run_pos = (dst_pos + gen + pos) & ACCUMULATOR_MASK;
+			len = MIN((unsigned)data.output_frames_gen - pos, ACCUMULATOR_SAMPLES - run_pos);
+			mixk_add_float(dst + run_pos, out_f + pos, len, scale);
+		}
+
+		if (data.input_frames_used == 0 && data.output_frames_gen == 0)
+			break;
+		used += data.input_frames_used;
+		gen += data.output_frames_gen;
+	}
+
+	*src_used = used;
+	return gen;
+}
+#endif
+
 /* Resample a channel
 	channel - channel info
 	state - filter state
@@ -302,19 +362,13 @@ static unsigned mixer_channel_resample_16(struct mixer_channel_data* channel,
 	INT16* __restrict src = *psrc;
 
 #ifdef USE_LIBSAMPLERATE
-	SRC_DATA data;
 	long i;
-	const double scale = volume * (8.0 * 0x10000000 / 256.0);
 
 	//limit src_len input length, roughly same as old code did basically:
 	src_len = MIN(src_len, MAX((unsigned int)(dst_len*1.2*((double)channel->from_frequency / channel->to_frequency)),1)); //1.2=magic, limit incoming input, so that not all is immediately processed
 
 	if (src_len == 0 || dst_len == 0)
 		return 0;
-
-	assert(src_len <= ACCUMULATOR_MASK*25); //!! magic see in_f
-
-	src_len = MIN(src_len, ACCUMULATOR_MASK*25);
 #endif
 	assert( dst_len <= ACCUMULATOR_MASK );
 
@@ -424,34 +478,13 @@ static unsigned mixer_channel_resample_16(struct mixer_channel_data* channel,
 
 	// Normal libsamplerate code-path:
 
-	src_short_to_float_array(src, in_f, src_len); //!! opt.?
-
-	data.data_in = in_f;
-	data.data_out = out_f;
-	data.input_frames = src_len;
-	data.output_frames = dst_len;
-	data.end_of_input = 0;
-	data.src_ratio = (double)channel->to_frequency/channel->from_frequency;
-
-	src_process(src_state, &data);
-
-	mixer_apply_reverb_filter(channel, out_f, data.output_frames_gen, left_right);
-
-	for (i = 0; i < data.output_frames_gen; ++i) //!! opt.?
 	{
-		double scaled_value = out_f[i] * scale;
-		if (CPU_CLIPS_POSITIVE == 0 && scaled_value >= (1.0 * 0x7FFFFFFF))
-			dst[dst_pos] += 32767;
-		else if (CPU_CLIPS_NEGATIVE == 0 && scaled_value <= (-8.0 * 0x10000000))
-			dst[dst_pos] += -32768;
-		else
-			dst[dst_pos] += (lrint(scaled_value) >> 16);
-		dst_pos = (dst_pos + 1) & ACCUMULATOR_MASK;
+		unsigned src_used;
+		const unsigned dst_gen = mixer_channel_resample_src(channel, src_state, volume, dst, dst_pos, dst_len, src, 1, src_len, left_right, &src_used);
+		*psrc = src + src_used;
+		return dst_gen;
 	}
 
-	*psrc = src+data.input_frames_used;
-	return (dst_pos - dst_base) & ACCUMULATOR_MASK;
-
 #else
 
 	if (!channel->filter)
@@ -560,19 +593,12 @@ static unsigned mixer_channel_resample_8(struct mixer_channel_data *channel,
 	INT8* __restrict src = *psrc;
 
 #ifdef USE_LIBSAMPLERATE
-	SRC_DATA data;
-	long i;
-	const double scale = volume * (8.0 * 0x10000000 / 256.0);
 
 	//limit src_len input length, roughly same as old code did basically:
 	src_len = MIN(src_len, MAX((unsigned int)(dst_len*1.2*((double)channel->from_frequency / channel->to_frequency)),1)); //1.2=magic, limit incoming input, so that not all is immediately processed
 
 	if (src_len == 0 || dst_len == 0)
 		return 0;
-
-	assert(src_len <= ACCUMULATOR_MASK*25); //!! magic see in_f
-
-	src_len = MIN(src_len, ACCUMULATOR_MASK*25);
 #endif
 	assert( dst_len <= ACCUMULATOR_MASK );
 
@@ -635,34 +661,13 @@ static unsigned mixer_channel_resample_8(struct mixer_channel_data *channel,
 
 	// Normal libsamplerate code-path:
 	
-	src_char_to_float_array(src, in_f, src_len); //!! opt.?
-
-	data.data_in = in_f;
-	data.data_out = out_f;
-	data.input_frames = src_len;
-	data.output_frames = dst_len;
-	data.end_of_input = 0;
-	data.src_ratio = (double)channel->to_frequency / channel->from_frequency;
-
-	src_process(src_state, &data);
-
-	mixer_apply_reverb_filter(channel, out_f, data.output_frames_gen, left_right);
-
-	for (i = 0; i < data.output_frames_gen; ++i) //!! opt.?
 	{
-		double scaled_value = out_f[i] * scale;
-		if (CPU_CLIPS_POSITIVE == 0 && scaled_value >= (1.0 * 0x7FFFFFFF))
-			dst[dst_pos] += 32767;
-		else if (CPU_CLIPS_NEGATIVE == 0 && scaled_value <= (-8.0 * 0x10000000))
-			dst[dst_pos] += -32768;
-		else
-			dst[dst_pos] += (lrint(scaled_value) >> 16);
-		dst_pos = (dst_pos + 1) & ACCUMULATOR_MASK;
+		unsigned src_used;
+		const unsigned dst_gen = mixer_channel_resample_src(channel, src_state, volume, dst, dst_pos, dst_len, src, 0, src_len, left_right, &src_used);
+		*psrc = src + src_used;
+		return dst_gen;
 	}
 
-	*psrc = src + data.input_frames_used;
-	return (dst_pos - dst_base) & ACCUMULATOR_MASK;
-
 #else
 
 	if (!channel->filter)
@@ -1045,6 +1050,23 @@ int mixer_sh_start(void)
 
 	samples_this_frame = r;
 
+	/* mix in blocks on emulated time instead of once per frame, if the OSD can take them */
+	audio_block = 0;
+	if (options.audio_block > 0 && Machine->sample_rate != 0)
+	{
+		unsigned block = options.audio_block;
+		if (block < MIXER_MIN_BLOCK)
+			block = MIXER_MIN_BLOCK;
+		if (block > MIXER_MAX_BLOCK)
+			block = MIXER_MAX_BLOCK;
+		r = osd_set_audio_block(block);
+		if (r > 0)
+		{
+			audio_block = block;
+			samples_this_frame = r;
+		}
+	}
+
 	mixer_sound_enabled = 1;
 
 	return 0;
@@ -1114,7 +1136,7 @@ void mixer_sh_update(void)
 	struct mixer_channel_data* channel;
 	unsigned accum_pos = accum_base;
 	INT16 *mix;
-	int sample;
+	unsigned len;
 	int i;
 
 	profiler_mark(PROFILER_MIXER);
@@ -1135,23 +1157,38 @@ void mixer_sh_update(void)
 			channel->samples_available -= samples_this_frame;
 	}
 
-	/* copy the mono 32-bit data to a 16-bit buffer, clipping along the way */
+	/* while warping the frame is thrown away, nothing is played or recorded */
+	if (cpu_warping())
+	{
+		for (i = 0; (unsigned int)i < samples_this_frame; i++)
+		{
+			left_accum[accum_pos] = right_accum[accum_pos] = 0;
+			accum_pos = (accum_pos + 1) & ACCUMULATOR_MASK;
+		}
+		accum_base = accum_pos;
+		profiler_mark(PROFILER_END);
+		return;
+	}
+
+#ifdef MIXER_USE_CLIPPING
+	/* copy the 32-bit data to a 16-bit buffer, clipping along the way, in two runs where the accumulator wraps around */
+	mix = mix_buffer;
+	for (i = 0; (unsigned int)i < samples_this_frame; i += len)
+	{
+		len = MIN(samples_this_frame - i, ACCUMULATOR_SAMPLES - accum_pos);
+		mixk_accum_to_short(mix, left_accum + accum_pos, is_stereo ? right_accum + accum_pos : NULL, len);
+		mix += is_stereo ? 2*len : len;
+		accum_pos = (accum_pos + len) & ACCUMULATOR_MASK;
+	}
+#else
+	/* copy the mono 32-bit data to a 16-bit buffer */
 	if (!is_stereo)
 	{
 		mix = mix_buffer;
 		for (i = 0; (unsigned int)i < samples_this_frame; i++)
 		{
-			/* fetch and clip the sample */
-			sample = left_accum[accum_pos];
-#ifdef MIXER_USE_CLIPPING
-			if (sample < -32768)
-				sample = -32768;
-			else if (sample > 32767)
-				sample = 32767;
-#endif
-
 			/* store and zero out behind us */
-			*mix++ = sample;
+			*mix++ = left_accum[accum_pos];
 			left_accum[accum_pos] = 0;
 
 			/* advance to the next sample */
@@ -1159,41 +1196,23 @@ void mixer_sh_update(void)
 		}
 	}
 
-	/* copy the stereo 32-bit data to a 16-bit buffer, clipping along the way */
+	/* copy the stereo 32-bit data to a 16-bit buffer */
 	else
 	{
 		mix = mix_buffer;
 		for (i = 0; (unsigned int)i < samples_this_frame; i++)
 		{
-			/* fetch and clip the left sample */
-			sample = left_accum[accum_pos];
-#ifdef MIXER_USE_CLIPPING
-			if (sample < -32768)
-				sample = -32768;
-			else if (sample > 32767)
-				sample = 32767;
-#endif
 			/* store and zero out behind us */
-			*mix++ = sample;
+			*mix++ = left_accum[accum_pos];
 			left_accum[accum_pos] = 0;
-
-			/* fetch and clip the right sample */
-			sample = right_accum[accum_pos];
-#ifdef MIXER_USE_CLIPPING
-			if (sample < -32768)
-				sample = -32768;
-			else if (sample > 32767)
-				sample = 32767;
-#endif
-
-			/* store and zero out behind us */
-			*mix++ = sample;
+			*mix++ = right_accum[accum_pos];
 			right_accum[accum_pos] = 0;
 
 			/* advance to the next sample */
 			accum_pos = (accum_pos + 1) & ACCUMULATOR_MASK;
 		}
 	}
+#endif
 
 	/* play the result */
 #ifdef MMSND
@@ -1514,6 +1533,16 @@ int mixer_samples_this_frame(void)
 }
 
 
+/***************************************************************************
+	mixer_audio_block
+***************************************************************************/
+
+int mixer_audio_block(void)
+{
+	return audio_block;
+}
+
+
 /***************************************************************************
 	mixer_need_samples_this_frame
 ***************************************************************************/
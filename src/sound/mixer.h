@@ -103,6 +103,7 @@ void mixer_sound_enable_global_w(int enable);
 
 void mixer_play_streamed_sample_16(int channel,INT16 *data,int len,int freq);
 int mixer_samples_this_frame(void);
+int mixer_audio_block(void);
 int mixer_need_samples_this_frame(int channel,int freq);
 void mixer_set_lowpass_frequency(int ch, int freq);
 
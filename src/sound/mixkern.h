@@ -0,0 +1,43 @@
+#ifndef MIXKERN_H
+#define MIXKERN_H
+#if !defined(__GNUC__) || (__GNUC__ == 3 && __GNUC_MINOR__ >= 4) || (__GNUC__ >= 4)	// GCC supports "pragma once" correctly since 3.4
+#pragma once
+#endif
+
+/***************************************************************************
+
+	mixkern.h
+
+	Sample format conversion and accumulation kernels of the mixer.
+
+	All kernels have a plain C version (the _c functions, also used as
+	reference by mixbench) and use SSE2 or NEON where available. The
+	vector versions give exactly the same results as the C ones.
+
+***************************************************************************/
+
+/* which vector unit the kernels were compiled for (for display) */
+extern const char *mixk_simd_name;
+
+/* samples to the -1..1 floats libsamplerate takes (/0x8000 resp. /0x80) */
+void mixk_short_to_float(float *dst, const INT16 *src, unsigned len);
+void mixk_short_to_float_c(float *dst, const INT16 *src, unsigned len);
+void mixk_char_to_float(float *dst, const INT8 *src, unsigned len);
+void mixk_char_to_float_c(float *dst, const INT8 *src, unsigned len);
+
+/*
+	add resampled floats to the 32-bit accumulator: dst += lrint(src * scale) >> 16
+	with src * scale clipped to the INT32 range (scale is volume * 0x800000 for
+	a 0-255 volume, so that is a 16-bit sample)
+*/
+void mixk_add_float(int *dst, const float *src, unsigned len, double scale);
+void mixk_add_float_c(int *dst, const float *src, unsigned len, double scale);
+
+/*
+	clip the accumulator to 16-bit samples and clear it behind us;
+	with right != NULL the samples are stored as left/right pairs
+*/
+void mixk_accum_to_short(INT16 *dst, int *left, int *right, unsigned len);
+void mixk_accum_to_short_c(INT16 *dst, int *left, int *right, unsigned len);
+
+#endif	/* MIXKERN_H */
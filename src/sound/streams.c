@@ -147,7 +147,9 @@ void streams_sh_update(void)
 						buf[i] = stream_buffer[channel+i] + stream_buffer_pos[channel+i];
 					}
 
+					hprof_begin(HPROF_STREAM, (FPTR)channel, channel);
 					(*stream_callback_multi[channel])(stream_param[channel],buf,buflen);
+					hprof_end();
 				}
 
 				for (i = 0;i < stream_joined_channels[channel];i++)
@@ -164,7 +166,9 @@ void streams_sh_update(void)
 
 					buf = stream_buffer[channel] + stream_buffer_pos[channel];
 
+					hprof_begin(HPROF_STREAM, (FPTR)channel, channel);
 					(*stream_callback[channel])(stream_param[channel],buf,buflen);
+					hprof_end();
 				}
 
 				stream_buffer_pos[channel] = 0;
@@ -304,7 +308,9 @@ void stream_update(int channel,int min_interval)
 				buf[i] = stream_buffer[channel+i] + stream_buffer_pos[channel+i];
 
 			profiler_mark(PROFILER_SOUND);
+			hprof_begin(HPROF_STREAM, (FPTR)channel, channel);
 			(*stream_callback_multi[channel])(stream_param[channel],buf,buflen);
+			hprof_end();
 			profiler_mark(PROFILER_END);
 
 			for (i = 0;i < stream_joined_channels[channel];i++)
@@ -317,7 +323,9 @@ void stream_update(int channel,int min_interval)
 			buf = stream_buffer[channel] + stream_buffer_pos[channel];
 
 			profiler_mark(PROFILER_SOUND);
+			hprof_begin(HPROF_STREAM, (FPTR)channel, channel);
 			(*stream_callback[channel])(stream_param[channel],buf,buflen);
+			hprof_end();
 			profiler_mark(PROFILER_END);
 
 			stream_buffer_pos[channel] += buflen;
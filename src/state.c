@@ -217,8 +217,14 @@ static ss_entry *ss_register_entry(const char *module, int instance, const char
 	while((e = *ep) != 0) {
 		int pos = strcmp(e->name, name);
 		if(!pos) {
-			logerror("Duplicate save state registration entry (%s, %d, %s)\n", module, instance, name);
-			return NULL;
+			/* drivers register again after a machine reset, their buffers may have moved */
+			if(e->type != type || e->size != size)
+				logerror("Duplicate save state registration entry (%s, %d, %s)\n", module, instance, name);
+			e->type = type;
+			e->data = data;
+			e->size = size;
+			e->tag  = ss_current_tag;
+			return e;
 		}
 		if(pos>0)
 			break;
@@ -299,11 +305,9 @@ static void ss_register_func(ss_func **root, void (*func)(void))
 	ss_func *next = *root;
 	while (next)
 	{
+		/* same as above, a second registration after a reset is harmless */
 		if (next->func == func && next->tag == ss_current_tag)
-		{
-			logerror("Duplicate save state function (%d, 0x%x)\n", ss_current_tag, (size_t)func);
-			exit(1);
-		}
+			return;
 		next = next->next;
 	}
 	next = *root;
@@ -412,6 +416,8 @@ void state_save_save_continue(void)
 	ss_module *m;
 	ss_func * f;
 	int count = 0;
+	if(!ss_dump_array)
+		return;
 	TRACE(logerror("Saving tag %d\n", ss_current_tag));
 	TRACE(logerror("  calling pre-save functions\n"));
 	f = ss_prefunc_reg;
@@ -446,13 +452,11 @@ void state_save_save_continue(void)
 	}
 }
 
-void state_save_save_finish(void)
+static void ss_write_header(void)
 {
 	UINT32 signature;
 	unsigned char flags = 0;
 
-	TRACE(logerror("Finishing save\n"));
-
 	signature = ss_get_signature();
 	if(!Machine->sample_rate)
 		flags |= SS_NO_SOUND;
@@ -471,30 +475,48 @@ void state_save_save_finish(void)
 	ss_dump_array[0x15] = signature >> 8;
 	ss_dump_array[0x16] = signature >> 16;
 	ss_dump_array[0x17] = signature >> 24;
+}
 
-	mame_fwrite(ss_dump_file, ss_dump_array, ss_dump_size);
+void state_save_save_finish(void)
+{
+	TRACE(logerror("Finishing save\n"));
+
+	if(ss_dump_array) {
+		ss_write_header();
+		mame_fwrite(ss_dump_file, ss_dump_array, ss_dump_size);
+	}
 	free(ss_dump_array);
 	ss_dump_array = 0;
 	ss_dump_size = 0;
 	ss_dump_file = 0;
 }
 
-int state_save_load_begin(mame_file *file)
+/* Finishes a save begun without a file and hands the image to the caller, */
+/* who frees it. NULL if there was no memory for it */
+UINT8 *state_save_save_finish_mem(unsigned *size)
+{
+	UINT8 *data = ss_dump_array;
+
+	TRACE(logerror("Finishing save to memory\n"));
+
+	if(data)
+		ss_write_header();
+	*size = data ? ss_dump_size : 0;
+	ss_dump_array = 0;
+	ss_dump_size = 0;
+	ss_dump_file = 0;
+	return data;
+}
+
+static int ss_load_check(void)
 {
 	ss_module *m;
 	unsigned int offset = 0;
 	UINT32 signature, file_sig;
 
-	TRACE(logerror("Beginning load\n"));
-
 	signature = ss_get_signature();
 
-	ss_dump_size = mame_fsize(file);
-	ss_dump_array = malloc(ss_dump_size);
-	ss_dump_file = file;
-	mame_fread(ss_dump_file, ss_dump_array, ss_dump_size);
-
-	if(memcmp(ss_dump_array, "MAMESAVE", 8)) {
+	if(ss_dump_size < 0x18 || memcmp(ss_dump_array, "MAMESAVE", 8)) {
 		usrintf_showmessage("Error: This is not a mame save file");
 		goto bad;
 	}
@@ -538,13 +560,45 @@ int state_save_load_begin(mame_file *file)
 			}
 		}
 	}
+	if(offset > ss_dump_size) {
+		usrintf_showmessage("Error: Truncated save file");
+		goto bad;
+	}
 	return 0;
 
  bad:
 	free(ss_dump_array);
+	ss_dump_array = 0;
 	return 1;
 }
 
+int state_save_load_begin(mame_file *file)
+{
+	TRACE(logerror("Beginning load\n"));
+
+	ss_dump_size = mame_fsize(file);
+	ss_dump_array = malloc(ss_dump_size);
+	ss_dump_file = file;
+	if(!ss_dump_array)
+		return 1;
+	mame_fread(ss_dump_file, ss_dump_array, ss_dump_size);
+	return ss_load_check();
+}
+
+/* Same from an image of state_save_save_finish_mem, which is copied */
+int state_save_load_begin_mem(const UINT8 *data, unsigned size)
+{
+	TRACE(logerror("Beginning load from memory\n"));
+
+	ss_dump_size = size;
+	ss_dump_array = malloc(size);
+	ss_dump_file = 0;
+	if(!ss_dump_array)
+		return 1;
+	memcpy(ss_dump_array, data, size);
+	return ss_load_check();
+}
+
 void state_save_load_continue(void)
 {
 	ss_module *m;
@@ -36,14 +36,17 @@ void state_save_register_func_postload(void (*func)(void));
 
 /* Save and load functions */
 /* The tags are a hack around the current cpu structures */
+/* Without a file the state goes to memory, see state_save_save_finish_mem */
 void state_save_save_begin(mame_file *file);
 int  state_save_load_begin(mame_file *file);
+int  state_save_load_begin_mem(const UINT8 *data, unsigned size);
 
 void state_save_set_current_tag(int tag);
 void state_save_save_continue(void);
 void state_save_load_continue(void);
 
 void state_save_save_finish(void);
+UINT8 *state_save_save_finish_mem(unsigned *size);
 void state_save_load_finish(void);
 
 /* Display function */
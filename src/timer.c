@@ -28,8 +28,19 @@
 	  burn cycles, because the cores might need to adjust internal
 	  counters or timers.
 
+  Changes for PinMAME:
+	- the timers are kept in a binary heap instead of a sorted list, so
+	  adjusting a timer is O(log n) instead of a walk over all timers
+	- times are kept as 64-bit fixed point ticks (2^32 per second) of
+	  absolute emulated time, so the global time adjustment doesn't touch
+	  every timer anymore; periodic timers are computed from their first
+	  firing, so they don't drift; timers that expire at the same tick
+	  fire in the order they were (re)scheduled
+	- the API still uses seconds as doubles, relative to the global time
+
 ***************************************************************************/
 
+#include <math.h>
 #include "cpuintrf.h"
 #include "driver.h"
 #include "timer.h"
@@ -47,6 +58,15 @@
 #endif
 
 
+/* fixed point emulated time */
+typedef INT64 timer_ticks;
+
+#define TICKS_PER_SEC		4294967296.0	/* 2^32 */
+#define TICKS_NEVER			((timer_ticks)0x7fffffffffffffff)
+#define TICKS_MAX_SEC		(1.0e9)			/* longer durations are TICKS_NEVER */
+#define TICKS_SLOP			((timer_ticks)5)	/* about 1ns, timers this close to now are due */
+
+
 
 /*-------------------------------------------------
 	internal timer structure
@@ -54,16 +74,19 @@
 
 struct _mame_timer
 {
-	struct _mame_timer *next;
-	struct _mame_timer *prev;
+	struct _mame_timer *next;		/* free list */
 	void (*callback)(int);
 	int callback_param;
 	int tag;
 	UINT8 enabled;
 	UINT8 temporary;
+	int heapindex;					/* position in the heap, -1 if not in it */
+	UINT32 seq;						/* orders timers with the same expire time */
 	double period;
-	double start;
-	double expire;
+	timer_ticks periodstart;		/* the first firing with this period */
+	UINT64 periodcount;				/* firings since then */
+	timer_ticks start;
+	timer_ticks expire;
 };
 
 
@@ -76,20 +99,56 @@ struct _mame_timer
 double cycles_to_sec[MAX_CPU];
 double sec_to_cycles[MAX_CPU];
 
-/* list of active timers */
+/* the timers, the enabled ones are in a heap ordered by expire time */
 static mame_timer timers[MAX_TIMERS];
-static mame_timer *timer_head;
+static mame_timer *timer_heap[MAX_TIMERS];
+static int timer_heap_count;
+static UINT32 timer_seq;
 static mame_timer *timer_free_head;
 static mame_timer *timer_free_tail;
 
 /* other internal states */
-static double global_offset;
+static timer_ticks global_ticks;
+static double global_offset;		/* global_ticks in seconds */
 static mame_timer *callback_timer;
 static int callback_timer_modified;
 static double callback_timer_expire_time;
 
 
 
+/*-------------------------------------------------
+	ticks conversion
+-------------------------------------------------*/
+
+INLINE timer_ticks sec_to_ticks(double sec)
+{
+	if (sec >= TICKS_MAX_SEC)
+		return TICKS_NEVER;
+	return (timer_ticks)floor(sec * TICKS_PER_SEC + 0.5);
+}
+
+INLINE double ticks_to_sec(timer_ticks ticks)
+{
+	if (ticks == TICKS_NEVER)
+		return TIME_NEVER;
+	return (double)ticks * (1.0 / TICKS_PER_SEC);
+}
+
+/* absolute time in ticks from a time relative to the global time */
+INLINE timer_ticks relative_to_ticks(double time)
+{
+	timer_ticks ticks = sec_to_ticks(time);
+	return (ticks == TICKS_NEVER) ? TICKS_NEVER : global_ticks + ticks;
+}
+
+/* time relative to the global time from absolute ticks */
+INLINE double ticks_to_relative(timer_ticks ticks)
+{
+	return (ticks == TICKS_NEVER) ? TIME_NEVER : ticks_to_sec(ticks - global_ticks);
+}
+
+
+
 /*-------------------------------------------------
 	get_relative_time - return the current time
 	relative to the global_offset
@@ -136,91 +195,110 @@ INLINE mame_timer *timer_new(void)
 
 
 /*-------------------------------------------------
-	timer_list_insert - insert a new timer into
-	the list at the appropriate location
+	timer_heap_before - heap order: expire time,
+	then (re)scheduling order
 -------------------------------------------------*/
 
-INLINE void timer_list_insert(mame_timer *timer)
+INLINE int timer_heap_before(const mame_timer *a, const mame_timer *b)
 {
-	double expire = timer->enabled ? timer->expire : TIME_NEVER;
-	mame_timer *t, *lt = NULL;
+	if (a->expire != b->expire)
+		return a->expire < b->expire;
+	return (INT32)(a->seq - b->seq) < 0;
+}
 
-	/* sanity checks for the debug build */
-	#ifdef MAME_DEBUG
-	{
-		int tnum = 0;
 
-		/* loop over the timer list */
-		for (t = timer_head; t; t = t->next, tnum++)
-		{
-			if (t == timer)
-				printf("This timer is already inserted in the list!\n");
-			if (tnum == MAX_TIMERS-1)
-				printf("Timer list is full!\n");
-		}
-	}
-	#endif
 
-	/* loop over the timer list */
-	for (t = timer_head; t; lt = t, t = t->next)
+/*-------------------------------------------------
+	timer_heap_up/down - move a heap entry to
+	its place
+-------------------------------------------------*/
+
+INLINE void timer_heap_set(int index, mame_timer *timer)
+{
+	timer_heap[index] = timer;
+	timer->heapindex = index;
+}
+
+static void timer_heap_up(int index)
+{
+	mame_timer *timer = timer_heap[index];
+
+	while (index > 0)
 	{
-		/* if the current list entry expires after us, we should be inserted before it */
-		/* note that due to floating point rounding, we need to allow a bit of slop here */
-		/* because two equal entries -- within rounding precision -- need to sort in */
-		/* the order they were inserted into the list */
-		if ((t->expire - expire) > TIME_IN_NSEC(1))
-		{
-			/* link the new guy in before the current list entry */
-			timer->prev = t->prev;
-			timer->next = t;
+		int parent = (index - 1) / 2;
+		if (!timer_heap_before(timer, timer_heap[parent]))
+			break;
+		timer_heap_set(index, timer_heap[parent]);
+		index = parent;
+	}
+	timer_heap_set(index, timer);
+}
 
-			if (t->prev)
-				t->prev->next = timer;
-			else
-				timer_head = timer;
-			t->prev = timer;
-			return;
-		}
+static void timer_heap_down(int index)
+{
+	mame_timer *timer = timer_heap[index];
+
+	for (;;)
+	{
+		int child = 2 * index + 1;
+		if (child >= timer_heap_count)
+			break;
+		if (child + 1 < timer_heap_count && timer_heap_before(timer_heap[child + 1], timer_heap[child]))
+			child++;
+		if (!timer_heap_before(timer_heap[child], timer))
+			break;
+		timer_heap_set(index, timer_heap[child]);
+		index = child;
 	}
+	timer_heap_set(index, timer);
+}
 
-	/* need to insert after the last one */
-	if (lt)
-		lt->next = timer;
-	else
-		timer_head = timer;
-	timer->prev = lt;
-	timer->next = NULL;
+
+
+/*-------------------------------------------------
+	timer_list_insert - insert a timer into the
+	heap if it is enabled
+-------------------------------------------------*/
+
+INLINE void timer_list_insert(mame_timer *timer)
+{
+	/* sanity checks for the debug build */
+	#ifdef MAME_DEBUG
+	if (timer->heapindex >= 0)
+		printf("This timer is already inserted in the list!\n");
+	#endif
+
+	/* disabled timers never fire, they don't need to be in the heap */
+	if (!timer->enabled || timer->expire == TICKS_NEVER)
+		return;
+
+	timer->seq = timer_seq++;
+	timer_heap_set(timer_heap_count++, timer);
+	timer_heap_up(timer->heapindex);
 }
 
 
 
 /*-------------------------------------------------
 	timer_list_remove - remove a timer from the
-	linked list
+	heap
 -------------------------------------------------*/
 
 INLINE void timer_list_remove(mame_timer *timer)
 {
-	/* sanity checks for the debug build */
-	#ifdef MAME_DEBUG
-	{
-		mame_timer *t;
-		int tnum = 0;
+	int index = timer->heapindex;
 
-		/* loop over the timer list */
-		for (t = timer_head; t && t != timer; t = t->next, tnum++) ;
-		if (t == NULL)
-			printf ("timer not found in list");
-	}
-	#endif
+	if (index < 0)
+		return;
+	timer->heapindex = -1;
 
-	/* remove it from the list */
-	if (timer->prev)
-		timer->prev->next = timer->next;
-	else
-		timer_head = timer->next;
-	if (timer->next)
-		timer->next->prev = timer->prev;
+	/* move the last entry into the hole and restore the order */
+	if (--timer_heap_count > index)
+	{
+		timer_heap_set(index, timer_heap[timer_heap_count]);
+		timer_heap_up(index);
+		timer_heap_down(timer_heap[index]->heapindex);
+	}
 }
 
 
@@ -234,21 +312,26 @@ void timer_init(void)
 	int i;
 
 	/* we need to wait until the first call to timer_cyclestorun before using real CPU times */
+	global_ticks = 0;
 	global_offset = 0.0;
 	callback_timer = NULL;
 	callback_timer_modified = 0;
 
 	/* reset the timers */
 	memset(timers, 0, sizeof(timers));
+	timer_heap_count = 0;
+	timer_seq = 0;
 
 	/* initialize the lists */
-	timer_head = NULL;
 	timer_free_head = &timers[0];
 	for (i = 0; i < MAX_TIMERS-1; i++)
 	{
 		timers[i].tag = -1;
+		timers[i].heapindex = -1;
 		timers[i].next = &timers[i+1];
 	}
+	timers[MAX_TIMERS-1].tag = -1;
+	timers[MAX_TIMERS-1].heapindex = -1;
 	timers[MAX_TIMERS-1].next = NULL;
 	timer_free_tail = &timers[MAX_TIMERS-1];
 }
@@ -263,18 +346,12 @@ void timer_init(void)
 void timer_free(void)
 {
 	int tag = get_resource_tag();
-	mame_timer *timer, *next;
-
-	/* scan the list */
-	for (timer = timer_head; timer != NULL; timer = next)
-	{
-		/* prefetch the next timer in case we remove this one */
-		next = timer->next;
+	int i;
 
-		/* if this tag matches, remove it */
-		if (timer->tag == tag)
-			timer_remove(timer);
-	}
+	/* scan all the timers */
+	for (i = 0; i < MAX_TIMERS; i++)
+		if (timers[i].tag != -1 && timers[i].tag == tag)
+			timer_remove(&timers[i]);
 }
 
 
@@ -287,7 +364,9 @@ void timer_free(void)
 double timer_time_until_next_timer(void)
 {
 	double time = get_relative_time();
-	return timer_head->expire - time;
+	if (timer_heap_count == 0)
+		return TIME_NEVER;
+	return ticks_to_relative(timer_heap[0]->expire) - time;
 }
 
 
@@ -301,47 +380,44 @@ void timer_adjust_global_time(double delta)
 {
 	mame_timer *timer;
 
-	/* add the delta to the global offset */
-	global_offset += delta;
+	/* move the global time, the timers are absolute and stay where they are */
+	global_ticks += sec_to_ticks(delta);
+	global_offset = ticks_to_sec(global_ticks);
 
-	/* scan the list and adjust the times */
-	for (timer = timer_head; timer != NULL; timer = timer->next)
-	{
-		timer->start -= delta;
-		timer->expire -= delta;
-	}
-
-	LOG(("timer_adjust_global_time: delta=%.9f head->expire=%.9f\n", delta, timer_head->expire));
+	LOG(("timer_adjust_global_time: delta=%.9f head->expire=%.9f\n", delta, timer_heap_count ? ticks_to_relative(timer_heap[0]->expire) : TIME_NEVER));
 
 	/* now process any timers that are overdue */
-	while (timer_head->expire < TIME_IN_NSEC(1))
+	while (timer_heap_count && timer_heap[0]->expire < global_ticks + TICKS_SLOP)
 	{
-		int was_enabled = timer_head->enabled;
+		int was_enabled;
 
 		/* if this is a one-shot timer, disable it now */
-		timer = timer_head;
+		timer = timer_heap[0];
+		was_enabled = timer->enabled;
 		if (timer->period == 0)
 			timer->enabled = 0;
 
 		/* set the global state of which callback we're in */
 		callback_timer_modified = 0;
 		callback_timer = timer;
-		callback_timer_expire_time = timer->expire;
+		callback_timer_expire_time = ticks_to_relative(timer->expire);
 
 		/* call the callback */
 		if (was_enabled && timer->callback)
 		{
-			LOG(("Timer %08X fired (expire=%.9f)\n", (UINT32)timer, timer->expire));
+			LOG(("Timer %08X fired (expire=%.9f)\n", (UINT32)timer, callback_timer_expire_time));
 			profiler_mark(PROFILER_TIMER_CALLBACK);
+			hprof_begin(HPROF_TIMER, timer->callback, 0);
 			(*timer->callback)(timer->callback_param);
+			hprof_end();
 			profiler_mark(PROFILER_END);
 		}
 
 		/* clear the callback timer global */
 		callback_timer = NULL;
 
-		/* reset or remove the timer, but only if it wasn't modified during the callback */
-		if (!callback_timer_modified)
+		/* reset or remove the timer, but only if it wasn't modified (or removed) during the callback */
+		if (!callback_timer_modified && timer->tag != -1)
 		{
 			/* if the timer is temporary, remove it now */
 			if (timer->temporary)
@@ -350,8 +426,14 @@ void timer_adjust_global_time(double delta)
 			/* otherwise, reschedule it */
 			else
 			{
+				/* from the first firing, so the rounding of the period doesn't add up */
 				timer->start = timer->expire;
-				timer->expire += timer->period;
+				timer->periodcount++;
+				timer->expire = sec_to_ticks((double)timer->periodcount * timer->period);
+				if (timer->expire != TICKS_NEVER && timer->periodstart != TICKS_NEVER)
+					timer->expire += timer->periodstart;
+				else
+					timer->expire = TICKS_NEVER;
 
 				timer_list_remove(timer);
 				timer_list_insert(timer);
@@ -383,11 +465,13 @@ mame_timer *timer_alloc(void (*callback)(int))
 	timer->temporary = 0;
 	timer->tag = get_resource_tag();
 	timer->period = 0;
+	timer->periodstart = 0;
+	timer->periodcount = 0;
 
-	/* compute the time of the next firing and insert into the list */
-	timer->start = time;
-	timer->expire = TIME_NEVER;
-	timer_list_insert(timer);
+	/* it doesn't fire until it is adjusted */
+	timer->start = relative_to_ticks(time);
+	timer->expire = TICKS_NEVER;
+	timer->heapindex = -1;
 
 	/* return a handle */
 	return timer;
@@ -418,17 +502,19 @@ void timer_adjust(mame_timer *which, double duration, int param, double period)
 		duration = 0.;
 
 	/* set the start and expire times */
-	which->start = time;
-	which->expire = time + duration;
+	which->start = relative_to_ticks(time);
+	which->expire = (duration >= TICKS_MAX_SEC) ? TICKS_NEVER : relative_to_ticks(time + duration);
 	which->period = period;
+	which->periodstart = which->expire;
+	which->periodcount = 0;
 
 	/* remove and re-insert the timer in its new order */
 	timer_list_remove(which);
 	timer_list_insert(which);
 
 	/* if this was inserted as the head, abort the current timeslice and resync */
-LOG(("timer_adjust %08X to expire @ %.9f\n", (UINT32)which, which->expire));
-	if (which == timer_head && cpu_getexecutingcpu() >= 0)
+LOG(("timer_adjust %08X to expire @ %.9f\n", (UINT32)which, ticks_to_relative(which->expire)));
+	if (which->heapindex == 0 && cpu_getexecutingcpu() >= 0)
 		activecpu_abort_timeslice();
 }
 
@@ -547,7 +633,7 @@ int timer_enable(mame_timer *which, int enable)
 double timer_timeelapsed(mame_timer *which)
 {
 	double time = get_relative_time();
-	return time - which->start;
+	return time - ticks_to_relative(which->start);
 }
 
 
@@ -560,7 +646,9 @@ double timer_timeelapsed(mame_timer *which)
 double timer_timeleft(mame_timer *which)
 {
 	double time = get_relative_time();
-	return which->expire - time;
+	if (which->expire == TICKS_NEVER)
+		return TIME_NEVER;
+	return ticks_to_relative(which->expire) - time;
 }
 
 
@@ -583,7 +671,7 @@ double timer_get_time(void)
 
 double timer_starttime(mame_timer *which)
 {
-	return global_offset + which->start;
+	return ticks_to_sec(which->start);
 }
 
 
@@ -595,13 +683,13 @@ double timer_starttime(mame_timer *which)
 
 double timer_firetime(mame_timer *which)
 {
-	return global_offset + which->expire;
+	return ticks_to_sec(which->expire);
 }
 
 #ifdef PINMAME
 double timer_expire(mame_timer *which)
 {
-	return which->expire;
+	return ticks_to_relative(which->expire);
 }
 int timer_param(mame_timer *which)
 {
@@ -170,6 +170,9 @@ static DWORD WINAPI AuditThreadProc(LPVOID hDlg)
 {
 	char buffer[200];
 
+	/* romhash.cfg is written once, at the end */
+	AuditBegin();
+
 	while (!bCancel)
 	{
 		if (!bPaused)
@@ -195,11 +198,13 @@ static DWORD WINAPI AuditThreadProc(LPVOID hDlg)
 					sprintf(buffer, "%s", "File Audit");
 					SetWindowText(hDlg, buffer);
 					EnableWindow(GetDlgItem(hDlg, IDPAUSE), FALSE);
+					AuditEnd();
 					ExitThread(1);
 				}
 			}
 		}
 	}
+	AuditEnd();
 	return 0;
 }
 
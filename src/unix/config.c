@@ -36,6 +36,7 @@ static int use_fuzzycmp = 1;
 static int loadconfig = 1;
 static char *language = NULL;
 static char *gamename = NULL;
+static int got_gamename = 0;
 char *rompath_extra = NULL;
 #ifndef MESS
 static char *defaultgamename;
@@ -88,6 +89,13 @@ struct rc_option pinmame_opts[] = {
 	{ "dmd_only",	NULL, rc_bool,&pmoptions.dmd_only,    "0",  0, 0,   NULL, "Show only DMD" },
 	{ "dmd_compact",NULL, rc_bool,&pmoptions.dmd_compact, "0",  0, 0,   NULL, "Show compact display" },
 	{ "dmd_antialias",NULL, rc_int,&pmoptions.dmd_antialias,  "50", 0, 100, NULL, "DMD antialias intensity [%]" },
+	{ "shmout",     NULL, rc_string, &shmout_name, NULL, 0, 0, NULL, "Publish DMD, segments and lamps in this POSIX shared memory object (see src/unix/shmout.h)" },
+	{ "dmdcapture", NULL, rc_string, &pmoptions.dmd_capture, NULL, 0, 0, NULL, "Record the DMD frames to this file (see dmdplay)" },
+	{ "warp_switch",NULL, rc_int, &pmoptions.warp_switch, "0", 0, 1000, NULL, "Fast forward after a reset until this switch is set (0 = off)" },
+	{ "warp_dmd",   NULL, rc_string, &pmoptions.warp_dmd, NULL, 0, 0, NULL, "Fast forward after a reset until the DMD shows the frame with this hash (see dmdplay -hash)" },
+	{ "swrecord",   NULL, rc_string, &pmoptions.sw_record, NULL, 0, 0, NULL, "Record the switch changes (e.g. of -batch_switches) with their emulated time to this file" },
+	{ "swreplay",   NULL, rc_string, &pmoptions.sw_replay, NULL, 0, 0, NULL, "Set the switches at the same emulated time as in this -swrecord file" },
+	{ "at91jit",    NULL, rc_int, &options.at91jit,    "1", 0, 33554432, NULL, "at91 CPU JIT compiler enabled (0 = interpreter only)" },
 #ifdef PROC_SUPPORT
 	{ "alpha_on_dmd",NULL, rc_bool,&pmoptions.alpha_on_dmd, "0",  0, 0, NULL, "Emulate alphanumeric display on DMD" },
 	{ "p-roc",NULL, rc_string,&pmoptions.p_roc, "None",  0, 0, NULL, "YAML Machine description file" },
@@ -131,7 +139,14 @@ static struct rc_option opts[] = {
 	{ "cheat", "c", rc_bool, &options.cheat, "0", 0, 0, NULL, "Enable/disable cheat subsystem" },
 	{ "skip_disclaimer", NULL, rc_bool, &options.skip_disclaimer, "0", 0, 0, NULL, "Skip displaying the disclaimer screen" },
 	{ "skip_gameinfo", NULL, rc_bool, &options.skip_gameinfo, "0", 0, 0, NULL, "Skip displaying the game info screen" },
+	{ "warp", NULL, rc_float, &options.warp, "0", 0, 3600, NULL, "Fast forward (no video, sound or throttling) this many emulated seconds after a reset (the longest fast forward with -warp_switch/-warp_dmd)" },
+	{ "bootsnapshot", NULL, rc_bool, &options.bootsnapshot, "0", 0, 0, NULL, "Save the machine when the first warp ends and start from there next time (state directory)" },
+	{ "rewind", NULL, rc_int, &options.rewind, "0", 0, 4095, NULL, "Keep this many MB of recent save states in memory to go back to with the Rewind key (0 = off)" },
+	{ "rewind_interval", NULL, rc_int, &options.rewind_interval, "60", 1, 3600, NULL, "Frames between two rewind states" },
+	{ "idleskip", NULL, rc_bool, &options.idleskip, "1", 0, 0, NULL, "Skip the time the 8-bit CPUs spend in loops that wait for an interrupt or a RAM change" },
+	{ "hprof", NULL, rc_string, &options.hprof, NULL, 0, 0, NULL, "Profile the emulation and write the result to this file (.json = Chrome trace, else folded stacks for flamegraph.pl)" },
 	{ "crconly", NULL, rc_bool, &options.crc_only, "0", 0, 0, NULL, "Use only CRC for all integrity checks" },
+	{ "hashcache", NULL, rc_bool, &options.hash_cache, "1", 0, 0, NULL, "Remember the checksums of unchanged ROM files (romhash.cfg in the cfg directory)" },
 	{ "bios", NULL, rc_string, &options.bios, "default", 0, 14, NULL, "change system bios" },
 #ifdef MAME_DEBUG
 	{ "debug", "d", rc_bool, &options.mame_debug, NULL, 0, 0, NULL, "Enable/disable debugger" },
@@ -196,8 +211,6 @@ static int config_printf(const char *fmt, ...)
 
 static int config_handle_arg(char *arg)
 {
-	static int got_gamename = 0;
-
 	if (!got_gamename) /* notice: for MESS game means system */
 	{
 		gamename     = arg;
@@ -257,6 +270,8 @@ int config_init (int argc, char *argv[])
 	int i;
 
 	memset(&options,0,sizeof(options));
+	gamename = NULL;
+	got_gamename = 0;
 
 	/* reset trackball devices */
 #ifdef USE_XINPUT_DEVICES
@@ -668,10 +683,12 @@ void config_exit(void)
 		sysdep_mixer_exit();
 		sysdep_dsp_exit();
 		rc_destroy(rc);
+		rc = NULL;
 	}
 
 	if(home_dir)
 		free(home_dir);
+	home_dir = NULL;
 
 	/* close open files */
 	if (options.playback)
@@ -5,9 +5,13 @@
 /*============================================================ */
 
 #include <stdarg.h>
+#include <limits.h>
 #include "xmame.h"
 #include "osdutils.h"
 #include "unzip.h"
+#ifdef _POSIX_MAPPED_FILES
+#include <sys/mman.h>
+#endif
 #ifdef MESS
 #include "image.h"
 #endif
@@ -15,9 +19,12 @@
 
 #define VERBOSE				0
 
-#define MAX_OPEN_FILES		16
 #define FILE_BUFFER_SIZE	256
 
+#ifndef PATH_MAX
+#define PATH_MAX			1024
+#endif
+
 
 /*============================================================ */
 /*	EXTERNALS */
@@ -58,7 +65,6 @@ struct _osd_file
 };
 
 static struct pathdata pathlist[FILETYPE_end];
-static osd_file openfile[MAX_OPEN_FILES];
 
 
 
@@ -457,20 +463,14 @@ osd_file *osd_fopen(int pathtype, int pathindex, const char *filename, const cha
 {
 	char fullpath[1024];
 	osd_file *file;
-	int i;
 	int offs;
 
-	/* find an empty file pointer */
-	for (i = 0; i < MAX_OPEN_FILES; i++)
-		if (openfile[i].fileptr == NULL)
-			break;
-	if (i == MAX_OPEN_FILES)
+	/* allocate a file record; not from a static table, the ROM audit opens
+	   files from several threads */
+	file = calloc(1, sizeof(*file));
+	if (file == NULL)
 		return NULL;
 
-	/* zap the file record */
-	file = &openfile[i];
-	memset(file, 0, sizeof(*file));
-
 	/* compose the full path */
 	compose_path(fullpath, pathtype, pathindex, filename);
 
@@ -479,8 +479,11 @@ osd_file *osd_fopen(int pathtype, int pathindex, const char *filename, const cha
 	if (file->fileptr == NULL)
 	{
 		/* if it's read-only, or if the path exists, then that's final */
-		if (!(strchr(mode, 'w')) || errno != EACCES)
+		if (!(strchr(mode, 'w')) || (errno != EACCES && errno != ENOENT))
+		{
+			free(file);
 			return NULL;
+		}
 
 		/* create the path and try again */
 		create_path(fullpath, 1);
@@ -488,7 +491,10 @@ osd_file *osd_fopen(int pathtype, int pathindex, const char *filename, const cha
 
 		/* if that doesn't work, we give up */
 		if (file->fileptr == NULL)
+		{
+			free(file);
 			return NULL;
+		}
 	}
 
 	/* get the file size */
@@ -654,10 +660,73 @@ UINT32 osd_fwrite(osd_file *file, const void *buffer, UINT32 length)
 
 void osd_fclose(osd_file *file)
 {
-	/* close the handle and clear it out */
+	/* close the handle and free the record */
 	if (file->fileptr)
 		fclose(file->fileptr);
-	file->fileptr = NULL;
+	free(file);
+}
+
+
+
+/*============================================================ */
+/*	osd_get_file_stamp */
+/*============================================================ */
+
+int osd_get_file_stamp(int pathtype, int pathindex, const char *filename, struct osd_file_stamp *stamp)
+{
+	struct stat buf;
+	char fullpath[1024];
+	char realname[PATH_MAX];
+
+	/* compose the full path */
+	compose_path(fullpath, pathtype, pathindex, filename);
+	if (stat(fullpath, &buf) || !S_ISREG(buf.st_mode))
+		return 0;
+
+	/* the same file may be found through different rompaths, so use the absolute name */
+	if (realpath(fullpath, realname) && strlen(realname) < sizeof(stamp->name))
+		strcpy(stamp->name, realname);
+	else
+		strcpy(stamp->name, fullpath);
+	stamp->size = buf.st_size;
+	stamp->mtime = buf.st_mtime;
+	return 1;
+}
+
+
+
+/*============================================================ */
+/*	osd_fmap */
+/*============================================================ */
+
+const void *osd_fmap(osd_file *file, UINT64 *length)
+{
+#ifdef _POSIX_MAPPED_FILES
+	void *data;
+
+	if (file->end <= 0)
+		return NULL;
+	data = mmap(NULL, file->end, PROT_READ, MAP_PRIVATE, fileno(file->fileptr), 0);
+	if (data == MAP_FAILED)
+		return NULL;
+	*length = file->end;
+	return data;
+#else
+	return NULL;
+#endif
+}
+
+
+
+/*============================================================ */
+/*	osd_funmap */
+/*============================================================ */
+
+void osd_funmap(const void *data, UINT64 length)
+{
+#ifdef _POSIX_MAPPED_FILES
+	munmap((void *)data, length);
+#endif
 }
 
 
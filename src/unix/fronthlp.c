@@ -9,6 +9,7 @@ static int frontend_list_clones(char *gamename);
 static int frontend_list_cpu(void);
 static int frontend_list_gamelistheader(void);
 static int frontend_list_hash(int type);
+static void frontend_verify_status(int driver, int rom, int status);
 
 static int list       = 0;
 static int showclones = 1;
@@ -17,6 +18,8 @@ static int correct    = 0;
 static int incorrect  = 0;
 static int not_found  = 0;
 static int sortby     = 0;
+static int auditthreads = 0;
+static int auditjson  = 0;
 
 enum {
 	/* standard list commands */
@@ -59,6 +62,8 @@ struct rc_option frontend_list_opts[] = {
 #endif   
 	{ "verifyroms", "vr", rc_set_int, &list, NULL, VERIFY_ROMS, 0, NULL, "Verify ROMs for games matching gamename, or all, gamename may contain * and ? wildcards" },
 	{ "verifyromsets", "vrs", rc_set_int, &list, NULL, VERIFY_ROMSETS, 0, NULL, "Like -verifyroms, but less verbose" },
+	{ "auditthreads", "at", rc_int, &auditthreads, "0", 0, 64, NULL, "Number of threads checking romsets for -verifyroms(ets) (0 = one per CPU)" },
+	{ "auditjson", "aj", rc_bool, &auditjson, "0", 0, 0, NULL, "Make -verifyroms(ets) print one JSON object per romset" },
 #if (HAS_SAMPLES)
 	{ "verifysamples", "vs", rc_set_int, &list, NULL, VERIFY_SAMPLES, 0, NULL, "Like -verifyroms but verify audio samples instead" },
 	{ "verifysamplesets", "vss", rc_set_int, &list, NULL, VERIFY_SAMPLESETS, 0, NULL, "Like -verifysamples, but less verbose" },
@@ -169,6 +174,12 @@ static void frontend_verify(int driver, int rom)
 	else
 		status = VerifySampleSet(driver, (verify_printf_proc)myprintf);
 
+	frontend_verify_status(driver, rom, status);
+}
+
+/* the status of a romset, see frontend_verify */
+static void frontend_verify_status(int driver, int rom, int status)
+{
 	if (verbose)
 		fprintf(stdout_file, "%s %s ", rom? "romset":"sampleset",
 				drivers[driver]->name);
@@ -198,6 +209,44 @@ static void frontend_verify(int driver, int rom)
 	fflush(stdout_file);
 }
 
+static int CLIB_DECL json_printf(const char *fmt, ...)
+{
+	int i;
+	va_list args;
+
+	va_start(args, fmt);
+	i = vfprintf(stdout_file, fmt, args);
+	va_end(args);
+	return i;
+}
+
+static int CLIB_DECL quiet_printf(const char *fmt, ...)
+{
+	return 0;
+}
+
+/* called by AuditRomSets in the order of the drivers */
+static void frontend_verify_report(int driver, const tAuditRecord *aud, int count, void *param)
+{
+	int status;
+
+	if (auditjson)
+	{
+		status = VerifyAuditRecords(driver, aud, count, (verify_printf_proc)quiet_printf);
+		VerifyRomSetJSON(driver, aud, count, status, (verify_printf_proc)json_printf);
+		switch (status)
+		{
+			case BEST_AVAILABLE: case CORRECT: correct++; break;
+			case NOTFOUND: case CLONE_NOTFOUND: not_found++; break;
+			case INCORRECT: incorrect++; break;
+		}
+		fflush(stdout_file);
+		return;
+	}
+	status = VerifyAuditRecords(driver, aud, count, (verify_printf_proc)myprintf);
+	frontend_verify_status(driver, 1, status);
+}
+
 static int frontend_uses_roms(int driver)
 {
 	const struct RomModule *region, *rom;
@@ -298,6 +347,9 @@ int frontend_list(char *gamename)
 	struct InternalMachineDriver drv;
 	int matching     = 0;
 	int skipped      = 0;
+	int *verify_games = NULL;
+	int verify_count = 0;
+	FILE *summary_file = stdout_file;
 
 	if (!gamename)
 		gamename = "";
@@ -347,7 +399,11 @@ int frontend_list(char *gamename)
 			break;
 	}
 
-	fprintf(stdout_file, header[list-1]);
+	/* keep the JSON output clean */
+	if (auditjson && (list == VERIFY_ROMS || list == VERIFY_ROMSETS))
+		summary_file = stderr_file;
+	else
+		fprintf(stdout_file, header[list-1]);
 
 	for (i=0;drivers[i];i++)
 	{
@@ -636,11 +692,25 @@ int frontend_list(char *gamename)
 					verbose = 0;
 					/* fall through */
 				case VERIFY_ROMS:
-					/* ignore games that need no roms */
+					/* ignore games that need no roms, check the others
+					   all at once after the loop */
 					if (!frontend_uses_roms(i))
 						skipped++;
 					else
-						frontend_verify(i, 1);
+					{
+						if (!verify_games)
+						{
+							for (j = i; drivers[j]; j++)
+								;
+							verify_games = malloc(j * sizeof(*verify_games));
+							if (!verify_games)
+							{
+								fprintf(stderr_file, "Error: out of memory\n");
+								return 1;
+							}
+						}
+						verify_games[verify_count++] = i;
+					}
 					break;
 
 					/*** internal verification list commands (developers only) ***/
@@ -867,6 +937,11 @@ int frontend_list(char *gamename)
 		}
 	}
 
+	/* check the romsets, in parallel */
+	if (verify_count)
+		AuditRomSets(verify_games, verify_count, auditthreads, frontend_verify_report, NULL);
+	free(verify_games);
+
 	/* print footer for those -list options which need one */
 	switch(list)
 	{
@@ -887,20 +962,20 @@ int frontend_list(char *gamename)
 		return 1;
 	}
 
-	fprintf(stdout_file, "\n\n");
-	fprintf(stdout_file, "Total Supported: %d", i);
+	fprintf(summary_file, "\n\n");
+	fprintf(summary_file, "Total Supported: %d", i);
 	if (matching != i)
 	{
-		fprintf(stdout_file, ", Matching \"%s\": %d\n", gamename, matching);
+		fprintf(summary_file, ", Matching \"%s\": %d\n", gamename, matching);
 	}
 	else
 	{
-		fprintf(stdout_file, "\n");
+		fprintf(summary_file, "\n");
 	}
-	if (skipped) fprintf(stdout_file, "Displayed: %d, Skipped: %d, because they don't use any roms/samples/devices\n", matching-skipped, skipped);
-	if (correct+incorrect) fprintf(stdout_file, "Found: %d, of which %d correct and %d incorrect\n", correct+incorrect, correct, incorrect);
-	if (not_found) fprintf(stdout_file, "Not found: %d\n", not_found);
-	fflush(stdout_file);
+	if (skipped) fprintf(summary_file, "Displayed: %d, Skipped: %d, because they don't use any roms/samples/devices\n", matching-skipped, skipped);
+	if (correct+incorrect) fprintf(summary_file, "Found: %d, of which %d correct and %d incorrect\n", correct+incorrect, correct, incorrect);
+	if (not_found) fprintf(summary_file, "Not found: %d\n", not_found);
+	fflush(summary_file);
 
 	if (incorrect > 0)
 		return 2;
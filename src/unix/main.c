@@ -26,6 +26,9 @@ int osd_init(void)
 	if (osd_net_init()      !=OSD_OK) return OSD_NOT_OK;
 #endif	
 	if (osd_input_initpre() !=OSD_OK) return OSD_NOT_OK;
+#ifdef PINMAME
+	if (shmout_open()       !=OSD_OK) return OSD_NOT_OK;
+#endif
 
 	return OSD_OK;
 }
@@ -39,9 +42,14 @@ void osd_exit(void)
 	osd_net_close();
 #endif
 	osd_input_close();
+#ifdef PINMAME
+	shmout_close();
+#endif
 }
 
 
+/* libpinmame runs the same start-up from its own thread, see src/libpinmame */
+#ifndef LIBPINMAME
 int main(int argc, char **argv)
 {
 	int res, res2;
@@ -112,3 +120,4 @@ leave:
 
 	return res;
 }
+#endif /* LIBPINMAME */
@@ -0,0 +1,186 @@
+/*
+ shmout.c - publish the DMD, segments and lamps in POSIX shared memory
+
+ Enabled with -shmout <name>. See shmout.h for the layout and for how
+ a display program reads it. The emulation never waits for a reader:
+ every channel is triple buffered and each slot carries a sequence
+ number that is odd while the slot is being rewritten.
+ */
+
+#include <stddef.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "xmame.h"
+#include "driver.h"
+#include "wpc/core.h"
+#include "shmout.h"
+
+#if SHMOUT_SEGCOUNT != CORE_SEGCOUNT || SHMOUT_LAMPCOLS != CORE_MAXLAMPCOL || \
+    SHMOUT_RGBLAMPS != CORE_MAXRGBLAMPS || SHMOUT_MAXGI != CORE_MAXGI || \
+    SHMOUT_DMD_MAXX != DMD_MAXX || SHMOUT_DMD_MAXY != DMD_MAXY
+#error shmout.h does not match core.h
+#endif
+
+#ifdef __GNUC__
+#define shmout_barrier() __sync_synchronize()
+#else
+#define shmout_barrier()
+#endif
+
+char *shmout_name = NULL;
+
+static shmout_tHeader *shm = NULL;
+static char shm_path[256];
+/* state is collected here and compared to the current slot */
+static shmout_tState state;
+
+/* start rewriting a slot, readers of it will retry */
+static void shmout_begin(volatile unsigned int *seq)
+{
+	(*seq)++;
+	shmout_barrier();
+}
+
+/* the slot is complete, make it the current one */
+static void shmout_end(volatile unsigned int *seq, volatile unsigned int *hdrSlot,
+		volatile unsigned int *hdrSeq, int slot)
+{
+	shmout_barrier();
+	(*seq)++;
+	shmout_barrier();
+	*hdrSlot = slot;
+	(*hdrSeq)++;
+}
+
+int shmout_open(void)
+{
+	int fd;
+
+	if (!shmout_name || !*shmout_name)
+		return OSD_OK;
+
+	snprintf(shm_path, sizeof(shm_path), "/%s", shmout_name);
+	if ((fd = shm_open(shm_path, O_CREAT | O_RDWR, 0644)) < 0)
+	{
+		fprintf(stderr_file, "shmout: can't open shared memory %s\n",
+				shm_path);
+		return OSD_NOT_OK;
+	}
+	if (ftruncate(fd, sizeof(shmout_tHeader)) < 0 ||
+			(shm = mmap(NULL, sizeof(shmout_tHeader),
+				PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED)
+	{
+		fprintf(stderr_file, "shmout: can't map shared memory %s\n",
+				shm_path);
+		shm = NULL;
+		close(fd);
+		return OSD_NOT_OK;
+	}
+	/* the mapping stays valid without the descriptor */
+	close(fd);
+
+	/* readers check the magic, so set that up last */
+	shm->magic = 0;
+	shmout_barrier();
+	memset(shm, 0, sizeof(shmout_tHeader));
+	shm->version = SHMOUT_VERSION;
+	shm->size = sizeof(shmout_tHeader);
+	strncpy(shm->gameName, Machine->gamedrv->name, sizeof(shm->gameName)-1);
+	shm->running = 1;
+	memset(&state, 0, sizeof(state));
+	shmout_barrier();
+	shm->magic = SHMOUT_MAGIC;
+
+	fprintf(stderr_file, "shmout: publishing to %s\n", shm_path);
+	return OSD_OK;
+}
+
+void shmout_close(void)
+{
+	if (!shm)
+		return;
+
+	/* leave the object behind, display programs may still have it open */
+	shm->running = 0;
+	munmap(shm, sizeof(shmout_tHeader));
+	shm = NULL;
+}
+
+/* called by core.c for every DMD update */
+void shmout_updateDMD(int width, int height, int levels, tDMDDot dotCol,
+		int rawFrames, const UINT8 *raw)
+{
+	const shmout_tDMD *curr;
+	shmout_tDMD *next;
+	int slot, ii;
+
+	if (!shm || width > DMD_MAXX || height > DMD_MAXY)
+		return;
+
+	/* only publish frames that differ from the current one */
+	curr = &shm->dmd[shm->dmdSlot];
+	if (shm->dmdSeq && curr->width == width && curr->height == height &&
+			curr->levels == levels)
+	{
+		for (ii = 0; ii < height; ii++)
+			if (memcmp(&curr->dots[ii*width], &dotCol[ii+1][0], width))
+				break;
+		if (ii == height)
+			return;
+	}
+
+	slot = (shm->dmdSlot + 1) % SHMOUT_SLOTS;
+	next = &shm->dmd[slot];
+	shmout_begin(&next->seq);
+	next->frameNo = shm->dmdSeq + 1;
+	next->time = timer_get_time();
+	next->width = width;
+	next->height = height;
+	next->levels = levels;
+	for (ii = 0; ii < height; ii++)
+		memcpy(&next->dots[ii*width], &dotCol[ii+1][0], width);
+	/* raw sub-frames are only there for the 1 bit/dot hardware */
+	if (raw && rawFrames > 0 && rawFrames * width * height / 8 <= SHMOUT_RAW_SIZE)
+	{
+		next->rawFrames = rawFrames;
+		memcpy(next->raw, raw, rawFrames * width * height / 8);
+	}
+	else
+		next->rawFrames = 0;
+	shmout_end(&next->seq, &shm->dmdSlot, &shm->dmdSeq, slot);
+}
+
+/* called by core.c once per vblank */
+void shmout_updateState(void)
+{
+	const UINT64 allSol = core_getAllSol();
+	shmout_tState *next;
+	int slot;
+
+	if (!shm)
+		return;
+
+	state.solenoids[0] = (unsigned int)allSol;
+	state.solenoids[1] = (unsigned int)(allSol >> 32);
+	memcpy(state.gi, (const void *)coreGlobals.gi, sizeof(state.gi));
+	memcpy(state.seg, coreGlobals.drawSeg, sizeof(state.seg));
+	memcpy(state.lampMatrix, (const void *)coreGlobals.lampMatrix, sizeof(state.lampMatrix));
+	memcpy(state.RGBlamps, (const void *)coreGlobals.RGBlamps, sizeof(state.RGBlamps));
+
+	/* only publish changes */
+	if (shm->stateSeq && memcmp(&state.solenoids,
+				(const void *)&shm->state[shm->stateSlot].solenoids,
+				sizeof(shmout_tState) - offsetof(shmout_tState, solenoids)) == 0)
+		return;
+
+	slot = (shm->stateSlot + 1) % SHMOUT_SLOTS;
+	next = &shm->state[slot];
+	shmout_begin(&next->seq);
+	memcpy(&next->solenoids, &state.solenoids,
+			sizeof(shmout_tState) - offsetof(shmout_tState, solenoids));
+	next->frameNo = shm->stateSeq + 1;
+	next->time = timer_get_time();
+	shmout_end(&next->seq, &shm->stateSlot, &shm->stateSeq, slot);
+}
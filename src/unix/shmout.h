@@ -0,0 +1,75 @@
+#ifndef INC_SHMOUT
+#define INC_SHMOUT
+#if !defined(__GNUC__) || (__GNUC__ == 3 && __GNUC_MINOR__ >= 4) || (__GNUC__ >= 4)	// GCC supports "pragma once" correctly since 3.4
+#pragma once
+#endif
+
+/*-------------------------------------------------------------------
+/  Shared memory output (-shmout <name>)
+/
+/  xpinmame publishes the DMD, its raw sub-frames, the segment displays
+/  and the lamp/solenoid/GI state in the POSIX shared memory object
+/  "/<name>" (/dev/shm/<name> on Linux) so that external display
+/  programs can show them without slowing down the emulation.
+/
+/  Layout: one shmout_tHeader, followed by nothing else. This header is
+/  self-contained so display programs can include it on its own.
+/
+/  Every channel (DMD, state) has SHMOUT_SLOTS buffers. The emulation
+/  only writes the slot after the current one, so a reader never blocks
+/  it. To read a channel:
+/    1. slot = hdr->dmdSlot, seq = hdr->dmd[slot].seq (retry if odd)
+/    2. copy what you need from hdr->dmd[slot]
+/    3. if hdr->dmd[slot].seq != seq the slot was rewritten, go to 1.
+/  hdr->dmdSeq counts the published frames, a reader that sees the same
+/  value as last time can skip the frame.
+/-------------------------------------------------------------------*/
+
+#define SHMOUT_MAGIC     0x4f4d4d50 /* "PMMO" */
+#define SHMOUT_VERSION   1
+#define SHMOUT_SLOTS     3
+
+#define SHMOUT_DMD_MAXX  256        /* = DMD_MAXX */
+#define SHMOUT_DMD_MAXY  64         /* = DMD_MAXY */
+#define SHMOUT_RAW_SIZE  (12*0x200) /* = GTS3DMD_FRAMES_5C*0x200 */
+#define SHMOUT_SEGCOUNT  128        /* = CORE_SEGCOUNT */
+#define SHMOUT_LAMPCOLS  42         /* = CORE_MAXLAMPCOL */
+#define SHMOUT_RGBLAMPS  260        /* = CORE_MAXRGBLAMPS */
+#define SHMOUT_MAXGI     5          /* = CORE_MAXGI */
+
+typedef struct {
+  volatile unsigned int seq;   /* odd while the slot is being written */
+  unsigned int   frameNo;      /* same as shmout_tHeader.dmdSeq when published */
+  double         time;         /* emulated time (seconds) */
+  unsigned short width, height;
+  unsigned char  levels;       /* dot values are 0..levels-1 */
+  unsigned char  rawFrames;    /* number of raw 1 bit/dot sub-frames in raw, 0 if none */
+  unsigned char  pad[2];
+  unsigned char  dots[SHMOUT_DMD_MAXY*SHMOUT_DMD_MAXX]; /* width*height, row by row */
+  unsigned char  raw[SHMOUT_RAW_SIZE];  /* rawFrames * width*height/8 bytes, as read from the hardware */
+} shmout_tDMD;
+
+typedef struct {
+  volatile unsigned int seq;   /* odd while the slot is being written */
+  unsigned int   frameNo;
+  double         time;
+  unsigned int   solenoids[2]; /* solenoids 1-32, 33-64 (1 bit each) */
+  int            gi[SHMOUT_MAXGI];
+  unsigned short seg[SHMOUT_SEGCOUNT];        /* segment bits as drawn */
+  unsigned char  lampMatrix[SHMOUT_LAMPCOLS]; /* 8 lamps per column */
+  unsigned char  RGBlamps[SHMOUT_RGBLAMPS];
+} shmout_tState;
+
+typedef struct {
+  unsigned int magic;          /* SHMOUT_MAGIC */
+  unsigned int version;        /* SHMOUT_VERSION */
+  unsigned int size;           /* sizeof(shmout_tHeader) */
+  volatile unsigned int running; /* 0 after the emulation has stopped */
+  char gameName[32];
+  volatile unsigned int dmdSeq, dmdSlot;     /* latest DMD frame */
+  volatile unsigned int stateSeq, stateSlot; /* latest state */
+  shmout_tDMD   dmd[SHMOUT_SLOTS];
+  shmout_tState state[SHMOUT_SLOTS];
+} shmout_tHeader;
+
+#endif /* INC_SHMOUT */
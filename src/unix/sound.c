@@ -21,7 +21,9 @@ static char *sound_dsp_device = NULL;
 static char *sound_mixer_device = NULL;
 static struct sysdep_dsp_struct *sound_dsp = NULL;
 static struct sysdep_mixer_struct *sound_mixer = NULL;
-static int sound_samples_per_frame = 0;
+static int sound_samples_per_frame = 0;	/* per block with -audioblock */
+static int sound_buf_count = 3;
+static int sound_block = 0;
 static int type;
 
 static int sound_set_options(struct rc_option *option, const char *arg,
@@ -63,6 +65,9 @@ struct rc_option sound_opts[] = {
    { "bufsize", 	"bs",			rc_float,	&sound_bufsize,
      "3.0",		1.0,			30.0,		NULL,
      "Number of frames of sound to buffer" },
+   { "audioblock",	"ab",			rc_int,		&options.audio_block,
+     "0",		0,			4096,		NULL,
+     "Make and output the sound in blocks of this many samples instead of once per frame, for less latency (0 = per frame)" },
    { "volume",		"v",			rc_int,		&sound_attenuation,
      "-3",		-32,			0,		NULL,
      "Set volume to <int> db, (-32 (soft) - 0(loud) )" },
@@ -136,7 +141,7 @@ void osd_sound_enable (int enable_it)
 	 {
 	    sound_stream_destroy(sound_stream);
 	    if (!(sound_stream = sound_stream_create(sound_dsp, type,
-	       sound_samples_per_frame, 3)))
+	       sound_samples_per_frame, sound_buf_count)))
 	    {
 	       osd_stop_audio_stream();
 	       sound_enabled = 0;
@@ -157,6 +162,8 @@ void osd_sound_enable (int enable_it)
 
 int osd_start_audio_stream(int stereo)
 {
+   sound_buf_count = 3;
+   sound_block = 0;
    type = SYSDEP_DSP_16BIT | (stereo? SYSDEP_DSP_STEREO:SYSDEP_DSP_MONO);
    
    sound_stream = NULL;
@@ -190,7 +197,7 @@ int osd_start_audio_stream(int stereo)
          sound_samples_per_frame);
 #endif
       if(!(sound_stream = sound_stream_create(sound_dsp, type,
-         sound_samples_per_frame, 3)))
+         sound_samples_per_frame, sound_buf_count)))
       {
          osd_stop_audio_stream();
          sound_enabled = 0;
@@ -224,6 +231,32 @@ int osd_start_audio_stream(int stereo)
 }
 
 
+int osd_set_audio_block(int samples)
+{
+   /* the emulation makes a whole frame of blocks before it is throttled, so
+      keep as many blocks as the dsp buffers plus one frame */
+   sound_buf_count = (int)((sound_bufsize + 1) * Machine->sample_rate /
+      Machine->drv->frames_per_second / samples) + 2;
+   sound_samples_per_frame = samples;
+   sound_block = 1;
+
+   if (sound_stream)
+   {
+      sound_stream_destroy(sound_stream);
+      if (!(sound_stream = sound_stream_create(sound_dsp, type,
+         sound_samples_per_frame, sound_buf_count)))
+      {
+         osd_stop_audio_stream();
+         sound_dsp = NULL;
+         sound_mixer = NULL;
+         sound_enabled = 0;
+      }
+   }
+
+   return sound_samples_per_frame;
+}
+
+
 #ifdef AVICAPTURE
 static FILE *audio_fp = NULL;
 static lame_global_flags* fl = NULL;
@@ -265,8 +298,13 @@ int osd_update_audio_stream(INT16 *buffer)
  
    /* sound enabled ? */
    if (sound_enabled)
+   {
       sound_stream_write(sound_stream, (unsigned char *)buffer,
          sound_samples_per_frame);
+      /* hand every block to the dsp right away, not once per frame */
+      if (sound_block)
+         sound_stream_update(sound_stream);
+   }
    
    return sound_samples_per_frame;
 }
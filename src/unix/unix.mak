@@ -23,6 +23,7 @@ CFLAGS.mips       = -DALIGN_INTS -DALIGN_SHORTS -DSGI_FIX_MWA_NOP
 ##############################################################################
 # **** Architecture dependent settings.
 ##############################################################################
+LIBS.linux         = -lrt -lpthread
 LIBS.solaris       = -lnsl -lsocket
 LIBS.irix          = -laudio
 LIBS.irix_al       = -laudio
@@ -148,7 +149,11 @@ ifdef ZLIB
 ZLIB    = src/unix/contrib/cutzlib-1.1.4/libz.a
 endif
 
+ifdef LIBPINMAME
+all: $(ZLIB) objdirs osdepend $(NAME).so
+else
 all: $(ZLIB) objdirs osdepend $(NAME).$(DISPLAY_METHOD)
+endif
 
 # CPU core include paths
 VPATH=src $(wildcard src/cpu/*)
@@ -181,6 +186,10 @@ ifdef LISY_X
 include src/lisy/lisy.mak
 endif
 
+ifdef LIBPINMAME
+include src/libpinmame/libpinmame.mak
+endif
+
 ifdef DEBUG
 DBGDEFS = -DMAME_DEBUG
 else
@@ -323,6 +332,14 @@ $(NAME).$(DISPLAY_METHOD): $(OBJS) $(PROCOBJS) $(LISYOBJS)
 	$(CC_COMMENT) @echo 'Linking $@ ...'
 	$(CC_COMPILE) $(LD) $(LDFLAGS) -o $@ $(OBJS) $(PROCOBJS) $(LISYOBJS) $(MY_LIBS) 
 
+ifdef LIBPINMAME
+$(NAME).so: $(LIBPINMAMEOBJS) $(OBJS) $(LIBPINMAMEMAP)
+	$(CC_COMMENT) @echo 'Linking $@ ...'
+	$(CC_COMPILE) $(LD) $(LDFLAGS) -shared -Wl,-soname,$@ \
+	 -Wl,--version-script=$(LIBPINMAMEMAP) -o $@ \
+	 $(LIBPINMAMEOBJS) $(OBJS) $(MY_LIBS) $(LIBPINMAMELIBS)
+endif
+
 tools: $(ZLIB) $(OBJDIRS) $(TOOLS)
 
 objdirs: $(MY_OBJDIRS)
@@ -338,6 +355,40 @@ romcmp: $(OBJ)/romcmp.o $(OBJ)/unzip.o
 	$(CC_COMMENT) @echo Linking $@...
 	$(CC_COMPILE) $(LD) $(LDFLAGS) -o $@ $^ -lz
 
+dmdbench: $(PINOBJ)/dmdbench.o $(PINOBJ)/dmdkern.o
+	$(CC_COMMENT) @echo Linking $@...
+	$(CC_COMPILE) $(LD) $(LDFLAGS) -o $@ $^
+
+pwmbench: $(PINOBJ)/pwmbench.o
+	$(CC_COMMENT) @echo Linking $@...
+	$(CC_COMPILE) $(LD) $(LDFLAGS) -o $@ $^
+
+dmdplay: $(PINOBJ)/dmdplay.o $(PINOBJ)/dmdcap.o
+	$(CC_COMMENT) @echo Linking $@...
+	$(CC_COMPILE) $(LD) $(LDFLAGS) -o $@ $^ -lpthread
+
+mixbench: $(OBJ)/sound/mixbench.o $(OBJ)/sound/mixkern.o
+	$(CC_COMMENT) @echo Linking $@...
+	$(CC_COMPILE) $(LD) $(LDFLAGS) -o $@ $^ -lm
+
+m6809bench: $(OBJ)/cpu/m6809/m6809bench.o $(OBJ)/cpu/m6809/m6809sw.o $(OBJ)/cpu/m6809/m6809thr.o
+	$(CC_COMMENT) @echo Linking $@...
+	$(CC_COMPILE) $(LD) $(LDFLAGS) -o $@ $^
+
+# the 6809 core once with each dispatch, public names prefixed m6809sw_/m6809thr_
+M6809BENCH_NAMES = ICount slapstic init reset exit execute get_context set_context \
+	get_reg set_reg set_irq_line set_irq_callback info dasm
+
+$(OBJ)/cpu/m6809/m6809sw.o: src/cpu/m6809/m6809.c
+	$(CC_COMMENT) @echo 'Compiling $< (switch) ...'
+	$(CC_COMPILE) $(CC) $(MY_CFLAGS) -DM6809_THREADED=0 \
+	 $(foreach n,$(M6809BENCH_NAMES),-Dm6809_$(n)=m6809sw_$(n)) -o $@ -c $<
+
+$(OBJ)/cpu/m6809/m6809thr.o: src/cpu/m6809/m6809.c
+	$(CC_COMMENT) @echo 'Compiling $< (threaded) ...'
+	$(CC_COMPILE) $(CC) $(MY_CFLAGS) -DM6809_THREADED=1 \
+	 $(foreach n,$(M6809BENCH_NAMES),-Dm6809_$(n)=m6809thr_$(n)) -o $@ -c $<
+
 hdcomp: $(OBJ)/hdcomp.o $(OBJ)/harddisk.o $(OBJ)/md5.o
 	$(CC_COMMENT) @echo Linking $@...
 	$(CC_COMMENT) $(LD) $(LDFLAGS) -o $@ $^ -lz
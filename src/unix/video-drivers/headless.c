@@ -0,0 +1,260 @@
+/*
+ headless.c - display method without any video or sound output
+
+ Runs the emulation as fast as the host allows (no throttling, no frame
+ drawing by default) for a fixed amount of emulated time, optionally
+ feeding a scripted switch timeline, and reports emulated-vs-wall time
+ when it is done. Meant for regression and soak testing.
+
+ The switch timeline is a plain text file, one event per line:
+
+   <emulated seconds> <switch number> <0|1>
+
+ Switch numbers are the ones the machine's driver uses (as in the
+ -switch keys of the core). Empty lines and lines starting with # are
+ ignored. Events do not need to be sorted. The events go through
+ swrec_putSw like the ones of a host, so -swrecord can record them at
+ exact emulated instants.
+ */
+
+#include <stdlib.h>
+#include "xmame.h"
+#include "driver.h"
+#include "keyboard.h"
+#include "wpc/core.h"
+#include "wpc/swrec.h"
+
+struct batch_event {
+	double time;
+	int swNo;
+	int value;
+	int seq;	/* line number, orders events at the same time */
+};
+
+static float batch_seconds = 0.0;
+static char *batch_switches = NULL;
+static int batch_draw = 0;
+
+static struct batch_event *batch_events = NULL;
+static int batch_event_count = 0;
+static int batch_event_next = 0;
+static int batch_switches_applied = 0;
+static cycles_t batch_start_time = 0;
+static int batch_frames = 0;
+static int batch_running = 0;
+
+/* called at the end of every emulated frame, used by libpinmame */
+void (*headless_frame_callback)(void) = NULL;
+
+struct rc_option display_opts[] = {
+   /* name, shortname, type, dest, deflt, min, max, func, help */
+   { "Headless Batch Related", NULL,		rc_seperator,	NULL,
+     NULL,		0,			0,		NULL,
+     NULL },
+   { "batch_seconds",	"bs",			rc_float,	&batch_seconds,
+     "0",		0,			1000000,	NULL,
+     "Number of emulated seconds to run before exiting (0 = until quit)" },
+   { "batch_switches",	"bsw",			rc_string,	&batch_switches,
+     NULL,		0,			0,		NULL,
+     "Switch timeline file, one '<seconds> <switch> <0|1>' event per line" },
+   { "batch_draw",	"bd",			rc_bool,	&batch_draw,
+     "0",		0,			0,		NULL,
+     "Still render every frame (exercises the video code, costs speed)" },
+   { NULL,		NULL,			rc_link,	mode_opts,
+     NULL,		0,			0,		NULL,
+     NULL },
+   { NULL,		NULL,			rc_end,		NULL,
+     NULL,		0,			0,		NULL,
+     NULL }
+};
+
+static int batch_event_cmp(const void *a, const void *b)
+{
+	const struct batch_event *ea = (const struct batch_event *)a;
+	const struct batch_event *eb = (const struct batch_event *)b;
+
+	if (ea->time < eb->time)
+		return -1;
+	if (ea->time > eb->time)
+		return 1;
+	/* keep the file order for events at the same time */
+	return (ea->seq < eb->seq) ? -1 : (ea->seq > eb->seq);
+}
+
+static int batch_load_switches(const char *filename)
+{
+	FILE *fp;
+	char line[256];
+	int lineno = 0;
+	int alloced = 0;
+
+	if (!(fp = fopen(filename, "r")))
+	{
+		fprintf(stderr_file, "headless: can't open switch timeline %s\n",
+				filename);
+		return OSD_NOT_OK;
+	}
+
+	while (fgets(line, sizeof(line), fp))
+	{
+		struct batch_event ev;
+		char *p = line;
+
+		lineno++;
+		while (*p == ' ' || *p == '\t')
+			p++;
+		if (*p == '#' || *p == '\n' || *p == '\r' || *p == 0)
+			continue;
+
+		if (sscanf(p, "%lf %d %d", &ev.time, &ev.swNo, &ev.value) != 3
+				|| ev.time < 0)
+		{
+			fprintf(stderr_file, "headless: %s:%d: syntax error, "
+					"expected '<seconds> <switch> <0|1>'\n",
+					filename, lineno);
+			fclose(fp);
+			return OSD_NOT_OK;
+		}
+
+		if (batch_event_count == alloced)
+		{
+			struct batch_event *grown;
+
+			alloced = alloced ? alloced * 2 : 64;
+			grown = realloc(batch_events,
+					alloced * sizeof(struct batch_event));
+			if (!grown)
+			{
+				fprintf(stderr_file,
+						"headless: out of memory reading %s\n",
+						filename);
+				fclose(fp);
+				return OSD_NOT_OK;
+			}
+			batch_events = grown;
+		}
+		ev.seq = lineno;
+		batch_events[batch_event_count++] = ev;
+	}
+	fclose(fp);
+
+	qsort(batch_events, batch_event_count, sizeof(struct batch_event),
+			batch_event_cmp);
+	fprintf(stderr_file, "headless: %d switch events loaded from %s\n",
+			batch_event_count, filename);
+	return OSD_OK;
+}
+
+int sysdep_init(void)
+{
+	return OSD_OK;
+}
+
+void sysdep_close(void)
+{
+	free(batch_events);
+	batch_events = NULL;
+	batch_event_count = batch_event_next = 0;
+}
+
+int sysdep_display_16bpp_capable(void)
+{
+	return 1;
+}
+
+void sysdep_update_keyboard (void)
+{
+}
+
+void sysdep_mouse_poll (void)
+{
+}
+
+/* nothing to open, but this is the first point where the options are
+   parsed and the machine is about to start; also skips the start-up
+   screens, which would otherwise wait for a keypress */
+int sysdep_create_display(int depth)
+{
+	/* there is no sound device to feed and nothing to throttle */
+	sound_enabled = 0;
+	throttle = 0;
+	options.skip_disclaimer = 1;
+	options.skip_gameinfo = 1;
+
+	batch_event_next = batch_switches_applied = batch_frames = 0;
+	batch_running = 0;
+	if (batch_switches && !batch_events
+			&& batch_load_switches(batch_switches) != OSD_OK)
+		return OSD_NOT_OK;
+
+	batch_start_time = osd_cycles();
+	return OSD_OK;
+}
+
+int headless_skip_this_frame(void)
+{
+	return !batch_draw;
+}
+
+/* called once per emulated frame from osd_update_video_and_audio */
+void headless_update(void)
+{
+	extern UINT8 trying_to_quit;
+	double now = timer_get_time();
+
+	batch_frames++;
+
+	/* the machine doesn't run until the "known problems" screen has been
+	   acknowledged; there is nobody to type OK, so do it here */
+	if (now == 0)
+	{
+		static const unsigned char ok_keys[] = { KEY_O, KEY_K };
+		struct xmame_keyboard_event event;
+
+		event.scancode = ok_keys[(batch_frames >> 1) & 1];
+		event.press = !(batch_frames & 1);
+		event.unicode = 0;
+		xmame_keyboard_register_event(&event);
+		return;
+	}
+	if (!batch_running)
+	{
+		/* don't leave a fake key held down in the running game */
+		xmame_keyboard_clear();
+		batch_running = 1;
+	}
+
+	while (batch_event_next < batch_event_count
+			&& batch_events[batch_event_next].time <= now)
+	{
+		swrec_putSw(batch_events[batch_event_next].swNo,
+				batch_events[batch_event_next].value);
+		batch_event_next++;
+		batch_switches_applied++;
+	}
+
+	if (batch_seconds > 0 && now >= batch_seconds)
+		trying_to_quit = 1;
+
+	if (headless_frame_callback)
+		(*headless_frame_callback)();
+}
+
+void headless_close(void)
+{
+	double emulated, wall;
+
+	/* the display never came up, nothing to report */
+	if (!batch_start_time)
+		return;
+
+	emulated = timer_get_time();
+	wall = (double)(osd_cycles() - batch_start_time)
+		/ (double)osd_cycles_per_second();
+	batch_start_time = 0;
+
+	fprintf(stderr_file, "headless: %.3f emulated seconds in %.3f wall "
+			"seconds (%.2fx realtime), %d frames, %d/%d switch events\n",
+			emulated, wall, (wall > 0) ? emulated / wall : 0.0,
+			batch_frames, batch_switches_applied, batch_event_count);
+}
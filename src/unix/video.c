@@ -215,7 +215,7 @@ struct rc_option video_opts[] = {
 };
 
 
-#ifndef LISY_VIDEO
+#if !defined(LISY_VIDEO) && !defined(headless)
 static int video_handle_scale(struct rc_option *option, const char *arg,
    int priority)
 {
@@ -953,7 +953,8 @@ void osd_update_video_and_audio(struct mame_display *display)
 	}
 
 	skip_this_frame = skip_next_frame;
-	skip_next_frame = (*skip_next_frame_functions[frameskipper])();
+	/* don't wait for the next frame while warping */
+	skip_next_frame = cpu_warping() ? 1 : (*skip_next_frame_functions[frameskipper])();
 
 	if (sound_stream && sound_enabled)
 		sound_stream_update(sound_stream);
@@ -1208,8 +1209,8 @@ void SetThrottleAdj(int adj)
 }
 
 
-//  LISY dummy/fake video driver
-#ifdef LISY_VIDEO
+//  LISY dummy/fake video driver, also used by the headless batch runner
+#if defined(LISY_VIDEO) || defined(headless)
 
 void osd_pause(int paused)
 {
@@ -1218,11 +1219,17 @@ void osd_pause(int paused)
 
 void osd_close_display(void)
 {
+#ifdef headless
+	headless_close();
+#endif
 }
 
 static int skip_next_frame = 0;
 int osd_skip_this_frame(void)
 {
+#ifdef headless
+	return headless_skip_this_frame();
+#endif
         return skip_next_frame;
 }
 
@@ -1230,8 +1237,7 @@ int osd_skip_this_frame(void)
 struct mame_bitmap *osd_override_snapshot(struct mame_bitmap *bitmap,
                 struct rectangle *bounds)
 {
-        struct mame_bitmap *copy;
-        return copy;
+        return NULL;
 }
 #endif
 
@@ -1245,6 +1251,12 @@ const char *osd_get_fps_text(const struct performance_info *performance)
 int osd_create_display(const struct osd_create_params *params,
                 UINT32 *rgb_components)
 {
+#ifdef headless
+	if (sysdep_create_display(params->depth) != OSD_OK)
+		return -1;
+	if (osd_input_initpost() != OSD_OK)
+		return -1;
+#endif
   return 0;
 }
 
@@ -1253,6 +1265,9 @@ void osd_update_video_and_audio(struct mame_display *display)
 {
 	if (sound_stream && sound_enabled)
 	  sound_stream_update(sound_stream);
+#ifdef headless
+	headless_update();
+#endif
 }
 
 void osd_video_initpre()
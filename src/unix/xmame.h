@@ -166,6 +166,17 @@ void osd_debug_close(void);
 int mode_disabled(int width, int height, int depth);
 int mode_match(int width, int height);
 
+/* headless batch runner (video-drivers/headless.c) */
+int  headless_skip_this_frame(void);
+void headless_update(void);
+void headless_close(void);
+extern void (*headless_frame_callback)(void);
+
+/* shared memory output (shmout.c) */
+extern char *shmout_name;
+int  shmout_open(void);
+void shmout_close(void);
+
 /* frameskip functions */
 int dos_skip_next_frame();
 int dos_show_fps(char *buffer);
@@ -6,6 +6,7 @@
 #include <ctype.h>
 #include <assert.h>
 #include <zlib.h>
+#include "mtlock.h"
 
 /* public globals */
 int	gUnzipQuiet = 0;		/* flag controls error messages */
@@ -719,6 +720,98 @@ static void cache_closezip(ZIP* zip) {
 	closezip(zip);
 }
 
+/* Shared directory cache, for the ROM audit
+     While it is enabled (unzip_cache_shared(1)) checksum_zipped_file()
+     keeps the directory of every zip it opens, suspended, in a hash table
+     by path, so that the clones of a set don't reread the parent zip and
+     several threads can look up entries at the same time: the table is
+     only changed under zip_shared_lock and a directory, once in, is never
+     changed or freed until unzip_cache_shared(0).
+*/
+#define ZIP_SHARED_HASH 1024
+
+struct zip_shared_entry {
+	struct zip_shared_entry* next;
+	ZIP* zip;
+};
+
+static struct zip_shared_entry* zip_shared_map[ZIP_SHARED_HASH];
+static int zip_shared_enabled;
+MTLOCK(zip_shared_lock);
+
+static unsigned zip_shared_slot(int pathtype, int pathindex, const char* zipfile) {
+	UINT32 h = 2166136261u ^ (pathtype << 8) ^ pathindex;
+	while (*zipfile)
+		h = (h ^ (UINT8)*zipfile++) * 16777619u;
+	return h % ZIP_SHARED_HASH;
+}
+
+static ZIP* zip_shared_lookup(unsigned slot, int pathtype, int pathindex, const char* zipfile) {
+	struct zip_shared_entry* e;
+	for (e = zip_shared_map[slot]; e; e = e->next)
+		if (e->zip->pathtype == pathtype && e->zip->pathindex == pathindex && strcmp(e->zip->zip, zipfile) == 0)
+			return e->zip;
+	return 0;
+}
+
+static ZIP* shared_openzip(int pathtype, int pathindex, const char* zipfile) {
+	unsigned slot = zip_shared_slot(pathtype, pathindex, zipfile);
+	struct zip_shared_entry* e;
+	ZIP* zip;
+
+	mtlock_enter(&zip_shared_lock);
+	zip = zip_shared_lookup(slot, pathtype, pathindex, zipfile);
+	mtlock_leave(&zip_shared_lock);
+	if (zip)
+		return zip;
+
+	e = (struct zip_shared_entry*)malloc(sizeof(*e));
+	if (!e)
+		return 0;
+
+	/* read the directory outside the lock, another thread may do the same */
+	e->zip = openzip(pathtype, pathindex, zipfile);
+	if (!e->zip) {
+		free(e);
+		return 0;
+	}
+	suspendzip(e->zip);
+
+	mtlock_enter(&zip_shared_lock);
+	zip = zip_shared_lookup(slot, pathtype, pathindex, zipfile);
+	if (!zip) {
+		zip = e->zip;
+		e->next = zip_shared_map[slot];
+		zip_shared_map[slot] = e;
+		e = 0;
+	}
+	mtlock_leave(&zip_shared_lock);
+
+	/* lost the race, keep the other one */
+	if (e) {
+		closezip(e->zip);
+		free(e);
+	}
+	return zip;
+}
+
+/* Enable or disable (and empty) the shared directory cache */
+void unzip_cache_shared(int enable) {
+	unsigned i;
+
+	mtlock_enter(&zip_shared_lock);
+	zip_shared_enabled = enable;
+	if (!enable)
+		for (i = 0; i < ZIP_SHARED_HASH; ++i)
+			while (zip_shared_map[i]) {
+				struct zip_shared_entry* e = zip_shared_map[i];
+				zip_shared_map[i] = e->next;
+				closezip(e->zip);
+				free(e);
+			}
+	mtlock_leave(&zip_shared_lock);
+}
+
 /* CK980415 added to allow osd code to clear zip cache for auditing--each time
    the user opens up an audit for a game we should reread the zip */
 void unzip_cache_clear()
@@ -748,6 +841,9 @@ void unzip_cache_clear()
 #define cache_suspendzip(a) closezip(a)
 
 #define unzip_cache_clear()
+#define unzip_cache_shared(a)
+#define zip_shared_enabled 0
+#define shared_openzip(a,b,c) 0
 
 #endif
 
@@ -819,48 +915,75 @@ int /* error */ load_zipped_file (int pathtype, int pathindex, const char* zipfi
 	return -1;
 }
 
+/* Look up an entry by name, or by CRC if *sum is preset and there is no such name.
+   Scans the directory with a local position and doesn't touch zip->ent, so
+   several threads can search the same (shared) directory. */
+static int find_zipent(ZIP* zip, const char* filename, unsigned int* length, unsigned int* sum) {
+	int pass;
+
+	for (pass = 0; pass < 2; ++pass) {
+		unsigned pos = 0;
+		while (pos + ZIPCFN <= zip->size_of_cent_dir) {
+			const char* cd = zip->cd + pos;
+			unsigned namelen = read_word((char*)cd+ZIPCFNL);
+			UINT32 crc = read_dword((char*)cd+ZIPCCRC);
+			int match;
+
+			if (pos + ZIPCFN + namelen > zip->size_of_cent_dir) {
+				errormsg("Invalid filename length in directory", ERROR_CORRUPT, zip->zip);
+				return -1;
+			}
+
+			if (pass == 0) {
+				/* equal_filename() on the unterminated name */
+				const char* name = cd + ZIPCFN;
+				const char* end = name + namelen;
+				const char* s;
+				for (s = name; s < end; ++s)
+					if (*s == '/')
+						name = s + 1;
+				s = filename;
+				while (*s && name < end && toupper(*s) == toupper(*name)) {
+					++s;
+					++name;
+				}
+				match = !*s && name == end;
+			}
+			else
+				/* NS981003: support for "load by CRC" */
+				match = *sum && crc == *sum;
+
+			if (match) {
+				*length = read_dword((char*)cd+ZIPCUNC);
+				*sum = crc;
+				return 0;
+			}
+			pos += ZIPCFN + namelen + read_word((char*)cd+ZIPCXTL) + read_word((char*)cd+ZIPCCML);
+		}
+	}
+	return -1;
+}
+
 /*	Pass the path to the zipfile and the name of the file within the zipfile.
 	sum will be set to the CRC-32 of that zipped file. */
 /*  The caller can preset sum to the expected checksum to enable "load by CRC" */
+/*  With the shared cache on this may be called from several threads at once. */
 int /* error */ checksum_zipped_file (int pathtype, int pathindex, const char *zipfile, const char *filename, unsigned int *length, unsigned int *sum) {
 	ZIP* zip;
-	struct zipent* ent;
+	int err;
 
-	zip = cache_openzip(pathtype, pathindex, zipfile);
-	if (!zip)
-		return -1;
-
-	while (readzip(zip)) {
-		ent = &(zip->ent);
-
-		if (equal_filename(ent->name, filename))
-		{
-			*length = ent->uncompressed_size;
-			*sum = ent->crc32;
-			cache_suspendzip(zip);
-			return 0;
-		}
+	if (zip_shared_enabled) {
+		zip = shared_openzip(pathtype, pathindex, zipfile);
+		if (!zip)
+			return -1;
+		return find_zipent(zip, filename, length, sum);
 	}
 
-	cache_suspendzip(zip);
-
-	/* NS981003: support for "load by CRC" */
 	zip = cache_openzip(pathtype, pathindex, zipfile);
 	if (!zip)
 		return -1;
 
-	while (readzip(zip)) {
-		ent = &(zip->ent);
-
-		if (*sum && ent->crc32 == *sum)
-		{
-			*length = ent->uncompressed_size;
-			*sum = ent->crc32;
-			cache_suspendzip(zip);
-			return 0;
-		}
-	}
-
+	err = find_zipent(zip, filename, length, sum);
 	cache_suspendzip(zip);
-	return -1;
+	return err;
 }
@@ -133,6 +133,11 @@ int /* error */ checksum_zipped_file (int pathtype, int pathindex, const char *z
 
 void unzip_cache_clear(void);
 
+/* Keep every zip directory read by checksum_zipped_file() until disabled
+   again, and allow checksum_zipped_file() to be called from several threads.
+   Used by the ROM audit, see audit.c */
+void unzip_cache_shared(int enable);
+
 /* public globals */
 extern int	gUnzipQuiet;	/* flag controls error messages */
 
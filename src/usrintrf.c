@@ -4170,6 +4170,9 @@ int handle_user_interface(struct mame_bitmap *bitmap)
 	if (input_ui_pressed(IPT_UI_LOAD_STATE))
 		do_loadsave(bitmap, LOADSAVE_LOAD);
 
+	if (input_ui_pressed(IPT_UI_REWIND))
+		cpu_rewind(1);
+
 #ifdef VPINMAME
 { extern int g_fPause;
   extern int g_fDumpFrames;
@@ -15,6 +15,7 @@
 
 **********************************************************************/
 #include "driver.h"
+#include "state.h"
 #include "crtc6845.h"
 
 #ifdef VERBOSE
@@ -48,6 +49,8 @@ static CRTC6845 crtc6845[MAX_6845];
 void crtc6845_init(int chipnum)
 {
 	memset(&crtc6845[chipnum],0,sizeof(CRTC6845));
+	/* all registers are ints */
+	state_save_register_INT32("crtc6845", chipnum, "regs", (INT32 *)&crtc6845[chipnum], sizeof(CRTC6845) / sizeof(int));
 }
 
 READ_HANDLER( crtc6845_register_r )
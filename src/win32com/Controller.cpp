@@ -568,6 +568,39 @@ static UINT8 oldNVRAM[CORE_MAXNVRAM];
 static char* oldNVRAMname = 0;
 static vp_tChgNVRAMs chgNVRAMs; // stack overflow when put into get_ChangedNVRAM??
 
+/*-- returns the first uCount entries of chgNVRAMs as array --*/
+static void ChgNVRAMsToVariant(size_t uCount, VARIANT *pVal)
+{
+	if (uCount == 0)
+	{
+		pVal->vt = 0; return;
+	}
+
+	/*-- Create array --*/
+	SAFEARRAYBOUND Bounds[] = { { (ULONG)uCount, 0 }, { 3, 0 } };
+	SAFEARRAY *psa = SafeArrayCreate(VT_VARIANT, 2, Bounds);
+	long ix[2];
+	VARIANT varValue;
+
+	varValue.vt = VT_I4;
+
+	/*-- add changed locations to array --*/
+	for (ix[0] = 0; ix[0] < (long)uCount; ix[0]++) {
+		ix[1] = 0;
+		varValue.lVal = chgNVRAMs[ix[0]].nvramNo;
+		SafeArrayPutElement(psa, ix, &varValue);
+		ix[1] = 1; // NVRAM value
+		varValue.lVal = chgNVRAMs[ix[0]].currStat;
+		SafeArrayPutElement(psa, ix, &varValue);
+		ix[1] = 2; // Old NVRAM value
+		varValue.lVal = chgNVRAMs[ix[0]].oldStat;
+		SafeArrayPutElement(psa, ix, &varValue);
+	}
+
+	pVal->vt = VT_ARRAY | VT_VARIANT;
+	pVal->parray = psa;
+}
+
 /***************************************************************
 * IController.ChangedNVRAM property: returns a list of the
 * numbers of NVRAM locations, which state has changed since the last call
@@ -585,6 +618,22 @@ STDMETHODIMP CController::get_ChangedNVRAM(VARIANT *pVal)
 	if (!(Machine && Machine->drv && Machine->drv->nvram_handler))
 		return S_FALSE;
 
+	/*-- drivers that report their NVRAM writes: only the changed bytes, no compare --*/
+	int iChanged = vp_getChangedNVRAM(chgNVRAMs);
+	if (iChanged >= 0)
+	{
+		if (oldNVRAMname == 0 || strstr(Machine->gamedrv->name, oldNVRAMname) == 0) // detect initial VPM start or game change
+		{
+			if (oldNVRAMname)
+				free(oldNVRAMname);
+			oldNVRAMname = (char*)malloc(strlen(Machine->gamedrv->name) + 1);
+			strcpy(oldNVRAMname, Machine->gamedrv->name);
+			iChanged = 0; //!! as below, too many changes initially
+		}
+		ChgNVRAMsToVariant(iChanged, pVal);
+		return S_OK;
+	}
+
 	// setup a ram file manually (MAME has no mechanism so far)
 	mame_file* nvram_file = (mame_file*)malloc(sizeof(mame_file));
 	memset(nvram_file, 0, sizeof(mame_file));
@@ -647,35 +696,7 @@ STDMETHODIMP CController::get_ChangedNVRAM(VARIANT *pVal)
 
 	mame_fclose(nvram_file);
 
-	if (uCount == 0)
-	{
-		pVal->vt = 0; return S_OK;
-	}
-
-	/*-- Create array --*/
-	SAFEARRAYBOUND Bounds[] = { { (ULONG)uCount, 0 }, { 3, 0 } };
-	SAFEARRAY *psa = SafeArrayCreate(VT_VARIANT, 2, Bounds);
-	long ix[2];
-	VARIANT varValue;
-
-	varValue.vt = VT_I4;
-
-	/*-- add changed locations to array --*/
-	for (ix[0] = 0; ix[0] < (long)uCount; ix[0]++) {
-		ix[1] = 0;
-		varValue.lVal = chgNVRAMs[ix[0]].nvramNo;
-		SafeArrayPutElement(psa, ix, &varValue);
-		ix[1] = 1; // NVRAM value
-		varValue.lVal = chgNVRAMs[ix[0]].currStat;
-		SafeArrayPutElement(psa, ix, &varValue);
-		ix[1] = 2; // Old NVRAM value
-		varValue.lVal = chgNVRAMs[ix[0]].oldStat;
-		SafeArrayPutElement(psa, ix, &varValue);
-	}
-
-	pVal->vt = VT_ARRAY | VT_VARIANT;
-	pVal->parray = psa;
-
+	ChgNVRAMsToVariant(uCount, pVal);
 	return S_OK;
 }
 
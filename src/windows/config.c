@@ -249,6 +249,7 @@ struct rc_option core_opts[] = {
         { "Mame CORE sound options", NULL, rc_seperator, NULL, NULL, 0, 0, NULL, NULL },
         { "samplerate", "sr", rc_int, &options.samplerate, "48000", 8000, 96000, NULL, "set samplerate" },
         { "samples", NULL, rc_bool, &options.use_samples, "1", 0, 0, NULL, "use samples" },
+        { "audioblock", "ab", rc_int, &options.audio_block, "0", 0, 4096, NULL, "make the sound in blocks of this many samples instead of once per frame (0 = per frame)" },
         //{ "resamplefilter", NULL, rc_bool, &options.use_filter, "1", 0, 0, NULL, "resample if samplerate does not match" },
         { "sound", NULL, rc_bool, &enable_sound, "1", 0, 0, NULL, "enable/disable sound and sound CPUs" },
         { "volume", "vol", rc_int, &attenuation, "0", -32, 0, NULL, "volume (range [-32,0])" },
@@ -271,6 +272,8 @@ struct rc_option core_opts[] = {
         { "skip_disclaimer", NULL, rc_bool, &options.skip_disclaimer, "0", 0, 0, NULL, "skip displaying the disclaimer screen" },
         { "skip_gameinfo", NULL, rc_bool, &options.skip_gameinfo, "0", 0, 0, NULL, "skip displaying the game info screen" },
         { "crconly", NULL, rc_bool, &options.crc_only, "0", 0, 0, NULL, "use only CRC for all integrity checks" },
+        { "hashcache", NULL, rc_bool, &options.hash_cache, "1", 0, 0, NULL, "remember the checksums of unchanged ROM files (romhash.cfg in the cfg directory)" },
+        { "idleskip", NULL, rc_bool, &options.idleskip, "1", 0, 0, NULL, "skip the time the 8-bit CPUs spend in loops that wait for an interrupt or a RAM change" },
         { "bios", NULL, rc_string, &options.bios, "default", 0, 14, NULL, "change system bios" },
         { "at91jit", NULL, rc_int, &options.at91jit, "1", 0, 33554432, NULL, "at91 CPU JIT compiler enabled" },
 
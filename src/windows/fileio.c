@@ -680,6 +680,77 @@ void osd_fclose(osd_file *file)
 
 
 
+//============================================================
+//	osd_get_file_stamp
+//============================================================
+
+int osd_get_file_stamp(int pathtype, int pathindex, const char *filename, struct osd_file_stamp *stamp)
+{
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	TCHAR fullpath[1024], absolute[1024], *name;
+	DWORD length;
+
+	/* compose the full path */
+	compose_path(fullpath, pathtype, pathindex, filename);
+	if (!GetFileAttributesEx(fullpath, GetFileExInfoStandard, &data) || (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+		return 0;
+
+	/* the same file may be found through different rompaths, so use the absolute name */
+	length = GetFullPathName(fullpath, sizeof(absolute) / sizeof(absolute[0]), absolute, &name);
+	if (length == 0 || length >= sizeof(absolute) / sizeof(absolute[0]))
+		_tcscpy(absolute, fullpath);
+#ifdef UNICODE
+	if (!WideCharToMultiByte(CP_UTF8, 0, absolute, -1, stamp->name, sizeof(stamp->name), NULL, NULL))
+		return 0;
+#else
+	if (_tcslen(absolute) >= sizeof(stamp->name))
+		return 0;
+	strcpy(stamp->name, absolute);
+#endif
+	stamp->size = ((UINT64)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+	stamp->mtime = ((UINT64)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+	return 1;
+}
+
+
+
+//============================================================
+//	osd_fmap
+//============================================================
+
+const void *osd_fmap(osd_file *file, UINT64 *length)
+{
+	HANDLE mapping;
+	void *data;
+
+	if (file->end == 0 || (SIZE_T)file->end != file->end)
+		return NULL;
+	mapping = CreateFileMapping(file->handle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping == NULL)
+		return NULL;
+
+	/* the view keeps the mapping (and the file) open */
+	data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (data == NULL)
+		return NULL;
+	*length = file->end;
+	return data;
+}
+
+
+
+//============================================================
+//	osd_funmap
+//============================================================
+
+void osd_funmap(const void *data, UINT64 length)
+{
+	UnmapViewOfFile(data);
+}
+
+
+
 //============================================================
 //	osd_display_loading_rom_message
 //============================================================
@@ -1654,6 +1654,10 @@ j = 0;	// count only the main cpu
 				total++;
 		}
 
+		/* the zip directories stay cached until the end */
+		if (verify & VERIFY_ROMS)
+			AuditBegin();
+
 		for (i = 0; drivers[i]; i++)
 		{
 			if (strwildcmp(gamename, drivers[i]->name))
@@ -1733,6 +1737,9 @@ nextloop:
 			fprintf(stderr,"%d%%\r",100 * checked / total);
 		}
 
+		if (verify & VERIFY_ROMS)
+			AuditEnd();
+
 		if (correct+incorrect == 0)
 		{
 			printf ("%s ", (verify & VERIFY_ROMS) ? "romset" : "sampleset" );
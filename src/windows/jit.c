@@ -2,9 +2,16 @@
 #include <string.h>
 #include <assert.h>
 
+#ifdef _WIN32
 #include <Windows.h>
+#else
+#include <stddef.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 #include "memory.h"
+#include "osdepend.h"
 
 #define JIT_OPALIGN 0
 #include "jit.h"
@@ -45,6 +52,43 @@
 
 #endif // JIT_DEBUG
 
+#ifdef _WIN32
+
+// flush the CPU instruction cache for a range of generated code
+#define FlushCode(addr, len) { BOOL FCres = FlushInstructionCache(GetCurrentProcess(), addr, len); ASSERT(FCres != 0); }
+
+#else /* _WIN32 */
+
+// POSIX - code pages are kept W^X: PROT_READ|PROT_EXEC normally, opened
+// to PROT_READ|PROT_WRITE only while we store or patch code.  This costs a
+// couple of mprotect() calls per translation, but many systems refuse
+// pages that are writable and executable at the same time.
+static void PosixProtect(byte *addr, int len, int prot)
+{
+	size_t pgsiz = (size_t)sysconf(_SC_PAGESIZE);
+	size_t start = (size_t)addr & ~(pgsiz - 1);
+	size_t end = ((size_t)addr + len + pgsiz - 1) & ~(pgsiz - 1);
+	int res = mprotect((void *)start, end - start, prot);
+	ASSERT(res == 0);
+	(void)res;
+}
+#define CodeWritable(addr, len)   PosixProtect(addr, len, PROT_READ | PROT_WRITE)
+#define CodeExecutable(addr, len) PosixProtect(addr, len, PROT_READ | PROT_EXEC)
+#define FlushCode(addr, len)      __builtin___clear_cache((char *)(addr), (char *)(addr) + (len))
+
+#endif /* _WIN32 */
+
+#if JIT_X64
+// Anchor for RIP-relative data operands.  JIT_ABS() expresses static
+// addresses as offsets from here, and every code page is allocated within
+// JIT_X64_REACH of it, so that both data references from generated code and
+// rel32 jumps between code pages stay within the +/-2GB the encoding allows.
+byte jit_abs_base[1];
+#define JIT_X64_REACH  (1024*1024*1024)
+
+static byte *emit_enter_code(struct jit_ctl *jit);
+#endif
+
 static struct jit_page *jit_add_page(struct jit_ctl *jit, int min_siz);
 static byte *emit_lookup_code(struct jit_ctl *jit, int patch);
 static void init_code_pages(struct jit_ctl *jit);
@@ -66,6 +110,9 @@ struct jit_ctl *_jit_create(int *cycle_counter, int rshift)
 	jit->pages = 0;
 	jit->mem_count = 0;
 	jit->cycle_counter_ptr = cycle_counter;
+#if JIT_X64
+	jit->cfunc_count = 0;
+#endif
 
 	// initialize the native code page list
 	init_code_pages(jit);
@@ -101,8 +148,11 @@ static void init_code_pages(struct jit_ctl *jit)
 	int reslen;
 	byte retn[] = { 0xC3 };  // RETN instruction
 	
-	// allocate the first page for native code storage (use the default length)
-	jit_add_page(jit, 0);
+	// allocate the first page for native code storage (use the default length);
+	// if that fails, leave the JIT without code pages - jit_create_map() will
+	// then refuse to set up a map, so everything runs in the emulator
+	if (jit_add_page(jit, 0) == 0)
+		return;
 
 	// reserve space for the boilerplate code
 	p = res = jit_reserve_native(jit, reslen = 16, 0);
@@ -138,6 +188,13 @@ static void init_code_pages(struct jit_ctl *jit)
 	// target emulated address into EAX and jumps to jit->pLookup.
 	jit->pLookup = emit_lookup_code(jit, 0);
 	jit->pLookupPatch = emit_lookup_code(jit, 1);
+
+#if JIT_X64
+	// create the C-to-native entry stub
+	jit->pEnter = emit_enter_code(jit);
+#else
+	jit->pEnter = 0;
+#endif
 }
 
 // Run-time address lookup.  This is invoked from generated code to
@@ -175,26 +232,34 @@ static byte *rtlookup_patch(struct jit_ctl *jit, data32_t addr, byte *caller)
 	// so go back 10 bytes and replace the MOV.
 	if (nat != jit->pEmulate && nat != jit->pPending)
 	{
+#ifdef _WIN32
 		DWORD prvPro;
-		BOOL res;
+#endif
 
 		// back up the caller address to the MOV instruction
 		caller -= 10;
 		ASSERT(caller[0] == 0xB8 && caller[5] == 0xE8);  // MOV, CALL
 
 		// make the code page temporarily writable
+#ifdef _WIN32
 		DbgVirtualProtect(caller, 10, PAGE_EXECUTE_READWRITE, &prvPro);
+#else
+		CodeWritable(caller, 10);
+#endif
 
 		// patch the MOV with JMP ofs32
 		caller[0] = 0xE9;       // JMP ofs32
 		*(UINT32 *)&caller[1] = (UINT32)(nat - (caller+5));
 
 		// restore the old page protection
+#ifdef _WIN32
 		DbgVirtualProtect(caller, 10, prvPro, &prvPro);
+#else
+		CodeExecutable(caller, 10);
+#endif
 
 		// flush the CPU instruction cache for the area where the new code resides
-		res = FlushInstructionCache(GetCurrentProcess(), caller, 10);
-		ASSERT(res != 0);
+		FlushCode(caller, 10);
 	}
 
 	// return the native address to invoke
@@ -249,6 +314,54 @@ static byte *emit_lookup_code(struct jit_ctl *jit, int patch)
 	// case where the code has already been translated is harmless, so simply
 	// load EAX with the target address in all cases.
 
+#if JIT_X64
+	// x86-64 version.  Same idea, but the handler takes its arguments in
+	// registers (RDI, RSI, RDX), the stack has to be 16-byte aligned at the
+	// CALL, and RSI/RDI (EDI holds the cycle counter) have to be preserved
+	// around the call, since they belong to the caller in the SysV
+	// convention.  The handler can be anywhere in the address space, so we
+	// call it through RAX.
+	//
+	// P  5A           POP RDX            ; caller address, third argument
+	//    50           PUSH RAX           ; save the target emu address
+	//    56           PUSH RSI
+	//    57           PUSH RDI
+	//    55           PUSH RBP
+	//    48 89 E5     MOV RBP,RSP
+	//    48 83 E4 F0  AND RSP,-16        ; align the stack for the call
+	//    89 C6        MOV ESI,EAX        ; emu address, second argument
+	//    48 BF <jit>  MOV RDI,<jit>      ; first argument
+	//    48 B8 <lkp>  MOV RAX,<lookup>
+	//    FF D0        CALL RAX
+	//    48 89 EC     MOV RSP,RBP
+	//    5D           POP RBP
+	//    5F           POP RDI
+	//    5E           POP RSI
+	//    5A           POP RDX            ; saved target emu address
+	//    48 92        XCHG RAX,RDX
+	//    FF E2        JMP RDX
+	static const byte prolog[] = { 0x50, 0x56, 0x57, 0x55, 0x48, 0x89, 0xE5, 0x48, 0x83, 0xE4, 0xF0, 0x89, 0xC6 };
+	static const byte epilog[] = { 0xFF, 0xD0, 0x48, 0x89, 0xEC, 0x5D, 0x5F, 0x5E, 0x5A, 0x48, 0x92, 0xFF, 0xE2 };
+	byte popRDX[] = { 0x5A };
+	byte movRDI[] = { 0x48, 0xBF, 0, 0, 0, 0, 0, 0, 0, 0 };
+	byte movRAX[] = { 0x48, 0xB8, 0, 0, 0, 0, 0, 0, 0, 0 };
+	byte *code;
+	byte *lookup = (patch ? (byte *)rtlookup_patch : (byte *)rtlookup);
+	int reslen;
+
+	// reserve space for the handler code
+	code = jit_reserve_native(jit, reslen = 64, 0);
+	if (patch)
+		jit_store_native(jit, popRDX, sizeof(popRDX));
+	jit_store_native(jit, prolog, sizeof(prolog));
+	*(struct jit_ctl **)&movRDI[2] = jit;
+	jit_store_native(jit, movRDI, sizeof(movRDI));
+	*(byte **)&movRAX[2] = lookup;
+	jit_store_native(jit, movRAX, sizeof(movRAX));
+	jit_store_native(jit, epilog, sizeof(epilog));
+	jit_close_native(jit, code, reslen);
+	return code;
+#else
 	byte pushEAX[] = { 0x50 };               // PUSH EAX
 	byte pushJit[] = { 0x68, 0, 0, 0, 0 };   // PUSH Imm32
 	byte callLk[]  = { 0xE8, 0, 0, 0, 0 };   // CALL Ofs32
@@ -304,8 +417,93 @@ static byte *emit_lookup_code(struct jit_ctl *jit, int patch)
 	
 	// return the generated code pointer
 	return code;
+#endif /* JIT_X64 */
+}
+
+#if JIT_X64
+// Emit the pEnter stub, data32_t enter(byte *native, int *cycle_counter).
+// Generated code freely modifies EBX, ECX, EDX, ESI, EDI and EBP; of those,
+// only RBX and RBP are callee-saved under SysV, so those are all we need
+// to save for our C caller.
+//
+//    53        PUSH RBX
+//    55        PUSH RBP
+//    56        PUSH RSI          ; cycle counter pointer
+//    48 89 F8  MOV RAX,RDI       ; native code address
+//    8B 3E     MOV EDI,[RSI]     ; load the cycle counter
+//    FF D0     CALL RAX          ; run the generated code
+//    5E        POP RSI
+//    89 3E     MOV [RSI],EDI     ; store the updated cycle counter
+//    5D        POP RBP
+//    5B        POP RBX
+//    C3        RETN              ; new emulated PC is in EAX
+static byte *emit_enter_code(struct jit_ctl *jit)
+{
+	static const byte enter[] = {
+		0x53, 0x55, 0x56, 0x48, 0x89, 0xF8, 0x8B, 0x3E, 0xFF, 0xD0,
+		0x5E, 0x89, 0x3E, 0x5D, 0x5B, 0xC3
+	};
+	byte *code = jit_reserve_native(jit, sizeof(enter), 0);
+	jit_store_native(jit, enter, sizeof(enter));
+	jit_close_native(jit, code, sizeof(enter));
+	return code;
 }
 
+// Get (generating on first use) the call thunk for a C function.  The
+// generated code has pushed up to four 8-byte argument slots, cdecl order,
+// and will discard them itself after the call.
+//
+//    55           PUSH RBP
+//    48 89 E5     MOV RBP,RSP
+//    56           PUSH RSI
+//    57           PUSH RDI
+//    48 83 E4 F0  AND RSP,-16
+//    8B 7D 10     MOV EDI,[RBP+16]   ; arguments 1-4 (unused slots are harmless to read)
+//    8B 75 18     MOV ESI,[RBP+24]
+//    8B 55 20     MOV EDX,[RBP+32]
+//    8B 4D 28     MOV ECX,[RBP+40]
+//    48 B8 <fn>   MOV RAX,<func>
+//    FF D0        CALL RAX
+//    48 8D 65 F0  LEA RSP,[RBP-16]
+//    5F           POP RDI
+//    5E           POP RSI
+//    5D           POP RBP
+//    C3           RETN
+byte *jit_cfunc(struct jit_ctl *jit, byte *func)
+{
+	byte thunk[] = {
+		0x55, 0x48, 0x89, 0xE5, 0x56, 0x57, 0x48, 0x83, 0xE4, 0xF0,
+		0x8B, 0x7D, 0x10, 0x8B, 0x75, 0x18, 0x8B, 0x55, 0x20, 0x8B, 0x4D, 0x28,
+		0x48, 0xB8, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xD0,
+		0x48, 0x8D, 0x65, 0xF0, 0x5F, 0x5E, 0x5D, 0xC3
+	};
+	byte *code;
+	int i;
+
+	// reuse an existing thunk if we have one
+	for (i = 0 ; i < jit->cfunc_count ; ++i) {
+		if (jit->cfunc[i].func == func)
+			return jit->cfunc[i].thunk;
+	}
+	if (jit->cfunc_count >= JIT_MAX_CFUNC)
+		return 0;
+
+	// generate a new one
+	*(byte **)&thunk[24] = func;
+	code = jit_reserve_native(jit, sizeof(thunk), 0);
+	if (code == 0)
+		return 0;
+	jit_store_native(jit, thunk, sizeof(thunk));
+	jit_close_native(jit, code, sizeof(thunk));
+
+	// remember it
+	jit->cfunc[jit->cfunc_count].func = func;
+	jit->cfunc[jit->cfunc_count].thunk = code;
+	jit->cfunc_count++;
+	return code;
+}
+#endif /* JIT_X64 */
+
 // free the native code page list
 static void delete_code_pages(struct jit_ctl *jit)
 {
@@ -317,8 +515,12 @@ static void delete_code_pages(struct jit_ctl *jit)
 		struct jit_page *nxt = p->nxt;
 
 		// free the code space
+#ifdef _WIN32
 		BOOL res = VirtualFree(p->b, 0, MEM_RELEASE);
 		ASSERT(res != 0);
+#else
+		munmap(p->b, p->siz);
+#endif
 
 		// free the page descriptor
 		free(p);
@@ -335,12 +537,21 @@ static void delete_code_pages(struct jit_ctl *jit)
 	jit->pPending = 0;
 	jit->pWorking = 0;
 	jit->pLookup = 0;
+	jit->pEnter = 0;
 	jit->mem_count = 0;
+#if JIT_X64
+	jit->cfunc_count = 0;
+#endif
 }
 
 void jit_create_map(struct jit_ctl *jit, data32_t minAddr, data32_t maxAddr)
 {
 	int i, nBytes, nAddrs;
+
+	// without code space there's nothing to translate into - leave the map
+	// empty, so that everything is emulated
+	if (jit->pages == 0)
+		return;
 	
 	// if there's an existing map, delete it
 	if (jit->native != 0)
@@ -415,7 +626,9 @@ void jit_untranslate(struct jit_ctl *jit, data32_t addr)
 	p = JIT_NATIVE(jit, addr);
 	if (p != jit->pEmulate && p != jit->pPending)
 	{
-		BOOL res;
+#ifndef _WIN32
+		CodeWritable(p, 6);
+#endif
 
 		// Replace the code with MOV EAX,<emulator address>, RETN.
 		// This will return to the emulator and resume emulation at the
@@ -423,6 +636,9 @@ void jit_untranslate(struct jit_ctl *jit, data32_t addr)
 		p[0] = 0xB8;                 // MOV EAX,Imm32
 		*(UINT32 *)(&p[1]) = addr;   // ... the immediate data for the MOV
 		p[5] = 0xC3;                 // RETN
+#ifndef _WIN32
+		CodeExecutable(p, 6);
+#endif
 
 		// Set the opcode mapping to 'emulate', so that we don't try
 		// to translate it again in the future.  Once a location is written,
@@ -432,8 +648,7 @@ void jit_untranslate(struct jit_ctl *jit, data32_t addr)
 		jit->native[(addr - jit->minAddr) >> jit->rshift] = jit->pEmulate;
 
 		// flush the instruction cache for this section of code
-		res = FlushInstructionCache(GetCurrentProcess(), p, 128); //!! 128?!
-		ASSERT(res != 0);
+		FlushCode(p, 128); //!! 128?!
 	}
 }
 
@@ -455,7 +670,9 @@ byte *jit_reserve_native(struct jit_ctl *jit, int len, struct jit_page **pgp)
 {
 	struct jit_page *pg;
 	byte *res;
+#ifdef _WIN32
 	DWORD prvPro;
+#endif
 
 	// find an existing page with space for the new code
 	for (pg = jit->pages ; pg != 0 && pg->siz - pg->ofsFree < len ; pg = pg->nxt) ;
@@ -475,7 +692,11 @@ byte *jit_reserve_native(struct jit_ctl *jit, int len, struct jit_page **pgp)
 	res = pg->b + pg->ofsFree;
 
 	// open this memory to writing
+#ifdef _WIN32
 	DbgVirtualProtect(res, len, PAGE_EXECUTE_READWRITE, &prvPro);
+#else
+	CodeWritable(res, len);
+#endif
 
 	// return the destination pointer
 	return pg->b + pg->ofsFree;
@@ -483,10 +704,16 @@ byte *jit_reserve_native(struct jit_ctl *jit, int len, struct jit_page **pgp)
 
 void jit_close_native(struct jit_ctl *jit, byte *addr, int len)
 {
+#ifdef _WIN32
 	DWORD prvPro;
 
 	// make the reserved memory executable and non-writable
 	DbgVirtualProtect(addr, len, PAGE_EXECUTE_READ, &prvPro);
+#else
+	// make the reserved memory executable and non-writable
+	if (addr != 0)
+		CodeExecutable(addr, len);
+#endif
 }
 
 byte *jit_store_native(struct jit_ctl *jit, const byte *code, int len)
@@ -496,10 +723,8 @@ byte *jit_store_native(struct jit_ctl *jit, const byte *code, int len)
 	byte *dst = jit_reserve_native(jit, len, &pg);
 
 	// copy the data, if any
-	if (len != 0)
+	if (len != 0 && dst != 0)
 	{
-		BOOL res;
-
 		// store the instruction data
 		memcpy(dst, code, len);
 
@@ -507,8 +732,7 @@ byte *jit_store_native(struct jit_ctl *jit, const byte *code, int len)
 		pg->ofsFree += len;
 		
 		// flush the CPU instruction cache for the area where the new code resides
-		res = FlushInstructionCache(GetCurrentProcess(), dst, len);
-		ASSERT(res != 0);
+		FlushCode(dst, len);
 	}
 
 	// return the new code address
@@ -520,27 +744,61 @@ void jit_store_native_from_reserved(struct jit_ctl *jit, const byte *code, int l
 	// copy the data, if any
 	if (len != 0)
 	{
-		BOOL res;
-
 		// store the instruction data
-		memcpy(dst, code, len);
+		memcpy((byte *)dst, code, len);
 
 		// consume the space
 		pg->ofsFree += len;
 		
 		// flush the CPU instruction cache for the area where the new code resides
-		res = FlushInstructionCache(GetCurrentProcess(), dst, len);
-		ASSERT(res != 0);
+		FlushCode(dst, len);
+	}
+}
+
+#ifndef _WIN32
+// Allocate code space.  On x86-64, look for free address space near the
+// emulator image, starting close by and working outwards, since generated
+// code has to reach static data and other code pages with 32-bit offsets.
+static byte *alloc_code_space(int siz)
+{
+	void *b;
+#if JIT_X64
+	const size_t step = 64*1024*1024;
+	byte *anchor = (byte *)((size_t)jit_abs_base & ~(step - 1));
+	size_t dist;
+	int dir;
+
+	for (dist = step ; dist + siz < JIT_X64_REACH ; dist += step)
+	{
+		for (dir = -1 ; dir <= 1 ; dir += 2)
+		{
+			byte *hint = anchor + dir * (ptrdiff_t)dist;
+			b = mmap(hint, siz, PROT_READ | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (b == MAP_FAILED)
+				continue;
+
+			// the hint is only a hint - make sure we're actually in range
+			if ((byte *)b - jit_abs_base > -(JIT_X64_REACH - siz) && (byte *)b - jit_abs_base < JIT_X64_REACH - siz)
+				return (byte *)b;
+			munmap(b, siz);
+		}
 	}
+	return 0;
+#else
+	b = mmap(0, siz, PROT_READ | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	return b == MAP_FAILED ? 0 : (byte *)b;
+#endif
 }
+#endif /* _WIN32 */
 
 static struct jit_page *jit_add_page(struct jit_ctl *jit, int min_siz)
 {
-#if JIT_DEBUG
+#if JIT_DEBUG && defined(_WIN32)
 	DWORD prvPro;
 	BOOL res;
 #endif
 	int siz;
+	byte *b;
 	struct jit_page *p;
 
 	// Figure the page size.  Allocate at least the minimum size requested
@@ -550,22 +808,31 @@ static struct jit_page *jit_add_page(struct jit_ctl *jit, int min_siz)
 	//!! Make code page (artifically by *17) larger to avoid unsafe jumps and memory references later.
 	siz = 128*1024*17;
 	if (siz < min_siz)
-		siz = min_siz;
+		siz = (min_siz + 0xFFFF) & ~0xFFFF;
+
+	// allocate the code space
+#ifdef _WIN32
+	b = (byte *)VirtualAlloc(0, siz, MEM_RESERVE | MEM_COMMIT, PAGE_EXECUTE_READWRITE);
+	ASSERT(b != NULL);
+#else
+	b = alloc_code_space(siz);
+	if (b == 0) {
+		logerror("JIT: unable to allocate code space, translation disabled\n");
+		return 0;
+	}
+#endif
 
 	// create the page descriptor structure
 	p = (struct jit_page *)malloc(sizeof(struct jit_page));
 	p->siz = siz;
 	p->ofsFree = 0;
+	p->b = b;
 
 	// link it in at the head of the page list
 	p->nxt = jit->pages;
 	jit->pages = p;
 
-	// allocate the code space
-	p->b = (byte *)VirtualAlloc(0, siz, MEM_RESERVE | MEM_COMMIT, PAGE_EXECUTE_READWRITE);
-	ASSERT(p->b != NULL);
-
-#if JIT_DEBUG
+#if JIT_DEBUG && defined(_WIN32)
 	res = FlushInstructionCache(GetCurrentProcess(), p->b, siz);
 	ASSERT(res != 0);
 
@@ -44,9 +44,13 @@
  *   
  *   JIT translation is obviously dependent on both the host hardware we're
  *   running on and the original CPU we're emulating.  This core module is
- *   specific to JITs for hosts running Windows on Intel 32-bit x86 hardware.
- *   This core will have to be re-implemented if anyone ever wants to port
- *   the JIT to other host platforms in the future.
+ *   specific to JITs for Intel hosts: Windows on 32-bit x86 hardware, and
+ *   POSIX systems (Linux etc) on x86-64 hardware.  On x86-64 the generated
+ *   code is still 32-bit Intel code; the differences are confined to the
+ *   stack slot size, RIP-relative data operands, and thunks for calling C
+ *   code (see JIT_SLOT, JIT_ABS, and jit_cfunc() below).  This core will
+ *   have to be re-implemented if anyone ever wants to port the JIT to
+ *   non-Intel host platforms in the future.
  *   
  *   Our basic strategy with the JIT is to translate each source instruction
  *   to a self-contained block of native host instructions.  The translation
@@ -255,8 +259,13 @@ typedef unsigned char byte;
 
 #if defined(_MSC_VER) && (_MSC_VER >= 1400) && !defined(__LP64__) // visual studio & > 6 & 32bit compile
 #define JIT_ENABLED  1   // enable the JIT (false -> use only the standard emulator code)
+#define JIT_X64      0
+#elif defined(__GNUC__) && defined(__x86_64__) && !defined(_WIN32) // gcc/clang, x86-64 POSIX (Linux, BSD, OS X)
+#define JIT_ENABLED  1
+#define JIT_X64      1   // 64-bit host: RIP-relative data, SysV calls through thunks
 #else
 #define JIT_ENABLED  0
+#define JIT_X64      0
 #endif
 
 #define JIT_DEBUG    0   // enable additional debugging code in the JIT
@@ -279,6 +288,36 @@ typedef unsigned char byte;
 # error Invalid JIT_OPALIGN value - must be 8, 16, 32, or 64
 #endif
 
+/*
+ *   Host differences.  The generated code is 32-bit Intel code in both
+ *   cases, but on an x86-64 host every PUSH/POP moves an 8-byte stack slot,
+ *   memory operands that refer to static data are encoded RIP-relative
+ *   (see JIT_ABS), and C functions follow the SysV register calling
+ *   convention rather than cdecl.  Translators should:
+ *   
+ *   - use JIT_SLOT rather than 4 for the size of a pushed stack item
+ *   
+ *   - write absolute memory operands as Idx, Imm, JIT_ABS(&var); 'var' must
+ *   be static data within the emulator image
+ *   
+ *   - CALL C functions through jit_cfunc(jit, func), pushing the arguments
+ *   cdecl style as usual (up to 4 arguments)
+ *   
+ *   - enter the generated code through jit_call_native() rather than inline
+ *   assembler
+ */
+#if JIT_X64
+# define JIT_SLOT  8
+extern byte jit_abs_base[];
+# define JIT_ABS(p) ((UINT32)((byte *)(p) - jit_abs_base))
+#else
+# define JIT_SLOT  4
+# define JIT_ABS(p) ((UINT32)(p))
+#endif
+
+/* maximum number of distinct C functions generated code can call on x86-64 */
+#define JIT_MAX_CFUNC 32
+
 /*
  *   JIT control structure.  This contains internal information that the JIT
  *   uses for translating and executing code.
@@ -391,6 +430,13 @@ struct jit_ctl
 	// must always do a run-time lookup.
 	byte *pLookupPatch;
 
+	// Native entry point, data32_t (*)(byte *native, int *cycle_counter).
+	// This saves the host registers, loads the cycle counter into EDI,
+	// calls 'native', stores EDI back into the cycle counter, and returns
+	// the emulated PC from EAX.  Used where the compiler has no inline
+	// assembler suitable for the job (see jit_call_native()).
+	byte *pEnter;
+
 	// Head of native code program memory list allocated by the JIT
 	// for this CPU.  The JIT uses this internally to manage the memory
 	// containing the translated code.
@@ -405,6 +451,12 @@ struct jit_ctl
 	byte *write8;    // void (*write8)(int addr, data8_t data);
 	byte *write16;   // void (*write16)(int addr, data16_t data);
 	byte *write32;   // void (*write32)(int addr, data32_t data);
+
+#if JIT_X64
+	// C call thunks generated by jit_cfunc(), cleared along with the code pages
+	struct { byte *func, *thunk; } cfunc[JIT_MAX_CFUNC];
+	int cfunc_count;
+#endif
 };
 
 
@@ -484,6 +536,30 @@ void jit_enable(struct jit_ctl *jit);
  */
 void jit_untranslate(struct jit_ctl *jit, data32_t addr);
 
+/*
+ *   Get a CALL target for a C function invoked from generated code.  The
+ *   generated code pushes the arguments right to left and pops them itself
+ *   after the call (cdecl), and expects EBX, ESI, EDI and EBP to survive the
+ *   call.  That's simply the C calling convention on 32-bit Intel hosts, so
+ *   there the function itself is returned.  On x86-64 hosts this returns a
+ *   small thunk in the code page that moves up to four stack arguments into
+ *   registers, aligns the stack, and preserves ESI/EDI across the call.
+ *   Returns null if no code space is available.
+ */
+#if JIT_X64
+byte *jit_cfunc(struct jit_ctl *jit, byte *func);
+#else
+#define jit_cfunc(jit, func) ((byte *)(func))
+#endif
+
+/*
+ *   Call translated native code from C, via the jit->pEnter stub.  Returns
+ *   the emulated program counter to resume at, and updates the cycle
+ *   counter.
+ */
+#define jit_call_native(jit, native, cycle_counter) \
+	(((data32_t (*)(byte *, int *))(jit)->pEnter)(native, cycle_counter))
+
 /* 
  *   get the native code pointer for a given machine code address (this isn't
  *   range-checked - always check that the address is in range before
@@ -713,7 +789,7 @@ void jit_untranslate(struct jit_ctl *jit, data32_t addr);
 #ifdef JIT_NAME
 # define JIT_XLAT_FUNC_(x) x ## _jit_xlat
 # define JIT_XLAT_FUNC(x) JIT_XLAT_FUNC_(x)
-int JIT_XLAT_FUNC(JIT_NAME)(struct jit_ctl *jit, data32_t pc);
+static int JIT_XLAT_FUNC(JIT_NAME)(struct jit_ctl *jit, data32_t pc);
 #endif
 
 /*
@@ -761,7 +837,7 @@ struct jit_page {
 	// offset of next free byte
 	int ofsFree;
 
-	// native code (allocated as a separate block via VirtualAlloc())
+	// native code (allocated as a separate block via VirtualAlloc() or mmap())
 	byte *b;
 };
 
@@ -210,6 +210,8 @@ struct instr {
 							 // the opcode byte.  For a TWOBYTE opcode, this is 0x0Fxx, where xx
 							 // is the opcode byte.  E.g., JG <ofs32> has effective opcode 0x0F8F.
 	int len;                 // size of bytes of the opcode sequence
+	int ripofs;              // x86-64: offset in b[] of a RIP-relative disp32 to fix up, or -1
+	INT32 ripdisp;           // x86-64: target of the RIP-relative operand, as a JIT_ABS() offset
 	byte b[1];               // opcode bytes; we overallocate to make room
 };
 
@@ -239,6 +241,7 @@ struct jit_label {
 /* Intel opcodes prefixes */
 #define TWOBYTE  0x0F
 #define OPSIZE   0x66
+#define REX_W    0x48
 
 /* some Intel opcodes we need for the instruction stream editing process */
 #define opCALL     0xE8    // call 32-bit offset
@@ -267,6 +270,10 @@ static struct instr *alloc_instr(int len, const byte *b)
 	// Find the primary opcode, skipping any prefix bytes
 	op = b;
 	rem = len;
+#if JIT_X64
+	if (rem > 1 && (*op & 0xF0) == 0x40)
+		++op, --rem;
+#endif
 	if (rem > 0 && *op == TWOBYTE) {
 		++op, --rem;
 		twobyte = 1;
@@ -299,6 +306,8 @@ static struct instr *alloc_instr(int len, const byte *b)
 	i->prv = 0;
 	i->nataddr = 0;
 	i->lbl = 0;
+	i->ripofs = -1;
+	i->ripdisp = 0;
 
 	// copy the emulator address information from the lead generated code object
 	// for the current emulator opcode, if set
@@ -660,6 +669,17 @@ void jit_emit_commit(struct jit_ctl *jit)
 	// Reserve the space
 	resp = jit_reserve_native(jit, reslen = len, &pg);  
 
+	// If we're out of code space, give up on this block: mark its opcodes
+	// for emulation and discard the generated code.
+	if (resp == 0)
+	{
+		for (i = stktop->ihead ; i != 0 ; i = i->nxt) {
+			if (i->len == 0)   // opcode marker from jit_emit_begin_instr()
+				JIT_NATIVE(jit, i->emuaddr) = jit->pEmulate;
+		}
+		return;
+	}
+
 	// Edit jumps that exceed +/- 127 bytes.  On each pass, we'll
 	// look for any two-byte jumps that are out of bounds.  For
 	// each one we find, we'll replace it as follows:
@@ -972,6 +992,12 @@ void jit_emit_commit(struct jit_ctl *jit)
 			}
 		}
 		
+		// convert a RIP-relative data reference to its final offset
+#if JIT_X64
+		if (i->ripofs >= 0)
+			*(INT32 *)&i->b[i->ripofs] = (INT32)((jit_abs_base + i->ripdisp) - (i->nataddr + i->len));
+#endif
+
 		// copy this instruction to the JIT executable code page
 
 #if JIT_DEBUG
@@ -1149,6 +1175,7 @@ struct mnedef {
 #define E_R       0x08    // opcode has register number encoded in bottom 3 bits
 #define E_16      0x10    // explicit OPSIZE prefix required for this coding
 #define E_TwoByte 0x20    // TWOBYTE prefix required for this coding
+#define E_No64    0x40    // coding isn't valid in 64-bit mode (opcode reused for REX etc)
 
 };
 
@@ -1371,14 +1398,14 @@ const static struct mnedef mnetab[] = {
 	{ imXCHG, rEDI,  rEAX,  none,  0x97,  0,    0,    0 },
 	{ imXCHG, rDI,   rAX,   none,  0x97,  0,    0,    E_16 },
 
-	{ imINC,  r16,   none,  none,  0x40,  0,    0,    E_R | E_16 },
-	{ imINC,  r32,   none,  none,  0x40,  0,    0,    E_R },
+	{ imINC,  r16,   none,  none,  0x40,  0,    0,    E_R | E_16 | E_No64 },
+	{ imINC,  r32,   none,  none,  0x40,  0,    0,    E_R | E_No64 },
 	{ imINC,  rm8,   none,  none,  0xFE,  0,    0,    E_Ext },
 	{ imINC,  rm16,  none,  none,  0xFF,  0,    0,    E_Ext | E_16 },
 	{ imINC,  rm32,  none,  none,  0xFF,  0,    0,    E_Ext },
 
-	{ imDEC,  r16,   none,  none,  0x48,  0,    0,    E_R | E_16 },
-	{ imDEC,  r32,   none,  none,  0x48,  0,    0,    E_R },
+	{ imDEC,  r16,   none,  none,  0x48,  0,    0,    E_R | E_16 | E_No64 },
+	{ imDEC,  r32,   none,  none,  0x48,  0,    0,    E_R | E_No64 },
 	{ imDEC,  rm8,   none,  none,  0xFE,  1,    0,    E_Ext },
 	{ imDEC,  rm16,  none,  none,  0xFF,  1,    0,    E_Ext | E_16 },
 	{ imDEC,  rm32,  none,  none,  0xFF,  1,    0,    E_Ext },
@@ -1462,13 +1489,13 @@ const static struct mnedef mnetab[] = {
 
 	{ imINT,  imm_3, none,  none,  0xCC,  0,    0,    0 },
 	{ imINT,  imm8,  none,  none,  0xCD,  0,    0,    0 },
-	{ imINTO, none,  none,  none,  0xCE,  0,    0,    0 },
+	{ imINTO, none,  none,  none,  0xCE,  0,    0,    E_No64 },
 	{ imIRET, none,  none,  none,  0xCF,  0,    0,    0 },
 
-	{ imPUSH, rES,   none,  none,  0x06,  0,    0,    0 },
-	{ imPUSH, rCS,   none,  none,  0x0E,  0,    0,    0 },
-	{ imPUSH, rSS,   none,  none,  0x16,  0,    0,    0 },
-	{ imPUSH, rDS,   none,  none,  0x1E,  0,    0,    0 },
+	{ imPUSH, rES,   none,  none,  0x06,  0,    0,    E_No64 },
+	{ imPUSH, rCS,   none,  none,  0x0E,  0,    0,    E_No64 },
+	{ imPUSH, rSS,   none,  none,  0x16,  0,    0,    E_No64 },
+	{ imPUSH, rDS,   none,  none,  0x1E,  0,    0,    E_No64 },
 	{ imPUSH, rFS,   none,  none,  0xA0,  0,    0,    E_TwoByte },
 	{ imPUSH, rGS,   none,  none,  0xA8,  0,    0,    E_TwoByte },
 	{ imPUSH, imm32, none,  none,  0x68,  0,    0,    0 },
@@ -1480,15 +1507,15 @@ const static struct mnedef mnetab[] = {
 
 	{ imPOP,  rm16,  none,  none,  0x8f,  0,    0,    E_16 },
 	{ imPOP,  rm32,  none,  none,  0x8f,  0,    0,    0 },
-	{ imPOP,  rES,   none,  none,  0x07,  0,    0,    0 },
-	{ imPOP,  rSS,   none,  none,  0x17,  0,    0,    0 },
-	{ imPOP,  rDS,   none,  none,  0x1F,  0,    0,    0 },
+	{ imPOP,  rES,   none,  none,  0x07,  0,    0,    E_No64 },
+	{ imPOP,  rSS,   none,  none,  0x17,  0,    0,    E_No64 },
+	{ imPOP,  rDS,   none,  none,  0x1F,  0,    0,    E_No64 },
 	{ imPOP,  r16,   none,  none,  0x58,  0,    0,    E_R | E_16 },
 	{ imPOP,  r32,   none,  none,  0x58,  0,    0,    E_R },
 
-	{ imPUSHA,none,  none,  none,  0x60,  0,    0,    0 },
+	{ imPUSHA,none,  none,  none,  0x60,  0,    0,    E_No64 },
 	{ imPUSHF,none,  none,  none,  0x9C,  0,    0,    0 },
-	{ imPOPA, none,  none,  none,  0x61,  0,    0,    0 },
+	{ imPOPA, none,  none,  none,  0x61,  0,    0,    E_No64 },
 	{ imPOPF, none,  none,  none,  0x9D,  0,    0,    0 },
 	{ imSAHF, none,  none,  none,  0x9E,  0,    0,    0 },
 	{ imLAHF, none,  none,  none,  0x9F,  0,    0,    0 },
@@ -1665,6 +1692,7 @@ struct opdesc {
 			UINT32 disp;    // displacement, if applicable
 			int    hasSib;  // true if there's a SIB byte
 			int    dispLen; // length in bytes of the displacement value
+			int    rip;     // x86-64: disp32 is RIP-relative, fixed up at commit
 		} mem;
 	} val;
 };
@@ -1713,7 +1741,7 @@ static int match_operand(optype t, struct opdesc *op)
 
 // Encode the MOD REG R/M byte for an instruction.  'rm' is the operand to encode
 // into the MOD RM fields, and 'r' is the operand to encode in the REG field.
-static byte *encode_modrm(byte *p, const struct mnedef *o, const struct opdesc *rm, const struct opdesc *r)
+static byte *encode_modrm(byte *p, const struct mnedef *o, const struct opdesc *rm, const struct opdesc *r, byte **ripp)
 {
 	// Start with the memory operand
 	if (rm->typ == opMem || rm->typ == opMem8 || rm->typ == opMem16 || rm->typ == opMem32)
@@ -1762,8 +1790,10 @@ static byte *encode_modrm(byte *p, const struct mnedef *o, const struct opdesc *
 		if (rm->val.mem.hasSib)
 			*p++ = rm->val.mem.sib;
 		
-		// add the displacement if present
+		// add the displacement if present, noting where a RIP-relative one goes
 		if (rm->val.mem.dispLen != 0) {
+			if (rm->val.mem.rip)
+				*ripp = p;
 			memcpy(p, &rm->val.mem.disp, rm->val.mem.dispLen);
 			p += rm->val.mem.dispLen;
 		}
@@ -1909,7 +1939,7 @@ void jit_emit(intelMneId mne, ...)
 	struct opdesc op[3];
 	int i;
 	const struct mnedef *m, *mbest;
-	byte buf[32], *p;
+	byte buf[32], *p, *ripp = 0;
 	struct instr *ins;
 	opdesctyp memType = opNone;
 
@@ -1986,16 +2016,20 @@ void jit_emit(intelMneId mne, ...)
 			op[n].val.mem.hasSib = 0;
 			op[n].val.mem.disp = 0;
 			op[n].val.mem.dispLen = 0;
+			op[n].val.mem.rip = 0;
 
 			// get the register or immediate value to index
 			r = va_arg(va, int);
 			if (r == Imm)
 			{
 				// indexing an immediate address - MOD REG RM = 00 xxx 101
-				// (disp32 with no index register)
+				// (disp32 with no index register).  In 64-bit mode the same
+				// encoding means [RIP+disp32]; the address is a JIT_ABS()
+				// offset, which we convert when the final location is known.
 				op[n].val.mem.disp = va_arg(va, int);
 				op[n].val.mem.dispLen = 4;
 				op[n].val.mem.MODrm = 0x05;
+				op[n].val.mem.rip = JIT_X64;
 			}
 			else
 			{
@@ -2033,6 +2067,7 @@ void jit_emit(intelMneId mne, ...)
 
 			op[n].typ = memType;
 			op[n].val.mem.hasSib = 0;
+			op[n].val.mem.rip = 0;
 
 			// check for registers that need special encodings
 			if (r == ESP) {
@@ -2075,6 +2110,7 @@ void jit_emit(intelMneId mne, ...)
 			op[n].val.mem.hasSib = 1;
 			op[n].val.mem.disp = 0;
 			op[n].val.mem.dispLen = 0;
+			op[n].val.mem.rip = 0;
 
 			// check if there's a scale
 			if (a == IdxScaleDisp || a == BaseIdxScaleDisp) {
@@ -2175,6 +2211,7 @@ void jit_emit(intelMneId mne, ...)
 	{
 		// check for an instruction match and operand matches
 		if (m->mne == mne
+			&& !(JIT_X64 && (m->flags & E_No64))
 			&& match_operand(m->op1, &op[0])
 			&& match_operand(m->op2, &op[1])
 			&& match_operand(m->op3, &op[2]))
@@ -2194,6 +2231,16 @@ void jit_emit(intelMneId mne, ...)
 	// start generating the instruction machine code bytes
 	p = buf;
 
+	// In 64-bit mode, arithmetic on ESP has to operate on the whole RSP
+	// (e.g., ADD ESP,8 to discard arguments), so add a REX.W prefix.
+	if (JIT_X64
+		&& ((op[0].typ == opReg32 && op[0].val.reg == rrr(ESP))
+			|| (op[1].typ == opReg32 && op[1].val.reg == rrr(ESP))))
+	{
+		ASSERT(!(mbest->flags & (E_16 | E_TwoByte)));
+		*p++ = REX_W;
+	}
+
 	// add the TWOBYTE prefix if necessary
 	if (mbest->flags & E_TwoByte)
 		*p++ = TWOBYTE;
@@ -2220,12 +2267,12 @@ void jit_emit(intelMneId mne, ...)
 	if (mbest->op1 == rm8 || mbest->op1 == rm16 || mbest->op1 == rm32)
 	{
 		// the left operand is the MOD R/M
-		p = encode_modrm(p, mbest, &op[0], &op[1]);
+		p = encode_modrm(p, mbest, &op[0], &op[1], &ripp);
 	}
 	else if (mbest->op2 == rm8 || mbest->op2 == rm16 || mbest->op2 == rm32)
 	{
 		// the right operand is the MOD R/M
-		p = encode_modrm(p, mbest, &op[1], &op[0]);
+		p = encode_modrm(p, mbest, &op[1], &op[0], &ripp);
 	}
 	else if ((mbest->flags & (E_ImpR | E_RExt)) != 0
 			 && (mbest->op1 == r8 || mbest->op1 == r16 || mbest->op1 == r32))
@@ -2243,6 +2290,12 @@ void jit_emit(intelMneId mne, ...)
 	// store the generated instruction
 	ins = add_instr(p - buf, buf);
 
+	// note the RIP-relative displacement, if any, for fixup at commit
+	if (ripp != 0) {
+		ins->ripofs = ripp - buf;
+		ins->ripdisp = *(INT32 *)ripp;
+	}
+
 	// set the label, if there is one
 	ins->lbl = (op[0].typ == opLbl ? op[0].val.lbl :
 				op[1].typ == opLbl ? op[1].val.lbl :
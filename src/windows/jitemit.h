@@ -174,8 +174,14 @@ void jit_emit_commit(struct jit_ctl *jit);
  *   supplied in the varargs.
  */
 typedef enum intelMneId intelMneId;
+#ifdef __GNUC__
+// gcc needs the ## extension to drop the comma for operand-less mnemonics (emit(RETN))
+#define emit(mne, ...) jit_emit(im##mne, ##__VA_ARGS__, EndOfOps)
+#define emitv(mne, ...) jit_emit(mne, ##__VA_ARGS__, EndOfOps)
+#else
 #define emit(mne, ...) jit_emit(im##mne, __VA_ARGS__, EndOfOps)
 #define emitv(mne, ...) jit_emit(mne, __VA_ARGS__, EndOfOps)
+#endif
 void jit_emit(intelMneId mne, ...);
 
 /*
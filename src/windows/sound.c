@@ -186,6 +186,23 @@ int osd_start_audio_stream(int stereo)
 
 
 
+//============================================================
+//	osd_set_audio_block
+//============================================================
+
+int osd_set_audio_block(int samples)
+{
+	// from now on a "frame" is a block, the buffer thresholds don't depend on it
+	samples_per_frame = (double)samples;
+	samples_left_over = 0;
+	samples_this_frame = samples;
+
+	// return the samples to play the first block
+	return samples_this_frame;
+}
+
+
+
 //============================================================
 //	osd_stop_audio_stream
 //============================================================
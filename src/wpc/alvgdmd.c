@@ -21,7 +21,7 @@
 static UINT8  *dmd32RAM;
 static UINT8 level[5] = { 0, 3, 7, 11, 15 }; // brightness mapping 0,25,50,75,100%
 
-#ifdef VPINMAME
+#ifdef CORE_RAWDMD
 extern UINT8  g_raw_gtswpc_dmd[];
 extern UINT32 g_raw_gtswpc_dmdframes;
 #endif
@@ -344,12 +344,12 @@ static void pistol_poker__mystery_castle_dmd(tDMDDot dotCol) {
   int ii,jj;
   RAM += dmdlocals.vid_page << 11;
 
-#ifdef VPINMAME
+#ifdef CORE_RAWDMD
   g_raw_gtswpc_dmdframes = 4;
 #endif
 
   if (dmdlocals.planenable) {
-#ifdef VPINMAME
+#ifdef CORE_RAWDMD
 	  memcpy (g_raw_gtswpc_dmd, RAM, 0x800);
 #endif
 
@@ -369,7 +369,7 @@ static void pistol_poker__mystery_castle_dmd(tDMDDot dotCol) {
 		*line = 0;
 	  }
   } else {
-#ifdef VPINMAME
+#ifdef CORE_RAWDMD
 	  memcpy (g_raw_gtswpc_dmd, RAM, 0x200);
 	  memcpy (g_raw_gtswpc_dmd+0x200, RAM, 0x200);
 	  memcpy (g_raw_gtswpc_dmd+0x400, RAM, 0x200);
@@ -3,11 +3,15 @@
 /***********************************************/
 #include <stdarg.h>
 #include "driver.h"
+#include "state.h"
 #include "sim.h"
 #include "snd_cmd.h"
 #include "mech.h"
 #include "core.h"
 #include "video.h"
+#include "dmdkern.h"
+#include "dmdcap.h"
+#include "swrec.h"
 
 #ifdef PROC_SUPPORT
  #include "p-roc/p-roc.h"
@@ -27,11 +31,18 @@
  static UINT8 *oldbuffer = NULL;
  static UINT32 raw_dmdoffs = 0;
 
+ UINT32 g_needs_DMD_update = 1;
+#endif
+#ifdef CORE_RAWDMD
  #include "gts3dmd.h"
  UINT8  g_raw_gtswpc_dmd[GTS3DMD_FRAMES_5C*0x200];
  UINT32 g_raw_gtswpc_dmdframes = 0;
 
- UINT32 g_needs_DMD_update = 1;
+ /*-- DMD capture file (VPinMAME: DmdDump\<game>.dmdcap, xpinmame: -dmdcapture) --*/
+ static struct {
+   dmdcap_tWriter *writer;
+   int failed;
+ } dmdCapture;
 #endif
 
 /* stuff to test VPINMAME */
@@ -66,6 +77,15 @@ void vp_setDIP(int bank, int value) { }
   #define vp_setDIP(x,y)
 #endif /* VPINMAME */
 
+#ifdef LIBPINMAME
+  extern void libpinmame_updateDMD(int width, int height, int levels, tDMDDot dotCol);
+  extern void vp_queueChangeEvents(void);
+#endif
+#ifdef XMAME
+  extern void shmout_updateDMD(int width, int height, int levels, tDMDDot dotCol, int rawFrames, const UINT8 *raw);
+  extern void shmout_updateState(void);
+#endif
+
 static void drawChar(struct mame_bitmap *bitmap, int row, int col, UINT32 bits, int type, int dimming);
 static UINT32 core_initDisplaySize(const struct core_dispLayout *layout);
 static VIDEO_UPDATE(core_status);
@@ -622,6 +642,10 @@ static struct {
   int       firstSimRow, maxSimRows; // space available for simulator
   int       solLog[4];
   int       solLogCount;
+  UINT32    warpDMD;       // DMD frame hash that ends the warp (-warp_dmd)
+  core_tPWM lampPWM[2];    // lamp matrix columns 0-3 and 4-7, one sample per scan
+  UINT32    lampScan[2];   // lamps on in the current scan
+  int       lampCol;       // last strobed column, -1 = no lamp strobes reported
 } locals;
 
 /*-------------------------------
@@ -741,88 +765,132 @@ static PALETTE_INIT(core) {
 #endif /* MAMEVER */
 }
 
+#ifdef CORE_RAWDMD
+/*-- add a frame to the DMD capture file, filename is only used to open it --*/
+static void core_captureDMD(const char *filename, int width, int height, int levels, const UINT8 palette[16][3], const UINT8 *dots, int pitch) {
+  if (!dmdCapture.writer && !dmdCapture.failed) {
+    if ((dmdCapture.writer = dmdcap_open(filename, Machine->gamedrv->name)) == NULL) {
+      logerror("DMD capture: can't create %s\n", filename);
+      dmdCapture.failed = 1;
+    }
+  }
+  if (dmdCapture.writer)
+    dmdcap_frame(dmdCapture.writer, (UINT32)(timer_get_time() * 1000.0), width, height, levels, palette,
+                 dots, pitch, g_raw_gtswpc_dmdframes, g_raw_gtswpc_dmd);
+}
+#endif
+
 /*-----------------------------------
 /    Generic DMD display handler
 /------------------------------------*/
 void video_update_core_dmd(struct mame_bitmap *bitmap, const struct rectangle *cliprect, tDMDDot dotCol, const struct core_dispLayout *layout) {
+  /*-- brightness & color/palette tables for mappings from internal DMD representation, --*/
+  /*-- only rebuilt when the game or the options change                                 --*/
+  static struct {
+    const struct GameDriver *game;
+    tPMoptions opts;
+    int shade_16_enabled;
+#ifdef VPINMAME
+    UINT8  raw_4[4], raw_16[16];
+    UINT32 palette32_4[4], palette32_16[16];
+#endif
+#ifdef CORE_RAWDMD
+    UINT8  capturePalette[16][3];
+#endif
+  } dmdTables;
 
   UINT32 *dmdColor = &CORE_COLOR(COL_DMDOFF);
   UINT32 *aaColor  = &CORE_COLOR(COL_DMDAA);
   BMTYPE **lines = ((BMTYPE **)bitmap->line) + (layout->top*locals.displaySize);
   int noaa = !pmoptions.dmd_antialias || (layout->type & CORE_DMDNOAA);
-  int ii, jj;
+  int shade_16_enabled;
+  int ii;
+#ifdef VPINMAME
+  int jj;
+#endif
 
-  // prepare all brightness & color/palette tables for mappings from internal DMD representation:
-  const int shade_16_enabled = ((core_gameData->gen == GEN_SAM) ||
+  if (dmdTables.game != Machine->gamedrv || memcmp(&dmdTables.opts, &pmoptions, sizeof(pmoptions))) {
+    dmdTables.game = Machine->gamedrv;
+    memcpy(&dmdTables.opts, &pmoptions, sizeof(pmoptions));
+    dmdTables.shade_16_enabled = ((core_gameData->gen == GEN_SAM) ||
 	  // extended handling also for some GTS3 games (SMB, SMBMW and CBW):
 	  (_strnicmp(Machine->gamedrv->name, "smb", 3) == 0) || (_strnicmp(Machine->gamedrv->name, "cueball", 7) == 0) ||
 	  (core_gameData->gen == GEN_ALVG_DMD2));
-
 #ifdef VPINMAME
+    {
+      const UINT8 perc0 = (pmoptions.dmd_perc0  > 0) ? pmoptions.dmd_perc0  : 20;
+      const UINT8 perc1 = (pmoptions.dmd_perc33 > 0) ? pmoptions.dmd_perc33 : 33;
+      const UINT8 perc2 = (pmoptions.dmd_perc66 > 0) ? pmoptions.dmd_perc66 : 67;
+      const UINT8 perc3 = 100;
 
-  const UINT8 perc0 = (pmoptions.dmd_perc0  > 0) ? pmoptions.dmd_perc0  : 20;
-  const UINT8 perc1 = (pmoptions.dmd_perc33 > 0) ? pmoptions.dmd_perc33 : 33;
-  const UINT8 perc2 = (pmoptions.dmd_perc66 > 0) ? pmoptions.dmd_perc66 : 67;
-  const UINT8 perc3 = 100;
-
-  static const int levelgts3[16] = {0/*5*/, 30, 35, 40, 45, 50, 55, 60, 65, 70, 75, 80, 85, 90, 95, 100}; // GTS3 and AlvinG brightness seems okay
-  static const int levelsam[16]  = {0/*5*/, 20, 25, 30, 35, 40, 45, 50, 55, 60, 65, 70, 75, 80, 90, 100}; // SAM brightness seems okay
+      static const int levelgts3[16] = {0/*5*/, 30, 35, 40, 45, 50, 55, 60, 65, 70, 75, 80, 85, 90, 95, 100}; // GTS3 and AlvinG brightness seems okay
+      static const int levelsam[16]  = {0/*5*/, 20, 25, 30, 35, 40, 45, 50, 55, 60, 65, 70, 75, 80, 90, 100}; // SAM brightness seems okay
 
-  const int * const level = (core_gameData->gen == GEN_SAM) ? levelsam : levelgts3;
+      const int * const level = (core_gameData->gen == GEN_SAM) ? levelsam : levelgts3;
 
-  const UINT8 raw_4[4]   = {perc0,perc1,perc2,perc3};
-  const UINT8 raw_16[16] = {level[0],level[1],level[2],level[3],level[4],level[5],level[6],level[7],level[8],level[9],level[10],level[11],level[12],level[13],level[14],level[15]};
+      unsigned char palette[4][3];
 
-  UINT32 palette32_4[4];
-  UINT32 palette32_16[16];
-  unsigned char palette[4][3];
+      int rStart = 0xFF, gStart = 0xE0, bStart = 0x20;
+      if ((pmoptions.dmd_red > 0) || (pmoptions.dmd_green > 0) || (pmoptions.dmd_blue > 0)) {
+        rStart = pmoptions.dmd_red; gStart = pmoptions.dmd_green; bStart = pmoptions.dmd_blue;
+      }
 
-  int rStart = 0xFF, gStart = 0xE0, bStart = 0x20;
-  if ((pmoptions.dmd_red > 0) || (pmoptions.dmd_green > 0) || (pmoptions.dmd_blue > 0)) {
-	  rStart = pmoptions.dmd_red; gStart = pmoptions.dmd_green; bStart = pmoptions.dmd_blue;
-  }
+      dmdTables.raw_4[0] = perc0; dmdTables.raw_4[1] = perc1; dmdTables.raw_4[2] = perc2; dmdTables.raw_4[3] = perc3;
+      for (ii = 0; ii < 16; ii++)
+        dmdTables.raw_16[ii] = level[ii];
+
+      /*-- Autogenerate DMD Color Shades--*/
+      palette[0][0] = rStart * perc0 / 100;
+      palette[0][1] = gStart * perc0 / 100;
+      palette[0][2] = bStart * perc0 / 100;
+      palette[1][0] = rStart * perc1 / 100;
+      palette[1][1] = gStart * perc1 / 100;
+      palette[1][2] = bStart * perc1 / 100;
+      palette[2][0] = rStart * perc2 / 100;
+      palette[2][1] = gStart * perc2 / 100;
+      palette[2][2] = bStart * perc2 / 100;
+      palette[3][0] = rStart * perc3 / 100;
+      palette[3][1] = gStart * perc3 / 100;
+      palette[3][2] = bStart * perc3 / 100;
+
+      /*-- If the "colorize" option is set, use the individual option colors for the shades --*/
+      if (pmoptions.dmd_colorize) {
+        if (pmoptions.dmd_red0 > 0 || pmoptions.dmd_green0 > 0 || pmoptions.dmd_blue0 > 0) {
+          palette[0][0] = pmoptions.dmd_red0;
+          palette[0][1] = pmoptions.dmd_green0;
+          palette[0][2] = pmoptions.dmd_blue0;
+        }
+        if (pmoptions.dmd_red33 > 0 || pmoptions.dmd_green33 > 0 || pmoptions.dmd_blue33 > 0) {
+          palette[1][0] = pmoptions.dmd_red33;
+          palette[1][1] = pmoptions.dmd_green33;
+          palette[1][2] = pmoptions.dmd_blue33;
+        }
+        if (pmoptions.dmd_red66 > 0 || pmoptions.dmd_green66 > 0 || pmoptions.dmd_blue66 > 0) {
+          palette[2][0] = pmoptions.dmd_red66;
+          palette[2][1] = pmoptions.dmd_green66;
+          palette[2][2] = pmoptions.dmd_blue66;
+        }
+      }
 
-  /*-- Autogenerate DMD Color Shades--*/
-  palette[0][0] = rStart * perc0 / 100;
-  palette[0][1] = gStart * perc0 / 100;
-  palette[0][2] = bStart * perc0 / 100;
-  palette[1][0] = rStart * perc1 / 100;
-  palette[1][1] = gStart * perc1 / 100;
-  palette[1][2] = bStart * perc1 / 100;
-  palette[2][0] = rStart * perc2 / 100;
-  palette[2][1] = gStart * perc2 / 100;
-  palette[2][2] = bStart * perc2 / 100;
-  palette[3][0] = rStart * perc3 / 100;
-  palette[3][1] = gStart * perc3 / 100;
-  palette[3][2] = bStart * perc3 / 100;
+      for (ii = 0; ii < 4; ++ii)
+        dmdTables.palette32_4[ii] = (UINT32)palette[ii][0] | (((UINT32)palette[ii][1]) << 8) | (((UINT32)palette[ii][2]) << 16);
 
-  /*-- If the "colorize" option is set, use the individual option colors for the shades --*/
-  if (pmoptions.dmd_colorize) {
-	  if (pmoptions.dmd_red0 > 0 || pmoptions.dmd_green0 > 0 || pmoptions.dmd_blue0 > 0) {
-		  palette[0][0] = pmoptions.dmd_red0;
-		  palette[0][1] = pmoptions.dmd_green0;
-		  palette[0][2] = pmoptions.dmd_blue0;
-	  }
-	  if (pmoptions.dmd_red33 > 0 || pmoptions.dmd_green33 > 0 || pmoptions.dmd_blue33 > 0) {
-		  palette[1][0] = pmoptions.dmd_red33;
-		  palette[1][1] = pmoptions.dmd_green33;
-		  palette[1][2] = pmoptions.dmd_blue33;
-	  }
-	  if (pmoptions.dmd_red66 > 0 || pmoptions.dmd_green66 > 0 || pmoptions.dmd_blue66 > 0) {
-		  palette[2][0] = pmoptions.dmd_red66;
-		  palette[2][1] = pmoptions.dmd_green66;
-		  palette[2][2] = pmoptions.dmd_blue66;
-	  }
+      for (ii = 0; ii < 16; ++ii)
+        dmdTables.palette32_16[ii] = (rStart*level[ii]/100) | ((gStart*level[ii]/100) << 8) | ((bStart*level[ii]/100) << 16);
+    }
+#endif
+#ifdef CORE_RAWDMD
+    memset(dmdTables.capturePalette, 0, sizeof(dmdTables.capturePalette));
+    for (ii = 0; ii < (dmdTables.shade_16_enabled ? 16 : 4); ii++)
+      palette_get_color(COL_DMDOFF + (dmdTables.shade_16_enabled ? 63 : 0) + ii, &dmdTables.capturePalette[ii][0],
+                        &dmdTables.capturePalette[ii][1], &dmdTables.capturePalette[ii][2]);
+#endif
   }
+  shade_16_enabled = dmdTables.shade_16_enabled;
+  if (shade_16_enabled)
+    dmdColor += 63;
 
-  for (ii = 0; ii < 4; ++ii)
-     palette32_4[ii] = (UINT32)palette[ii][0] | (((UINT32)palette[ii][1]) << 8) | (((UINT32)palette[ii][2]) << 16);
-
-  for(ii = 0; ii < 16; ++ii)
-     palette32_16[ii] = (rStart*level[ii]/100) | ((gStart*level[ii]/100) << 8) | ((bStart*level[ii]/100) << 16);
-
-  //
-
+#ifdef VPINMAME
   if(layout->length >= 128) // Capcom hack
   {
       g_raw_dmdx = layout->length;
@@ -839,45 +907,58 @@ void video_update_core_dmd(struct mame_bitmap *bitmap, const struct rectangle *c
               raw_dmdoffs = 0;
       }
   }
+  for (ii = 1; ii < layout->start+1; ii++) {
+    const UINT8 * const dots = &dotCol[ii][0];
+    UINT8 * const raw = &g_raw_dmdbuffer[(ii-1)*layout->length + raw_dmdoffs];
+    UINT32 * const rawColor = &g_raw_colordmdbuffer[(ii-1)*layout->length + raw_dmdoffs];
+
+    memcpy(&currbuffer[(ii-1)*layout->length], dots, layout->length);
+    if(layout->length >= 128) { // Capcom hack
+      const UINT8  * const rawLevel = shade_16_enabled ? dmdTables.raw_16 : dmdTables.raw_4;
+      const UINT32 * const rawPalette = shade_16_enabled ? dmdTables.palette32_16 : dmdTables.palette32_4;
+      for (jj = 0; jj < layout->length; jj++) {
+        raw[jj] = rawLevel[dots[jj]];
+        rawColor[jj] = rawPalette[dots[jj]];
+      }
+    }
+  }
 #endif
 
+  /*-- end the warp (fast forward) when the DMD shows the frame --*/
+  if (locals.warpDMD && cpu_warping() &&
+      dmdcap_hash(&dotCol[1][0], layout->length, layout->start, sizeof(dotCol[0])) == locals.warpDMD)
+    cpu_warp(0, 0);
+
   memset(&dotCol[layout->start+1][0], 0, sizeof(dotCol[0][0])*layout->length+1);
   memset(&dotCol[0][0], 0, sizeof(dotCol[0][0])*layout->length+1); // clear above
+  for (ii = 1; ii < layout->start+1; ii++)
+    dotCol[ii][layout->length] = 0; // to simplify antialiasing
   for (ii = 0; ii < layout->start+1; ii++) {
     BMTYPE *line = (*lines++) + (layout->left*locals.displaySize);
-    dotCol[ii][layout->length] = 0;
-    if (ii > 0) {
-      for (jj = 0; jj < layout->length; jj++) {
-		const UINT8 col = dotCol[ii][jj];
-#ifdef VPINMAME
-		const int offs = (ii-1)*layout->length + jj;
-		currbuffer[offs] = col;
-		if(layout->length >= 128) { // Capcom hack
-			g_raw_dmdbuffer[offs + raw_dmdoffs] = shade_16_enabled ? raw_16[col] : raw_4[col];
-			g_raw_colordmdbuffer[offs + raw_dmdoffs] = shade_16_enabled ? palette32_16[col] : palette32_4[col];
-		}
-#endif
-		*line++ = shade_16_enabled ? dmdColor[col+63] : dmdColor[col];
-        if (locals.displaySize > 1 && jj < layout->length-1)
-          *line++ = noaa ? 0 : aaColor[col + dotCol[ii][jj+1]];
-      }
-    }
+    if (ii > 0)
+      dmdk_renderRow(line, &dotCol[ii][0], layout->length, dmdColor, locals.displaySize, noaa ? NULL : aaColor);
     if (locals.displaySize > 1) {
-      int col1 = dotCol[ii][0] + dotCol[ii+1][0];
       line = (*lines++) + (layout->left*locals.displaySize);
-      for (jj = 0; jj < layout->length; jj++) {
-        int col2 = dotCol[ii][jj+1] + dotCol[ii+1][jj+1];
-        *line++ = noaa ? 0 : aaColor[col1];
-        if (jj < layout->length-1)
-          *line++ = noaa ? 0 : aaColor[2*(col1 + col2)/5];
-        col1 = col2;
-      }
+      dmdk_renderAARow(line, &dotCol[ii][0], &dotCol[ii+1][0], layout->length, noaa ? NULL : aaColor);
     }
   }
 
   osd_mark_dirty(layout->left*locals.displaySize,layout->top*locals.displaySize,
                  (layout->left+layout->length)*locals.displaySize,(layout->top+layout->start)*locals.displaySize);
 
+#ifdef LIBPINMAME
+  libpinmame_updateDMD(layout->length, layout->start, shade_16_enabled ? 16 : 4, dotCol);
+#endif
+#ifdef XMAME
+  if (layout->length >= 128) { // skip small extra DMDs like the one of Flipper Football
+    shmout_updateDMD(layout->length, layout->start, shade_16_enabled ? 16 : 4, dotCol, g_raw_gtswpc_dmdframes, g_raw_gtswpc_dmd);
+    if (pmoptions.dmd_capture)
+      core_captureDMD(pmoptions.dmd_capture, layout->length, layout->start, shade_16_enabled ? 16 : 4,
+                      dmdTables.capturePalette, &dotCol[1][0], sizeof(dotCol[0]));
+    g_raw_gtswpc_dmdframes = 0;
+  }
+#endif
+
 #ifdef VPINMAME
 
   if ((layout->length == 128) || (layout->length == 192) || (layout->length == 256)) { // filter 16x8 output from Flipper Football
@@ -891,70 +972,26 @@ void video_update_core_dmd(struct mame_bitmap *bitmap, const struct rectangle *c
 		  {
 			  g_needs_DMD_update = 1;
 
-			  if ((g_fShowPinDMD && g_fShowWinDMD) || g_fDumpFrames)	// output dump frame to .txt
+			  if ((g_fShowPinDMD && g_fShowWinDMD) || g_fDumpFrames)	// record frame to DmdDump\<game>.dmdcap
 			  {
-				  FILE *f;
 				  char *ptr;
 				  char DumpFilename[MAX_PATH];
 
-				  const DWORD tick = GetTickCount();
+				  DumpFilename[0] = '\0';
+				  if (!dmdCapture.writer) {
 #ifndef _WIN64
-				  const HINSTANCE hInst = GetModuleHandle("VPinMAME.dll");
+					  const HINSTANCE hInst = GetModuleHandle("VPinMAME.dll");
 #else
-				  const HINSTANCE hInst = GetModuleHandle("VPinMAME64.dll");
+					  const HINSTANCE hInst = GetModuleHandle("VPinMAME64.dll");
 #endif
-				  GetModuleFileName(hInst, DumpFilename, MAX_PATH);
-				  ptr = strrchr(DumpFilename, '\\');
-				  strcpy_s(ptr + 1, 11, "DmdDump\\");
-				  strcat_s(DumpFilename, MAX_PATH, Machine->gamedrv->name);
-
-				  if (g_raw_gtswpc_dmdframes != 0) {
-					  FILE* fr;
-					  char RawFilename[MAX_PATH];
-					  strcpy_s(RawFilename, MAX_PATH, DumpFilename);
-					  strcat_s(RawFilename, MAX_PATH, ".raw");
-					  fr = fopen(RawFilename, "rb");
-					  if (fr) {
-						  fclose(fr);
-						  fr = fopen(RawFilename, "ab");
-					  }
-					  else {
-						  fr = fopen(RawFilename, "ab");
-						  if(fr)
-						  {
-							  fputc(0x52, fr);
-							  fputc(0x41, fr);
-							  fputc(0x57, fr);
-							  fputc(0x00, fr);
-							  fputc(0x01, fr);
-							  fputc(layout->length, fr);
-							  fputc(layout->start, fr);
-							  fputc(g_raw_gtswpc_dmdframes, fr);
-						  }
-					  }
-					  if(fr)
-					  {
-						  fwrite(&tick, 1, 4, fr);
-						  fwrite(g_raw_gtswpc_dmd, 1, (layout->length * layout->start / 8 * g_raw_gtswpc_dmdframes), fr);
-						  fclose(fr);
-					  }
-				  }
-
-				  strcat_s(DumpFilename, MAX_PATH, ".txt");
-				  f = fopen(DumpFilename, "a");
-				  if (f) {
-					  fprintf(f, "0x%08x\n", tick);
-					  for (jj = 0; jj < layout->start; jj++) {
-						  for (ii = 0; ii < layout->length; ii++)
-						  {
-							  const UINT8 col = currbuffer[jj*layout->length + ii];
-							  fprintf(f, "%01x", col);
-						  }
-						  fprintf(f, "\n");
-					  }
-					  fprintf(f, "\n");
-					  fclose(f);
+					  GetModuleFileName(hInst, DumpFilename, MAX_PATH);
+					  ptr = strrchr(DumpFilename, '\\');
+					  strcpy_s(ptr + 1, 11, "DmdDump\\");
+					  strcat_s(DumpFilename, MAX_PATH, Machine->gamedrv->name);
+					  strcat_s(DumpFilename, MAX_PATH, ".dmdcap");
 				  }
+				  core_captureDMD(DumpFilename, layout->length, layout->start, shade_16_enabled ? 16 : 4,
+				                  dmdTables.capturePalette, currbuffer, layout->length);
 			  }
 		  }
 	  }
@@ -1262,6 +1299,28 @@ void core_updateSw(int flipEn) {
       }
     }
   }
+  { /*-- brightness of the matrix lamps, on/off if the driver doesn't report the strobes --*/
+    UINT8 levels[64];
+    if (locals.lampCol >= 0) {
+      core_pwm_levels(&locals.lampPWM[0], 32, levels);
+      core_pwm_levels(&locals.lampPWM[1], 32, levels + 32);
+    }
+    else
+      for (ii = 0; ii < 64; ii++)
+        levels[ii] = ((coreGlobals.lampMatrix[ii/8] >> (ii%8)) & 0x01) ? 255 : 0;
+    memcpy((UINT8 *)coreGlobals.lampLevels, levels, sizeof(levels));
+  }
+#ifdef LIBPINMAME
+  /*-- queue lamp/solenoid/GI changes for vp_getChangeEvents (libpinmame drains them) --*/
+  vp_queueChangeEvents();
+#endif
+#ifdef XMAME
+  shmout_updateState();
+#endif
+
+  /*-- end the warp (fast forward) when the switch is set --*/
+  if (pmoptions.warp_switch && cpu_warping() && core_getSw(pmoptions.warp_switch))
+    cpu_warp(0, 0);
 
   /*-- check if we should use simulator keys --*/
   if (g_fHandleKeyboard &&
@@ -1724,6 +1783,34 @@ static void drawChar(struct mame_bitmap *bitmap, int row, int col, UINT32 bits,
   osd_mark_dirty(col,row,col+s->cols,row+s->rows);
 }
 
+/*-----------------------------------------------
+/  Save state: the board state that is shared by
+/  all generations. Drivers add their own in init.
+/------------------------------------------------*/
+static void core_postload(void) {
+  schedule_full_refresh();
+}
+
+static void core_registerState(void) {
+  state_save_register_UINT8 ("core", 0, "swMatrix",      (UINT8 *)coreGlobals.swMatrix, CORE_MAXSWCOL);
+  state_save_register_UINT8 ("core", 0, "invSw",         (UINT8 *)coreGlobals.invSw, CORE_MAXSWCOL);
+  state_save_register_UINT8 ("core", 0, "lampMatrix",    (UINT8 *)coreGlobals.lampMatrix, CORE_MAXLAMPCOL);
+  state_save_register_UINT8 ("core", 0, "tmpLampMatrix", (UINT8 *)coreGlobals.tmpLampMatrix, CORE_MAXLAMPCOL);
+  state_save_register_UINT8 ("core", 0, "RGBlamps",      (UINT8 *)coreGlobals.RGBlamps, CORE_MAXRGBLAMPS);
+  state_save_register_UINT16("core", 0, "segments",      &coreGlobals.segments[0].w, CORE_SEGCOUNT);
+  state_save_register_INT8  ("core", 0, "segDim",        (INT8 *)coreGlobals.segDim, CORE_SEGCOUNT);
+  state_save_register_UINT32("core", 0, "solenoids",     (UINT32 *)&coreGlobals.solenoids, 1);
+  state_save_register_UINT32("core", 0, "solenoids2",    (UINT32 *)&coreGlobals.solenoids2, 1);
+  state_save_register_UINT8 ("core", 0, "modulatedSolenoids", (UINT8 *)coreGlobals.modulatedSolenoids, 2*CORE_MODSOL_MAX);
+  state_save_register_UINT32("core", 0, "pulsedSolState", (UINT32 *)&coreGlobals.pulsedSolState, 1);
+  state_save_register_UINT32("core", 0, "lastSol",       (UINT32 *)&coreGlobals.lastSol, 2);
+  state_save_register_INT32 ("core", 0, "gi",            (INT32 *)coreGlobals.gi, CORE_MAXGI);
+  state_save_register_INT32 ("core", 0, "diagnosticLed", (INT32 *)&coreGlobals.diagnosticLed, 1);
+  state_save_register_UINT16("core", 0, "lastSeg",       &locals.lastSeg[0].w, CORE_SEGCOUNT);
+  state_save_register_INT32 ("core", 0, "flipTimer",     (INT32 *)locals.flipTimer, 4);
+  state_save_register_func_postload(core_postload);
+}
+
 /*----------------------
 /  Initialize PinMAME
 /-----------------------*/
@@ -1737,6 +1824,9 @@ static MACHINE_INIT(core) {
     memset(&coreGlobals, 0, sizeof(coreGlobals));
     memset(&locals, 0, sizeof(locals));
     memset(&locals.lastSeg, -1, sizeof(locals.lastSeg));
+    core_pwm_init(&locals.lampPWM[0], CORE_LAMPPWM_WINDOW);
+    core_pwm_init(&locals.lampPWM[1], CORE_LAMPPWM_WINDOW);
+    locals.lampCol = -1;
     coreData = (struct pinMachine *)&Machine->drv->pinmame;
     //-- initialise timers --
     if (coreData->timers[0].callback) {
@@ -1817,6 +1907,7 @@ static MACHINE_INIT(core) {
       coreGlobals.simAvail = sim_init((sim_tSimData *)core_gameData->simData,
                                          inports,CORE_COREINPORT+(coreData->coreDips+31)/16);
     }
+    core_registerState();
     /*-- finally init the core --*/
     if (coreData->init) coreData->init();
     /*-- init sound commander --*/
@@ -1825,6 +1916,12 @@ static MACHINE_INIT(core) {
   /*-- now reset everything --*/
   if (coreData->reset) coreData->reset();
   mech_emuInit();
+  swrec_init();
+
+  /*-- fast forward over the boot until a switch is set or the DMD shows a frame --*/
+  locals.warpDMD = pmoptions.warp_dmd ? (UINT32)strtoul(pmoptions.warp_dmd, NULL, 16) : 0;
+  if (pmoptions.warp_switch || locals.warpDMD)
+    cpu_warp((options.warp > 0) ? options.warp : TIME_NEVER, locals.warpDMD ? 4 : 0);
   OnStateChange(1); /* We have a lift-off */
 
 /* TOM: this causes to draw the static sim text */
@@ -1852,11 +1949,17 @@ static MACHINE_STOP(core) {
   oldbuffer = NULL;
   raw_dmdoffs = 0;
 
-  g_raw_gtswpc_dmdframes = 0;
-  
   g_needs_DMD_update = 1;
 #endif
+#ifdef CORE_RAWDMD
+  g_raw_gtswpc_dmdframes = 0;
+  if (dmdCapture.writer && !dmdcap_close(dmdCapture.writer))
+    logerror("DMD capture: write error\n");
+  dmdCapture.writer = NULL;
+  dmdCapture.failed = 0;
+#endif
 
+  swrec_exit();
   mech_emuExit();
   if (coreData->stop) coreData->stop();
   snd_cmd_exit();
@@ -1962,31 +2065,45 @@ void core_nvram(void *file, int write, void *mem, size_t length, UINT8 init) {
   }
 }
 
-static const unsigned char core_bits_set_table256[256] =
-{
-#   define B2(n) n,     n+1,     n+1,     n+2
-#   define B4(n) B2(n), B2(n+1), B2(n+1), B2(n+2)
-#   define B6(n) B4(n), B4(n+1), B4(n+1), B4(n+2)
-    B6(0), B6(1), B6(1), B6(2)
-};
+/*-------------------------------------
+/  PWM integration, see core.h
+/  No smoothing with the previous level,
+/  it made the AFM monsters stop shaking
+/  intermittently.
+/--------------------------------------*/
+void core_pwm_setModSol(const core_tPWM *pwm) {
+  UINT8 levels[32];
+  int ii;
 
-UINT8 core_calc_modulated_light(UINT32 bits, UINT32 bit_count, UINT8 *prev_level)
-{
-	//UINT8 outputlevel;
-	UINT32 targetlevel;
-	UINT32 mask = (1 << bit_count) - 1;
-
-	bits &= mask;
-	targetlevel = ((UINT32)core_bits_set_table256[bits & 0xff] +
-		core_bits_set_table256[(bits >> 8) & 0xff] +
-		core_bits_set_table256[(bits >> 16) & 0xff] +
-		core_bits_set_table256[(bits >> 24) & 0xff]) * 255 / bit_count;
-	// Apply some smoothing with the previous level
-	// 12/8 - Commenting out for now, causes AFM monsters to stop shaking intermittently.
-	// outputlevel = (UINT8)((targetlevel + *prev_level) / 2);
-	// return outputlevel;
-	*prev_level = (UINT8)targetlevel;
-	return targetlevel;
+  core_pwm_levels(pwm, 32, levels);
+  for (ii = 0; ii < 32; ii++)
+    coreGlobals.modulatedSolenoids[CORE_MODSOL_CUR][ii] = levels[ii];
+  for (; ii < CORE_MODSOL_MAX; ii++)
+    coreGlobals.modulatedSolenoids[CORE_MODSOL_CUR][ii] = core_getSol(ii + 1) ? 1 : 0;
+}
+
+/*-------------------------------------
+/  A lamp is on in a scan if it was on
+/  at any write while its column was
+/  strobed, as in tmpLampMatrix. A scan
+/  ends when a lower column is strobed.
+/--------------------------------------*/
+void core_pwm_lampStrobe(int col, int row) {
+  int first, ii;
+
+  col &= 0xff;
+  if (!col) return;
+  for (first = 0; !(col & (1 << first)); first++)
+    ;
+  if (first < locals.lampCol) {
+    core_pwm_record(&locals.lampPWM[0], locals.lampScan[0]);
+    core_pwm_record(&locals.lampPWM[1], locals.lampScan[1]);
+    locals.lampScan[0] = locals.lampScan[1] = 0;
+  }
+  locals.lampCol = first;
+  for (ii = first; col >> ii; ii++)
+    if ((col >> ii) & 0x01)
+      locals.lampScan[ii >> 2] |= (UINT32)(row & 0xff) << ((ii & 3) * 8);
 }
 
 void core_sound_throttle_adj(int sIn, int *sOut, int buffersize, int samplerate)
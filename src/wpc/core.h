@@ -210,6 +210,12 @@
 
 typedef UINT8 tDMDDot[DMD_MAXY+2][DMD_MAXX+2];
 
+/* The DMD drivers keep a copy of the raw sub-frames in g_raw_gtswpc_dmd */
+/* for VPinMAME's dmddevice and the xpinmame shared memory output        */
+#if defined(VPINMAME) || defined(XMAME)
+#define CORE_RAWDMD
+#endif
+
 /* Shortcuts for some common display sizes */
 #define DISP_SEG_16(row,type)    {4*row, 0, 20*row, 16, type}
 #define DISP_SEG_7(row,col,type) {4*row,16*col,row*20+col*8+1,7,type}
@@ -393,6 +399,7 @@ typedef struct {
   volatile UINT8  invSw[CORE_MAXSWCOL];   /* Active low switches */
   volatile UINT8  lampMatrix[CORE_MAXLAMPCOL], tmpLampMatrix[CORE_MAXLAMPCOL];
   volatile UINT8  RGBlamps[CORE_MAXRGBLAMPS];
+  volatile UINT8  lampLevels[64];  /* brightness 0-255 of the lamps in columns 0-7 (core_pwm_lampStrobe) */
   core_tSeg segments;     /* segments data from driver */
   UINT16 drawSeg[CORE_SEGCOUNT]; /* segments drawn */
   volatile UINT32 solenoids;       /* on power driver bord */
@@ -480,13 +487,76 @@ extern int core_getSol(int solNo);
 extern int core_getPulsedSol(int solNo);
 extern UINT64 core_getAllSol(void);
 
-INLINE void core_update_modulated_light(UINT32 *light, int bit){
-	(*light) = (*light) << 1;
-	if (bit)
-		(*light) |= 0x01;
+/*-- PWM integration of modulated solenoids and lamps --*/
+/*  The driver records the state of up to 32 outputs that are strobed
+    together as one word per strobe (bit n = output n): the history is
+    kept bit-sliced, sample[k] holds strobe k of all outputs instead of
+    one shift register per output. The number of strobes each output was
+    on in the window is kept the same way, as 32 counters of 6 bits in
+    sum[], so a strobe costs the same for 1 or 32 outputs and the level
+    of an output is only put together when the driver reads it. */
+#define CORE_PWM_DEPTH  32  /* samples kept, power of 2 */
+typedef struct {
+  UINT32 sample[CORE_PWM_DEPTH];
+  UINT32 sum[6];            /* bit b of the count of output n is bit n of sum[b] */
+  UINT32 pos;               /* next sample to write */
+  UINT32 window;            /* strobes to average, 1..CORE_PWM_DEPTH */
+} core_tPWM;
+
+INLINE void core_pwm_count(core_tPWM *pwm, UINT32 add, UINT32 sub) {
+  int b;
+  for (b = 0; add; b++) {
+    const UINT32 carry = pwm->sum[b] & add;
+    pwm->sum[b] ^= add; add = carry;
+  }
+  for (b = 0; sub; b++) {
+    const UINT32 borrow = ~pwm->sum[b] & sub;
+    pwm->sum[b] ^= sub; sub = borrow;
+  }
 }
-
-extern UINT8 core_calc_modulated_light(UINT32 bits, UINT32 bit_count, UINT8 *prev_level);
+INLINE void core_pwm_record(core_tPWM *pwm, UINT32 outputs) {
+  const UINT32 old = pwm->sample[(pwm->pos - pwm->window) & (CORE_PWM_DEPTH-1)]; /* leaves the window */
+  core_pwm_count(pwm, outputs & ~old, old & ~outputs);
+  pwm->sample[pwm->pos] = outputs;
+  pwm->pos = (pwm->pos + 1) & (CORE_PWM_DEPTH-1);
+}
+/*-- adds outputs to the last strobe --*/
+INLINE void core_pwm_merge(core_tPWM *pwm, UINT32 outputs) {
+  UINT32 *last = &pwm->sample[(pwm->pos - 1) & (CORE_PWM_DEPTH-1)];
+  core_pwm_count(pwm, outputs & ~*last, 0);
+  *last |= outputs;
+}
+/*-- level (0-255) of output n: on in how many strobes of the window --*/
+INLINE UINT8 core_pwm_level(const core_tPWM *pwm, int n) {
+  const UINT32 count = ((pwm->sum[0] >> n) & 1)        | (((pwm->sum[1] >> n) & 1) << 1) |
+                       (((pwm->sum[2] >> n) & 1) << 2) | (((pwm->sum[3] >> n) & 1) << 3) |
+                       (((pwm->sum[4] >> n) & 1) << 4) | (((pwm->sum[5] >> n) & 1) << 5);
+  return (UINT8)(count * 255 / pwm->window);
+}
+INLINE void core_pwm_init(core_tPWM *pwm, int window) {
+  memset(pwm, 0, sizeof(*pwm));
+  pwm->window = window;
+}
+/*-- levels of outputs 0..count-1 --*/
+INLINE void core_pwm_levels(const core_tPWM *pwm, int count, UINT8 *levels) {
+  UINT32 s0 = pwm->sum[0], s1 = pwm->sum[1], s2 = pwm->sum[2], s3 = pwm->sum[3], s4 = pwm->sum[4], s5 = pwm->sum[5];
+  int ii;
+
+  for (ii = 0; ii < count; ii++) {
+    const UINT32 n = (s0 & 1) | ((s1 & 1) << 1) | ((s2 & 1) << 2) | ((s3 & 1) << 3) | ((s4 & 1) << 4) | ((s5 & 1) << 5);
+    levels[ii] = (UINT8)(n * 255 / pwm->window);
+    s0 >>= 1; s1 >>= 1; s2 >>= 1; s3 >>= 1; s4 >>= 1; s5 >>= 1;
+  }
+}
+/*-- modulated solenoids of a driver that records the 32 solenoids of
+     the driver board: the others are on/off --*/
+extern void core_pwm_setModSol(const core_tPWM *pwm);
+/*-- the lamp matrix: the driver reports every write of its lamp row or
+     column (col = bits of the strobed columns), lampLevels gets the part
+     of the scans of columns 0-7 each lamp was on in. For other drivers
+     core_updateSw sets them from lampMatrix (0 or 255). --*/
+#define CORE_LAMPPWM_WINDOW 8   /* scans averaged */
+extern void core_pwm_lampStrobe(int col, int row);
 extern void core_sound_throttle_adj(int sIn, int *sOut, int buffersize, int samplerate);
 
 /*-- nvram handling --*/
@@ -0,0 +1,165 @@
+/************************************************/
+/* dmdbench - DMD kernel microbenchmark          */
+/************************************************/
+/*
+ Runs the plain C and the vector versions of the DMD kernels (dmdkern.c)
+ on the same random frames, checks that they give identical results and
+ prints the time per frame of both.
+
+ usage: dmdbench [frames]
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "driver.h"
+#include "core.h"
+#include "dmdkern.h"
+
+#define BENCH_WIDTH  128
+#define BENCH_HEIGHT 32
+#define BENCH_PLANES 12   /* as GTS3 5 color */
+#define BENCH_AAPENS 64
+
+static UINT8  planeData[BENCH_PLANES][BENCH_WIDTH*BENCH_HEIGHT/8];
+static const UINT8 *planes[BENCH_PLANES];
+static UINT32 pens[BENCH_AAPENS], aaPens[BENCH_AAPENS];
+static tDMDDot dotsC, dotsV;
+static BMTYPE lineC[2*DMD_MAXX], lineV[2*DMD_MAXX];
+static const UINT8 level5[16] = { 0, 3, 3, 7, 7, 7, 11, 11, 11, 11, 11, 11, 15 };
+
+static int errors = 0;
+
+static double seconds(clock_t start) {
+  return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static void report(const char *name, double timeC, double timeV, int frames) {
+  printf("%-28s C: %8.2f us/frame  %s: %8.2f us/frame  (%.1fx)\n", name,
+         timeC * 1e6 / frames, dmdk_simdName, timeV * 1e6 / frames,
+         timeV > 0 ? timeC / timeV : 0.0);
+}
+
+static void check(const char *name, int ok) {
+  if (!ok) { printf("%s: vector and C results differ\n", name); errors++; }
+}
+
+static int sameDots(int height) {
+  int ii;
+  for (ii = 1; ii <= height; ii++)
+    if (memcmp(dotsC[ii], dotsV[ii], BENCH_WIDTH)) return 0;
+  return 1;
+}
+
+/*-- random frame with a few of the dots set in each plane --*/
+static void randomPlanes(void) {
+  int ff, ii;
+  for (ff = 0; ff < BENCH_PLANES; ff++)
+    for (ii = 0; ii < (int)sizeof(planeData[0]); ii++)
+      planeData[ff][ii] = rand() & rand() & 0xff;
+}
+
+static void benchAccumulate(const char *name, int count, int lsbFirst, int frames) {
+  double timeC, timeV;
+  clock_t start;
+  int ii;
+
+  start = clock();
+  for (ii = 0; ii < frames; ii++)
+    dmdk_accumulate_c(dotsC, planes, count, BENCH_WIDTH, BENCH_HEIGHT, lsbFirst);
+  timeC = seconds(start);
+  start = clock();
+  for (ii = 0; ii < frames; ii++)
+    dmdk_accumulate(dotsV, planes, count, BENCH_WIDTH, BENCH_HEIGHT, lsbFirst);
+  timeV = seconds(start);
+  check(name, sameDots(BENCH_HEIGHT));
+  report(name, timeC, timeV, frames);
+}
+
+static void benchLevels(int frames) {
+  static tDMDDot counts;
+  double timeC, timeV;
+  clock_t start;
+  int ii, foundC = 0, foundV = 0;
+
+  /*-- both loops start each frame from the same counts --*/
+  dmdk_accumulate_c(counts, planes, BENCH_PLANES, BENCH_WIDTH, BENCH_HEIGHT, 0);
+  start = clock();
+  for (ii = 0; ii < frames; ii++) {
+    memcpy(dotsC, counts, sizeof(tDMDDot));
+    foundC += dmdk_findLevel_c(dotsC, BENCH_WIDTH, BENCH_HEIGHT, 4);
+    dmdk_mapLevels_c(dotsC, BENCH_WIDTH, BENCH_HEIGHT, level5);
+  }
+  timeC = seconds(start);
+  start = clock();
+  for (ii = 0; ii < frames; ii++) {
+    memcpy(dotsV, counts, sizeof(tDMDDot));
+    foundV += dmdk_findLevel(dotsV, BENCH_WIDTH, BENCH_HEIGHT, 4);
+    dmdk_mapLevels(dotsV, BENCH_WIDTH, BENCH_HEIGHT, level5);
+  }
+  timeV = seconds(start);
+  check("find + map levels", sameDots(BENCH_HEIGHT) && foundC == foundV);
+  report("find + map levels", timeC, timeV, frames);
+}
+
+static void benchRender(int frames) {
+  double timeC, timeV;
+  clock_t start;
+  int ii, jj, ok = 1;
+
+  dmdk_accumulate_c(dotsC, planes, 3, BENCH_WIDTH, BENCH_HEIGHT, 1);
+  for (ii = 0; ii <= BENCH_HEIGHT+1; ii++) dotsC[ii][BENCH_WIDTH] = 0;
+  memset(dotsC[0], 0, BENCH_WIDTH); memset(dotsC[BENCH_HEIGHT+1], 0, BENCH_WIDTH);
+
+  start = clock();
+  for (ii = 0; ii < frames; ii++)
+    for (jj = 0; jj <= BENCH_HEIGHT; jj++) {
+      if (jj > 0) dmdk_renderRow_c(lineC, dotsC[jj], BENCH_WIDTH, pens, 2, aaPens);
+      dmdk_renderAARow_c(lineC, dotsC[jj], dotsC[jj+1], BENCH_WIDTH, aaPens);
+    }
+  timeC = seconds(start);
+  start = clock();
+  for (ii = 0; ii < frames; ii++)
+    for (jj = 0; jj <= BENCH_HEIGHT; jj++) {
+      if (jj > 0) dmdk_renderRow(lineV, dotsC[jj], BENCH_WIDTH, pens, 2, aaPens);
+      dmdk_renderAARow(lineV, dotsC[jj], dotsC[jj+1], BENCH_WIDTH, aaPens);
+    }
+  timeV = seconds(start);
+
+  /*-- compare every row, not only the last one --*/
+  for (jj = 0; jj <= BENCH_HEIGHT; jj++) {
+    if (jj > 0) {
+      dmdk_renderRow_c(lineC, dotsC[jj], BENCH_WIDTH, pens, 2, aaPens);
+      dmdk_renderRow(lineV, dotsC[jj], BENCH_WIDTH, pens, 2, aaPens);
+      ok &= !memcmp(lineC, lineV, (2*BENCH_WIDTH-1)*sizeof(BMTYPE));
+    }
+    dmdk_renderAARow_c(lineC, dotsC[jj], dotsC[jj+1], BENCH_WIDTH, aaPens);
+    dmdk_renderAARow(lineV, dotsC[jj], dotsC[jj+1], BENCH_WIDTH, aaPens);
+    ok &= !memcmp(lineC, lineV, (2*BENCH_WIDTH-1)*sizeof(BMTYPE));
+  }
+  check("render (double size, AA)", ok);
+  report("render (double size, AA)", timeC, timeV, frames);
+}
+
+int main(int argc, char *argv[]) {
+  const int frames = (argc > 1) ? atoi(argv[1]) : 20000;
+  int ii;
+
+  if (frames <= 0) {
+    fprintf(stderr, "usage: %s [frames]\n", argv[0]);
+    return 1;
+  }
+  srand(1234);
+  randomPlanes();
+  for (ii = 0; ii < BENCH_PLANES; ii++)
+    planes[ii] = planeData[ii];
+  for (ii = 0; ii < BENCH_AAPENS; ii++) {
+    pens[ii] = 0x100 + ii; aaPens[ii] = 0x200 + ii;
+  }
+
+  printf("dmdbench: %dx%d dots, %d frames, vector unit: %s\n", BENCH_WIDTH, BENCH_HEIGHT, frames, dmdk_simdName);
+  benchAccumulate("accumulate (WPC, 3 planes)", 3, 1, frames);
+  benchAccumulate("accumulate (GTS3, 12 planes)", BENCH_PLANES, 0, frames);
+  benchLevels(frames);
+  benchRender(frames);
+  return errors ? 1 : 0;
+}
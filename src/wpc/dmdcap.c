@@ -0,0 +1,519 @@
+/************************************************/
+/* DMD capture files                             */
+/************************************************/
+/*
+ Replaces the old DmdDump .txt/.raw files (one hex character per dot,
+ both files reopened for every frame). The emulation thread only
+ compresses the frame into a memory block, full blocks are written by a
+ background thread. See dmdcap.h for the file layout.
+ This file must not use anything from the emulator, dmdplay links it on
+ its own.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "driver.h"
+#include "core.h"
+#include "dmdcap.h"
+
+#ifdef _WIN32
+#  include <windows.h>
+#  include <process.h>
+#else
+#  include <pthread.h>
+#endif
+
+#if defined(_MSC_VER)
+#  define dmdcap_fseek _fseeki64
+#  define dmdcap_ftell _ftelli64
+#elif defined(_WIN32)
+#  define dmdcap_fseek fseeko64
+#  define dmdcap_ftell ftello64
+#else
+#  define dmdcap_fseek fseeko
+#  define dmdcap_ftell ftello
+#endif
+
+#define BLOCKSIZE 0x10000
+#define BLOCKS    8
+#define PACKSIZE(n) ((n) + ((n) + 127) / 128)
+#define KEYSIZE   (6 + 16*3)
+#define MAXRECORD (DMDCAP_RECHEADERSIZE + KEYSIZE + PACKSIZE(DMD_MAXX*DMD_MAXY) + PACKSIZE(DMDCAP_MAXRAW))
+
+typedef struct { UINT32 frameNo, time; UINT64 offset; } tIndex;
+
+struct dmdcap_tWriter {
+  FILE *f;
+  /*-- emulation thread --*/
+  int curr, used;          /* block being filled */
+  UINT64 offset;           /* file offset of the next byte */
+  UINT32 frameNo, sinceKey;
+  int width, height, levels, rawFrames;
+  UINT8 palette[16][3];
+  UINT8 dots[DMD_MAXX*DMD_MAXY], prevDots[DMD_MAXX*DMD_MAXY];
+  UINT8 prevRaw[DMDCAP_MAXRAW];
+  UINT8 payload[MAXRECORD];
+  tIndex *index;
+  int indexCount, indexSize;
+  /*-- shared with the writer thread --*/
+  int len[BLOCKS];         /* bytes to write, 0 = block free */
+  volatile int stop, error;
+#ifdef _WIN32
+  CRITICAL_SECTION lock;
+  CONDITION_VARIABLE cond;
+  HANDLE thread;
+#else
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  pthread_t thread;
+#endif
+  UINT8 blocks[BLOCKS][BLOCKSIZE];
+};
+
+struct dmdcap_tReader {
+  FILE *f;
+  char gameName[33];
+  tIndex *index;
+  int indexCount;
+  UINT32 frames;
+  UINT64 end;              /* offset after the last complete frame */
+  UINT32 skipTo;           /* seeking: decode but do not return frames before this one */
+  int valid;               /* frame holds the previous frame */
+  dmdcap_tFrame frame;
+  UINT8 *payload;
+  UINT32 payloadSize;
+  UINT8 work[DMD_MAXX*DMD_MAXY];
+};
+
+#ifdef _WIN32
+#  define capLock(c)      EnterCriticalSection(&(c)->lock)
+#  define capUnlock(c)    LeaveCriticalSection(&(c)->lock)
+#  define capWait(c)      SleepConditionVariableCS(&(c)->cond, &(c)->lock, INFINITE)
+#  define capSignal(c)    WakeAllConditionVariable(&(c)->cond)
+#else
+#  define capLock(c)      pthread_mutex_lock(&(c)->lock)
+#  define capUnlock(c)    pthread_mutex_unlock(&(c)->lock)
+#  define capWait(c)      pthread_cond_wait(&(c)->cond, &(c)->lock)
+#  define capSignal(c)    pthread_cond_broadcast(&(c)->cond)
+#endif
+
+/*-------------------------------
+/  Little endian helpers
+/--------------------------------*/
+static UINT8 *put16(UINT8 *p, UINT32 v) { p[0] = v; p[1] = v >> 8; return p + 2; }
+static UINT8 *put32(UINT8 *p, UINT32 v) { p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24; return p + 4; }
+static UINT32 get16(const UINT8 *p) { return p[0] | (p[1] << 8); }
+static UINT32 get32(const UINT8 *p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((UINT32)p[3] << 24); }
+
+/*-------------------------------
+/  PackBits run length coding
+/--------------------------------*/
+static UINT8 *packBits(UINT8 *out, const UINT8 *in, int len) {
+  int ii = 0;
+  while (ii < len) {
+    int run = 1;
+    while (ii + run < len && run < 128 && in[ii+run] == in[ii]) run++;
+    if (run > 1) {
+      *out++ = (UINT8)(257 - run); *out++ = in[ii];
+    }
+    else { /*-- literals up to the next run --*/
+      while (ii + run < len && run < 128 && !(ii + run + 1 < len && in[ii+run] == in[ii+run+1])) run++;
+      *out++ = (UINT8)(run - 1); memcpy(out, &in[ii], run); out += run;
+    }
+    ii += run;
+  }
+  return out;
+}
+
+/*-- returns the end of the packed data, NULL if it is broken --*/
+static const UINT8 *unpackBits(UINT8 *out, int len, const UINT8 *in, const UINT8 *end) {
+  while (len > 0) {
+    int run;
+    if (in >= end) return NULL;
+    run = *in++;
+    if (run < 128) {
+      if (++run > len || in + run > end) return NULL;
+      memcpy(out, in, run); in += run;
+    }
+    else if (run > 128) {
+      if ((run = 257 - run) > len || in >= end) return NULL;
+      memset(out, *in++, run);
+    }
+    else continue;
+    out += run; len -= run;
+  }
+  return in;
+}
+
+static void xorBytes(UINT8 *out, const UINT8 *a, const UINT8 *b, int len) {
+  int ii;
+  for (ii = 0; ii < len; ii++) out[ii] = a[ii] ^ b[ii];
+}
+
+UINT32 dmdcap_hash(const UINT8 *dots, int width, int height, int pitch) {
+  UINT32 hash = 2166136261u;
+  int ii, jj;
+  for (jj = 0; jj < height; jj++, dots += pitch)
+    for (ii = 0; ii < width; ii++)
+      hash = (hash ^ dots[ii]) * 16777619u;
+  return hash;
+}
+
+/*-------------------------------
+/  Writer
+/--------------------------------*/
+#ifdef _WIN32
+static unsigned __stdcall writerThread(void *arg) {
+#else
+static void *writerThread(void *arg) {
+#endif
+  dmdcap_tWriter *cap = (dmdcap_tWriter *)arg;
+  int ii = 0;
+
+  for (;;) {
+    int len;
+    capLock(cap);
+    while (cap->len[ii] == 0 && !cap->stop) capWait(cap);
+    len = cap->len[ii];
+    capUnlock(cap);
+    if (len == 0) break; /* stopped and everything written */
+    if (fwrite(cap->blocks[ii], 1, len, cap->f) != (size_t)len) cap->error = 1;
+    capLock(cap);
+    cap->len[ii] = 0;
+    capSignal(cap);
+    capUnlock(cap);
+    ii = (ii + 1) % BLOCKS;
+  }
+  return 0;
+}
+
+/*-- hand the current block to the writer thread and wait for a free one --*/
+static void submitBlock(dmdcap_tWriter *cap) {
+  if (cap->used == 0) return;
+  capLock(cap);
+  cap->len[cap->curr] = cap->used;
+  capSignal(cap);
+  cap->curr = (cap->curr + 1) % BLOCKS;
+  while (cap->len[cap->curr] != 0) capWait(cap);
+  capUnlock(cap);
+  cap->used = 0;
+}
+
+static void putBytes(dmdcap_tWriter *cap, const UINT8 *data, int len) {
+  while (len > 0) {
+    int size = BLOCKSIZE - cap->used;
+    if (size > len) size = len;
+    memcpy(&cap->blocks[cap->curr][cap->used], data, size);
+    cap->used += size; cap->offset += size; data += size; len -= size;
+    if (cap->used == BLOCKSIZE) submitBlock(cap);
+  }
+}
+
+static void putRecord(dmdcap_tWriter *cap, int type, int rawFrames, UINT32 time, UINT32 frameNo, const UINT8 *payload, UINT32 size) {
+  UINT8 header[DMDCAP_RECHEADERSIZE], *p = header;
+  *p++ = type; *p++ = rawFrames; p = put16(p, 0);
+  p = put32(p, size); p = put32(p, time); put32(p, frameNo);
+  putBytes(cap, header, sizeof(header));
+  putBytes(cap, payload, size);
+}
+
+dmdcap_tWriter *dmdcap_open(const char *filename, const char *gameName) {
+  dmdcap_tWriter *cap = (dmdcap_tWriter *)calloc(1, sizeof(dmdcap_tWriter));
+  UINT8 header[DMDCAP_HEADERSIZE], *p = header;
+
+  if (!cap) return NULL;
+  if ((cap->f = fopen(filename, "wb")) == NULL) { free(cap); return NULL; }
+#ifdef _WIN32
+  InitializeCriticalSection(&cap->lock);
+  InitializeConditionVariable(&cap->cond);
+  cap->thread = (HANDLE)_beginthreadex(NULL, 0, writerThread, cap, 0, NULL);
+  if (!cap->thread) {
+    DeleteCriticalSection(&cap->lock);
+#else
+  pthread_mutex_init(&cap->lock, NULL);
+  pthread_cond_init(&cap->cond, NULL);
+  if (pthread_create(&cap->thread, NULL, writerThread, cap)) {
+    pthread_mutex_destroy(&cap->lock); pthread_cond_destroy(&cap->cond);
+#endif
+    fclose(cap->f); free(cap);
+    return NULL;
+  }
+  memset(header, 0, sizeof(header));
+  memcpy(p, "PMDC", 4); p += 4;
+  p = put16(p, DMDCAP_VERSION); p = put16(p, DMDCAP_HEADERSIZE);
+  strncpy((char *)p, gameName, 31); p += 32;
+  put32(p, DMDCAP_KEYINTERVAL);
+  putBytes(cap, header, sizeof(header));
+  return cap;
+}
+
+void dmdcap_frame(dmdcap_tWriter *cap, UINT32 time, int width, int height, int levels, const UINT8 palette[16][3],
+                  const UINT8 *dots, int pitch, int rawFrames, const UINT8 *raw) {
+  const int size = width * height;
+  int rawSize = rawFrames * size / 8;
+  int key, ii;
+  UINT8 *p = cap->payload;
+
+  if (width > DMD_MAXX || height > DMD_MAXY) return;
+  if (!raw || rawSize > DMDCAP_MAXRAW) rawFrames = rawSize = 0;
+  for (ii = 0; ii < height; ii++)
+    memcpy(&cap->dots[ii*width], &dots[ii*pitch], width);
+  key = cap->frameNo == 0 || cap->sinceKey >= DMDCAP_KEYINTERVAL ||
+        width != cap->width || height != cap->height || levels != cap->levels ||
+        (palette && memcmp(palette, cap->palette, sizeof(cap->palette)));
+  /*-- only changed frames are recorded --*/
+  if (!key && rawFrames == cap->rawFrames && memcmp(cap->dots, cap->prevDots, size) == 0 &&
+      (rawSize == 0 || memcmp(raw, cap->prevRaw, rawSize) == 0))
+    return;
+
+  if (key) {
+    cap->width = width; cap->height = height; cap->levels = levels;
+    if (palette) memcpy(cap->palette, palette, sizeof(cap->palette));
+    p = put16(p, width); p = put16(p, height);
+    *p++ = levels; *p++ = 0;
+    memcpy(p, cap->palette, sizeof(cap->palette)); p += sizeof(cap->palette);
+    p = packBits(p, cap->dots, size);
+    p = packBits(p, raw, rawSize);
+    memset(cap->prevRaw, 0, sizeof(cap->prevRaw));
+    /*-- remember the keyframe for the index --*/
+    if (cap->indexCount == cap->indexSize) {
+      tIndex *index = (tIndex *)realloc(cap->index, (cap->indexSize + 1024) * sizeof(tIndex));
+      if (index) { cap->index = index; cap->indexSize += 1024; }
+    }
+    if (cap->indexCount < cap->indexSize) {
+      cap->index[cap->indexCount].frameNo = cap->frameNo;
+      cap->index[cap->indexCount].time = time;
+      cap->index[cap->indexCount++].offset = cap->offset;
+    }
+    cap->sinceKey = 0;
+  }
+  else {
+    xorBytes(cap->prevDots, cap->prevDots, cap->dots, size);
+    p = packBits(p, cap->prevDots, size);
+    xorBytes(cap->prevRaw, cap->prevRaw, raw, rawSize);
+    p = packBits(p, cap->prevRaw, rawSize);
+  }
+  putRecord(cap, key ? 'K' : 'D', rawFrames, time, cap->frameNo, cap->payload, (UINT32)(p - cap->payload));
+  memcpy(cap->prevDots, cap->dots, size);
+  if (rawSize) memcpy(cap->prevRaw, raw, rawSize);
+  cap->rawFrames = rawFrames;
+  cap->frameNo += 1; cap->sinceKey += 1;
+}
+
+int dmdcap_close(dmdcap_tWriter *cap) {
+  UINT8 entry[16], *p;
+  const UINT64 indexOffset = cap->offset;
+  int ii, ok;
+
+  /*-- index (frame number of the record = number of frames) and trailer --*/
+  p = entry;
+  *p++ = 'X'; *p++ = 0; p = put16(p, 0);
+  p = put32(p, cap->indexCount * sizeof(entry)); p = put32(p, 0); put32(p, cap->frameNo);
+  putBytes(cap, entry, DMDCAP_RECHEADERSIZE);
+  for (ii = 0; ii < cap->indexCount; ii++) {
+    p = put32(entry, cap->index[ii].frameNo); p = put32(p, cap->index[ii].time);
+    p = put32(p, (UINT32)cap->index[ii].offset); put32(p, (UINT32)(cap->index[ii].offset >> 32));
+    putBytes(cap, entry, sizeof(entry));
+  }
+  memcpy(entry, "PMDX", 4);
+  p = put32(entry + 4, 0); p = put32(p, (UINT32)indexOffset); put32(p, (UINT32)(indexOffset >> 32));
+  putBytes(cap, entry, sizeof(entry));
+  submitBlock(cap);
+
+  /*-- let the writer thread finish --*/
+  capLock(cap);
+  cap->stop = 1;
+  capSignal(cap);
+  capUnlock(cap);
+#ifdef _WIN32
+  WaitForSingleObject(cap->thread, INFINITE);
+  CloseHandle(cap->thread);
+  DeleteCriticalSection(&cap->lock);
+#else
+  pthread_join(cap->thread, NULL);
+  pthread_mutex_destroy(&cap->lock);
+  pthread_cond_destroy(&cap->cond);
+#endif
+  ok = !cap->error && fclose(cap->f) == 0;
+  free(cap->index);
+  free(cap);
+  return ok;
+}
+
+/*-------------------------------
+/  Reader
+/--------------------------------*/
+static int readAt(dmdcap_tReader *cap, UINT64 offset, UINT8 *data, int len) {
+  return dmdcap_fseek(cap->f, offset, SEEK_SET) == 0 && fread(data, 1, len, cap->f) == (size_t)len;
+}
+
+static int addIndex(dmdcap_tReader *cap, UINT32 frameNo, UINT32 time, UINT64 offset) {
+  if ((cap->indexCount % 1024) == 0) {
+    tIndex *index = (tIndex *)realloc(cap->index, (cap->indexCount + 1024) * sizeof(tIndex));
+    if (!index) return 0;
+    cap->index = index;
+  }
+  cap->index[cap->indexCount].frameNo = frameNo;
+  cap->index[cap->indexCount].time = time;
+  cap->index[cap->indexCount++].offset = offset;
+  return 1;
+}
+
+/*-- read the index written by dmdcap_close --*/
+static int readIndex(dmdcap_tReader *cap, UINT64 fileSize) {
+  UINT8 data[DMDCAP_RECHEADERSIZE];
+  UINT64 offset;
+  UINT32 count, ii;
+
+  if (fileSize < DMDCAP_HEADERSIZE + DMDCAP_RECHEADERSIZE + DMDCAP_TRAILERSIZE ||
+      !readAt(cap, fileSize - DMDCAP_TRAILERSIZE, data, DMDCAP_TRAILERSIZE) || memcmp(data, "PMDX", 4))
+    return 0;
+  offset = get32(data + 8) | ((UINT64)get32(data + 12) << 32);
+  if (offset > fileSize - DMDCAP_TRAILERSIZE - DMDCAP_RECHEADERSIZE ||
+      !readAt(cap, offset, data, DMDCAP_RECHEADERSIZE) || data[0] != 'X')
+    return 0;
+  count = get32(data + 4) / 16;
+  cap->frames = get32(data + 12);
+  cap->end = offset;
+  for (ii = 0; ii < count; ii++) {
+    if (fread(data, 1, 16, cap->f) != 16 ||
+        !addIndex(cap, get32(data), get32(data + 4), get32(data + 8) | ((UINT64)get32(data + 12) << 32)))
+      return 0;
+  }
+  return 1;
+}
+
+/*-- no index (emulator did not close the file), find the keyframes --*/
+static void scanIndex(dmdcap_tReader *cap, UINT64 fileSize) {
+  UINT8 data[DMDCAP_RECHEADERSIZE];
+  UINT64 offset = DMDCAP_HEADERSIZE;
+
+  cap->indexCount = 0; cap->frames = 0;
+  while (readAt(cap, offset, data, DMDCAP_RECHEADERSIZE)) {
+    const UINT64 next = offset + DMDCAP_RECHEADERSIZE + get32(data + 4);
+    if ((data[0] != 'K' && data[0] != 'D') || next > fileSize) break;
+    if (data[0] == 'K' && !addIndex(cap, get32(data + 12), get32(data + 8), offset)) break;
+    if (cap->indexCount) cap->frames = get32(data + 12) + 1;
+    offset = next;
+  }
+  cap->end = offset;
+}
+
+dmdcap_tReader *dmdcap_openRead(const char *filename) {
+  dmdcap_tReader *cap = (dmdcap_tReader *)calloc(1, sizeof(dmdcap_tReader));
+  UINT8 header[DMDCAP_HEADERSIZE];
+  UINT64 fileSize;
+
+  if (!cap) return NULL;
+  if ((cap->f = fopen(filename, "rb")) == NULL) { free(cap); return NULL; }
+  if (fread(header, 1, sizeof(header), cap->f) != sizeof(header) || memcmp(header, "PMDC", 4) ||
+      get16(header + 4) != DMDCAP_VERSION || dmdcap_fseek(cap->f, 0, SEEK_END)) {
+    dmdcap_closeRead(cap);
+    return NULL;
+  }
+  memcpy(cap->gameName, header + 8, 32);
+  fileSize = dmdcap_ftell(cap->f);
+  if (!readIndex(cap, fileSize))
+    scanIndex(cap, fileSize);
+  if (cap->indexCount == 0 || !dmdcap_seekFrame(cap, 0))
+    cap->frames = 0;
+  return cap;
+}
+
+const char *dmdcap_gameName(dmdcap_tReader *cap) { return cap->gameName; }
+UINT32 dmdcap_frameCount(dmdcap_tReader *cap) { return cap->frames; }
+
+int dmdcap_seekFrame(dmdcap_tReader *cap, UINT32 frameNo) {
+  int lo = 0, hi = cap->indexCount - 1;
+
+  if (frameNo >= cap->frames || cap->indexCount == 0) return 0;
+  /*-- last keyframe at or before the frame --*/
+  while (lo < hi) {
+    const int mid = (lo + hi + 1) / 2;
+    if (cap->index[mid].frameNo <= frameNo) lo = mid; else hi = mid - 1;
+  }
+  cap->skipTo = frameNo;
+  cap->valid = 0;
+  return dmdcap_fseek(cap->f, cap->index[lo].offset, SEEK_SET) == 0;
+}
+
+int dmdcap_seekTime(dmdcap_tReader *cap, UINT32 time) {
+  UINT8 data[DMDCAP_RECHEADERSIZE];
+  UINT32 frameNo;
+  UINT64 offset;
+  int lo = 0, hi = cap->indexCount - 1;
+
+  if (cap->indexCount == 0 || time < cap->index[0].time) return 0;
+  while (lo < hi) {
+    const int mid = (lo + hi + 1) / 2;
+    if (cap->index[mid].time <= time) lo = mid; else hi = mid - 1;
+  }
+  /*-- step over the record headers up to the time --*/
+  frameNo = cap->index[lo].frameNo;
+  offset = cap->index[lo].offset;
+  while (offset < cap->end && readAt(cap, offset, data, DMDCAP_RECHEADERSIZE) && get32(data + 8) <= time) {
+    frameNo = get32(data + 12);
+    offset += DMDCAP_RECHEADERSIZE + get32(data + 4);
+  }
+  return dmdcap_seekFrame(cap, frameNo);
+}
+
+int dmdcap_read(dmdcap_tReader *cap, dmdcap_tFrame *frame) {
+  dmdcap_tFrame *curr = &cap->frame;
+  UINT8 header[DMDCAP_RECHEADERSIZE];
+  UINT8 * const work = cap->work;
+
+  for (;;) {
+    const UINT8 *p, *end;
+    UINT32 size;
+    int rawSize;
+
+    if ((UINT64)dmdcap_ftell(cap->f) >= cap->end ||
+        fread(header, 1, sizeof(header), cap->f) != sizeof(header) ||
+        (header[0] != 'K' && (header[0] != 'D' || !cap->valid)))
+      return 0;
+    size = get32(header + 4);
+    if (size > cap->payloadSize) {
+      UINT8 *payload = (UINT8 *)realloc(cap->payload, size);
+      if (!payload) return 0;
+      cap->payload = payload; cap->payloadSize = size;
+    }
+    if (fread(cap->payload, 1, size, cap->f) != size) return 0;
+    p = cap->payload; end = p + size;
+
+    if (header[0] == 'K') {
+      if (size < KEYSIZE) return 0;
+      curr->width = get16(p); curr->height = get16(p + 2); curr->levels = p[4];
+      memcpy(curr->palette, p + 6, sizeof(curr->palette));
+      p += KEYSIZE;
+      if (curr->width > DMD_MAXX || curr->height > DMD_MAXY) return 0;
+    }
+    rawSize = header[1] * curr->width * curr->height / 8;
+    if (rawSize > DMDCAP_MAXRAW) return 0;
+    if (header[0] == 'K') {
+      memset(curr->raw, 0, sizeof(curr->raw));
+      if (!(p = unpackBits(curr->dots, curr->width * curr->height, p, end)) ||
+          !unpackBits(curr->raw, rawSize, p, end))
+        return 0;
+    }
+    else {
+      if (!(p = unpackBits(work, curr->width * curr->height, p, end))) return 0;
+      xorBytes(curr->dots, curr->dots, work, curr->width * curr->height);
+      if (!unpackBits(work, rawSize, p, end)) return 0;
+      xorBytes(curr->raw, curr->raw, work, rawSize);
+    }
+    curr->rawFrames = header[1];
+    curr->time = get32(header + 8);
+    curr->frameNo = get32(header + 12);
+    cap->valid = 1;
+    if (curr->frameNo >= cap->skipTo) break;
+  }
+  memcpy(frame, curr, sizeof(dmdcap_tFrame));
+  return 1;
+}
+
+void dmdcap_closeRead(dmdcap_tReader *cap) {
+  if (cap->f) fclose(cap->f);
+  free(cap->index);
+  free(cap->payload);
+  free(cap);
+}
@@ -0,0 +1,87 @@
+#ifndef INC_DMDCAP
+#define INC_DMDCAP
+#if !defined(__GNUC__) || (__GNUC__ == 3 && __GNUC_MINOR__ >= 4) || (__GNUC__ >= 4)	// GCC supports "pragma once" correctly since 3.4
+#pragma once
+#endif
+
+/*-------------------------------------------------------------------
+/  DMD capture files (.dmdcap)
+/
+/  Records every changed DMD frame with its raw sub-frames, the time
+/  and the palette. Frames are stored as the difference (XOR) to the
+/  previous frame, run length (PackBits) compressed, with a full
+/  keyframe every DMDCAP_KEYINTERVAL frames and an index of the
+/  keyframes at the end of the file so a player can seek.
+/  The compressed data is written to disk by a background thread.
+/
+/  All numbers are little endian.
+/  File header (DMDCAP_HEADERSIZE bytes):
+/    0  "PMDC"
+/    4  UINT16 version, UINT16 header size
+/    8  char   gameName[32]
+/    40 UINT32 keyframe interval, rest 0
+/  Records (DMDCAP_RECHEADERSIZE bytes + payload):
+/    0  UINT8  type ('K' keyframe, 'D' delta, 'X' index)
+/    1  UINT8  number of raw sub-frames
+/    2  UINT16 0
+/    4  UINT32 payload size
+/    8  UINT32 time (ms of emulated time)
+/    12 UINT32 frame number
+/  Keyframe payload: UINT16 width, UINT16 height, UINT8 levels, UINT8 0,
+/    UINT8 palette[16][3], then the dots and the raw sub-frames
+/  Delta payload: the dots and raw sub-frames XORed with the previous
+/    frame (the raw data with the same number of bytes of the previous
+/    raw data)
+/  Dots are one byte each (0..levels-1), width*height of them, raw
+/    sub-frames are rawFrames*width*height/8 bytes. Both are PackBits
+/    compressed on their own.
+/  Index payload: per keyframe UINT32 frame number, UINT32 time,
+/    UINT32 file offset low, UINT32 file offset high
+/  Trailer (last DMDCAP_TRAILERSIZE bytes): "PMDX", UINT32 0,
+/    UINT32 index record offset low, UINT32 high
+/  A file without trailer (emulator crashed) can still be read, the
+/  reader then builds the index by scanning the record headers.
+/-------------------------------------------------------------------*/
+#define DMDCAP_VERSION       1
+#define DMDCAP_HEADERSIZE    64
+#define DMDCAP_RECHEADERSIZE 16
+#define DMDCAP_TRAILERSIZE   16
+#define DMDCAP_KEYINTERVAL   256
+#define DMDCAP_MAXRAW        (12*DMD_MAXX*DMD_MAXY/8) /* GTS3DMD_FRAMES_5C sub-frames */
+
+typedef struct {
+  UINT32 frameNo;
+  UINT32 time;      /* ms */
+  int width, height, levels;
+  UINT8 palette[16][3];
+  int rawFrames;
+  UINT8 dots[DMD_MAXY*DMD_MAXX]; /* width*height */
+  UINT8 raw[DMDCAP_MAXRAW];      /* rawFrames*width*height/8 */
+} dmdcap_tFrame;
+
+typedef struct dmdcap_tWriter dmdcap_tWriter;
+typedef struct dmdcap_tReader dmdcap_tReader;
+
+/*-- hash of a frame (FNV-1a of the dots), also used for -warp_dmd --*/
+UINT32 dmdcap_hash(const UINT8 *dots, int width, int height, int pitch);
+
+/*-- writing (called from the emulation) --*/
+dmdcap_tWriter *dmdcap_open(const char *filename, const char *gameName);
+/* records the frame if it differs from the previous one, dots are pitch bytes apart per row */
+void dmdcap_frame(dmdcap_tWriter *cap, UINT32 time, int width, int height, int levels, const UINT8 palette[16][3],
+                  const UINT8 *dots, int pitch, int rawFrames, const UINT8 *raw);
+/* returns 0 if not everything could be written */
+int dmdcap_close(dmdcap_tWriter *cap);
+
+/*-- reading --*/
+dmdcap_tReader *dmdcap_openRead(const char *filename);
+const char *dmdcap_gameName(dmdcap_tReader *cap);
+UINT32 dmdcap_frameCount(dmdcap_tReader *cap);
+/* position at a frame (frame number or the last frame at/before time), returns 0 if not there */
+int dmdcap_seekFrame(dmdcap_tReader *cap, UINT32 frameNo);
+int dmdcap_seekTime(dmdcap_tReader *cap, UINT32 time);
+/* reads the next frame, returns 0 at the end of the file */
+int dmdcap_read(dmdcap_tReader *cap, dmdcap_tFrame *frame);
+void dmdcap_closeRead(dmdcap_tReader *cap);
+
+#endif /* INC_DMDCAP */
@@ -0,0 +1,323 @@
+/************************************************/
+/* DMD frame composition kernels                 */
+/************************************************/
+/*
+ The DMD drivers build a frame by counting, for every dot, in how many of
+ the last few hardware frames (bitplanes) it was lit, map that count to a
+ brightness level and then draw the levels with the DMD pens (plus the
+ anti-aliased dots between them in double size mode). Doing that one bit
+ and one dot at a time shows up in profiles, so here it is done 16 dots
+ at a time where SSE2 (x86) or NEON (ARM) is available.
+ All vector versions must give exactly the same result as the _c ones,
+ dmdbench checks that.
+*/
+#include "driver.h"
+#include "core.h"
+#include "dmdkern.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define DMDK_SSE2
+#  include <emmintrin.h>
+#  ifdef __SSSE3__
+#    define DMDK_SSSE3
+#    include <tmmintrin.h>
+#  endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  define DMDK_NEON
+#  include <arm_neon.h>
+#endif
+
+#if defined(DMDK_SSSE3)
+const char *dmdk_simdName = "SSSE3";
+#elif defined(DMDK_SSE2)
+const char *dmdk_simdName = "SSE2";
+#elif defined(DMDK_NEON)
+const char *dmdk_simdName = "NEON";
+#else
+const char *dmdk_simdName = "none";
+#endif
+
+/* test masks for the dots of two plane bytes, leftmost dot first */
+static const UINT8 msbBits[16] = { 0x80,0x40,0x20,0x10,0x08,0x04,0x02,0x01, 0x80,0x40,0x20,0x10,0x08,0x04,0x02,0x01 };
+static const UINT8 lsbBits[16] = { 0x01,0x02,0x04,0x08,0x10,0x20,0x40,0x80, 0x01,0x02,0x04,0x08,0x10,0x20,0x40,0x80 };
+
+/*-------------------------------
+/  Plain C versions
+/--------------------------------*/
+static void accumulateBytes(UINT8 *line, const UINT8 * const planes[], int frames, int offs, int from, int to, int lsbFirst) {
+  int ff, kk, ll;
+
+  memset(line + from*8, 0, (to - from)*8);
+  for (ff = 0; ff < frames; ff++) {
+    const UINT8 *data = planes[ff] + offs;
+    UINT8 *dot = line + from*8;
+    for (kk = from; kk < to; kk++) {
+      UINT8 bits = data[kk];
+      if (lsbFirst)
+        for (ll = 0; ll < 8; ll++) { (*dot++) += (bits & 0x01); bits >>= 1; }
+      else
+        for (ll = 0; ll < 8; ll++) { (*dot++) += (bits >> 7); bits <<= 1; }
+    }
+  }
+}
+
+void dmdk_accumulate_c(tDMDDot dotCol, const UINT8 * const planes[], int frames, int width, int height, int lsbFirst) {
+  int ii;
+  for (ii = 0; ii < height; ii++)
+    accumulateBytes(&dotCol[ii+1][0], planes, frames, ii*(width/8), 0, width/8, lsbFirst);
+}
+
+void dmdk_mapLevels_c(tDMDDot dotCol, int width, int height, const UINT8 map[16]) {
+  int ii, jj;
+  for (ii = 1; ii <= height; ii++)
+    for (jj = 0; jj < width; jj++)
+      dotCol[ii][jj] = map[dotCol[ii][jj]];
+}
+
+int dmdk_findLevel_c(tDMDDot dotCol, int width, int height, UINT8 value) {
+  int ii, jj;
+  for (ii = 1; ii <= height; ii++)
+    for (jj = 0; jj < width; jj++)
+      if (dotCol[ii][jj] == value)
+        return 1;
+  return 0;
+}
+
+void dmdk_renderRow_c(BMTYPE *line, const UINT8 *dots, int width, const UINT32 *pens, int dotSize, const UINT32 *aaPens) {
+  int jj;
+
+  if (dotSize < 2) {
+    for (jj = 0; jj < width; jj++)
+      *line++ = pens[dots[jj]];
+    return;
+  }
+  for (jj = 0; jj < width; jj++) {
+    *line++ = pens[dots[jj]];
+    if (jj < width-1)
+      *line++ = aaPens ? aaPens[dots[jj] + dots[jj+1]] : 0;
+  }
+}
+
+void dmdk_renderAARow_c(BMTYPE *line, const UINT8 *dots, const UINT8 *next, int width, const UINT32 *aaPens) {
+  int col1 = dots[0] + next[0];
+  int jj;
+
+  for (jj = 0; jj < width; jj++) {
+    const int col2 = dots[jj+1] + next[jj+1];
+    *line++ = aaPens ? aaPens[col1] : 0;
+    if (jj < width-1)
+      *line++ = aaPens ? aaPens[2*(col1 + col2)/5] : 0;
+    col1 = col2;
+  }
+}
+
+/*-------------------------------
+/  Vector versions
+/--------------------------------*/
+#if defined(DMDK_SSE2)
+/*-- 16 plane bytes -> 128 dots --*/
+static void accumulate16(UINT8 *line, const UINT8 * const planes[], int frames, int offs, __m128i bits) {
+  __m128i acc0, acc1, acc2, acc3, acc4, acc5, acc6, acc7;
+  int ff;
+
+  acc0 = acc1 = acc2 = acc3 = acc4 = acc5 = acc6 = acc7 = _mm_setzero_si128();
+  for (ff = 0; ff < frames; ff++) {
+    const __m128i p  = _mm_loadu_si128((const __m128i *)(planes[ff] + offs));
+    const __m128i lo = _mm_unpacklo_epi8(p, p),   hi = _mm_unpackhi_epi8(p, p);
+    const __m128i q0 = _mm_unpacklo_epi16(lo, lo), q1 = _mm_unpackhi_epi16(lo, lo);
+    const __m128i q2 = _mm_unpacklo_epi16(hi, hi), q3 = _mm_unpackhi_epi16(hi, hi);
+    /* a set dot compares to 0xff, subtracting that adds one */
+#define ACC(acc, x) acc = _mm_sub_epi8(acc, _mm_cmpeq_epi8(_mm_and_si128((x), bits), bits))
+    ACC(acc0, _mm_unpacklo_epi32(q0, q0)); ACC(acc1, _mm_unpackhi_epi32(q0, q0));
+    ACC(acc2, _mm_unpacklo_epi32(q1, q1)); ACC(acc3, _mm_unpackhi_epi32(q1, q1));
+    ACC(acc4, _mm_unpacklo_epi32(q2, q2)); ACC(acc5, _mm_unpackhi_epi32(q2, q2));
+    ACC(acc6, _mm_unpacklo_epi32(q3, q3)); ACC(acc7, _mm_unpackhi_epi32(q3, q3));
+#undef ACC
+  }
+  _mm_storeu_si128((__m128i *)(line +   0), acc0); _mm_storeu_si128((__m128i *)(line +  16), acc1);
+  _mm_storeu_si128((__m128i *)(line +  32), acc2); _mm_storeu_si128((__m128i *)(line +  48), acc3);
+  _mm_storeu_si128((__m128i *)(line +  64), acc4); _mm_storeu_si128((__m128i *)(line +  80), acc5);
+  _mm_storeu_si128((__m128i *)(line +  96), acc6); _mm_storeu_si128((__m128i *)(line + 112), acc7);
+}
+#define DMDK_LOADBITS(b) _mm_loadu_si128((const __m128i *)(b))
+
+#elif defined(DMDK_NEON)
+static void accumulate16(UINT8 *line, const UINT8 * const planes[], int frames, int offs, uint8x16_t bits) {
+  uint8x16_t acc[8];
+  int ff, ii;
+
+  for (ii = 0; ii < 8; ii++) acc[ii] = vdupq_n_u8(0);
+  for (ff = 0; ff < frames; ff++) {
+    const uint8x16_t p = vld1q_u8(planes[ff] + offs);
+    const uint8x16x2_t z  = vzipq_u8(p, p);
+    const uint8x16x2_t y0 = vzipq_u8(z.val[0], z.val[0]), y1 = vzipq_u8(z.val[1], z.val[1]);
+    const uint8x16x2_t x0 = vzipq_u8(y0.val[0], y0.val[0]), x1 = vzipq_u8(y0.val[1], y0.val[1]);
+    const uint8x16x2_t x2 = vzipq_u8(y1.val[0], y1.val[0]), x3 = vzipq_u8(y1.val[1], y1.val[1]);
+    /* a set dot tests to 0xff, subtracting that adds one */
+    acc[0] = vsubq_u8(acc[0], vtstq_u8(x0.val[0], bits)); acc[1] = vsubq_u8(acc[1], vtstq_u8(x0.val[1], bits));
+    acc[2] = vsubq_u8(acc[2], vtstq_u8(x1.val[0], bits)); acc[3] = vsubq_u8(acc[3], vtstq_u8(x1.val[1], bits));
+    acc[4] = vsubq_u8(acc[4], vtstq_u8(x2.val[0], bits)); acc[5] = vsubq_u8(acc[5], vtstq_u8(x2.val[1], bits));
+    acc[6] = vsubq_u8(acc[6], vtstq_u8(x3.val[0], bits)); acc[7] = vsubq_u8(acc[7], vtstq_u8(x3.val[1], bits));
+  }
+  for (ii = 0; ii < 8; ii++)
+    vst1q_u8(line + 16*ii, acc[ii]);
+}
+#define DMDK_LOADBITS(b) vld1q_u8(b)
+#endif
+
+#if defined(DMDK_SSE2) || defined(DMDK_NEON)
+void dmdk_accumulate(tDMDDot dotCol, const UINT8 * const planes[], int frames, int width, int height, int lsbFirst) {
+  const int pitch = width / 8;
+  int ii, kk;
+
+  for (ii = 0; ii < height; ii++) {
+    UINT8 *line = &dotCol[ii+1][0];
+    for (kk = 0; kk + 16 <= pitch; kk += 16)
+      accumulate16(line + kk*8, planes, frames, ii*pitch + kk, DMDK_LOADBITS(lsbFirst ? lsbBits : msbBits));
+    if (kk < pitch)
+      accumulateBytes(line, planes, frames, ii*pitch, kk, pitch, lsbFirst);
+  }
+}
+
+void dmdk_mapLevels(tDMDDot dotCol, int width, int height, const UINT8 map[16]) {
+#if defined(DMDK_SSSE3) || defined(DMDK_NEON)
+  int ii, jj;
+#if defined(DMDK_SSSE3)
+  const __m128i table = _mm_loadu_si128((const __m128i *)map);
+#elif defined(__aarch64__)
+  const uint8x16_t table = vld1q_u8(map);
+#else
+  uint8x8x2_t table;
+  table.val[0] = vld1_u8(map); table.val[1] = vld1_u8(map + 8);
+#endif
+
+  for (ii = 1; ii <= height; ii++) {
+    UINT8 *line = &dotCol[ii][0];
+    for (jj = 0; jj + 16 <= width; jj += 16) {
+#if defined(DMDK_SSSE3)
+      _mm_storeu_si128((__m128i *)(line + jj), _mm_shuffle_epi8(table, _mm_loadu_si128((const __m128i *)(line + jj))));
+#elif defined(__aarch64__)
+      vst1q_u8(line + jj, vqtbl1q_u8(table, vld1q_u8(line + jj)));
+#else
+      const uint8x16_t dots = vld1q_u8(line + jj);
+      vst1q_u8(line + jj, vcombine_u8(vtbl2_u8(table, vget_low_u8(dots)), vtbl2_u8(table, vget_high_u8(dots))));
+#endif
+    }
+    for (; jj < width; jj++)
+      line[jj] = map[line[jj]];
+  }
+#else
+  /* plain SSE2 has no byte shuffle, selecting each level is slower than the lookup */
+  dmdk_mapLevels_c(dotCol, width, height, map);
+#endif
+}
+
+int dmdk_findLevel(tDMDDot dotCol, int width, int height, UINT8 value) {
+  int ii, jj;
+#if defined(DMDK_SSE2)
+  const __m128i val = _mm_set1_epi8((char)value);
+#else
+  const uint8x16_t val = vdupq_n_u8(value);
+#endif
+
+  for (ii = 1; ii <= height; ii++) {
+    const UINT8 *line = &dotCol[ii][0];
+#if defined(DMDK_SSE2)
+    __m128i found = _mm_setzero_si128();
+    for (jj = 0; jj + 16 <= width; jj += 16)
+      found = _mm_or_si128(found, _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(line + jj)), val));
+    if (_mm_movemask_epi8(found))
+      return 1;
+#else
+    uint8x16_t found = vdupq_n_u8(0);
+    uint64x2_t found64;
+    for (jj = 0; jj + 16 <= width; jj += 16)
+      found = vorrq_u8(found, vceqq_u8(vld1q_u8(line + jj), val));
+    found64 = vreinterpretq_u64_u8(found);
+    if (vgetq_lane_u64(found64, 0) | vgetq_lane_u64(found64, 1))
+      return 1;
+#endif
+    for (; jj < width; jj++)
+      if (line[jj] == value)
+        return 1;
+  }
+  return 0;
+}
+
+/*-- sum[j] = a[j] + a[j+1] --*/
+static void pairSums(UINT8 *sum, const UINT8 *a, const UINT8 *b, int width) {
+  int jj;
+  for (jj = 0; jj + 16 <= width; jj += 16)
+#if defined(DMDK_SSE2)
+    _mm_storeu_si128((__m128i *)(sum + jj), _mm_add_epi8(_mm_loadu_si128((const __m128i *)(a + jj)), _mm_loadu_si128((const __m128i *)(b + jj))));
+#else
+    vst1q_u8(sum + jj, vaddq_u8(vld1q_u8(a + jj), vld1q_u8(b + jj)));
+#endif
+  for (; jj < width; jj++)
+    sum[jj] = a[jj] + b[jj];
+}
+
+void dmdk_renderRow(BMTYPE *line, const UINT8 *dots, int width, const UINT32 *pens, int dotSize, const UINT32 *aaPens) {
+  UINT8 aa[DMD_MAXX+16];
+  int jj;
+
+  if (dotSize < 2 || !aaPens) {
+    dmdk_renderRow_c(line, dots, width, pens, dotSize, aaPens);
+    return;
+  }
+  pairSums(aa, dots, dots + 1, width - 1);
+  for (jj = 0; jj < width-1; jj++) {
+    *line++ = pens[dots[jj]];
+    *line++ = aaPens[aa[jj]];
+  }
+  *line = pens[dots[jj]];
+}
+
+void dmdk_renderAARow(BMTYPE *line, const UINT8 *dots, const UINT8 *next, int width, const UINT32 *aaPens) {
+  UINT8 col[DMD_MAXX+16], diag[DMD_MAXX+16];
+  int jj;
+
+  if (!aaPens) {
+    dmdk_renderAARow_c(line, dots, next, width, aaPens);
+    return;
+  }
+  /*-- col[j] = vertical neighbours, diag[j] = 2*(col[j]+col[j+1])/5 --*/
+  pairSums(col, dots, next, width + 1);
+  for (jj = 0; jj + 8 <= width - 1; jj += 8) {
+#if defined(DMDK_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i c1 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(col + jj)), zero);
+    const __m128i c2 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(col + jj + 1)), zero);
+    const __m128i sum2 = _mm_slli_epi16(_mm_add_epi16(c1, c2), 1);
+    /* x/5 == (x*0xcccd)>>18 for all 16 bit x */
+    const __m128i div5 = _mm_srli_epi16(_mm_mulhi_epu16(sum2, _mm_set1_epi16((short)0xcccd)), 2);
+    _mm_storel_epi64((__m128i *)(diag + jj), _mm_packus_epi16(div5, div5));
+#else
+    const uint16x8_t sum2 = vshlq_n_u16(vaddl_u8(vld1_u8(col + jj), vld1_u8(col + jj + 1)), 1);
+    const uint16x4_t lo = vshrn_n_u32(vmull_u16(vget_low_u16(sum2),  vdup_n_u16(0xcccd)), 16);
+    const uint16x4_t hi = vshrn_n_u32(vmull_u16(vget_high_u16(sum2), vdup_n_u16(0xcccd)), 16);
+    vst1_u8(diag + jj, vmovn_u16(vshrq_n_u16(vcombine_u16(lo, hi), 2)));
+#endif
+  }
+  for (; jj < width - 1; jj++)
+    diag[jj] = 2*(col[jj] + col[jj+1])/5;
+
+  for (jj = 0; jj < width-1; jj++) {
+    *line++ = aaPens[col[jj]];
+    *line++ = aaPens[diag[jj]];
+  }
+  *line = aaPens[col[jj]];
+}
+
+#else /* no vector unit */
+void dmdk_accumulate(tDMDDot dotCol, const UINT8 * const planes[], int frames, int width, int height, int lsbFirst)
+  { dmdk_accumulate_c(dotCol, planes, frames, width, height, lsbFirst); }
+void dmdk_mapLevels(tDMDDot dotCol, int width, int height, const UINT8 map[16])
+  { dmdk_mapLevels_c(dotCol, width, height, map); }
+int dmdk_findLevel(tDMDDot dotCol, int width, int height, UINT8 value)
+  { return dmdk_findLevel_c(dotCol, width, height, value); }
+void dmdk_renderRow(BMTYPE *line, const UINT8 *dots, int width, const UINT32 *pens, int dotSize, const UINT32 *aaPens)
+  { dmdk_renderRow_c(line, dots, width, pens, dotSize, aaPens); }
+void dmdk_renderAARow(BMTYPE *line, const UINT8 *dots, const UINT8 *next, int width, const UINT32 *aaPens)
+  { dmdk_renderAARow_c(line, dots, next, width, aaPens); }
+#endif
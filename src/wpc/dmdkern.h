@@ -0,0 +1,54 @@
+#ifndef INC_DMDKERN
+#define INC_DMDKERN
+#if !defined(__GNUC__) || (__GNUC__ == 3 && __GNUC_MINOR__ >= 4) || (__GNUC__ >= 4)	// GCC supports "pragma once" correctly since 3.4
+#pragma once
+#endif
+
+/*-------------------------------------------------------------------
+/  DMD frame composition kernels
+/
+/  The dot buffers are the tDMDDot arrays passed to video_update_core_dmd,
+/  i.e. the visible dots are in rows 1..height.
+/  All kernels have a plain C version (the _c functions, also used as
+/  reference by dmdbench) and use SSE2/SSSE3 or NEON where available.
+/  width must be a multiple of 8.
+/-------------------------------------------------------------------*/
+
+/*-- which vector unit the kernels were compiled for (for display) --*/
+extern const char *dmdk_simdName;
+
+/*-------------------------------------------------------------------
+/  Set each dot to the number of bitplanes (1 bit per dot) it is set in.
+/  Planes are width/8 bytes per row. lsbFirst = leftmost dot in bit 0.
+/-------------------------------------------------------------------*/
+void dmdk_accumulate(tDMDDot dotCol, const UINT8 * const planes[], int frames, int width, int height, int lsbFirst);
+void dmdk_accumulate_c(tDMDDot dotCol, const UINT8 * const planes[], int frames, int width, int height, int lsbFirst);
+
+/*-------------------------------------------------------------------
+/  Replace all dots by map[dot], dots must be < 16
+/-------------------------------------------------------------------*/
+void dmdk_mapLevels(tDMDDot dotCol, int width, int height, const UINT8 map[16]);
+void dmdk_mapLevels_c(tDMDDot dotCol, int width, int height, const UINT8 map[16]);
+
+/*-------------------------------------------------------------------
+/  Returns !0 if any dot has the given value
+/-------------------------------------------------------------------*/
+int dmdk_findLevel(tDMDDot dotCol, int width, int height, UINT8 value);
+int dmdk_findLevel_c(tDMDDot dotCol, int width, int height, UINT8 value);
+
+/*-------------------------------------------------------------------
+/  Output one row of dots as pens.
+/  With aaPens (double size display) an anti-aliased dot is put between
+/  the dots, a NULL aaPens puts black gaps. dots[width] must be 0.
+/-------------------------------------------------------------------*/
+void dmdk_renderRow(BMTYPE *line, const UINT8 *dots, int width, const UINT32 *pens, int dotSize, const UINT32 *aaPens);
+void dmdk_renderRow_c(BMTYPE *line, const UINT8 *dots, int width, const UINT32 *pens, int dotSize, const UINT32 *aaPens);
+
+/*-------------------------------------------------------------------
+/  Output the anti-aliased row between two rows of dots
+/  (double size display only). A NULL aaPens puts a black row.
+/-------------------------------------------------------------------*/
+void dmdk_renderAARow(BMTYPE *line, const UINT8 *dots, const UINT8 *next, int width, const UINT32 *aaPens);
+void dmdk_renderAARow_c(BMTYPE *line, const UINT8 *dots, const UINT8 *next, int width, const UINT32 *aaPens);
+
+#endif /* INC_DMDKERN */
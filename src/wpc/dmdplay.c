@@ -0,0 +1,123 @@
+/************************************************/
+/* dmdplay - DMD capture file player             */
+/************************************************/
+/*
+ Shows what is in a DMD capture file (dmdcap.h), plays it on a text
+ terminal or converts it to the old DmdDump .txt format.
+
+ usage: dmdplay [-txt | -play | -hash] [-f frame | -t ms] [-n frames] file.dmdcap
+   (none) information about the file
+   -txt   write the frames as text (time, then one hex digit per dot)
+   -play  show the frames on the terminal, in real time
+   -hash  list frame number, time and hash of the frames (for -warp_dmd)
+   -f/-t  start at this frame number / time in ms
+   -n     stop after this many frames
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "driver.h"
+#include "core.h"
+#include "dmdcap.h"
+#ifdef _WIN32
+#  include <windows.h>
+#  define sleepMs(ms) Sleep(ms)
+#else
+#  include <unistd.h>
+#  define sleepMs(ms) usleep((ms)*1000)
+#endif
+
+static dmdcap_tFrame frame;
+
+static void usage(const char *name) {
+  fprintf(stderr, "usage: %s [-txt | -play | -hash] [-f frame | -t ms] [-n frames] file.dmdcap\n", name);
+  exit(1);
+}
+
+static void info(dmdcap_tReader *cap) {
+  const UINT32 frames = dmdcap_frameCount(cap);
+  UINT32 first;
+
+  printf("game:   %s\n", dmdcap_gameName(cap));
+  printf("frames: %u\n", frames);
+  if (frames == 0 || !dmdcap_read(cap, &frame)) return;
+  first = frame.time;
+  printf("size:   %dx%d, %d levels, %d raw sub-frames\n", frame.width, frame.height, frame.levels, frame.rawFrames);
+  if (dmdcap_seekFrame(cap, frames - 1) && dmdcap_read(cap, &frame))
+    printf("time:   %u - %u ms (%.1f s)\n", first, frame.time, (frame.time - first) / 1000.0);
+}
+
+static void printText(void) {
+  int ii, jj;
+  printf("0x%08x\n", frame.time);
+  for (jj = 0; jj < frame.height; jj++) {
+    for (ii = 0; ii < frame.width; ii++)
+      printf("%01x", frame.dots[jj*frame.width + ii]);
+    printf("\n");
+  }
+  printf("\n");
+}
+
+static void printFrame(void) {
+  static const char shades[] = " .:-=+*#%@";
+  const int levels = frame.levels > 1 ? frame.levels : 2;
+  int ii, jj;
+
+  printf("\x1b[H%-10u %8u ms\n", frame.frameNo, frame.time);
+  for (jj = 0; jj < frame.height; jj++) {
+    for (ii = 0; ii < frame.width; ii++)
+      putchar(shades[frame.dots[jj*frame.width + ii] * (sizeof(shades)-2) / (levels-1)]);
+    putchar('\n');
+  }
+  fflush(stdout);
+}
+
+int main(int argc, char *argv[]) {
+  dmdcap_tReader *cap;
+  const char *filename = NULL;
+  int txt = 0, play = 0, hash = 0, ii;
+  long startFrame = -1, startTime = -1, count = -1;
+  UINT32 lastTime = 0;
+
+  for (ii = 1; ii < argc; ii++) {
+    if      (strcmp(argv[ii], "-txt") == 0)  txt = 1;
+    else if (strcmp(argv[ii], "-play") == 0) play = 1;
+    else if (strcmp(argv[ii], "-hash") == 0) hash = 1;
+    else if (strcmp(argv[ii], "-f") == 0 && ii+1 < argc) startFrame = atol(argv[++ii]);
+    else if (strcmp(argv[ii], "-t") == 0 && ii+1 < argc) startTime = atol(argv[++ii]);
+    else if (strcmp(argv[ii], "-n") == 0 && ii+1 < argc) count = atol(argv[++ii]);
+    else if (argv[ii][0] != '-' && !filename) filename = argv[ii];
+    else usage(argv[0]);
+  }
+  if (!filename || txt + play + hash > 1) usage(argv[0]);
+
+  if ((cap = dmdcap_openRead(filename)) == NULL) {
+    fprintf(stderr, "%s: not a DMD capture file\n", filename);
+    return 1;
+  }
+  if (!txt && !play && !hash) {
+    info(cap);
+    dmdcap_closeRead(cap);
+    return 0;
+  }
+  if ((startFrame >= 0 && !dmdcap_seekFrame(cap, startFrame)) ||
+      (startTime >= 0 && !dmdcap_seekTime(cap, startTime))) {
+    fprintf(stderr, "%s: no such frame\n", filename);
+    dmdcap_closeRead(cap);
+    return 1;
+  }
+  if (play) printf("\x1b[2J");
+  for (ii = 0; (count < 0 || ii < count) && dmdcap_read(cap, &frame); ii++) {
+    if (txt)
+      printText();
+    else if (hash)
+      printf("%-10u %10u ms  %08x\n", frame.frameNo, frame.time, dmdcap_hash(frame.dots, frame.width, frame.height, frame.width));
+    else {
+      if (ii > 0 && frame.time > lastTime)
+        sleepMs(frame.time - lastTime);
+      lastTime = frame.time;
+      printFrame();
+    }
+  }
+  dmdcap_closeRead(cap);
+  return 0;
+}
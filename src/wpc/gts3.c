@@ -16,6 +16,7 @@
 *************************************************************************************************/
 #include <stdarg.h>
 #include "driver.h"
+#include "state.h"
 //#include "cpu/m6502/m65ce02.h"
 #include "machine/6522via.h"
 #include "core.h"
@@ -501,6 +502,53 @@ static int gts3_m2sw(int col, int row) {
 }
 
 
+/*-- save state, the handler pointers are set by the init --*/
+static void gts3_registerDMD(int which) {
+  GTS3_DMDlocals *d = &GTS3_dmdlocals[which];
+  state_save_register_int  ("gts3dmd", which, "pa0",           &d->pa0);
+  state_save_register_int  ("gts3dmd", which, "pa1",           &d->pa1);
+  state_save_register_int  ("gts3dmd", which, "pa2",           &d->pa2);
+  state_save_register_int  ("gts3dmd", which, "pa3",           &d->pa3);
+  state_save_register_int  ("gts3dmd", which, "a18",           &d->a18);
+  state_save_register_int  ("gts3dmd", which, "q3",            &d->q3);
+  state_save_register_int  ("gts3dmd", which, "dmd_latch",     &d->dmd_latch);
+  state_save_register_int  ("gts3dmd", which, "diagnosticLed", &d->diagnosticLed);
+  state_save_register_int  ("gts3dmd", which, "status1",       &d->status1);
+  state_save_register_int  ("gts3dmd", which, "status2",       &d->status2);
+  state_save_register_int  ("gts3dmd", which, "dstrb",         &d->dstrb);
+  state_save_register_UINT8("gts3dmd", which, "dmd_visible_addr", &d->dmd_visible_addr, 1);
+  state_save_register_int  ("gts3dmd", which, "nextDMDFrame",  &d->nextDMDFrame);
+  state_save_register_UINT8("gts3dmd", which, "frames",        which ? &DMDFrames2[0][0] : &DMDFrames[0][0], sizeof(DMDFrames));
+}
+
+static void gts3_registerState(void) {
+  state_save_register_UINT16("gts3", 0, "segments",     &GTS3locals.segments[0].w, CORE_SEGCOUNT);
+  state_save_register_UINT16("gts3", 0, "pseg",         &GTS3locals.pseg[0].w, CORE_SEGCOUNT);
+  state_save_register_int   ("gts3", 0, "vblankCount",  &GTS3locals.vblankCount);
+  state_save_register_UINT32("gts3", 0, "solenoids",    &GTS3locals.solenoids, 1);
+  state_save_register_int   ("gts3", 0, "lampRow",      &GTS3locals.lampRow);
+  state_save_register_int   ("gts3", 0, "lampColumn",   &GTS3locals.lampColumn);
+  state_save_register_int   ("gts3", 0, "diagnosticLed",   &GTS3locals.diagnosticLed);
+  state_save_register_int   ("gts3", 0, "diagnosticLeds1", &GTS3locals.diagnosticLeds1);
+  state_save_register_int   ("gts3", 0, "diagnosticLeds2", &GTS3locals.diagnosticLeds2);
+  state_save_register_int   ("gts3", 0, "swCol",        &GTS3locals.swCol);
+  state_save_register_int   ("gts3", 0, "ssEn",         &GTS3locals.ssEn);
+  state_save_register_int   ("gts3", 0, "mainIrq",      &GTS3locals.mainIrq);
+  state_save_register_int   ("gts3", 0, "swDiag",       &GTS3locals.swDiag);
+  state_save_register_int   ("gts3", 0, "swTilt",       &GTS3locals.swTilt);
+  state_save_register_int   ("gts3", 0, "swSlam",       &GTS3locals.swSlam);
+  state_save_register_int   ("gts3", 0, "swPrin",       &GTS3locals.swPrin);
+  state_save_register_int   ("gts3", 0, "acol",         &GTS3locals.acol);
+  state_save_register_int   ("gts3", 0, "u4pb",         &GTS3locals.u4pb);
+  state_save_register_UINT8 ("gts3", 0, "ax",           GTS3locals.ax, 7);
+  state_save_register_UINT8 ("gts3", 0, "cx1",          &GTS3locals.cx1, 1);
+  state_save_register_UINT8 ("gts3", 0, "cx2",          &GTS3locals.cx2, 1);
+  state_save_register_UINT8 ("gts3", 0, "ex1",          &GTS3locals.ex1, 1);
+  state_save_register_INT8  ("gts3", 0, "extra16led",   (INT8 *)&GTS3locals.extra16led, 1);
+  state_save_register_int   ("gts3", 0, "sound_data",   &GTS3locals.sound_data);
+  state_save_register_UINT8 ("gts3", 0, "prn",          GTS3locals.prn, 8);
+}
+
 /*Alpha Numeric First Generation Init*/
 static void GTS3_alpha_common_init(void) {
   memset(&GTS3locals, 0, sizeof(GTS3locals));
@@ -515,6 +563,7 @@ static void GTS3_alpha_common_init(void) {
   GTS3locals.DISPLAY_CONTROL = alpha_display;
   GTS3locals.UPDATE_DISPLAY = alpha_update;
   GTS3locals.AUX_W = alpha_aux;
+  gts3_registerState();
 
   /* Init the sound board */
   sndbrd_0_init(core_gameData->hw.soundBoard, 1, memory_region(GTS3_MEMREG_SCPU1), NULL, NULL);
@@ -560,6 +609,8 @@ static void gts3dmd_init(void) {
   GTS3locals.DISPLAY_CONTROL = dmd_display;
   GTS3locals.UPDATE_DISPLAY = dmd_update;
   GTS3locals.AUX_W = dmd_aux;
+  gts3_registerState();
+  gts3_registerDMD(0);
 
   /* Init the sound board */
   sndbrd_0_init(core_gameData->hw.soundBoard, 2, memory_region(GTS3_MEMREG_SCPU1), NULL, NULL);
@@ -609,6 +660,7 @@ static MACHINE_INIT(gts3dmd2) {
 
   //Init 2nd 6845
   crtc6845_init(1);
+  gts3_registerDMD(1);
 
   /*copy last 32K of DMD ROM into last 32K of CPU region*/
   if (memory_region(GTS3_MEMREG_DCPU2)) {
@@ -2,6 +2,7 @@
 #include "core.h"
 #include "gts3.h"
 #include "gts3dmd.h"
+#include "dmdkern.h"
 
 //#define DEBUGSWAP
 
@@ -17,14 +18,15 @@ extern int crtc6845_start_addr;
 //static int level4_a[9]  = { 0, 1, 5, 5, 5, 5, 5, 5, 15 }; // mapping for 4 color roms, mode a
 //static int level4_b[16] = { 0, 1, 1, 1, 5, 5, 5, 10, 10, 10, 15, 15, 15, 15, 15, 15 }; // mapping for 4 color roms, mode b
 //static int level4_a[16] = { 0, 3, 3, 3, 6, 6, 6, 8, 8, 9, 10, 11, 12, 13, 14, 15 };
-static int level4_a[7] = { 0, 1, 2, 2, 2, 2, 3 }; // 4 colors
-static int level4_a2[7] = { 0, 1, 1, 2, 2, 2, 3 }; // 4 colors
-static int level4_b[9] = { 0, 1, 2, 2, 2, 2, 2, 2, 3 }; // 4 colors
-static int level5[13] = { 0, 3, 3, 7, 7, 7, 11, 11, 11, 11, 11, 11, 15 }; // 5 colors
+// (padded to 16 entries for dmdk_mapLevels)
+static const UINT8 level4_a[16] = { 0, 1, 2, 2, 2, 2, 3 }; // 4 colors
+static const UINT8 level4_a2[16] = { 0, 1, 1, 2, 2, 2, 3 }; // 4 colors
+static const UINT8 level4_b[16] = { 0, 1, 2, 2, 2, 2, 2, 2, 3 }; // 4 colors
+static const UINT8 level5[16] = { 0, 3, 3, 7, 7, 7, 11, 11, 11, 11, 11, 11, 15 }; // 5 colors
 //static int level5[19] = { 0, 3, 3, 4, 5, 5, 5, 7, 8, 9, 11, 11, 11, 12, 13, 14, 15, 15, 15 };
 //static int level[25]  = { 0, 0, 1, 1, 1, 5, 5, 5, 5, 5, 5, 5, 10, 10, 10, 10, 10, 15, 15, 15, 15, 15, 15, 15, 15 }; // temporary mapping for both 4 and 5 color roms // deprecated
 
-#ifdef VPINMAME
+#ifdef CORE_RAWDMD
 extern UINT8  g_raw_gtswpc_dmd[GTS3DMD_FRAMES_5C*0x200];
 extern UINT32 g_raw_gtswpc_dmdframes;
 #endif
@@ -32,39 +34,21 @@ extern UINT32 g_raw_gtswpc_dmdframes;
 //DMD #2 Display routine for Strikes N Spares - code is IDENTICAL to the gts3_dmd128x32
 PINMAME_VIDEO_UPDATE(gts3_dmd128x32a) {
   tDMDDot dotCol;
-  UINT8 *frameData = &DMDFrames2[0][0];
-  int ii,jj,kk,ll;
+  const UINT8 *planes[GTS3DMD_FRAMES_5C];
+  int ii;
   int frames = GTS3_dmdlocals[0].color_mode == 0 ? GTS3DMD_FRAMES_4C_a : (GTS3_dmdlocals[0].color_mode == 1 ? GTS3DMD_FRAMES_4C_b : GTS3DMD_FRAMES_5C);
-  int *level = GTS3_dmdlocals[0].color_mode == 0 ? level4_a : (GTS3_dmdlocals[0].color_mode == 1 ? level4_b : level5);
-
-  memset(dotCol,0,sizeof(tDMDDot));
-  for (ii = 0; ii < frames; ii++) {
-    for (jj = 1; jj <= 32; jj++) {           // 32 lines
-      UINT8 *line = &dotCol[jj][0];
-      for (kk = 0; kk < 16; kk++) {      // 16 columns/line
-        UINT8 data = *frameData++;
-        for (ll = 0; ll < 8; ll++)          // 8 pixels/column
-          { (*line++) += (data>>7); data <<= 1; }
-      }
-    }
-  }
+  const UINT8 *level = GTS3_dmdlocals[0].color_mode == 0 ? level4_a : (GTS3_dmdlocals[0].color_mode == 1 ? level4_b : level5);
+
+  // count how often each dot was lit in the captured frames
+  for (ii = 0; ii < frames; ii++)
+    planes[ii] = DMDFrames2[ii];
+  dmdk_accumulate(dotCol, planes, frames, 128, 32, 0);
 
   // detect special case for some otherwise flickering frames
-  if (frames == GTS3DMD_FRAMES_4C_a) {
-	  for (ii = 1; ii <= 32; ii++)               // 32 lines
-		  for (jj = 0; jj < 128; jj++) {		// 128 pixels/line
-			  if (dotCol[ii][jj] == 4){
-				  level = level4_a2;
-				  break;
-			  }
-		  }
-  }
-
-  for (ii = 1; ii <= 32; ii++)               // 32 lines
-    for (jj = 0; jj < 128; jj++) {          // 128 pixels/line
-      UINT8 data = dotCol[ii][jj];
-      dotCol[ii][jj] = level[data];
-  }
+  if (frames == GTS3DMD_FRAMES_4C_a && dmdk_findLevel(dotCol, 128, 32, 4))
+    level = level4_a2;
+
+  dmdk_mapLevels(dotCol, 128, 32, level);
 
   video_update_core_dmd(bitmap, cliprect, dotCol, layout);
   return 0;
@@ -72,12 +56,12 @@ PINMAME_VIDEO_UPDATE(gts3_dmd128x32a) {
 
 PINMAME_VIDEO_UPDATE(gts3_dmd128x32) {
   tDMDDot dotCol;
-  UINT8 *frameData = &DMDFrames[0][0];
-  int ii,jj,kk,ll;
+  const UINT8 *planes[GTS3DMD_FRAMES_5C];
+  int ii;
   int frames = GTS3_dmdlocals[0].color_mode == 0 ? GTS3DMD_FRAMES_4C_a : (GTS3_dmdlocals[0].color_mode == 1 ? GTS3DMD_FRAMES_4C_b : GTS3DMD_FRAMES_5C);
-  int *level = GTS3_dmdlocals[0].color_mode == 0 ? level4_a : (GTS3_dmdlocals[0].color_mode == 1 ? level4_b : level5);
+  const UINT8 *level = GTS3_dmdlocals[0].color_mode == 0 ? level4_a : (GTS3_dmdlocals[0].color_mode == 1 ? level4_b : level5);
 
-#ifdef VPINMAME
+#ifdef CORE_RAWDMD
   g_raw_gtswpc_dmdframes = frames;
 #endif
 
@@ -87,40 +71,20 @@ PINMAME_VIDEO_UPDATE(gts3_dmd128x32) {
   core_textOutf(50,50,1,temp);
 #endif
 
-  /* Drawing is not optimised so just clear everything */
-  // !!! if (fullRefresh) fillbitmap(bitmap,Machine->pens[0],NULL);
-  memset(dotCol,0,sizeof(tDMDDot));
-  for (ii = 0; ii < frames; ii++) {
-    for (jj = 1; jj <= 32; jj++) {          // 32 lines
-      UINT8 *line = &dotCol[jj][0];
-      for (kk = 0; kk < 16; kk++) {         // 16 columns/line
-        UINT8 data = *frameData++;
-        for (ll = 0; ll < 8; ll++)          // 8 pixels/column
-          { (*line++) += (data>>7); data <<= 1; }
-      }
-    }
-  }
-
-#ifdef VPINMAME
+  // count how often each dot was lit in the captured frames
+  for (ii = 0; ii < frames; ii++)
+    planes[ii] = DMDFrames[ii];
+  dmdk_accumulate(dotCol, planes, frames, 128, 32, 0);
+
+#ifdef CORE_RAWDMD
   memcpy(g_raw_gtswpc_dmd, &DMDFrames[0][0], g_raw_gtswpc_dmdframes * 0x200);
 #endif
 
   // detect special case for some otherwise flickering frames
-  if (frames == GTS3DMD_FRAMES_4C_a) {
-	  for (ii = 1; ii <= 32; ii++)               // 32 lines
-		  for (jj = 0; jj < 128; jj++) {         // 128 pixels/line
-			  if (dotCol[ii][jj] == 4){
-				  level = level4_a2;
-				  break;
-			  }
-		  }
-  }
+  if (frames == GTS3DMD_FRAMES_4C_a && dmdk_findLevel(dotCol, 128, 32, 4))
+    level = level4_a2;
   
-  for (ii = 1; ii <= 32; ii++)              // 32 lines
-    for (jj = 0; jj < 128; jj++) {          // 128 pixels/line
-      UINT8 data = dotCol[ii][jj];
-      dotCol[ii][jj] = level[data];
-  }
+  dmdk_mapLevels(dotCol, 128, 32, level);
 
   video_update_core_dmd(bitmap, cliprect, dotCol, layout);
   return 0;
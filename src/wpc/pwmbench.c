@@ -0,0 +1,194 @@
+/************************************************/
+/* pwmbench - PWM integrator microbenchmark      */
+/************************************************/
+/*
+ Feeds the same strobes to the bit-sliced PWM integrator of core.h
+ (core_tPWM) and to the shift register per output it replaced, checks
+ that both give the same levels for every window and prints the time
+ per strobe and per read of both.
+
+ usage: pwmbench [strobes]
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "driver.h"
+#include "core.h"
+
+#define BENCH_OUTPUTS 32
+#define BENCH_WINDOW  24   /* as SAM */
+#define BENCH_CHECKS  100000
+
+static int errors = 0;
+static volatile UINT32 sink;
+
+static double seconds(clock_t start) {
+  return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static void report(const char *name, double timeOld, double timeNew, int count) {
+  printf("%-38s old: %6.2f ns  new: %6.2f ns  (%.1fx)\n", name,
+         timeOld * 1e9 / count, timeNew * 1e9 / count,
+         timeNew > 0 ? timeOld / timeNew : 0.0);
+}
+
+/*-------------------------------------------------
+/  The old model: the last strobes of an output
+/  shifted into a word, the level is the number of
+/  bits set in the window.
+/--------------------------------------------------*/
+static UINT32 shift[BENCH_OUTPUTS];
+
+static const UINT8 bitsSet[256] = {
+#   define B2(n) n,     n+1,     n+1,     n+2
+#   define B4(n) B2(n), B2(n+1), B2(n+1), B2(n+2)
+#   define B6(n) B4(n), B4(n+1), B4(n+1), B4(n+2)
+    B6(0), B6(1), B6(1), B6(2)
+};
+
+static void oldRecord(UINT32 outputs, int count) {
+  int ii;
+  for (ii = 0; ii < count; ii++)
+    shift[ii] = (shift[ii] << 1) | ((outputs >> ii) & 1);
+}
+
+static UINT8 oldLevel(UINT32 bits, UINT32 window) {
+  if (window < 32) bits &= (1u << window) - 1;
+  return (UINT8)(((UINT32)bitsSet[bits & 0xff] + bitsSet[(bits >> 8) & 0xff] +
+                  bitsSet[(bits >> 16) & 0xff] + bitsSet[bits >> 24]) * 255 / window);
+}
+
+/*-- a random word, sometimes with few outputs on --*/
+static UINT32 randomOutputs(int ii) {
+  UINT32 outputs = rand() ^ ((UINT32)rand() << 16);
+  return (ii % 3 == 0) ? outputs & 0x0f0f00ff : outputs;
+}
+
+static void checkLevels(void) {
+  static core_tPWM pwm[CORE_PWM_DEPTH+1];
+  UINT8 levels[BENCH_OUTPUTS];
+  int ii, jj, window;
+
+  for (window = 1; window <= CORE_PWM_DEPTH; window++)
+    core_pwm_init(&pwm[window], window);
+  memset(shift, 0, sizeof(shift));
+  for (ii = 0; ii < BENCH_CHECKS; ii++) {
+    const UINT32 outputs = randomOutputs(ii);
+    if (ii % 11 == 5) {
+      /*-- a write within the strobe sets the last sample --*/
+      for (window = 1; window <= CORE_PWM_DEPTH; window++)
+        core_pwm_merge(&pwm[window], outputs & 0xf0);
+      for (jj = 0; jj < BENCH_OUTPUTS; jj++)
+        shift[jj] |= ((outputs & 0xf0) >> jj) & 1;
+      continue;
+    }
+    oldRecord(outputs, BENCH_OUTPUTS);
+    for (window = 1; window <= CORE_PWM_DEPTH; window++) {
+      core_pwm_record(&pwm[window], outputs);
+      core_pwm_levels(&pwm[window], BENCH_OUTPUTS, levels);
+      for (jj = 0; jj < BENCH_OUTPUTS; jj++)
+        if (levels[jj] != oldLevel(shift[jj], window) && errors++ < 10)
+          printf("window %d output %d: level %d, old model %d\n", window, jj, levels[jj], oldLevel(shift[jj], window));
+    }
+  }
+}
+
+/*-- strobes of all 32 outputs, random or as a game (a few held, four dimmed, one pulsed) --*/
+static void benchStrobe(const char *name, int typical, int outputs, int strobes) {
+  const UINT32 mask = (outputs < 32) ? (1u << outputs) - 1 : 0xffffffff;
+  core_tPWM pwm;
+  double timeOld, timeNew;
+  clock_t start;
+  UINT32 word = 12345;
+  int ii;
+
+  start = clock();
+  for (ii = 0; ii < strobes; ii++) {
+    word = typical ? 0x00030000 | ((ii % 3 == 0) ? 0x0000f000 : 0) | ((ii & 1023) < 40 ? 0x2 : 0) : word * 1103515245 + 12345;
+    oldRecord(word & mask, outputs);
+  }
+  timeOld = seconds(start); sink += shift[3];
+  core_pwm_init(&pwm, BENCH_WINDOW);
+  word = 12345;
+  start = clock();
+  for (ii = 0; ii < strobes; ii++) {
+    word = typical ? 0x00030000 | ((ii % 3 == 0) ? 0x0000f000 : 0) | ((ii & 1023) < 40 ? 0x2 : 0) : word * 1103515245 + 12345;
+    core_pwm_record(&pwm, word & mask);
+  }
+  timeNew = seconds(start); sink += pwm.sum[3];
+  report(name, timeOld, timeNew, strobes);
+}
+
+/*-- the SAM flipper bank: a strobe of 8 and 4 levels read back each time --*/
+static void benchFlipper(int strobes) {
+  core_tPWM pwm;
+  double timeOld, timeNew;
+  clock_t start;
+  UINT32 word = 12345;
+  int ii, jj;
+
+  start = clock();
+  for (ii = 0; ii < strobes; ii++) {
+    word = word * 1103515245 + 12345;
+    oldRecord(word & 0xff, 8);
+    for (jj = 4; jj < 8; jj++) sink += oldLevel(shift[jj], BENCH_WINDOW);
+  }
+  timeOld = seconds(start);
+  core_pwm_init(&pwm, BENCH_WINDOW);
+  word = 12345;
+  start = clock();
+  for (ii = 0; ii < strobes; ii++) {
+    word = word * 1103515245 + 12345;
+    core_pwm_record(&pwm, word & 0xff);
+    for (jj = 4; jj < 8; jj++) sink += core_pwm_level(&pwm, jj);
+  }
+  timeNew = seconds(start);
+  report("SAM flipper bank (strobe + 4 levels)", timeOld, timeNew, strobes);
+}
+
+/*-- reading all levels, as the drivers do once per window or vblank --*/
+static void benchRead(int reads) {
+  core_tPWM pwm;
+  UINT8 levels[BENCH_OUTPUTS];
+  double timeOld, timeNew;
+  clock_t start;
+  int ii, jj;
+
+  core_pwm_init(&pwm, BENCH_WINDOW);
+  for (ii = 0; ii < CORE_PWM_DEPTH; ii++) {
+    const UINT32 outputs = randomOutputs(1);
+    oldRecord(outputs, BENCH_OUTPUTS);
+    core_pwm_record(&pwm, outputs);
+  }
+  start = clock();
+  for (ii = 0; ii < reads; ii++) {
+    for (jj = 0; jj < BENCH_OUTPUTS; jj++) levels[jj] = oldLevel(shift[jj], BENCH_WINDOW);
+    sink += levels[ii & 31]; shift[ii & 31] ^= ii;
+  }
+  timeOld = seconds(start);
+  start = clock();
+  for (ii = 0; ii < reads; ii++) {
+    core_pwm_levels(&pwm, BENCH_OUTPUTS, levels);
+    sink += levels[ii & 31]; pwm.sum[ii & 3] ^= ii;
+  }
+  timeNew = seconds(start);
+  report("read 32 levels", timeOld, timeNew, reads);
+}
+
+int main(int argc, char *argv[]) {
+  const int strobes = (argc > 1) ? atoi(argv[1]) : 20000000;
+
+  if (strobes <= 0) {
+    fprintf(stderr, "usage: %s [strobes]\n", argv[0]);
+    return 1;
+  }
+  srand(1234);
+  checkLevels();
+  printf("pwmbench: windows 1-%d checked, %d strobes, window %d\n", CORE_PWM_DEPTH, strobes, BENCH_WINDOW);
+  benchStrobe("typical strobe of 32 solenoids", 1, 32, strobes);
+  benchStrobe("random strobe of 32 outputs", 0, 32, strobes);
+  benchStrobe("random strobe, bank of 8", 0, 8, strobes);
+  benchFlipper(strobes);
+  benchRead(strobes / 10);
+  return errors ? 1 : 0;
+}
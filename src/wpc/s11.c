@@ -4,6 +4,7 @@
 #include <stdarg.h>
 #include <time.h>
 #include "driver.h"
+#include "state.h"
 #include "cpu/m6800/m6800.h"
 #include "machine/6821pia.h"
 #include "core.h"
@@ -31,6 +32,7 @@
 #define S11_VBLANKFREQ    60 /* VBLANK frequency */
 
 #define S11_IRQFREQ     1000
+#define S11_MODSOLSMOOTH  32 /* Modulated solenoids - IRQs to average */
 /*-- Smoothing values --*/
 #ifdef PROC_SUPPORT
 // TODO/PROC: Make variables out of these defines. Values depend on "-proc" switch.
@@ -70,6 +72,7 @@ const struct core_dispLayout s11_dispS11b2[] = {
 static struct {
   int    vblankCount;
   UINT32 solenoids, solsmooth[S11_SOLSMOOTH];
+  core_tPWM solpwm;         /* modulated solenoids, sampled every IRQ */
   UINT32 extSol, extSolPulse;
   core_tSeg segments, pseg;
   int    lampRow, lampColumn;
@@ -114,6 +117,8 @@ static void s11_piaMainIrq(int state) {
 }
 
 static INTERRUPT_GEN(s11_irq) {
+  if (options.usemodsol)
+    core_pwm_record(&locals.solpwm, coreGlobals.pulsedSolState | (locals.ssEn ? CORE_SOLBIT(S11_GAMEONSOL) : 0));
   s11_irqline(1); timer_set(TIME_IN_CYCLES(32,0),0,s11_irqline);
 }
 static INTERRUPT_GEN(s11_vblank) {
@@ -206,6 +211,8 @@ static INTERRUPT_GEN(s11_vblank) {
 #endif
   coreGlobals.solenoids  = locals.solsmooth[0] | locals.solsmooth[1];
   coreGlobals.solenoids2 = locals.extSol << 8;
+  if (options.usemodsol)
+    core_pwm_setModSol(&locals.solpwm);
   locals.solenoids = coreGlobals.pulsedSolState;
   locals.extSol = locals.extSolPulse;
 
@@ -347,9 +354,11 @@ static INTERRUPT_GEN(s11_vblank) {
 /----------------*/
 static WRITE_HANDLER(pia1a_w) {
   core_setLamp(coreGlobals.tmpLampMatrix, locals.lampColumn, locals.lampRow = ~data);
+  core_pwm_lampStrobe(locals.lampColumn, locals.lampRow);
 }
 static WRITE_HANDLER(pia1b_w) {
   core_setLamp(coreGlobals.tmpLampMatrix, locals.lampColumn = data, locals.lampRow);
+  core_pwm_lampStrobe(locals.lampColumn, locals.lampRow);
 }
 
 /*-- Jumper W7 --*/
@@ -700,7 +709,37 @@ static int s11_sw2m(int no) { return no+7; }
 int s11_m2sw(int col, int row) { return col*8+row-7; } // needed to map
 #endif
 
+static void s11_registerState(void) {
+  state_save_register_int   ("s11", 0, "vblankCount",   &locals.vblankCount);
+  state_save_register_UINT32("s11", 0, "solenoids",     &locals.solenoids, 1);
+  state_save_register_UINT32("s11", 0, "solsmooth",     locals.solsmooth, S11_SOLSMOOTH);
+  state_save_register_UINT32("s11", 0, "solpwm",        (UINT32 *)&locals.solpwm, sizeof(locals.solpwm) / sizeof(UINT32));
+  state_save_register_UINT32("s11", 0, "extSol",        &locals.extSol, 1);
+  state_save_register_UINT32("s11", 0, "extSolPulse",   &locals.extSolPulse, 1);
+  state_save_register_UINT16("s11", 0, "segments",      &locals.segments[0].w, CORE_SEGCOUNT);
+  state_save_register_UINT16("s11", 0, "pseg",          &locals.pseg[0].w, CORE_SEGCOUNT);
+  state_save_register_int   ("s11", 0, "lampRow",       &locals.lampRow);
+  state_save_register_int   ("s11", 0, "lampColumn",    &locals.lampColumn);
+#ifdef PROC_SUPPORT
+  state_save_register_int   ("s11", 0, "ac_select",     &locals.ac_select);
+  state_save_register_int   ("s11", 0, "ac_state",      &locals.ac_state);
+#endif
+  state_save_register_int   ("s11", 0, "digSel",        &locals.digSel);
+  state_save_register_int   ("s11", 0, "diagnosticLed", &locals.diagnosticLed);
+  state_save_register_int   ("s11", 0, "swCol",         &locals.swCol);
+  state_save_register_int   ("s11", 0, "ssEn",          &locals.ssEn);
+  state_save_register_int   ("s11", 0, "sndCmd",        &locals.sndCmd);
+  state_save_register_int   ("s11", 0, "piaIrq",        &locals.piaIrq);
+#ifdef FIXMUX
+  state_save_register_UINT8 ("s11", 0, "solBits1",      &locals.solBits1, 1);
+  state_save_register_UINT8 ("s11", 0, "solBits2",      &locals.solBits2, 1);
+  state_save_register_UINT8 ("s11", 0, "solBits2prv",   &locals.solBits2prv, 1);
+#endif
+}
+
 static MACHINE_INIT(s11) {
+  s11_registerState();
+  core_pwm_init(&locals.solpwm, S11_MODSOLSMOOTH);
   if (core_gameData->gen & (GEN_DE | GEN_DEDMD16 | GEN_DEDMD32 | GEN_DEDMD64))
     locals.deGame = 1;
   pia_config(S11_PIA0, PIA_STANDARD_ORDERING, &s11_pia[0]);
@@ -742,6 +781,8 @@ static MACHINE_INIT(s11) {
   }
 }
 static MACHINE_INIT(s9pf) {
+  s11_registerState();
+  core_pwm_init(&locals.solpwm, S11_MODSOLSMOOTH);
   pia_config(S11_PIA0, PIA_STANDARD_ORDERING, &s11_pia[0]);
   pia_config(S11_PIA1, PIA_STANDARD_ORDERING, &s11_pia[1]);
   pia_config(S11_PIA2, PIA_STANDARD_ORDERING, &s11_pia[2]);
@@ -31,6 +31,7 @@
 ************************************************************************************************/
 
 #include "driver.h"
+#include "state.h"
 #include "core.h"
 #include "sim.h"
 #include "vpintf.h"
@@ -44,6 +45,14 @@
 
 #define SAM_USE_JIT
 #define SAM_DISPLAYSMOOTH 4
+#define SAM_SOLSMOOTH 24   /* Modulated solenoids - strobes to average */
+
+// Modulated solenoid groups, strobed together
+#define SAM_PWM_SOL1   0   /* 0-3: solenoids 1-32, 8 per bank */
+#define SAM_PWM_AUX1   4   /* aux board: solenoids 51-58 */
+#define SAM_PWM_AUX2   5   /* aux board 12: solenoids 59-64 */
+#define SAM_PWM_MAGNET 6   /* Metallica coffin magnet: solenoids 57-58 */
+#define SAM_PWM_GROUPS 7
 
 #define SAM_FAST_FLIPPERS 1
 #define SAM_SOL_FLIPSTART 13 
@@ -140,9 +149,8 @@ struct {
 	UINT16 value;
 	INT16 bank;
 	UINT8 miniDMDData[14][16];
-	UINT32 solenoidbits[CORE_MODSOL_MAX];
-	UINT32 modulated_lights[WOF_MINIDMD_MAX];  // Also used by Tron ramps
-	UINT8 modulated_lights_prev_levels[WOF_MINIDMD_MAX];
+	core_tPWM solpwm[SAM_PWM_GROUPS];
+	core_tPWM lightpwm[WOF_MINIDMD_MAX / 7];  // WOF mini DMD: 7 dots per column write, also used by Tron ramps
 
 	data8_t ext_leds[SAM_LEDS_MAX];
 	data8_t tmp_leds[SAM_LED_MAX_STRING_LENGTH];
@@ -792,24 +800,23 @@ static WRITE32_HANDLER(sambank_w)
 			case 0x02400020:
 				if (++samlocals.dataWrites[0] == 1)
 				{
-					int ii;
 					coreGlobals.pulsedSolState &= ~(0xFFu << 8);
 					coreGlobals.pulsedSolState |= data << 8;
-					for (ii = 0; ii <= 7; ii++)
-					{
-						core_update_modulated_light(&samlocals.solenoidbits[ii + 8], data & (1u << ii));
+					core_pwm_record(&samlocals.solpwm[SAM_PWM_SOL1 + 1], data);
 #ifdef SAM_FAST_FLIPPERS
-						if (ii + 9 >= SAM_SOL_FLIPSTART && ii + 9 <= SAM_SOL_FLIPEND)
+					{
+						int ii;
+						for (ii = SAM_SOL_FLIPSTART; ii <= SAM_SOL_FLIPEND; ii++)
 						{
-							UINT8 value = core_calc_modulated_light(samlocals.solenoidbits[ii + 8], 24, &coreGlobals.modulatedSolenoids[CORE_MODSOL_PREV][ii + 8]);
-							coreGlobals.modulatedSolenoids[CORE_MODSOL_CUR][ii+8] = value;
+							UINT8 value = core_pwm_level(&samlocals.solpwm[SAM_PWM_SOL1 + 1], ii - 9);
+							coreGlobals.modulatedSolenoids[CORE_MODSOL_CUR][ii - 1] = value;
 							if (value > 0)
 							{
-								coreGlobals.solenoids |= (1u << (ii + 8));
+								coreGlobals.solenoids |= (1u << (ii - 1));
 							}
 						}
-#endif
 					}
+#endif
 				}
 #ifdef SAM_FAST_FLIPPERS
 				else
@@ -820,7 +827,7 @@ static WRITE32_HANDLER(sambank_w)
 					{
 						if (data & (1u << (ii - 9)))
 						{
-							core_update_modulated_light(&samlocals.solenoidbits[ii-1], 1);
+							core_pwm_merge(&samlocals.solpwm[SAM_PWM_SOL1 + 1], 1u << (ii - 9));
 							coreGlobals.solenoids |= (1u << (ii - 1));
 						}
 					}
@@ -830,7 +837,6 @@ static WRITE32_HANDLER(sambank_w)
 			case 0x02400021:
 				if (++samlocals.dataWrites[1] == 1)
 				{
-					int ii;
 					if (core_gameData->hw.gameSpecific1 & SAM_GAME_WOF)
 					{
 						// Special case for Wheel of Fortune.   It has a 4-way stepper motor that goes 4,6,5,7 ... but 
@@ -844,39 +850,27 @@ static WRITE32_HANDLER(sambank_w)
 						coreGlobals.pulsedSolState &= ~(0xFFu);
 						coreGlobals.pulsedSolState |= data;
 					}
-					for (ii = 0; ii <= 7; ii++)
-					{
-						core_update_modulated_light(&samlocals.solenoidbits[ii], data & (1u << ii));
-					}
+					core_pwm_record(&samlocals.solpwm[SAM_PWM_SOL1], data);
 				}
 				break;
 			case 0x02400022:
 				if (++samlocals.dataWrites[2] == 1)
 				{
-					int ii;
 					coreGlobals.pulsedSolState &= ~(0xFFu << 16);
 					coreGlobals.pulsedSolState |= data << 16;
-
-					for (ii = 0; ii <= 7; ii++)
-					{
-						core_update_modulated_light(&samlocals.solenoidbits[ii + 16], data & (1u << ii));
-					}
+					core_pwm_record(&samlocals.solpwm[SAM_PWM_SOL1 + 2], data);
 				}
 				break;
 			case 0x02400023:
 				if (++samlocals.dataWrites[3] == 1)
 				{
-					int ii;
 					coreGlobals.pulsedSolState &= ~(0xFFu << 24);
 					coreGlobals.pulsedSolState |= data << 24;
-					for (ii = 0; ii <= 7; ii++)
-					{
-						core_update_modulated_light(&samlocals.solenoidbits[ii + 24], data & (1u << ii));
-					}
+					core_pwm_record(&samlocals.solpwm[SAM_PWM_SOL1 + 3], data);
 				}
 				break;
 			case 0x02400026:
-				//if (++samlocals.dataWrites[4] == 1) //!! ?? or only for core_update_modulated_light case below?
+				//if (++samlocals.dataWrites[4] == 1) //!! ?? or only for core_pwm_record case below?
 				//{
 				if (core_gameData->hw.gameSpecific1 & SAM_GAME_WPT)
 				{
@@ -916,10 +910,13 @@ static WRITE32_HANDLER(sambank_w)
 						samlocals.miniDMDCol = 0;
 						if (options.usemodsol) // To protect the VP9 table from an onslaught of extra lights. 
 						{
-							int i;
-							for (i = 0; i < WOF_MINIDMD_MAX; i++)
+							int i, j;
+							for (i = 0; i < WOF_MINIDMD_MAX / 7; i++)
 							{
-								coreGlobals.RGBlamps[i + 60] = core_calc_modulated_light(samlocals.modulated_lights[i], 8, &samlocals.modulated_lights_prev_levels[i]);
+								UINT8 level[7];
+								core_pwm_levels(&samlocals.lightpwm[i], 7, level);
+								for (j = 0; j < 7; j++)
+									coreGlobals.RGBlamps[60 + 7 * i + j] = level[6 - j]; // dot j is bit 6-j
 							}
 						}
 					}
@@ -932,12 +929,8 @@ static WRITE32_HANDLER(sambank_w)
 						}
 						if ( samlocals.miniDMDCol > 1 && samlocals.miniDMDCol < 7 )
 						{
-							int i;
 							samlocals.miniDMDData[samlocals.miniDMDRow][samlocals.miniDMDCol - 2] = data & 0x7F;
-							for (i = 0; i < 7; i++) //!! <= 7 ? most likely not
-							{
-								core_update_modulated_light(&samlocals.modulated_lights[35 * samlocals.miniDMDRow + (samlocals.miniDMDCol - 2) * 7 + i], data & (1u << (6 - i)));
-							}
+							core_pwm_record(&samlocals.lightpwm[5 * samlocals.miniDMDRow + samlocals.miniDMDCol - 2], data & 0x7F);
 						}
 					}
 					else
@@ -963,10 +956,13 @@ static WRITE32_HANDLER(sambank_w)
 			case 0x0240002A:
 				samlocals.colWrites = 0;
 				if (++samlocals.dataWrites[5] == 1)
+				{
 					coreGlobals.tmpLampMatrix[samlocals.lampcol] = core_revbyte(data);
+					core_pwm_lampStrobe(1 << samlocals.lampcol, coreGlobals.tmpLampMatrix[samlocals.lampcol]);
+				}
 				break;
 			case 0x0240002B:
-				//if (++samlocals.dataWrites[6] == 1) //!! ?? or only for core_update_modulated_light cases below?
+				//if (++samlocals.dataWrites[6] == 1) //!! ?? or only for core_pwm_record cases below?
 				//{
 				coreGlobals.gi[0] = (~data & 0x01) ? 9 : 0;
 
@@ -983,25 +979,16 @@ static WRITE32_HANDLER(sambank_w)
 					((core_gameData->hw.gameSpecific1 & SAM_GAME_AUXSOL8)  && (~data & 0x10)) ||
 					((core_gameData->hw.gameSpecific1 & SAM_GAME_IJ4_SOL3) && (~data & 0x40)))
 				{
-					int ii;
-					for (ii = 0; ii <= ((core_gameData->hw.gameSpecific1 & (SAM_GAME_AUXSOL8 | SAM_GAME_ACDC_FLAMES)) ? 7 : 5); ii++)
-					{
-						core_update_modulated_light(&samlocals.solenoidbits[ii + CORE_FIRSTCUSTSOL - 1], samlocals.auxdata & (1u << ii));
-					}
+					core_pwm_record(&samlocals.solpwm[SAM_PWM_AUX1], samlocals.auxdata & ((core_gameData->hw.gameSpecific1 & (SAM_GAME_AUXSOL8 | SAM_GAME_ACDC_FLAMES)) ? 0xff : 0x3f));
 				}
 				if (((core_gameData->hw.gameSpecific1 & SAM_GAME_AUXSOL12) && (~data & 0x10)))
 				{
-					int ii;
-					for (ii = 0; ii <= 5; ii++)
-					{
-						core_update_modulated_light(&samlocals.solenoidbits[ii + CORE_FIRSTCUSTSOL + 8 - 1], samlocals.auxdata & (1u << ii));
-					}
+					core_pwm_record(&samlocals.solpwm[SAM_PWM_AUX2], samlocals.auxdata & 0x3f);
 				}
 				// Metallica LE has a special aux board just for the coffin magnet! 
 				if (((core_gameData->hw.gameSpecific1 & SAM_GAME_METALLICA_MAGNET) && (~data & 0x08)))
 				{
-					core_update_modulated_light(&samlocals.solenoidbits[6 + CORE_FIRSTCUSTSOL - 1], samlocals.auxdata & 0x80);
-					core_update_modulated_light(&samlocals.solenoidbits[7 + CORE_FIRSTCUSTSOL - 1], samlocals.auxdata & 0x40);
+					core_pwm_record(&samlocals.solpwm[SAM_PWM_MAGNET], ((samlocals.auxdata >> 7) & 0x01) | ((samlocals.auxdata >> 5) & 0x02));
 				}
 				// AC/DC LE uses a special aux board for flame lights
 				if (((core_gameData->hw.gameSpecific1 & SAM_GAME_ACDC_FLAMES) && (~data & 0x08)))
@@ -1028,16 +1015,12 @@ static WRITE32_HANDLER(sambank_w)
 					if ( ~data & 0x10 )
 					{
 						coreGlobals.lampMatrix[11] = coreGlobals.tmpLampMatrix[11] = core_revbyte(samlocals.auxdata);
-						core_update_modulated_light(&samlocals.modulated_lights[0], samlocals.auxdata & (1u << 3));
-						core_update_modulated_light(&samlocals.modulated_lights[1], samlocals.auxdata & (1u << 4));
-						core_update_modulated_light(&samlocals.modulated_lights[2], samlocals.auxdata & (1u << 5));
+						core_pwm_record(&samlocals.lightpwm[0], (samlocals.auxdata >> 3) & 0x07);
 					}
 					if ( ~data & 0x20 )
 					{
 						coreGlobals.lampMatrix[10] = coreGlobals.tmpLampMatrix[10] = core_revbyte(samlocals.auxdata);
-						core_update_modulated_light(&samlocals.modulated_lights[3], samlocals.auxdata & (1u << 3));
-						core_update_modulated_light(&samlocals.modulated_lights[4], samlocals.auxdata & (1u << 4));
-						core_update_modulated_light(&samlocals.modulated_lights[5], samlocals.auxdata & (1u << 5));
+						core_pwm_record(&samlocals.lightpwm[1], (samlocals.auxdata >> 3) & 0x07);
 					}
 					if ( ~data & 0x40 )
 						LOG(("Test"));
@@ -1117,6 +1100,13 @@ static WRITE32_HANDLER(sambank_w)
 	nvram[offset] = (nvram[offset] & mem_mask) | (data & ~mem_mask);
 }*/
 
+//U11 NVRAM, a handler only to report the writes for the host (ChangedNVRAM)
+static WRITE32_HANDLER(sam_nvram_w)
+{
+	COMBINE_DATA(&nvram[offset]);
+	memory_track_write(&nvram[offset], 4);
+}
+
 static MEMORY_WRITE32_START(sam_writemem)
 	{ 0x00000000, 0x000FFFFF, MWA32_RAM, &sam_page0_ram},  // Boot RAM
 	{ 0x00300000, 0x003FFFFF, MWA32_RAM, &sam_reset_ram},  // Swapped RAM
@@ -1124,7 +1114,7 @@ static MEMORY_WRITE32_START(sam_writemem)
 	{ 0x01080000, 0x0109EFFF, MWA32_RAM },				   //U13 RAM - DMD Data for output
 	{ 0x0109F000, 0x010FFFFF, samxilinx_w },			   //U13 RAM - Sound Data for output
 	{ 0x01100000, 0x01FFFFFF, samdmdram_w },			   //Various Output Signals
-	{ 0x02100000, 0x0211FFFF, MWA32_RAM, &nvram },		   //U11 NVRAM (128K) 0x02100000,0x0211ffff
+	{ 0x02100000, 0x0211FFFF, sam_nvram_w, &nvram },	   //U11 NVRAM (128K) 0x02100000,0x0211ffff
 	{ 0x02200000, 0x022fffff, sam_io2_w },				   //LE versions: more I/O stuff (mostly LED lamps)
 	{ 0x02400000, 0x02FFFFFF, sambank_w },				   //I/O Related
 	{ 0x03000000, 0x030000FF, MWA32_RAM },				   //USB Related
@@ -1212,7 +1202,56 @@ static PORT_WRITE32_START(sam_writeport)
 	{ 0x00,0xFF, sam_port_w },
 PORT_END
 
+/*-- save state --*/
+static void sam_postload(void)
+{
+	cpu_setbank(SAM_ROMBANK0, memory_region(REGION_USER1) + (samlocals.bank << 23));
+}
+
+static void sam_register_state(void)
+{
+	state_save_register_int   ("sam", 0, "vblankCount", &samlocals.vblankCount);
+	state_save_register_int   ("sam", 0, "diagnosticLed", &samlocals.diagnosticLed);
+	state_save_register_int   ("sam", 0, "sw_stb", &samlocals.sw_stb);
+	state_save_register_int   ("sam", 0, "zc", &samlocals.zc);
+	state_save_register_INT32 ("sam", 0, "video_page", (INT32 *)samlocals.video_page, 2);
+	state_save_register_INT16 ("sam", 0, "samplebuf", &samlocals.samplebuf[0][0], 2 * SNDBUFSIZE);
+	state_save_register_INT16 ("sam", 0, "lastsamp", samlocals.lastsamp, 2);
+	state_save_register_int   ("sam", 0, "sampout", &samlocals.sampout);
+	state_save_register_int   ("sam", 0, "sampnum", &samlocals.sampnum);
+	state_save_register_UINT8 ("sam", 0, "volume", samlocals.volume, 2);
+	state_save_register_UINT8 ("sam", 0, "mute", samlocals.mute, 2);
+	state_save_register_UINT8 ("sam", 0, "DAC_mute", samlocals.DAC_mute, 2);
+	state_save_register_int   ("sam", 0, "pass", &samlocals.pass);
+	state_save_register_int   ("sam", 0, "coindoor", &samlocals.coindoor);
+	state_save_register_UINT16("sam", 0, "value", &samlocals.value, 1);
+	state_save_register_INT16 ("sam", 0, "bank", &samlocals.bank, 1);
+	state_save_register_UINT8 ("sam", 0, "miniDMDData", &samlocals.miniDMDData[0][0], sizeof(samlocals.miniDMDData));
+	state_save_register_UINT32("sam", 0, "solpwm", (UINT32 *)samlocals.solpwm, SAM_PWM_GROUPS * sizeof(core_tPWM) / sizeof(UINT32));
+	state_save_register_UINT32("sam", 0, "lightpwm", (UINT32 *)samlocals.lightpwm, WOF_MINIDMD_MAX / 7 * sizeof(core_tPWM) / sizeof(UINT32));
+	state_save_register_UINT8 ("sam", 0, "ext_leds", samlocals.ext_leds, SAM_LEDS_MAX);
+	state_save_register_UINT8 ("sam", 0, "tmp_leds", samlocals.tmp_leds, SAM_LED_MAX_STRING_LENGTH);
+	state_save_register_int   ("sam", 0, "lampcol", &samlocals.lampcol);
+	state_save_register_UINT8 ("sam", 0, "auxstrb", &samlocals.auxstrb, 1);
+	state_save_register_UINT8 ("sam", 0, "auxdata", &samlocals.auxdata, 1);
+	state_save_register_int   ("sam", 0, "WOF_minidmdflag", &samlocals.WOF_minidmdflag);
+	state_save_register_int   ("sam", 0, "colWrites", &samlocals.colWrites);
+	state_save_register_INT32 ("sam", 0, "dataWrites", (INT32 *)samlocals.dataWrites, 6);
+	state_save_register_int   ("sam", 0, "miniDMDCol", &samlocals.miniDMDCol);
+	state_save_register_int   ("sam", 0, "miniDMDRow", &samlocals.miniDMDRow);
+	state_save_register_UINT8 ("sam", 0, "prev_ch1", &samlocals.prev_ch1, 1);
+	state_save_register_UINT8 ("sam", 0, "prev_ch2", &samlocals.prev_ch2, 1);
+	state_save_register_int   ("sam", 0, "led_col", &samlocals.led_col);
+	state_save_register_int   ("sam", 0, "led_row", &samlocals.led_row);
+	state_save_register_int   ("sam", 0, "target_row", &samlocals.target_row);
+	state_save_register_int   ("sam", 0, "serchar_waiting", &samlocals.serchar_waiting);
+	state_save_register_int   ("sam", 0, "leds_per_string", &samlocals.leds_per_string);
+	state_save_register_int   ("sam", 0, "LED_hack_send_garbage", &samlocals.LED_hack_send_garbage);
+	state_save_register_func_postload(sam_postload);
+}
+
 static MACHINE_INIT(sam) {
+	sam_register_state();
 	at91_set_ram_pointers(sam_reset_ram, sam_page0_ram);
 	at91_set_transmit_serial(sam_transmit_serial);
 	at91_set_serial_receive_ready(sam_LED_hack);
@@ -1232,8 +1271,13 @@ static MACHINE_INIT(sam) {
 void sam_init()
 {
 	const char * const gn = Machine->gamedrv->name;
+	int i;
 
 	memset(&samlocals, 0, sizeof(samlocals));
+	for (i = 0; i < SAM_PWM_GROUPS; i++)
+		core_pwm_init(&samlocals.solpwm[i], SAM_SOLSMOOTH);
+	for (i = 0; i < WOF_MINIDMD_MAX / 7; i++) // Tron ramps average over more strobes
+		core_pwm_init(&samlocals.lightpwm[i], (core_gameData->hw.gameSpecific1 & SAM_GAME_TRON) ? 15 : 8);
 	samlocals.pass = 16;
 	samlocals.coindoor = 1;
 	samlocals.led_row = -1;
@@ -1496,10 +1540,8 @@ static INTERRUPT_GEN(sam_vblank) {
 	{
 	case SAM_GAME_TRON:
 	{
-		for(i=0;i<6;i++)
-		{
-			coreGlobals.RGBlamps[i+20] = core_calc_modulated_light(samlocals.modulated_lights[i], 15, &samlocals.modulated_lights_prev_levels[i]);
-		}
+		core_pwm_levels(&samlocals.lightpwm[0], 3, (UINT8 *)&coreGlobals.RGBlamps[20]);
+		core_pwm_levels(&samlocals.lightpwm[1], 3, (UINT8 *)&coreGlobals.RGBlamps[23]);
 		break;
 	}
 	case SAM_GAME_WOF:
@@ -1523,16 +1565,22 @@ static INTERRUPT_GEN(sam_vblank) {
 	/*-- solenoids --*/
 	{
 	UINT32 solenoidupdate = 0;
+	UINT8 level[CORE_MODSOL_MAX];
+
+	memset(level, 0, sizeof(level));
+	for (i = 0; i < 4; i++)
+		core_pwm_levels(&samlocals.solpwm[SAM_PWM_SOL1 + i], 8, &level[8 * i]);
+	core_pwm_levels(&samlocals.solpwm[SAM_PWM_AUX1], 8, &level[CORE_FIRSTCUSTSOL - 1]);
+	core_pwm_levels(&samlocals.solpwm[SAM_PWM_AUX2], 6, &level[CORE_FIRSTCUSTSOL + 8 - 1]);
+	if (core_gameData->hw.gameSpecific1 & SAM_GAME_METALLICA_MAGNET)
+		core_pwm_levels(&samlocals.solpwm[SAM_PWM_MAGNET], 2, &level[CORE_FIRSTCUSTSOL + 6 - 1]);
 	for(i=0;i<CORE_MODSOL_MAX;i++)
 	{
-		UINT8 value;
-
 		if (i == 32) // Skip VPM reserved solenoids
 			i=CORE_FIRSTCUSTSOL-1;
 
-		value = core_calc_modulated_light(samlocals.solenoidbits[i], 24, &coreGlobals.modulatedSolenoids[CORE_MODSOL_PREV][i]);		
-		coreGlobals.modulatedSolenoids[CORE_MODSOL_CUR][i] = value;		
-		if (value > 0 && i < 32)
+		coreGlobals.modulatedSolenoids[CORE_MODSOL_CUR][i] = level[i];
+		if (level[i] > 0 && i < 32)
 			solenoidupdate |= (1u << i);
 	}
 	coreGlobals.solenoids = solenoidupdate;
@@ -1551,8 +1599,22 @@ static INTERRUPT_GEN(sam_vblank) {
 / Load/Save static ram
 / Save RAM & CMOS Information
 /-------------------------------------------------*/
+//-bootsnapshot: the NVRAM is a chip of its own, all of it persists
+static void sam_mergeNVRAM(const UINT8 *data, UINT32 size)
+{
+	if (size < 0x20000)
+		return;
+	memcpy(nvram, data, 0x20000);
+	memory_track_write(nvram, 0x20000);
+}
+
 static NVRAM_HANDLER(sam) {
 	core_nvram(file, read_or_write, nvram, 0x20000, 0xff);		//128K NVRAM
+	if (!read_or_write)
+	{
+		memory_track_region(nvram, 0x20000);	//sam_nvram_w reports the writes
+		cpu_set_bootsnap_nvram(sam_mergeNVRAM);
+	}
 }
 
 //Toggle Zero Cross bit
@@ -41,6 +41,7 @@ DMD Timing is still wrong.. FIRQ rate is variable, and it's not fully understood
 
 #define SE_VBLANKFREQ      60 /* VBLANK frequency */
 #define SE_FIRQFREQ       976 /* FIRQ Frequency according to Theory of Operation */
+#define SE_MODSOLSMOOTH    32 /* Modulated solenoids - FIRQs to average */
 #define SE_ROMBANK0         1
 
 #ifdef PROC_SUPPORT
@@ -67,6 +68,7 @@ struct {
   int    vblankCount;
   int    initDone;
   UINT32 solenoids;
+  core_tPWM solpwm;               /* modulated solenoids, sampled every FIRQ */
   int    lampRow, lampColumn;
   int    diagnosticLed;
   int    swCol;
@@ -90,6 +92,12 @@ struct {
 #ifdef PROC_SUPPORT
 static int switches_retrieved=0;
 #endif
+static INTERRUPT_GEN(se_firq) {
+  if (options.usemodsol)
+    core_pwm_record(&selocals.solpwm, coreGlobals.pulsedSolState);
+  irq1_line_pulse();
+}
+
 static INTERRUPT_GEN(se_vblank) {
   /*-------------------------------
   /  copy local data to interface
@@ -162,6 +170,11 @@ static INTERRUPT_GEN(se_vblank) {
 		}
 #endif
   }
+  if (options.usemodsol) {
+    core_pwm_setModSol(&selocals.solpwm);
+    if (coreGlobals.solenoids & 0x4000) /* fast flips */
+      coreGlobals.modulatedSolenoids[CORE_MODSOL_CUR][14] = 255;
+  }
 #ifdef PROC_SUPPORT
 	if (coreGlobals.p_rocEn) {
 		procCheckActiveCoils();
@@ -206,6 +219,7 @@ static SWITCH_UPDATE(se) {
 
 static MACHINE_INIT(se3) {
 	//const char * const gn = Machine->gamedrv->name;
+	core_pwm_init(&selocals.solpwm, SE_MODSOLSMOOTH);
 	sndbrd_0_init(SNDBRD_DEDMD32, 2, memory_region(DE_DMD32ROMREGION),NULL,NULL);
 	sndbrd_1_init(SNDBRD_DE3S,    1, memory_region(DE2S_ROMREGION), NULL, NULL);
 
@@ -250,6 +264,7 @@ static MACHINE_INIT(se3) {
 
 static MACHINE_INIT(se) {
   const char * const gn = Machine->gamedrv->name;
+  core_pwm_init(&selocals.solpwm, SE_MODSOLSMOOTH);
   sndbrd_0_init(SNDBRD_DEDMD32, 2, memory_region(DE_DMD32ROMREGION),NULL,NULL);
   sndbrd_1_init(SNDBRD_DE2S,    1, memory_region(DE2S_ROMREGION), NULL, NULL);
 
@@ -375,8 +390,12 @@ static READ_HANDLER(mcpu_ram8000_r) { return selocals.ram8000[offset]; }
 static WRITE_HANDLER(lampdriv_w) {
   selocals.lampRow = core_revbyte(data);
   core_setLamp(coreGlobals.tmpLampMatrix, selocals.lampColumn, selocals.lampRow);
+  core_pwm_lampStrobe(selocals.lampColumn, selocals.lampRow);
+}
+static WRITE_HANDLER(lampstrb_w) {
+  core_setLamp(coreGlobals.tmpLampMatrix, selocals.lampColumn = (selocals.lampColumn & 0xff00) | data, selocals.lampRow);
+  core_pwm_lampStrobe(selocals.lampColumn, selocals.lampRow);
 }
-static WRITE_HANDLER(lampstrb_w) { core_setLamp(coreGlobals.tmpLampMatrix, selocals.lampColumn = (selocals.lampColumn & 0xff00) | data, selocals.lampRow);}
 static READ_HANDLER(lampstrb_r) { return selocals.lampColumn & 0xff; }
 static WRITE_HANDLER(auxlamp_w) { core_setLamp(coreGlobals.tmpLampMatrix, selocals.lampColumn = (selocals.lampColumn & 0x00ff) | (data<<8), selocals.lampRow);}
 static READ_HANDLER(auxlamp_r) { return (selocals.lampColumn >> 8) & 0xff; }
@@ -813,7 +832,7 @@ static MACHINE_DRIVER_START(se)
   MDRV_CORE_INIT_RESET_STOP(se,NULL,se)
   MDRV_CPU_MEMORY(se_readmem, se_writemem)
   MDRV_CPU_VBLANK_INT(se_vblank, 1)
-  MDRV_CPU_PERIODIC_INT(irq1_line_pulse, SE_FIRQFREQ)
+  MDRV_CPU_PERIODIC_INT(se_firq, SE_FIRQFREQ)
   MDRV_NVRAM_HANDLER(se)
   MDRV_DIPS(8)
   MDRV_SWITCH_UPDATE(se)
@@ -851,7 +870,7 @@ MACHINE_DRIVER_START(se3aS)
   MDRV_CORE_INIT_RESET_STOP(se3,NULL,se)
   MDRV_CPU_MEMORY(se_readmem, se_writemem)
   MDRV_CPU_VBLANK_INT(se_vblank, 1)
-  MDRV_CPU_PERIODIC_INT(irq1_line_pulse, SE_FIRQFREQ)
+  MDRV_CPU_PERIODIC_INT(se_firq, SE_FIRQFREQ)
   MDRV_NVRAM_HANDLER(se)
   MDRV_DIPS(8)
   MDRV_SWITCH_UPDATE(se)
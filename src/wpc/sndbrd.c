@@ -1,6 +1,7 @@
 #ifndef SNDBRD_RECURSIVE
 #  define SNDBRD_RECURSIVE
 #  include "driver.h"
+#  include "state.h"
 #  include "core.h"
 #  include "snd_cmd.h"
 #  include "sndbrd.h"
@@ -21,11 +22,27 @@ static struct intfData {
   int manCmdBuf; // if board requires 2 sound commands, keep last value here.
 } intf[2];
 
+/*-- commands to the sound boards (and their answers) wait in a timer --*/
+#define MAX_SYNCS 5
+static struct {
+  int used;
+  WRITE_HANDLER((*handler));
+  int offset,data;
+} syncData[MAX_SYNCS];
+
+/*-- the timers are not saved, commands in flight when a state is loaded are lost --*/
+static void sndbrd_postload(void) {
+  memset(syncData, 0, sizeof(syncData));
+}
+
 void sndbrd_init(int brdNo, int brdType, int cpuNo, UINT8 *romRegion,
                  WRITE_HANDLER((*data_cb)),WRITE_HANDLER((*ctrl_cb))) {
   const struct sndbrdIntf *b = allsndboards[brdType>>8];
   struct intfData *i = &intf[brdNo];
   struct sndbrdData brdData;
+
+  /*-- the sync timers didn't survive a reset --*/
+  memset(syncData, 0, sizeof(syncData));
 #if HAS_SAMPLES
   if ((brdType != SNDBRD_NONE) &&
       ((b->flags & SNDBRD_NOTSOUND) ||
@@ -42,6 +59,8 @@ void sndbrd_init(int brdNo, int brdType, int cpuNo, UINT8 *romRegion,
     i->data_cb = data_cb;
     i->ctrl_cb = ctrl_cb;
     i->manCmdBuf = -1;
+    state_save_register_int("sndbrd", brdNo, "manCmdBuf", &i->manCmdBuf);
+    state_save_register_func_postload(sndbrd_postload);
     if (b && (coreGlobals.soundEn || b->flags & SNDBRD_NOTSOUND) && b->init)
       b->init(&brdData);
   }
@@ -160,13 +179,6 @@ int sndbrd_type(int offset) { return intf[offset].type; }
 int sndbrd_0_type()         { return intf[0].type; }
 int sndbrd_1_type()         { return intf[1].type; }
 
-#define MAX_SYNCS 5
-static struct {
-  int used;
-  WRITE_HANDLER((*handler));
-  int offset,data;
-} syncData[MAX_SYNCS];
-
 static void sndbrd_doSync(int param) {
   syncData[param].used = FALSE;
   syncData[param].handler(syncData[param].offset,syncData[param].data);
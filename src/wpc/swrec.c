@@ -0,0 +1,161 @@
+/************************************************/
+/* Switch recording and replay                  */
+/************************************************/
+/*
+ See swrec.h. The host thread only fills the queue, everything else
+ runs in the emulation thread from the tick timer.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "driver.h"
+#include "mtlock.h"
+#include "core.h"
+#include "swrec.h"
+
+enum { SWREC_OFF = 0, SWREC_RECORD, SWREC_REPLAY };
+
+static struct {
+  int mode;
+  int done;                 /* a reset ended the recording/replay */
+  FILE *f;
+  void *timer;
+  UINT32 events;
+  /*-- recording, filled by the host --*/
+  struct { int swNo, value; } queue[SWREC_QUEUE];
+  int queued;
+  /*-- replay, the next event of the file --*/
+  int hasNext, lineNo;
+  UINT64 nextCycles;
+  int nextSw, nextValue;
+} locals;
+
+MTLOCK(swrecLock);
+
+/*-- reads the next event of the replay file --*/
+static void swrec_readNext(void) {
+  char line[256];
+
+  locals.hasNext = FALSE;
+  while (fgets(line, sizeof(line), locals.f)) {
+    unsigned long long cycles;
+    char *p = line;
+
+    locals.lineNo += 1;
+    while (*p == ' ' || *p == '\t') p++;
+    if (*p == '#' || *p == '\n' || *p == '\r' || *p == 0)
+      continue;
+    if (sscanf(p, "%llu %d %d", &cycles, &locals.nextSw, &locals.nextValue) != 3) {
+      logerror("swreplay: line %d: syntax error\n", locals.lineNo);
+      return;
+    }
+    locals.nextCycles = cycles;
+    locals.hasNext = TRUE;
+    return;
+  }
+}
+
+static void swrec_tick(int param) {
+  UINT64 now = cpunum_gettotalcycles64(0);
+
+  if (locals.mode == SWREC_RECORD) {
+    int ii;
+    mtlock_enter(&swrecLock);
+    for (ii = 0; ii < locals.queued; ii++) {
+      core_setSw(locals.queue[ii].swNo, locals.queue[ii].value);
+      fprintf(locals.f, "%llu %d %d\n", (unsigned long long)now, locals.queue[ii].swNo, locals.queue[ii].value);
+    }
+    locals.events += locals.queued;
+    locals.queued = 0;
+    mtlock_leave(&swrecLock);
+  }
+  else {
+    while (locals.hasNext && locals.nextCycles <= now) {
+      core_setSw(locals.nextSw, locals.nextValue);
+      locals.events += 1;
+      swrec_readNext();
+    }
+  }
+}
+
+/*-- checks the "# swrec <game> <rate> <clock>" line of a replay --*/
+static int swrec_checkHeader(void) {
+  char line[256], game[64];
+  int rate, clock;
+
+  if (!fgets(line, sizeof(line), locals.f) ||
+      sscanf(line, "# swrec %63s %d %d", game, &rate, &clock) != 3) {
+    logerror("swreplay: not a switch recording\n");
+    return FALSE;
+  }
+  locals.lineNo = 1;
+  if (strcmp(game, Machine->gamedrv->name) || rate != SWREC_RATE || clock != Machine->drv->cpu[0].cpu_clock) {
+    logerror("swreplay: recorded with %s at %d Hz, CPU clock %d\n", game, rate, clock);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+void swrec_init(void) {
+  if (locals.done || locals.mode != SWREC_OFF)
+    return;
+  if (pmoptions.sw_replay && *pmoptions.sw_replay) {
+    if ((locals.f = fopen(pmoptions.sw_replay, "r")) == NULL)
+      logerror("swreplay: can't open %s\n", pmoptions.sw_replay);
+    else if (!swrec_checkHeader()) {
+      fclose(locals.f); locals.f = NULL;
+    }
+    else {
+      locals.mode = SWREC_REPLAY;
+      swrec_readNext();
+    }
+  }
+  else if (pmoptions.sw_record && *pmoptions.sw_record) {
+    if ((locals.f = fopen(pmoptions.sw_record, "w")) == NULL)
+      logerror("swrecord: can't create %s\n", pmoptions.sw_record);
+    else {
+      fprintf(locals.f, "# swrec %s %d %d\n", Machine->gamedrv->name, SWREC_RATE, Machine->drv->cpu[0].cpu_clock);
+      locals.mode = SWREC_RECORD;
+    }
+  }
+  if (locals.mode != SWREC_OFF) {
+    locals.events = 0;
+    locals.timer = timer_alloc(swrec_tick);
+    timer_adjust(locals.timer, TIME_IN_HZ(SWREC_RATE), 0, TIME_IN_HZ(SWREC_RATE));
+  }
+}
+
+void swrec_exit(void) {
+  if (locals.mode == SWREC_OFF)
+    return;
+  logerror("%s: %u switch events\n", locals.mode == SWREC_RECORD ? "swrecord" : "swreplay", locals.events);
+  if (locals.timer)
+    timer_remove(locals.timer);
+  locals.timer = NULL;
+  mtlock_enter(&swrecLock);
+  locals.mode = SWREC_OFF;
+  locals.queued = 0;
+  mtlock_leave(&swrecLock);
+  fclose(locals.f);
+  locals.f = NULL;
+  locals.done = TRUE;
+}
+
+void swrec_putSw(int swNo, int value) {
+  if (locals.mode == SWREC_OFF)
+    core_setSw(swNo, value);
+  else if (locals.mode == SWREC_RECORD) {
+    mtlock_enter(&swrecLock);
+    if (locals.mode != SWREC_RECORD)
+      core_setSw(swNo, value);
+    else if (locals.queued < SWREC_QUEUE) {
+      locals.queue[locals.queued].swNo = swNo;
+      locals.queue[locals.queued].value = value;
+      locals.queued += 1;
+    }
+    else
+      logerror("swrecord: queue full, switch %d lost\n", swNo);
+    mtlock_leave(&swrecLock);
+  }
+  /* replay: the file sets the switches */
+}
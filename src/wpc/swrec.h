@@ -0,0 +1,39 @@
+#ifndef INC_SWREC
+#define INC_SWREC
+#if !defined(__GNUC__) || (__GNUC__ == 3 && __GNUC_MINOR__ >= 4) || (__GNUC__ >= 4)	// GCC supports "pragma once" correctly since 3.4
+#pragma once
+#endif
+
+/*-------------------------------------------------------------------
+/  Switch recording and replay (-swrecord/-swreplay)
+/
+/  Switch changes from the host (vp_putSwitch, the headless switch
+/  timeline) arrive whenever the host thread calls, so two runs of the
+/  same session are not the same. While recording they are queued and
+/  set by a timer every 1/SWREC_RATE s of emulated time, which also
+/  writes them to the file with the total cycles of CPU 0 at that
+/  moment. A replay runs the same timer and sets the switches of the
+/  file at the tick that has reached their cycle count. Switch changes
+/  from the host are ignored during a replay.
+/
+/  Switches set by the driver from the keyboard are not in the file,
+/  use -record/-playback for those. A reset ends the recording or the
+/  replay.
+/
+/  Text file, one event per line:
+/    <cycles of CPU 0> <switch number> <0|1>
+/  Lines starting with # are comments. The first one names the game,
+/  the rate and the clock of CPU 0. The file is not replayed if they
+/  do not match.
+/-------------------------------------------------------------------*/
+#define SWREC_RATE   1000    /* Hz */
+#define SWREC_QUEUE  256     /* host changes between two ticks */
+
+/*-- called by the core at machine init/stop --*/
+void swrec_init(void);
+void swrec_exit(void);
+
+/*-- a switch change from the host, any thread --*/
+void swrec_putSw(int swNo, int value);
+
+#endif /* INC_SWREC */
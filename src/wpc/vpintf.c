@@ -17,11 +17,36 @@ static struct {
   mech_tInitData md;
 } locals;
 
+/*-- change event queue, written by the emulation, read by the host --*/
+#define VP_EVENTQUEUE_SIZE 4096 /* must be a power of 2 */
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#  define vp_memoryBarrier() _ReadWriteBarrier()
+#elif defined(__GNUC__)
+#  define vp_memoryBarrier() __sync_synchronize()
+#else
+#  define vp_memoryBarrier()
+#endif
+
+static struct {
+  vp_tChgEvent events[VP_EVENTQUEUE_SIZE];
+  volatile unsigned int head; /* next to write, only changed by the emulation */
+  volatile unsigned int tail; /* next to read, only changed by the host */
+  volatile int lost;
+  /*-- status as last queued --*/
+  UINT8  lastLampMatrix[CORE_MAXLAMPCOL];
+  UINT8  lastRGBLamps[CORE_MAXRGBLAMPS];
+  UINT64 lastSol;
+  UINT8  lastModSol[CORE_MODSOL_MAX];
+  int    lastGI[CORE_MAXGI];
+} evlocals;
+
 /*-------------------------------
 /  Initialise/reset the VP interface
 /--------------------------------*/
 void vp_init(void) {
   memset(&locals, 0, sizeof(locals));
+  memset(&evlocals, 0, sizeof(evlocals));
   locals.solMask[0] = locals.solMask[1] = 0xffffffff;
   mech_init();
 }
@@ -34,6 +59,17 @@ int vp_getLamp(int lampNo) {
   return (coreGlobals.lampMatrix[lampNo/8]>>(lampNo%8)) & 0x01;
 }
 
+/*------------------------------------
+/  get the brightness of a lamp (0-255)
+/-------------------------------------*/
+int vp_getLampLevel(int lampNo) {
+  if (coreData->lamp2m) lampNo = coreData->lamp2m(lampNo)-8;
+  /*-- lamps outside columns 0-7 are on/off --*/
+  if (lampNo >= 0 && lampNo < 64)
+    return coreGlobals.lampLevels[lampNo];
+  return ((coreGlobals.lampMatrix[lampNo/8]>>(lampNo%8)) & 0x01) ? 255 : 0;
+}
+
 /*-------------------------------------------
 /  get all lamps changed since last call
 /  returns number of canged lamps
@@ -159,6 +195,23 @@ int vp_getChangedGI(vp_tChgGIs chgStat) {
 
   return idx;
 }
+
+int vp_getChangedNVRAM(vp_tChgNVRAMs chgStat) {
+  struct mem_change chg[256];
+  int idx = 0, count, ii;
+
+  do {
+    count = memory_track_changes(chg, (CORE_MAXNVRAM - idx < 256) ? CORE_MAXNVRAM - idx : 256);
+    if (count < 0)
+      return -1;
+    for (ii = 0; ii < count; ii++, idx++) {
+      chgStat[idx].nvramNo  = chg[ii].offset;
+      chgStat[idx].oldStat  = chg[ii].olddata;
+      chgStat[idx].currStat = chg[ii].newdata;
+    }
+  } while (count == 256);
+  return idx;
+}
 /*-----------
 /  set DIPs
 /-----------*/
@@ -257,3 +310,95 @@ int vp_getChangedLEDs(vp_tChgLED chgStat, UINT64 mask, UINT64 mask2) {
   memcpy(locals.lastSeg, coreGlobals.drawSeg, sizeof(locals.lastSeg));
   return idx;
 }
+
+/*-------------------------------------------------
+/  queue change events (called by the emulation)
+/------------------------------------------------*/
+static void vp_queueEvent(double time, int type, int no, int currStat) {
+  unsigned int head = evlocals.head;
+
+  if (head - evlocals.tail >= VP_EVENTQUEUE_SIZE) { evlocals.lost += 1; return; }
+  evlocals.events[head & (VP_EVENTQUEUE_SIZE-1)].time = time;
+  evlocals.events[head & (VP_EVENTQUEUE_SIZE-1)].type = type;
+  evlocals.events[head & (VP_EVENTQUEUE_SIZE-1)].no = no;
+  evlocals.events[head & (VP_EVENTQUEUE_SIZE-1)].currStat = currStat;
+  vp_memoryBarrier(); /* event must be complete before the reader can see it */
+  evlocals.head = head + 1;
+}
+
+void vp_queueChangeEvents(void) {
+  const double now = timer_get_time();
+  int ii, jj;
+
+  /*-- lamps, numbered as in vp_getChangedLamps --*/
+  for (ii = 0; ii < CORE_STDLAMPCOLS+core_gameData->hw.lampCol; ii++) {
+    int lamps = coreGlobals.lampMatrix[ii];
+    int chgLamp = lamps ^ evlocals.lastLampMatrix[ii];
+    if (chgLamp) {
+      evlocals.lastLampMatrix[ii] = lamps;
+      for (jj = 0; jj < 8; jj++, chgLamp >>= 1, lamps >>= 1)
+        if (chgLamp & 0x01)
+          vp_queueEvent(now, VP_CHGEVENT_LAMP, coreData->m2lamp ? coreData->m2lamp(ii+1, jj) : 0, lamps & 0x01);
+    }
+  }
+  for (ii = 0; ii < CORE_MAXRGBLAMPS; ii++) {
+    if (coreGlobals.RGBlamps[ii] != evlocals.lastRGBLamps[ii]) {
+      evlocals.lastRGBLamps[ii] = coreGlobals.RGBlamps[ii];
+      vp_queueEvent(now, VP_CHGEVENT_LAMP, ii+81, evlocals.lastRGBLamps[ii]);
+    }
+  }
+
+  /*-- solenoids, as in vp_getChangedSolenoids --*/
+  {
+    UINT64 allSol = core_getAllSol();
+    UINT64 chgSol = (allSol ^ evlocals.lastSol) & vp_getSolMask64();
+    int start = 0, end = CORE_FIRSTCUSTSOL+core_gameData->hw.custSol-1;
+
+    evlocals.lastSol = allSol;
+    if (options.usemodsol) {
+      for (ii = 0; ii < CORE_MODSOL_MAX; ii++) {
+        if (ii == 40)
+          ii = CORE_FIRSTCUSTSOL-1;
+        if (evlocals.lastModSol[ii] != coreGlobals.modulatedSolenoids[CORE_MODSOL_CUR][ii]) {
+          evlocals.lastModSol[ii] = coreGlobals.modulatedSolenoids[CORE_MODSOL_CUR][ii];
+          vp_queueEvent(now, VP_CHGEVENT_SOLENOID, ii+1, evlocals.lastModSol[ii]);
+        }
+      }
+      start = 40;
+      end = CORE_FIRSTCUSTSOL-1;
+      chgSol >>= start;
+      allSol >>= start;
+    }
+    for (ii = start; ii < end; ii++, chgSol >>= 1, allSol >>= 1)
+      if (chgSol & 0x01)
+        vp_queueEvent(now, VP_CHGEVENT_SOLENOID, ii+1, (int)(allSol & 0x01));
+  }
+
+  /*-- GI strings --*/
+  for (ii = 0; ii < CORE_MAXGI; ii++) {
+    if (coreGlobals.gi[ii] != evlocals.lastGI[ii]) {
+      evlocals.lastGI[ii] = coreGlobals.gi[ii];
+      vp_queueEvent(now, VP_CHGEVENT_GI, ii, evlocals.lastGI[ii]);
+    }
+  }
+}
+
+/*-------------------------------------------------
+/  get the queued change events (called by the host)
+/------------------------------------------------*/
+int vp_getChangeEvents(vp_tChgEvent *events, int maxEvents) {
+  unsigned int tail = evlocals.tail;
+  const unsigned int head = evlocals.head;
+  int idx = 0;
+
+  vp_memoryBarrier(); /* don't read events older than head */
+  for (; tail != head && idx < maxEvents; tail++)
+    events[idx++] = evlocals.events[tail & (VP_EVENTQUEUE_SIZE-1)];
+  vp_memoryBarrier(); /* done reading before the slots are given back */
+  evlocals.tail = tail;
+  return idx;
+}
+
+int vp_getChangeEventsLost(void) {
+  return evlocals.lost;
+}
@@ -5,6 +5,7 @@
 #endif
 
 #include "snd_cmd.h"
+#include "swrec.h"
 
 #ifdef VPINMAME
 	#define GAME_NOCRC 0x2000	//This should allow mame team to add at least a few more flags to gamedrv before it's a problem
@@ -19,6 +20,12 @@ typedef struct { int ledNo, chgSeg, currStat; } vp_tChgLED[128];
 typedef struct { int sndNo; } vp_tChgSound[MAX_CMD_LOG];
 typedef struct { int nvramNo, oldStat, currStat; } vp_tChgNVRAMs[CORE_MAXNVRAM];
 
+/*-- timestamped change events, see vp_getChangeEvents() --*/
+#define VP_CHGEVENT_LAMP     0
+#define VP_CHGEVENT_SOLENOID 1
+#define VP_CHGEVENT_GI       2
+typedef struct { double time; int type, no, currStat; } vp_tChgEvent;
+
 #define VP_MAXDIPBANKS 10
 /*----------------------------------------------------
 / Switches/Lamps are numbered differently in WPCgames
@@ -41,10 +48,17 @@ INLINE int vp_getWPCNumbering(void) { return WPCNUMBERING; }
 /-------------------------------------*/
 int vp_getLamp(int lampNo);
 
+/*------------------------------------
+/  get the brightness of a lamp (0=off .. 255=on)
+/  part of the last lamp matrix scans it was on in,
+/  WPC, System 11, Whitestar and SAM dim by PWM
+/-------------------------------------*/
+int vp_getLampLevel(int lampNo);
+
 /*------------------------------------
 /  set status of a switch (0=off, !0=on)
 /-------------------------------------*/
-INLINE void vp_putSwitch(int swNo, int newStat) { core_setSw(swNo, newStat); }
+INLINE void vp_putSwitch(int swNo, int newStat) { swrec_putSw(swNo, newStat); }
 
 /*------------------------------------
 /  get status of a switch (0=off, !0=on)
@@ -68,6 +82,23 @@ INLINE int vp_getGI(int giNo) { return coreGlobals.gi[giNo]; }
 /-------------------------------------*/
 int vp_getChangedLamps(vp_tChgLamps chgStat);
 
+/*-------------------------------------------
+/  get lamp/solenoid/GI changes in the order they happened
+/  with the emulated time (timer_get_time) of the change.
+/  Returns the number of events copied (at most maxEvents),
+/  call again until it returns less than maxEvents.
+/  Unlike the vp_getChanged* calls this doesn't scan anything,
+/  the events are queued while the emulation runs (one reader only).
+/  Only libpinmame builds queue them.
+/-------------------------------------*/
+int vp_getChangeEvents(vp_tChgEvent *events, int maxEvents);
+
+/*-------------------------------------------
+/  number of change events dropped because the
+/  reader didn't keep up (since vp_init)
+/-------------------------------------*/
+int vp_getChangeEventsLost(void);
+
 /*-------------------------------------------
 /  get all solenoids changed since last call
 /  returns number of canged solenoids
@@ -80,6 +111,14 @@ int vp_getChangedSolenoids(vp_tChgSols chgStat);
 /-------------------------------------*/
 int vp_getChangedGI(vp_tChgGIs chgStat);
 
+/*-------------------------------------------
+/  get all NVRAM bytes changed since last call
+/  (nvramNo is the offset in the NVRAM file)
+/  returns number of changed bytes or -1 if the
+/  driver doesn't report its NVRAM writes
+/-------------------------------------*/
+int vp_getChangedNVRAM(vp_tChgNVRAMs chgStat);
+
 /*------------------------------------
 /  get status of a game specific mechanic
 /-------------------------------------*/
@@ -108,6 +147,7 @@ void vp_setMechData(int para, int data);
 
 /*-- used from core.c --*/
 UINT64 vp_getSolMask64(void);
+void vp_queueChangeEvents(void);
 
 /*-------------------------------------------------
 /  get all sound commands issued since last call
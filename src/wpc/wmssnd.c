@@ -6,6 +6,7 @@
 #include "sound/2151intf.h"
 #include "sound/hc55516.h"
 #include "sound/dac.h"
+#include "state.h"
 #include "core.h"
 #include "sndbrd.h"
 #include "s11.h"
@@ -328,6 +329,8 @@ static const struct pia6821_interface s67s_pia = {
 static void s67s_init(struct sndbrdData *brdData) {
   s67slocals.brdData = *brdData;
   pia_config(S67S_PIA0, PIA_STANDARD_ORDERING, &s67s_pia);
+  state_save_register_UINT8("s67s", 0, "sndCmd", &s67slocals.sndCmd, 1);
+  state_save_register_UINT8("s67s", 0, "sndBitsA", &s67slocals.sndBitsA, 1);
 }
 
 static WRITE_HANDLER(s67s_ctrl_w) {
@@ -501,8 +504,13 @@ static const struct pia6821_interface s11s_pia[] = {{
 
 static struct {
   struct sndbrdData brdData;
+  int bankData;
 } s11slocals;
 
+static void s11s_postload(void) {
+  if (s11slocals.brdData.subType) s11s_bankSelect(0, s11slocals.bankData);
+}
+
 static void s11s_init(struct sndbrdData *brdData) {
   int hcgain = (core_gameData->hw.gameSpecific2 & 0x1ffff);
   int ymvol = ((core_gameData->hw.gameSpecific2) >> 18) & 0x7f;
@@ -512,7 +520,10 @@ static void s11s_init(struct sndbrdData *brdData) {
   if (s11slocals.brdData.subType) {
     cpu_setbank(S11S_BANK0, s11slocals.brdData.romRegion+0xc000);
     cpu_setbank(S11S_BANK1, s11slocals.brdData.romRegion+0x4000);
+    s11slocals.bankData = 0x03;
   }
+  state_save_register_int("s11s", 0, "bankData", &s11slocals.bankData);
+  state_save_register_func_postload(s11s_postload);
   if (hcgain != 0)
 	hc55516_set_gain(0, hcgain);
   if (ymvol != 0)
@@ -524,6 +535,7 @@ static WRITE_HANDLER(s11s_manCmd_w) {
   soundlatch_w(0, data); pia_set_input_ca1(S11S_PIA0, 1); pia_set_input_ca1(S11S_PIA0, 0);
 }
 static WRITE_HANDLER(s11s_bankSelect) {
+  s11slocals.bankData = data;
   cpu_setbank(S11S_BANK0, s11slocals.brdData.romRegion + 0x8000+((data&0x01)<<14));
   cpu_setbank(S11S_BANK1, s11slocals.brdData.romRegion + 0x0000+((data&0x02)<<13));
 }
@@ -613,10 +625,12 @@ static WRITE_HANDLER(s11cs_pia0cb2_w);
 static WRITE_HANDLER(s11cs_rombank_w);
 static WRITE_HANDLER(s11cs_manCmd_w);
 static void s11cs_init(struct sndbrdData *brdData);
+static void s11cs_postload(void);
 
 static struct {
   struct sndbrdData brdData;
   int ignore;
+  int romBank;
 } s11clocals;
 
 static WRITE_HANDLER(cslatch2_w) {
@@ -704,13 +718,20 @@ static const struct pia6821_interface s11cs_pia = {
 };
 
 static WRITE_HANDLER(s11cs_rombank_w) {
+  s11clocals.romBank = data;
   cpu_setbank(S11CS_BANK0, s11clocals.brdData.romRegion + 0x10000*(data & 0x03) + 0x8000*((data & 0x04)>>2));
 }
 static void s11cs_init(struct sndbrdData *brdData) {
   s11clocals.brdData = *brdData;
   s11clocals.ignore = core_gameData->hw.gameSpecific1 & S11_SNDDELAY ? 7 : 0;
   pia_config(S11CS_PIA0, PIA_STANDARD_ORDERING, &s11cs_pia);
-  cpu_setbank(S11CS_BANK0, s11clocals.brdData.romRegion);
+  s11cs_rombank_w(0, 0);
+  state_save_register_int("s11cs", 0, "ignore", &s11clocals.ignore);
+  state_save_register_int("s11cs", 0, "romBank", &s11clocals.romBank);
+  state_save_register_func_postload(s11cs_postload);
+}
+static void s11cs_postload(void) {
+  s11cs_rombank_w(0, s11clocals.romBank);
 }
 static WRITE_HANDLER(s11cs_manCmd_w) {
   cslatch2_w(0, data); pia_set_input_cb1(S11CS_PIA0, 1); pia_set_input_cb1(S11CS_PIA0, 0);
@@ -734,6 +755,7 @@ static void s11cs_piaIrqB(int state) {
 
 static void s11js_ym2151IRQ(int state);
 static void s11js_init(struct sndbrdData *brdData);
+static void s11js_postload(void);
 static WRITE_HANDLER(s11js_reply_w);
 static WRITE_HANDLER(s11js_rombank_w);
 static WRITE_HANDLER(s11js_ctrl_w);
@@ -743,6 +765,7 @@ static struct {
   struct sndbrdData brdData;
   int irqen;
   int ignore;
+  int romBank;
 } s11jlocals;
 
 static WRITE_HANDLER(jlatch2_w) {
@@ -807,12 +830,20 @@ MACHINE_DRIVER_START(wmssnd_s11js)
 MACHINE_DRIVER_END
 
 static WRITE_HANDLER(s11js_rombank_w) {
+  s11jlocals.romBank = data;
   cpu_setbank(S11JS_BANK0, s11jlocals.brdData.romRegion + 0x8000*(data & 0x01));
 }
 static void s11js_init(struct sndbrdData *brdData) {
   s11jlocals.brdData = *brdData;
   s11jlocals.ignore = 10;
 //  cpu_setbank(S11JS_BANK0, s11jlocals.brdData.romRegion);
+  state_save_register_int("s11js", 0, "irqen", &s11jlocals.irqen);
+  state_save_register_int("s11js", 0, "ignore", &s11jlocals.ignore);
+  state_save_register_int("s11js", 0, "romBank", &s11jlocals.romBank);
+  state_save_register_func_postload(s11js_postload);
+}
+static void s11js_postload(void) {
+  s11js_rombank_w(0, s11jlocals.romBank);
 }
 static WRITE_HANDLER(s11js_ctrl_w) {
   if (!s11jlocals.ignore) {
@@ -860,14 +891,24 @@ static struct {
   struct sndbrdData brdData;
   int replyAvail;
   int volume;
+  int romBank;
 } locals;
 
+static void wpcs_setVolume(void) {
+  int ch;
+  for (ch = 0; ch < MIXER_MAX_CHANNELS; ch++) {
+    if (mixer_get_name(ch) != NULL)
+      mixer_set_volume(ch, locals.volume * 100 / 127);
+  }
+}
+
 static WRITE_HANDLER(wpcs_rombank_w) {
   /* the hardware can actually handle 1M chip but no games used it */
   /* if such ROM appears the region must be doubled and mask set to 0x1f */
   /* this would be much easier if the region was filled in opposite order */
   /* but I don't want to change it now */
   int bankBase = data & 0x0f;
+  locals.romBank = data;
 #ifdef MAME_DEBUG
   /* this register can no be read but this makes debugging easier */
   *(memory_region(REGION_CPU1+locals.brdData.cpuNo) + 0x2000) = data;
@@ -893,13 +934,7 @@ static WRITE_HANDLER(wpcs_volume_w) {
     else if ((locals.volume < 0xff) && ((data & 0x02) == 0))
       locals.volume += 1;
     /* DBGLOG(("Volume set to %d\n",locals.volume)); */
-    {
-      int ch;
-      for (ch = 0; ch < MIXER_MAX_CHANNELS; ch++) {
-        if (mixer_get_name(ch) != NULL)
-          mixer_set_volume(ch, locals.volume * 100 / 127);
-      }
-    }
+    wpcs_setVolume();
   }
 }
 
@@ -1021,6 +1056,11 @@ static WRITE_HANDLER(wpcs_ctrl_w) { /*-- a write here resets the CPU --*/
   cpunum_set_reset_line(locals.brdData.cpuNo, PULSE_LINE);
 }
 
+static void wpcs_postload(void) {
+  wpcs_rombank_w(0, locals.romBank);
+  wpcs_setVolume();
+}
+
 static void wpcs_init(struct sndbrdData *brdData) {
   int hcgain = (core_gameData->hw.gameSpecific2 & 0x1ffff);
   int ymvol = ((core_gameData->hw.gameSpecific2) >> 18) & 0x7f;
@@ -1029,6 +1069,10 @@ static void wpcs_init(struct sndbrdData *brdData) {
   /* the non-paged ROM is at the end of the image. move it to its correct place */
   memcpy(memory_region(REGION_CPU1+locals.brdData.cpuNo) + 0x00c000, locals.brdData.romRegion + 0x07c000, 0x4000);
   wpcs_rombank_w(0,0);
+  state_save_register_int("wpcs", 0, "replyAvail", &locals.replyAvail);
+  state_save_register_int("wpcs", 0, "volume", &locals.volume);
+  state_save_register_int("wpcs", 0, "romBank", &locals.romBank);
+  state_save_register_func_postload(wpcs_postload);
   if (hcgain != 0)
 	hc55516_set_gain(0, hcgain);
   if (ymvol != 0)
@@ -1077,6 +1121,7 @@ static WRITE_HANDLER(dcs_data_w);
 static READ_HANDLER(dcs_ctrl_r);
 static WRITE_HANDLER(dcs_ctrl_w);
 static void dcs_init(struct sndbrdData *brdData);
+static void dcs_registerState(void);
 
 /*-- local data --*/
 #define DCS_BUFFER_SIZE	  8192  // Must be power of 2 because of how circular buffer works
@@ -1373,6 +1418,7 @@ static void dcs_init(struct sndbrdData *brdData) {
 #endif
   /*-- boot ADSP2100 --*/
   adsp_boot(0);
+  dcs_registerState();
 }
 
 /*-----------------
@@ -1512,6 +1558,55 @@ static struct {
   int    irqCount;
 } adsp_aBufData;
 
+/*-- save state --*/
+static struct {
+  INT32 ROMbankOffset;
+  INT32 RAMbanked;
+} dcssave;
+
+static void dcs_presave(void) {
+  dcssave.ROMbankOffset = dcslocals.ROMbankPtr - dcslocals.brdData.romRegion;
+  dcssave.RAMbanked = (dcslocals.RAMbankPtr == (UINT16 *)memory_region(DCS_BANKREGION));
+}
+
+static void dcs_postload(void) {
+  dcslocals.ROMbankPtr = dcslocals.brdData.romRegion + dcssave.ROMbankOffset;
+  dcslocals.RAMbankPtr = dcssave.RAMbanked ? (UINT16 *)memory_region(DCS_BANKREGION) :
+                         (UINT16 *)(dcslocals.cpuRegion + ADSP2100_DATA_OFFSET + (0x2000<<1));
+  /*-- the autobuffer timer is not saved, restart it from the registers --*/
+  if ((adsp.ctrlRegs[SYSCONTROL_REG] & 0x0800) && (adsp.ctrlRegs[S1_AUTOBUF_REG] & 0x0002) &&
+      adsp_aBufData.sRate && adsp_aBufData.step) {
+    double period = TIME_IN_HZ(adsp_aBufData.sRate) * adsp_aBufData.size / adsp_aBufData.step / DCS_IRQSTEPS;
+    timer_adjust(adsp.irqTimer, period, 0, period);
+  }
+  else
+    timer_enable(adsp.irqTimer, FALSE);
+}
+
+static void dcs_registerState(void) {
+  state_save_register_UINT16("dcs", 0, "ROMbank1", &dcslocals.ROMbank1, 1);
+  state_save_register_UINT16("dcs", 0, "ROMbank2", &dcslocals.ROMbank2, 1);
+  state_save_register_UINT16("dcs", 0, "RAMbank", &dcslocals.RAMbank, 1);
+  state_save_register_int   ("dcs", 0, "replyAvail", &dcslocals.replyAvail);
+  state_save_register_UINT8 ("dcs", 0, "bankRAM", memory_region(DCS_BANKREGION), memory_region_length(DCS_BANKREGION));
+  state_save_register_INT32 ("dcs", 0, "bankPtrs", &dcssave.ROMbankOffset, 2);
+  state_save_register_UINT16("dcs", 0, "ctrlRegs", adsp.ctrlRegs, 32);
+  state_save_register_UINT16("dcs", 0, "aBufStart", &adsp_aBufData.start, 1);
+  state_save_register_UINT16("dcs", 0, "aBufSize", &adsp_aBufData.size, 1);
+  state_save_register_UINT16("dcs", 0, "aBufStep", &adsp_aBufData.step, 1);
+  state_save_register_int   ("dcs", 0, "aBufRate", &adsp_aBufData.sRate);
+  state_save_register_int   ("dcs", 0, "aBufIReg", &adsp_aBufData.iReg);
+  state_save_register_int   ("dcs", 0, "aBufLast", &adsp_aBufData.last);
+  state_save_register_int   ("dcs", 0, "aBufIrqCount", &adsp_aBufData.irqCount);
+  state_save_register_int   ("dcs", 0, "dacStatus", &dcs_dac.status);
+  state_save_register_UINT32("dcs", 0, "dacOut", &dcs_dac.sOut, 1);
+  state_save_register_UINT32("dcs", 0, "dacIn", &dcs_dac.sIn, 1);
+  if (dcs_dac.buffer)
+    state_save_register_INT16("dcs", 0, "dacBuffer", dcs_dac.buffer, DCS_BUFFER_SIZE);
+  state_save_register_func_presave(dcs_presave);
+  state_save_register_func_postload(dcs_postload);
+}
+
 static void adsp_irqGen(int dummy) {
   int next;
 
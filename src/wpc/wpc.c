@@ -3,6 +3,7 @@
 #include <stdarg.h>
 #include <time.h>
 #include "driver.h"
+#include "state.h"
 #include "cpu/m6809/m6809.h"
 #include "sndbrd.h"
 #include "snd_cmd.h"
@@ -10,6 +11,7 @@
 #include "sim.h"
 #include "core.h"
 #include "wpc.h"
+#include "dmdkern.h"
 #ifdef PROC_SUPPORT
 #include "p-roc/p-roc.h"
 #endif
@@ -86,7 +88,7 @@ static SWITCH_UPDATE(wpc);
 /---------------------*/
 UINT8 *wpc_data;     /* WPC registers */
 
-#ifdef VPINMAME
+#ifdef CORE_RAWDMD
 extern UINT8  g_raw_gtswpc_dmd[];
 extern UINT32 g_raw_gtswpc_dmdframes;
 #endif
@@ -124,7 +126,7 @@ static struct {
   int zc;						/* zero cross flag */
   int gi_irqcnt;                /* Count IRQ occurrences for GI Dimming */
   int gi_active[CORE_MAXGI];    /* Used to check if GI string is accessed at all */
-  UINT32 solenoidbits[64];
+  core_tPWM solpwm[2];          /* modulated solenoids: 1-32, upper flippers 33-36 (bits 4-7) and aux board 51-58 (bits 8-15) */
   UINT32 modsol_seen_pulses;
   UINT8 modsol_seen_flip_pulses;
   UINT8 modsol_seen_aux_pulses;
@@ -141,6 +143,12 @@ static struct {
   int    nextDMDFrame;
 } dmdlocals;
 
+/*-- pointers kept as region offsets in a save state, see wpc_presave --*/
+static struct {
+  INT32 bank[8];
+  INT32 DMDFrames[DMD_FRAMES];
+} wpcsave;
+
 /*-- pointers --*/
 static mame_file *wpc_printfile = NULL;
 UINT8 *wpc_ram = NULL;
@@ -617,6 +625,7 @@ READ_HANDLER(wpc_r) {
       checksum = 0xffff - checksum;
       *timeMem++ = checksum>>8;
       *timeMem   = checksum & 0xff;
+      memory_track_write(wpc_ram + 0x1800, 9);
       return systime->tm_hour;
     }
     case WPC_RTCMIN: {
@@ -716,9 +725,11 @@ WRITE_HANDLER(wpc_w) {
       break;
     case WPC_LAMPROW: /* row and column can be written in any order */
       core_setLamp(coreGlobals.tmpLampMatrix,wpc_data[WPC_LAMPCOLUMN],data);
+      core_pwm_lampStrobe(wpc_data[WPC_LAMPCOLUMN],data);
       break;
     case WPC_LAMPCOLUMN: /* row and column can be written in any order */
       core_setLamp(coreGlobals.tmpLampMatrix,data,wpc_data[WPC_LAMPROW]);
+      core_pwm_lampStrobe(data,wpc_data[WPC_LAMPROW]);
       break;
     case WPC_SWCOLSELECT:
       if (core_gameData->gen & GENWPC_HASPIC)
@@ -900,8 +911,10 @@ WRITE_HANDLER(wpc_w) {
 /---------------------------*/
 static WRITE_HANDLER(wpc_ram_w) {
   if ((wpc_data[WPC_PROTMEM] == WPC_PROTMEMCODE) ||
-      ((offset & wpclocals.memProtMask) != wpclocals.memProtMask))
+      ((offset & wpclocals.memProtMask) != wpclocals.memProtMask)) {
     wpc_ram[offset] = data;
+    memory_track_write(&wpc_ram[offset], 1);
+  }
   else DBGLOG(("mem prot violation. PC=%04x a=%04x d=%02x\n",activecpu_get_pc(), offset, data));
 }
 
@@ -963,25 +976,13 @@ static INTERRUPT_GEN(wpc_irq) {
 			wpclocals.modsol_sample = 0;
 			
 			// Messy mappings to duplicate what the core does, see core_getSol()
-			for (i = 0; i < 32; i++)
-			{
-				core_update_modulated_light(&wpclocals.solenoidbits[i], wpclocals.modsol_seen_pulses & (1 << i));
-			}
+			core_pwm_record(&wpclocals.solpwm[0], wpclocals.modsol_seen_pulses);
+			core_pwm_record(&wpclocals.solpwm[1], (wpclocals.modsol_seen_flip_pulses & wpclocals.nonFlipBits & 0xf0) |
+			                                      ((wpc_modsol_aux_board > 0) ? wpclocals.modsol_seen_aux_pulses << 8 : 0));
 			wpclocals.modsol_seen_pulses = coreGlobals.pulsedSolState;
-			for (i = 4; i < 8; i++)
-			{
-				if (wpclocals.nonFlipBits & (1 << i))
-				{
-					core_update_modulated_light(&wpclocals.solenoidbits[i + 28], wpclocals.modsol_seen_flip_pulses & (1 << i));
-				}
-			}
 			wpclocals.modsol_seen_flip_pulses = wpclocals.solFlipPulse;
 			if (wpc_modsol_aux_board > 0)
 			{
-				for (i = 0; i < 8; i++)
-				{
-					core_update_modulated_light(&wpclocals.solenoidbits[CORE_FIRSTCUSTSOL + i - 1], wpclocals.modsol_seen_aux_pulses & (1 << i));
-				}
 				wpclocals.modsol_seen_aux_pulses = (wpc_modsol_aux_board == 1) ? wpc_data[WPC_EXTBOARD1] : wpc_data[WPC_EXTBOARD2];
 			}
 			if (wpclocals.modsol_count < WPC_MODSOLSMOOTH)
@@ -990,18 +991,21 @@ static INTERRUPT_GEN(wpc_irq) {
 			}
 			else
 			{
+				UINT8 level[32], extLevel[16];
 				wpclocals.modsol_count  = 0;
+				core_pwm_levels(&wpclocals.solpwm[0], 32, level);
+				core_pwm_levels(&wpclocals.solpwm[1], 16, extLevel);
 				// TODO: Does GEN_ALLWPC apply to everything in this driver?  If yes this check is not needed here, but I can
 				// see the same check is made in the P-ROC stuff above?
 				for (i = 0; i < ((core_gameData->gen & GEN_ALLWPC) ? 28 : 32); i++)
 				{
-					coreGlobals.modulatedSolenoids[CORE_MODSOL_CUR][i] = core_calc_modulated_light(wpclocals.solenoidbits[i], WPC_MODSOLSMOOTH, &coreGlobals.modulatedSolenoids[CORE_MODSOL_PREV][i]);
+					coreGlobals.modulatedSolenoids[CORE_MODSOL_CUR][i] = level[i];
 				}
 				for (i = 4; i < 8; i++)
 				{
 					if (wpclocals.nonFlipBits & (1 << i))
 					{
-						coreGlobals.modulatedSolenoids[CORE_MODSOL_CUR][i + 28] = core_calc_modulated_light(wpclocals.solenoidbits[i + 28], WPC_MODSOLSMOOTH, &coreGlobals.modulatedSolenoids[CORE_MODSOL_PREV][i + 28]);
+						coreGlobals.modulatedSolenoids[CORE_MODSOL_CUR][i + 28] = extLevel[i];
 					}
 					else
 					{
@@ -1012,7 +1016,7 @@ static INTERRUPT_GEN(wpc_irq) {
 				{
 					for (i = 36; i < 40; i++)
 					{
-						coreGlobals.modulatedSolenoids[CORE_MODSOL_CUR][i] = core_calc_modulated_light(wpclocals.solenoidbits[i - 8], WPC_MODSOLSMOOTH, &coreGlobals.modulatedSolenoids[CORE_MODSOL_PREV][i - 8]);
+						coreGlobals.modulatedSolenoids[CORE_MODSOL_CUR][i] = level[i - 8];
 					}
 				}
 				else
@@ -1034,7 +1038,7 @@ static INTERRUPT_GEN(wpc_irq) {
 				for (i = 0; i < core_gameData->hw.custSol; i++)
 				{
 					if (i < 8 && wpc_modsol_aux_board > 0)
-						coreGlobals.modulatedSolenoids[CORE_MODSOL_CUR][CORE_FIRSTCUSTSOL + i - 1] = core_calc_modulated_light(wpclocals.solenoidbits[CORE_FIRSTCUSTSOL + i - 1], WPC_MODSOLSMOOTH, &coreGlobals.modulatedSolenoids[CORE_MODSOL_PREV][CORE_FIRSTCUSTSOL + i - 1]);
+						coreGlobals.modulatedSolenoids[CORE_MODSOL_CUR][CORE_FIRSTCUSTSOL + i - 1] = extLevel[i + 8];
 					else
 						coreGlobals.modulatedSolenoids[CORE_MODSOL_CUR][CORE_FIRSTCUSTSOL + i - 1] = core_getSol(CORE_FIRSTCUSTSOL + i) ? 1 :0;
 				}
@@ -1073,12 +1077,89 @@ static WRITE_HANDLER(snd_data_cb) { // WPCS sound generates FIRQ on reply
   wpc_firq(TRUE, WPC_FIRQ_SOUND);
 }
 
+/*-----------------------------------------------
+/ Save state. The ROM and DMD pages are mapped
+/ with pointers, they are saved as region offsets.
+/------------------------------------------------*/
+static const int wpc_saveRegions[] = { WPC_ROMREGION, WPC_DMDREGION, WPC_CPUREGION };
+
+static INT32 wpc_ptrToOffset(const UINT8 *ptr) {
+  int ii;
+  for (ii = 0; ii < sizeof(wpc_saveRegions)/sizeof(wpc_saveRegions[0]); ii++) {
+    const UINT8 *base = memory_region(wpc_saveRegions[ii]);
+    if (base && ptr >= base && ptr < base + memory_region_length(wpc_saveRegions[ii]))
+      return (ii << 24) | (INT32)(ptr - base);
+  }
+  return -1;
+}
+
+static UINT8 *wpc_offsetToPtr(INT32 offset) {
+  return (offset < 0) ? NULL : memory_region(wpc_saveRegions[offset >> 24]) + (offset & 0xffffff);
+}
+
+static void wpc_presave(void) {
+  int ii;
+  for (ii = 1; ii < 8; ii++)
+    wpcsave.bank[ii] = wpc_ptrToOffset(cpu_bankbase[ii]);
+  for (ii = 0; ii < DMD_FRAMES; ii++)
+    wpcsave.DMDFrames[ii] = wpc_ptrToOffset(dmdlocals.DMDFrames[ii]);
+}
+
+static void wpc_postload(void) {
+  int ii;
+  for (ii = 1; ii < 8; ii++)
+    if (wpcsave.bank[ii] >= 0)
+      cpu_setbank(ii, wpc_offsetToPtr(wpcsave.bank[ii]));
+#ifdef PINMAME
+  if ((wpcsave.bank[1] >> 24) == 0)
+    cpu_bankid[1] = (wpcsave.bank[1] & 0xffffff) / 0x4000 + (0x3F ^ wpclocals.pageMask);
+#endif /* PINMAME */
+  for (ii = 0; ii < DMD_FRAMES; ii++)
+    if (wpcsave.DMDFrames[ii] >= 0)
+      dmdlocals.DMDFrames[ii] = wpc_offsetToPtr(wpcsave.DMDFrames[ii]);
+}
+
+static void wpc_registerState(void) {
+  state_save_register_UINT16("wpc", 0, "memProtMask",  &wpclocals.memProtMask, 1);
+  state_save_register_UINT32("wpc", 0, "solData",      &wpclocals.solData, 1);
+  state_save_register_UINT8 ("wpc", 0, "solFlip",      &wpclocals.solFlip, 1);
+  state_save_register_UINT8 ("wpc", 0, "solFlipPulse", &wpclocals.solFlipPulse, 1);
+  state_save_register_UINT8 ("wpc", 0, "nonFlipBits",  &wpclocals.nonFlipBits, 1);
+  state_save_register_int   ("wpc", 0, "vblankCount",  &wpclocals.vblankCount);
+  state_save_register_UINT16("wpc", 0, "alphaSeg",     &wpclocals.alphaSeg[0].w, CORE_SEGCOUNT);
+  state_save_register_UINT8 ("wpc", 0, "pic.sData",    wpclocals.pic.sData, 16);
+  state_save_register_UINT8 ("wpc", 0, "pic.codeNo",   wpclocals.pic.codeNo, 3);
+  state_save_register_UINT8 ("wpc", 0, "pic.lastW",    &wpclocals.pic.lastW, 1);
+  state_save_register_UINT8 ("wpc", 0, "pic.sNoS",     &wpclocals.pic.sNoS, 1);
+  state_save_register_UINT8 ("wpc", 0, "pic.count",    &wpclocals.pic.count, 1);
+  state_save_register_int   ("wpc", 0, "pic.codeW",    &wpclocals.pic.codeW);
+  state_save_register_int   ("wpc", 0, "firqSrc",      &wpclocals.firqSrc);
+  state_save_register_int   ("wpc", 0, "diagnostic",   &wpclocals.diagnostic);
+  state_save_register_int   ("wpc", 0, "zc",           &wpclocals.zc);
+  state_save_register_int   ("wpc", 0, "gi_irqcnt",    &wpclocals.gi_irqcnt);
+  state_save_register_INT32 ("wpc", 0, "gi_active",    (INT32 *)wpclocals.gi_active, CORE_MAXGI);
+  state_save_register_UINT32("wpc", 0, "solpwm",       (UINT32 *)wpclocals.solpwm, 2 * sizeof(core_tPWM) / sizeof(UINT32));
+  state_save_register_UINT32("wpc", 0, "modsol_seen_pulses",      &wpclocals.modsol_seen_pulses, 1);
+  state_save_register_UINT8 ("wpc", 0, "modsol_seen_flip_pulses", &wpclocals.modsol_seen_flip_pulses, 1);
+  state_save_register_UINT8 ("wpc", 0, "modsol_seen_aux_pulses",  &wpclocals.modsol_seen_aux_pulses, 1);
+  state_save_register_int   ("wpc", 0, "modsol_count",  &wpclocals.modsol_count);
+  state_save_register_int   ("wpc", 0, "modsol_sample", &wpclocals.modsol_sample);
+  state_save_register_int   ("wpc", 0, "nextDMDFrame",  &dmdlocals.nextDMDFrame);
+  state_save_register_UINT8 ("wpc", 0, "dmdRAM",        memory_region(WPC_DMDREGION), memory_region_length(WPC_DMDREGION));
+  state_save_register_INT32 ("wpc", 0, "banks",         wpcsave.bank, 8);
+  state_save_register_INT32 ("wpc", 0, "DMDFrames",     wpcsave.DMDFrames, DMD_FRAMES);
+  state_save_register_func_presave(wpc_presave);
+  state_save_register_func_postload(wpc_postload);
+}
+
 static MACHINE_INIT(wpc) {
                               /*128K  256K        512K        768K       1024K*/
   static const int romLengthMask[] = {0x07, 0x0f, 0x00, 0x1f, 0x00, 0x00, 0x00, 0x3f};
   size_t romLength = memory_region_length(WPC_ROMREGION);
 
   memset(&wpclocals, 0, sizeof(wpclocals));
+  core_pwm_init(&wpclocals.solpwm[0], WPC_MODSOLSMOOTH);
+  core_pwm_init(&wpclocals.solpwm[1], WPC_MODSOLSMOOTH);
 
   // map dmd banks to standard ram for games that don't use it
   cpu_setbank(4, memory_region(WPC_CPUREGION) + 0x3000);
@@ -1135,6 +1216,7 @@ static MACHINE_INIT(wpc) {
     *(memory_region(WPC_CPUREGION) + 0xffec) = 0x00;
     *(memory_region(WPC_CPUREGION) + 0xffed) = 0xff;
   }
+  wpc_registerState();
 }
 
 static MACHINE_STOP(wpc) {
@@ -1151,9 +1233,31 @@ static MACHINE_STOP(wpc) {
 / The RAM size was changed from 8K to 16K starting with
 / DCS generation
 /-------------------------------------------------*/
+static size_t wpc_nvramSize(void) {
+  return (core_gameData->gen & (GEN_WPCDCS | GEN_WPCSECURITY | GEN_WPC95 | GEN_WPC95DCS)) ? 0x3000 : 0x2000;
+}
+
+/*-- -bootsnapshot: settings, audits and high scores are in the protected memory, --*/
+/*-- the rest of the SRAM stays as the snapshot has it                             --*/
+static void wpc_mergeNVRAM(const UINT8 *nvram, UINT32 size) {
+  const size_t ramSize = wpc_nvramSize();
+  size_t ii;
+
+  if (size < ramSize) return;
+  for (ii = 0; ii < ramSize; ii++)
+    if ((ii & wpclocals.memProtMask) == wpclocals.memProtMask)
+      wpc_ram[ii] = nvram[ii];
+  memory_track_write(wpc_ram, ramSize);
+}
+
 static NVRAM_HANDLER(wpc) {
-  core_nvram(file, read_or_write, wpc_ram,
-             (core_gameData->gen & (GEN_WPCDCS | GEN_WPCSECURITY | GEN_WPC95 | GEN_WPC95DCS)) ? 0x3000 : 0x2000,0xff);
+  size_t size = wpc_nvramSize();
+  core_nvram(file, read_or_write, wpc_ram, size, 0xff);
+  /*-- wpc_ram_w reports the writes for the host (ChangedNVRAM) --*/
+  if (!read_or_write) {
+    memory_track_region(wpc_ram, size);
+    cpu_set_bootsnap_nvram(wpc_mergeNVRAM);
+  }
 }
 
 static void wpc_serialCnv(const char no[21], UINT8 pic[16], UINT8 code[3]) {
@@ -1210,44 +1314,17 @@ static VIDEO_START(wpc_dmd) {
 //static VIDEO_UPDATE(wpc_dmd) {
 PINMAME_VIDEO_UPDATE(wpcdmd_update) {
   tDMDDot dotCol;
-  int ii,jj,kk;
 
-#ifdef VPINMAME
+#ifdef CORE_RAWDMD
   g_raw_gtswpc_dmdframes = DMD_FRAMES;
+  memcpy(g_raw_gtswpc_dmd,         dmdlocals.DMDFrames[0], 0x200);
+  memcpy(g_raw_gtswpc_dmd + 0x200, dmdlocals.DMDFrames[1], 0x200);
+  memcpy(g_raw_gtswpc_dmd + 0x400, dmdlocals.DMDFrames[2], 0x200);
 #endif
 
-  /* Create a temporary buffer with all pixels */
-  for (kk = 0, ii = 1; ii < 33; ii++) {
-    UINT8 *line = &dotCol[ii][0];
-    for (jj = 0; jj < 16; jj++) {
-      /* Intensity depends on how many times the pixel */
-      /* been on in the last 3 frames                  */
-      const unsigned int intens1 = ((dmdlocals.DMDFrames[0][kk] & 0x55) +
-                                    (dmdlocals.DMDFrames[1][kk] & 0x55) +
-                                    (dmdlocals.DMDFrames[2][kk] & 0x55));
-      const unsigned int intens2 = ((dmdlocals.DMDFrames[0][kk] & 0xaa) +
-                                    (dmdlocals.DMDFrames[1][kk] & 0xaa) +
-                                    (dmdlocals.DMDFrames[2][kk] & 0xaa));
-
-#ifdef VPINMAME
-      g_raw_gtswpc_dmd[kk        ] = dmdlocals.DMDFrames[0][kk];
-      g_raw_gtswpc_dmd[kk + 0x200] = dmdlocals.DMDFrames[1][kk];
-      g_raw_gtswpc_dmd[kk + 0x400] = dmdlocals.DMDFrames[2][kk];
-#endif
-
-      *line++ = (intens1)    & 0x03;
-      *line++ = (intens2>>1) & 0x03;
-      *line++ = (intens1>>2) & 0x03;
-      *line++ = (intens2>>3) & 0x03;
-      *line++ = (intens1>>4) & 0x03;
-      *line++ = (intens2>>5) & 0x03;
-      *line++ = (intens1>>6) & 0x03;
-      *line++ = (intens2>>7) & 0x03;
-
-      kk++;
-    }
-    *line = 0; /* to simplify antialiasing */
-  }
+  /* Intensity depends on how many times the pixel */
+  /* been on in the last 3 frames                  */
+  dmdk_accumulate(dotCol, (const UINT8 * const *)dmdlocals.DMDFrames, DMD_FRAMES, 128, 32, 1);
   video_update_core_dmd(bitmap, cliprect, dotCol, layout);
   return 0;
 }